@@ -0,0 +1,270 @@
+//
+// CoreBench.cpp
+//	Microbenchmarks of the viewer's CPU hot paths, with no window or GPU: OBJ parsing and mesh building
+//	(on a synthetic grid OBJ), Matrix4 multiply and inverse, sphere generation at high segment counts,
+//	JSON parsing of a large scene file, and SceneManager lookups. Each benchmark takes a number of
+//	samples, each timing enough operations to last a few milliseconds, and reports the median, p95 and
+//	median absolute deviation of the time per operation.
+//
+// Usage: coreBench [--obj-size N] [--sphere-segments N] [--scene-objects N] [--samples N]
+//					[--filter TEXT] [--json FILE]
+//	(defaults: a 128 × 128-quad OBJ, 256 segments, 2,000 scene objects, 30 samples;
+//	 --filter runs only benchmarks whose names contain TEXT, --json also writes results as JSON)
+//
+#include "geometry/ObjLoader.h"
+#include "geometry/GeometryGenerator.h"
+#include "math/Matrix4.h"
+#include "scene/SceneManager.h"
+#include "scene/GeneratedModel.h"
+#include "utils/FrameStats.h"
+#include "utils/JsonSupport.h"
+#include "utils/logger/Logging.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+namespace {
+	const double SAMPLE_TARGET_MS = 5.0;	// (each sample repeats its operation for about this long)
+
+	float sink = 0.0f;		// (results feed this, so timed loops aren't optimized away)
+
+	struct Settings {
+		int objSize = 128;
+		int sphereSegments = 256;
+		int sceneObjects = 2000;
+		int samples = 30;
+		std::string filter;
+		std::string jsonFile;
+	};
+
+	// (in whichever unit keeps it readable)
+	std::string formatTime(double milliseconds) {
+		char text[32];
+		if (milliseconds >= 1.0) {
+			snprintf(text, sizeof(text), "%.2f ms", milliseconds);
+		} else if (milliseconds >= 1e-3) {
+			snprintf(text, sizeof(text), "%.2f us", milliseconds * 1e3);
+		} else {
+			snprintf(text, sizeof(text), "%.1f ns", milliseconds * 1e6);
+		}
+		return text;
+	}
+
+	double millisecondsSince(Clock::time_point startTime) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+	}
+
+	// Time 'operation' (which performs 'opsPerCall' operations each call) as samples of ms per operation
+	FrameStats measure(const std::function<void()>& operation, size_t opsPerCall, int samples) {
+		auto startTime = Clock::now();
+		operation();		// (warm up, and estimate how many calls fill a sample)
+		double callMs = std::max(millisecondsSince(startTime), 1e-6);
+		size_t callsPerSample = std::max<size_t>(1, static_cast<size_t>(SAMPLE_TARGET_MS / callMs));
+
+		FrameStats stats;
+		stats.reserve(samples);
+		for (int sample = 0; sample < samples; ++sample) {
+			startTime = Clock::now();
+			for (size_t call = 0; call < callsPerSample; ++call) {
+				operation();
+			}
+			stats.add(millisecondsSince(startTime) / (callsPerSample * opsPerCall));
+		}
+		return stats;
+	}
+
+	// A flat grid of size × size quads, with positions, texture coordinates and normals, as v/vt/vn faces
+	std::string syntheticObj(int size) {
+		std::ostringstream obj;
+		obj << "# synthetic " << size << " x " << size << " grid\n";
+		for (int z = 0; z <= size; ++z) {
+			for (int x = 0; x <= size; ++x) {
+				obj << "v " << x * 0.01f << " " << (x * z % 7) * 0.001f << " " << z * 0.01f << "\n";
+				obj << "vt " << static_cast<float>(x) / size << " " << static_cast<float>(z) / size << "\n";
+			}
+		}
+		obj << "vn 0 1 0\n";
+		int row = size + 1;
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				int a = z * row + x + 1, b = a + 1, c = a + row + 1, d = a + row;
+				obj << "f " << a << "/" << a << "/1 " << b << "/" << b << "/1 "
+					<< c << "/" << c << "/1 " << d << "/" << d << "/1\n";
+			}
+		}
+		return obj.str();
+	}
+
+	// A scene of objects of every generated shape, each of the first quarter parenting four others
+	void populateScene(SceneManager& scene, int objectCount) {
+		const GeneratedModel::Shape shapes[] = { GeneratedModel::Shape::CUBE, GeneratedModel::Shape::SPHERE,
+			GeneratedModel::Shape::DODECAHEDRON, GeneratedModel::Shape::CYLINDER, GeneratedModel::Shape::PLANE };
+		for (int i = 0; i < objectCount; ++i) {
+			auto object = std::make_unique<GeneratedModel>(shapes[i % 5], "Object " + std::to_string(i));
+			object->setPosition(Vector3(static_cast<float>(i % 50), 0.0f, static_cast<float>(i / 50)));
+			scene.addObject(std::move(object));
+		}
+		for (int i = 1; i < objectCount; ++i) {
+			scene.setParent(scene.getObject(i), scene.getObject((i - 1) / 4));
+		}
+	}
+
+	bool parseArguments(int argc, char* argv[], Settings& settings) {
+		for (int i = 1; i < argc; ++i) {
+			std::string argument = argv[i];
+			if (i + 1 >= argc) {
+				return false;
+			}
+			const char* value = argv[++i];
+			if (argument == "--obj-size") {
+				settings.objSize = std::max(1, atoi(value));
+			} else if (argument == "--sphere-segments") {
+				settings.sphereSegments = std::max(3, atoi(value));
+			} else if (argument == "--scene-objects") {
+				settings.sceneObjects = std::max(1, atoi(value));
+			} else if (argument == "--samples") {
+				settings.samples = std::max(1, atoi(value));
+			} else if (argument == "--filter") {
+				settings.filter = value;
+			} else if (argument == "--json") {
+				settings.jsonFile = value;
+			} else {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Settings settings;
+	if (!parseArguments(argc, argv, settings)) {
+		Log(ERROR, "Usage: coreBench [--obj-size N] [--sphere-segments N] [--scene-objects N] [--samples N] "
+				   "[--filter TEXT] [--json FILE]");
+		return EXIT_FAILURE;
+	}
+
+	json results = json::array();
+	auto run = [&](const std::string& name, size_t opsPerCall, const std::function<void()>& operation) {
+		if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos) {
+			return;
+		}
+		FrameStats stats = measure(operation, opsPerCall, settings.samples);
+		double median = stats.percentile(50.0);
+		Log(RAW, "%-48s %12s %12s %12s %8.1f%%", name.c_str(), formatTime(median).c_str(),
+			formatTime(stats.percentile(95.0)).c_str(), formatTime(stats.medianAbsoluteDeviation()).c_str(),
+			median > 0.0 ? 100.0 * stats.medianAbsoluteDeviation() / median : 0.0);
+
+		json result = stats.toJson();
+		result["name"] = name;
+		result["opsPerCall"] = static_cast<double>(opsPerCall);
+		results.push_back(result);
+	};
+
+	Log(RAW, "%d samples of each, times per operation", settings.samples);
+	Log(RAW, "%-48s %12s %12s %12s %9s", "benchmark", "median", "p95", "MAD", "MAD/med");
+
+	// OBJ loading, in its two stages
+	std::string objText = syntheticObj(settings.objSize);
+	ObjLoader loader;
+	run("ObjLoader::parseObj (" + std::to_string(objText.size() / 1024) + " KB)", 1, [&]() {
+		sink += static_cast<float>(loader.parseObj(objText).faceVertices.size());
+	});
+	ObjLoader::ObjData objData = loader.parseObj(objText);
+	run("ObjLoader::buildMeshFromObjData (" + std::to_string(objData.faceVertices.size() / 3) + " tris)", 1, [&]() {
+		sink += static_cast<float>(loader.buildMeshFromObjData(objData)->getVertices().size());
+	});
+
+	// Matrix4 over a batch bigger than a few cache lines, but well within L2
+	const size_t MATRIX_COUNT = 1024;
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+	std::vector<Matrix4> matrices(MATRIX_COUNT), products(MATRIX_COUNT);
+	for (Matrix4& matrix : matrices) {
+		matrix = Matrix4::trs(Vector3(position(random), position(random), position(random)),
+							  Vector3(angle(random), angle(random), angle(random)),
+							  Vector3(scale(random), scale(random), scale(random)));
+	}
+	run("Matrix4 multiply", MATRIX_COUNT, [&]() {
+		for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+			products[i] = matrices[i] * matrices[(i + 1) % MATRIX_COUNT];
+		}
+		sink += products[0](0, 0);
+	});
+	run("Matrix4::inverted", MATRIX_COUNT, [&]() {
+		for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+			products[i] = matrices[i].inverted();
+		}
+		sink += products[0](0, 0);
+	});
+
+	// Geometry generation
+	run("GeometryGenerator::createSphere (" + std::to_string(settings.sphereSegments) + " segments)", 1, [&]() {
+		sink += static_cast<float>(GeometryGenerator::createSphere(1.0f, settings.sphereSegments)->getIndices().size());
+	});
+
+	// A large scene: parsing its file, and looking objects up in it
+	SceneManager scene;
+	populateScene(scene, settings.sceneObjects);
+	std::string sceneText = scene.serialize().dump(2);
+	run("JsonValue::parse (" + std::to_string(sceneText.size() / 1024) + " KB scene)", 1, [&]() {
+		const json parsed = json::parse(sceneText);
+		sink += static_cast<float>(parsed["objects"].size());
+	});
+
+	const size_t LOOKUP_COUNT = 256;
+	std::vector<std::string> names(LOOKUP_COUNT);
+	std::vector<SceneObject*> objects(LOOKUP_COUNT);
+	std::uniform_int_distribution<int> objectIndex(0, settings.sceneObjects - 1);
+	for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+		int index = objectIndex(random);
+		names[i] = "Object " + std::to_string(index);
+		objects[i] = scene.getObject(index);
+	}
+	run("SceneManager::findObject (" + std::to_string(settings.sceneObjects) + " objects)", LOOKUP_COUNT, [&]() {
+		for (const std::string& name : names) {
+			sink += scene.findObject(name) != nullptr ? 1.0f : 0.0f;
+		}
+	});
+	run("SceneManager::getParent", LOOKUP_COUNT, [&]() {
+		for (SceneObject* object : objects) {
+			sink += scene.getParent(object) != nullptr ? 1.0f : 0.0f;
+		}
+	});
+	run("SceneManager::getChildren", LOOKUP_COUNT, [&]() {
+		for (SceneObject* object : objects) {
+			sink += static_cast<float>(scene.getChildren(object).size());
+		}
+	});
+
+	if (!settings.jsonFile.empty()) {
+		json report;
+		report["objSize"] = settings.objSize;
+		report["sphereSegments"] = settings.sphereSegments;
+		report["sceneObjects"] = settings.sceneObjects;
+		report["samples"] = settings.samples;
+		report["unit"] = std::string("ms per operation");
+		report["benchmarks"] = results;
+		std::ofstream file(settings.jsonFile);
+		if (!file) {
+			Log(ERROR, "Can't write %s", settings.jsonFile.c_str());
+			return EXIT_FAILURE;
+		}
+		file << report.dump(4) << std::endl;
+		Log(RAW, "Results written to %s", settings.jsonFile.c_str());
+	}
+
+	Log(RAW, "(sink: %g)", sink);
+	return EXIT_SUCCESS;
+}
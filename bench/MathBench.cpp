@@ -0,0 +1,248 @@
+//
+// MathBench.cpp
+//	Microbenchmark of the SIMD matrix kernels against their scalar reference versions,
+//	which also checks that both agree to within a number of bits. Likewise quaternion rotations
+//	against the Euler-angle matrices they replace.
+//
+// Usage: mathBench [passes]
+//	(exits with failure if any kernel disagrees with its reference beyond tolerance)
+//
+#include "math/MatrixKernels.h"
+#include "math/Matrix4.h"
+#include "math/Quaternion.h"
+#include "utils/logger/Logging.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+namespace {
+	const size_t MATRIX_COUNT = 1024;
+	const size_t POINT_COUNT = 4096;
+
+	float sink = 0.0f;		// (results feed this, so timed loops aren't optimized away)
+
+	template<typename Function>
+	double nanosecondsPerOp(Function function, int passes, size_t opsPerPass) {
+		function();		// (warm up)
+		auto startTime = Clock::now();
+		for (int pass = 0; pass < passes; ++pass) {
+			function();
+		}
+		double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - startTime).count();
+		return elapsed / (static_cast<double>(passes) * opsPerPass);
+	}
+
+	// Bits to which 'fast' agrees with 'reference', relative to the largest magnitude in each group
+	//	of 'stride' values (one matrix or vector), so near-zero elements aren't held to relative precision.
+	float agreementBits(const float* reference, const float* fast, size_t count, size_t stride) {
+		double worst = 0.0;
+		for (size_t group = 0; group < count; group += stride) {
+			double scale = 1e-30;
+			for (size_t i = group; i < group + stride; ++i) {
+				scale = std::max(scale, static_cast<double>(std::fabs(reference[i])));
+			}
+			for (size_t i = group; i < group + stride; ++i) {
+				worst = std::max(worst, std::fabs(static_cast<double>(fast[i]) - reference[i]) / scale);
+			}
+		}
+		return worst == 0.0 ? 24.0f : static_cast<float>(std::min(24.0, -std::log2(worst)));
+	}
+
+	bool report(const char* name, double referenceNs, double fastNs, float bits, float minBits) {
+		bool pass = bits >= minBits;
+		Log(RAW, "%-20s %9.2f ns %9.2f ns %7.2fx   %5.1f bits (min %.0f)  %s", name, referenceNs, fastNs,
+			referenceNs / fastNs, bits, minBits, pass ? "ok" : "FAIL");
+		return pass;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	int passes = argc > 1 ? std::max(1, atoi(argv[1])) : 2000;
+
+	// Well-conditioned TRS matrices, as models have
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+
+	std::vector<Vector3> translations(MATRIX_COUNT), rotations(MATRIX_COUNT), scales(MATRIX_COUNT);
+	std::vector<float> matrices(MATRIX_COUNT * 16);
+	for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+		translations[i] = Vector3(position(random), position(random), position(random));
+		rotations[i] = Vector3(angle(random), angle(random), angle(random));
+		scales[i] = Vector3(scale(random), scale(random), scale(random));
+		MatrixKernels::Reference::composeTRS(translations[i], rotations[i], scales[i], &matrices[i * 16]);
+	}
+	std::vector<Vector3> points(POINT_COUNT);
+	for (Vector3& point : points) {
+		point = Vector3(position(random), position(random), position(random));
+	}
+
+	std::vector<float> referenceOut(MATRIX_COUNT * 16), fastOut(MATRIX_COUNT * 16);
+	std::vector<Vector3> referencePoints(POINT_COUNT), fastPoints(POINT_COUNT);
+	bool allPass = true;
+
+	Log(RAW, "Matrix kernels: %s (vs scalar reference), %d passes", MatrixKernels::backendName(), passes);
+	Log(RAW, "%-20s %12s %12s %8s   %s", "kernel", "reference", "simd", "speedup", "agreement");
+
+	// Multiply
+	auto multiplyAll = [&](auto multiply, std::vector<float>& out) {
+		return [&, multiply]() {
+			for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+				multiply(&matrices[i * 16], &matrices[((i + 1) % MATRIX_COUNT) * 16], &out[i * 16]);
+			}
+			sink += out[0];
+		};
+	};
+	double referenceNs = nanosecondsPerOp(multiplyAll(MatrixKernels::Reference::multiply, referenceOut), passes, MATRIX_COUNT);
+	double fastNs = nanosecondsPerOp(multiplyAll(MatrixKernels::multiply, fastOut), passes, MATRIX_COUNT);
+	allPass &= report("multiply", referenceNs, fastNs,
+					  agreementBits(referenceOut.data(), fastOut.data(), referenceOut.size(), 16), 18.0f);
+
+	// Inverse
+	auto invertAll = [&](auto invert, std::vector<float>& out) {
+		return [&, invert]() {
+			for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+				invert(&matrices[i * 16], &out[i * 16]);
+			}
+			sink += out[0];
+		};
+	};
+	referenceNs = nanosecondsPerOp(invertAll(MatrixKernels::Reference::invert, referenceOut), passes, MATRIX_COUNT);
+	fastNs = nanosecondsPerOp(invertAll(MatrixKernels::invert, fastOut), passes, MATRIX_COUNT);
+	allPass &= report("invert", referenceNs, fastNs,
+					  agreementBits(referenceOut.data(), fastOut.data(), referenceOut.size(), 16), 14.0f);
+
+	// (and the reference inverse really is one: M * inverse(M) = I)
+	std::vector<float> identities(MATRIX_COUNT * 16), expected(MATRIX_COUNT * 16, 0.0f);
+	for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+		MatrixKernels::Reference::multiply(&matrices[i * 16], &referenceOut[i * 16], &identities[i * 16]);
+		for (int d = 0; d < 4; ++d) {
+			expected[i * 16 + d * 5] = 1.0f;
+		}
+	}
+	float identityBits = agreementBits(expected.data(), identities.data(), expected.size(), 16);
+	bool identityPass = identityBits >= 12.0f;
+	Log(RAW, "%-20s %43.1f bits (min 12)  %s", "  M * inverse(M) = I", identityBits, identityPass ? "ok" : "FAIL");
+	allPass &= identityPass;
+
+	// TRS composition
+	auto composeAll = [&](auto compose, std::vector<float>& out) {
+		return [&, compose]() {
+			for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+				compose(translations[i], rotations[i], scales[i], &out[i * 16]);
+			}
+			sink += out[0];
+		};
+	};
+	referenceNs = nanosecondsPerOp(composeAll(MatrixKernels::Reference::composeTRS, referenceOut), passes, MATRIX_COUNT);
+	fastNs = nanosecondsPerOp(composeAll(MatrixKernels::composeTRS, fastOut), passes, MATRIX_COUNT);
+	allPass &= report("composeTRS", referenceNs, fastNs,
+					  agreementBits(referenceOut.data(), fastOut.data(), referenceOut.size(), 16), 16.0f);
+
+	// Point and direction transforms
+	auto transformAll = [&](auto transform, std::vector<Vector3>& out) {
+		return [&, transform]() {
+			transform(&matrices[0], points.data(), out.data(), POINT_COUNT);
+			sink += out[0].x;
+		};
+	};
+	referenceNs = nanosecondsPerOp(transformAll(MatrixKernels::Reference::transformPoints, referencePoints), passes, POINT_COUNT);
+	fastNs = nanosecondsPerOp(transformAll(MatrixKernels::transformPoints, fastPoints), passes, POINT_COUNT);
+	allPass &= report("transformPoints", referenceNs, fastNs,
+					  agreementBits(&referencePoints[0].x, &fastPoints[0].x, POINT_COUNT * 3, 3), 18.0f);
+
+	referenceNs = nanosecondsPerOp(transformAll(MatrixKernels::Reference::transformDirections, referencePoints), passes, POINT_COUNT);
+	fastNs = nanosecondsPerOp(transformAll(MatrixKernels::transformDirections, fastPoints), passes, POINT_COUNT);
+	allPass &= report("transformDirections", referenceNs, fastNs,
+					  agreementBits(&referencePoints[0].x, &fastPoints[0].x, POINT_COUNT * 3, 3), 18.0f);
+
+	// Quaternion TRS (built straight from the quaternion) against Euler angles' matrix products
+	std::vector<Quaternion> quaternions(MATRIX_COUNT);
+	for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+		quaternions[i] = Quaternion::fromEuler(rotations[i]);
+	}
+	auto quaternionTRSAll = [&]() {
+		for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+			Matrix4 trs = Matrix4::trs(translations[i], quaternions[i], scales[i]);
+			std::copy(trs.data(), trs.data() + 16, &fastOut[i * 16]);
+		}
+		sink += fastOut[0];
+	};
+	referenceNs = nanosecondsPerOp(composeAll(MatrixKernels::Reference::composeTRS, referenceOut), passes, MATRIX_COUNT);
+	fastNs = nanosecondsPerOp(quaternionTRSAll, passes, MATRIX_COUNT);
+	allPass &= report("quaternion TRS", referenceNs, fastNs,
+					  agreementBits(referenceOut.data(), fastOut.data(), referenceOut.size(), 16), 16.0f);
+
+	// Composing rotations: quaternion product (then to a matrix) against the rotation matrices' product
+	std::vector<float> rotationMatrices(MATRIX_COUNT * 16);
+	for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+		MatrixKernels::Reference::composeTRS(Vector3::zero(), rotations[i], Vector3::one(), &rotationMatrices[i * 16]);
+	}
+	auto matrixComposeAll = [&]() {
+		for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+			MatrixKernels::Reference::multiply(&rotationMatrices[i * 16], &rotationMatrices[((i + 1) % MATRIX_COUNT) * 16],
+											   &referenceOut[i * 16]);
+		}
+		sink += referenceOut[0];
+	};
+	auto quaternionComposeAll = [&]() {
+		for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+			Matrix4 rotation = Matrix4::rotation(quaternions[i] * quaternions[(i + 1) % MATRIX_COUNT]);
+			std::copy(rotation.data(), rotation.data() + 16, &fastOut[i * 16]);
+		}
+		sink += fastOut[0];
+	};
+	referenceNs = nanosecondsPerOp(matrixComposeAll, passes, MATRIX_COUNT);
+	fastNs = nanosecondsPerOp(quaternionComposeAll, passes, MATRIX_COUNT);
+	allPass &= report("quaternion compose", referenceNs, fastNs,
+					  agreementBits(referenceOut.data(), fastOut.data(), referenceOut.size(), 16), 18.0f);
+
+	// (Euler angles back from quaternions give the same rotation)
+	for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+		Matrix4 rotation = Matrix4::rotation(Quaternion::fromEuler(quaternions[i].toEuler()));
+		std::copy(rotation.data(), rotation.data() + 16, &fastOut[i * 16]);
+	}
+	float eulerBits = agreementBits(rotationMatrices.data(), fastOut.data(), rotationMatrices.size(), 16);
+	bool eulerPass = eulerBits >= 14.0f;
+	Log(RAW, "%-20s %43.1f bits (min 14)  %s", "  toEuler round trip", eulerBits, eulerPass ? "ok" : "FAIL");
+	allPass &= eulerPass;
+
+	// Interpolation: slerp against nlerp, both checked to stay unit length and hit their end points,
+	//	and slerp's halfway point to be half the angle from each end
+	std::vector<Quaternion> referenceBlends(MATRIX_COUNT), fastBlends(MATRIX_COUNT);
+	auto interpolateAll = [&](auto interpolate, std::vector<Quaternion>& out) {
+		return [&, interpolate]() {
+			for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+				out[i] = interpolate(quaternions[i], quaternions[(i + 1) % MATRIX_COUNT], 0.3f);
+			}
+			sink += out[0].w;
+		};
+	};
+	referenceNs = nanosecondsPerOp(interpolateAll(Quaternion::slerp, referenceBlends), passes, MATRIX_COUNT);
+	fastNs = nanosecondsPerOp(interpolateAll(Quaternion::nlerp, fastBlends), passes, MATRIX_COUNT);
+	double worstError = 0.0;
+	for (size_t i = 0; i < MATRIX_COUNT; ++i) {
+		const Quaternion& a = quaternions[i];
+		const Quaternion& b = quaternions[(i + 1) % MATRIX_COUNT];
+		Quaternion start = Quaternion::slerp(a, b, 0.0f), end = Quaternion::slerp(a, b, 1.0f);
+		Quaternion half = Quaternion::slerp(a, b, 0.5f);
+		worstError = std::max(worstError, static_cast<double>(std::fabs(referenceBlends[i].length() - 1.0f)));
+		worstError = std::max(worstError, static_cast<double>(std::fabs(fastBlends[i].length() - 1.0f)));
+		worstError = std::max(worstError, static_cast<double>(1.0f - std::fabs(start.dot(a))));
+		worstError = std::max(worstError, static_cast<double>(1.0f - std::fabs(end.dot(b))));
+		worstError = std::max(worstError, static_cast<double>(std::fabs(std::fabs(half.dot(a)) - std::fabs(half.dot(b)))));
+	}
+	float interpolationBits = worstError == 0.0 ? 24.0f : static_cast<float>(std::min(24.0, -std::log2(worstError)));
+	Log(RAW, "%-20s %9.2f ns %9.2f ns %7.2fx   %5.1f bits (min 16)  %s", "slerp vs nlerp", referenceNs, fastNs,
+		referenceNs / fastNs, interpolationBits, interpolationBits >= 16.0f ? "ok" : "FAIL");
+	allPass &= interpolationBits >= 16.0f;
+
+	Log(RAW, "(checksum %g)", sink);
+	return allPass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
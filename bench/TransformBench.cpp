@@ -0,0 +1,160 @@
+//
+// TransformBench.cpp
+//	Throughput of composing world and normal matrices for a large scene: each object composing its own
+//	(as Models did), against the TransformStore's batched SoA kernel, single- and multi-threaded.
+//	Also checks the store's matrices agree with the scalar reference to within a number of bits.
+//
+// Usage: transformBench [objects] [passes]
+//	(defaults to 1,000,000 objects; exits with failure if the store disagrees with the reference)
+//
+#include "math/TransformStore.h"
+#include "math/MatrixKernels.h"
+#include "utils/logger/Logging.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+namespace {
+	float sink = 0.0f;		// (results feed this, so timed loops aren't optimized away)
+
+	double secondsSince(Clock::time_point startTime) {
+		return std::chrono::duration<double>(Clock::now() - startTime).count();
+	}
+
+	void report(const char* name, size_t matrices, double seconds, double baselineSeconds) {
+		Log(RAW, "%-32s %9.2f ms %10.1f M/s %8.2fx", name, seconds * 1000.0, matrices / seconds / 1e6,
+			baselineSeconds / seconds);
+	}
+
+	// Normal matrix the way ObjectBuffer derives it: inverse transpose of the upper 3x3
+	void normalOf(const float* world, float* normal) {
+		float inverse[16];
+		if (!MatrixKernels::Reference::invert(world, inverse)) {
+			std::copy(world, world + 16, normal);
+			return;
+		}
+		for (int col = 0; col < 4; ++col) {
+			for (int row = 0; row < 4; ++row) {
+				normal[col * 4 + row] = (row < 3 && col < 3) ? inverse[row * 4 + col] : (row == col ? 1.0f : 0.0f);
+			}
+		}
+	}
+
+	// Bits to which 'fast' agrees with 'reference', relative to the matrix's largest element
+	float agreementBits(const float* reference, const float* fast) {
+		double scale = 1e-30, worst = 0.0;
+		for (int i = 0; i < 16; ++i) {
+			scale = std::max(scale, static_cast<double>(std::fabs(reference[i])));
+		}
+		for (int i = 0; i < 16; ++i) {
+			worst = std::max(worst, std::fabs(static_cast<double>(fast[i]) - reference[i]) / scale);
+		}
+		return worst == 0.0 ? 24.0f : static_cast<float>(std::min(24.0, -std::log2(worst)));
+	}
+}
+
+int main(int argc, char* argv[]) {
+	size_t objectCount = argc > 1 ? std::max(1, atoi(argv[1])) : 1000000;
+	int passes = argc > 2 ? std::max(1, atoi(argv[2])) : 5;
+
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+
+	std::vector<Vector3> translations(objectCount), rotations(objectCount), scales(objectCount);
+	for (size_t i = 0; i < objectCount; ++i) {
+		translations[i] = Vector3(position(random), position(random), position(random));
+		rotations[i] = Vector3(angle(random), angle(random), angle(random));
+		scales[i] = Vector3(scale(random), scale(random), scale(random));
+	}
+
+	TransformStore store;
+	std::vector<TransformHandle> handles(objectCount);
+	for (size_t i = 0; i < objectCount; ++i) {
+		handles[i] = store.create(translations[i], rotations[i], scales[i]);
+	}
+	unsigned threads = store.getWorkerCount();
+
+	Log(RAW, "Composing world + normal matrices for %zu objects (%s kernels, %u threads), best of %d passes",
+		objectCount, MatrixKernels::backendName(), threads, passes);
+	Log(RAW, "%-32s %12s %14s %9s", "method", "time", "matrices", "speedup");
+
+	// Each object on its own: Euler angles to matrix products (as Models once did), then a general inverse
+	std::vector<float> world(objectCount * 16), normal(objectCount * 16);
+	double baselineSeconds = 1e30;
+	for (int pass = 0; pass < passes; ++pass) {
+		auto startTime = Clock::now();
+		for (size_t i = 0; i < objectCount; ++i) {
+			MatrixKernels::Reference::composeTRS(translations[i], rotations[i], scales[i], &world[i * 16]);
+			normalOf(&world[i * 16], &normal[i * 16]);
+		}
+		baselineSeconds = std::min(baselineSeconds, secondsSince(startTime));
+		sink += world[0] + normal[0];
+	}
+	report("per object, matrix products", objectCount, baselineSeconds, baselineSeconds);
+
+	// ...and with the closed-form SIMD TRS
+	double seconds = 1e30;
+	for (int pass = 0; pass < passes; ++pass) {
+		auto startTime = Clock::now();
+		for (size_t i = 0; i < objectCount; ++i) {
+			MatrixKernels::composeTRS(translations[i], rotations[i], scales[i], &world[i * 16]);
+			MatrixKernels::invert(&world[i * 16], &normal[i * 16]);
+		}
+		seconds = std::min(seconds, secondsSince(startTime));
+		sink += world[0] + normal[0];
+	}
+	report("per object, SIMD TRS + inverse", objectCount, seconds, baselineSeconds);
+
+	// The store's batch, every entry dirty (re-dirtying them isn't timed)
+	auto timeUpdate = [&](unsigned workers, size_t stride) {
+		store.setWorkerCount(workers);
+		double best = 1e30;
+		size_t composed = 0;
+		for (int pass = 0; pass < passes; ++pass) {
+			for (size_t i = 0; i < objectCount; i += stride) {
+				store.setPosition(handles[i], translations[i]);
+			}
+			auto startTime = Clock::now();
+			composed = store.update();
+			best = std::min(best, secondsSince(startTime));
+		}
+		sink += store.getWorldMatrix(handles[0]).data()[0];
+		return std::make_pair(composed, best);
+	};
+
+	size_t composed;
+	double batchSeconds;
+	std::tie(composed, batchSeconds) = timeUpdate(1, 1);
+	report("store batch, 1 thread", composed, batchSeconds, baselineSeconds);
+	if (threads > 1) {
+		std::tie(composed, batchSeconds) = timeUpdate(threads, 1);
+		report("store batch, all threads", composed, batchSeconds, baselineSeconds);
+	}
+	// (a scattered tenth dirty, as when some objects animate: gathers rather than contiguous loads)
+	std::tie(composed, batchSeconds) = timeUpdate(threads, 10);
+	report("store batch, every 10th dirty", composed, batchSeconds, baselineSeconds * composed / objectCount);
+
+	// Agreement with the reference, over a sample
+	float worldBits = 24.0f, normalBits = 24.0f;
+	for (size_t i = 0; i < objectCount; i += std::max<size_t>(1, objectCount / 4096)) {
+		float referenceWorld[16], referenceNormal[16];
+		MatrixKernels::Reference::composeTRS(translations[i], rotations[i], scales[i], referenceWorld);
+		normalOf(referenceWorld, referenceNormal);
+		worldBits = std::min(worldBits, agreementBits(referenceWorld, store.getWorldMatrix(handles[i]).data()));
+		normalBits = std::min(normalBits, agreementBits(referenceNormal, store.getNormalMatrix(handles[i]).data()));
+	}
+	bool pass = worldBits >= 16.0f && normalBits >= 14.0f;
+	Log(RAW, "Agreement with reference: world %.1f bits (min 16), normal %.1f bits (min 14)  %s",
+		worldBits, normalBits, pass ? "ok" : "FAIL");
+
+	Log(RAW, "(checksum %g)", sink);
+	return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
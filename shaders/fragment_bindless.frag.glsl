@@ -0,0 +1,70 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// Pipeline variants (specialization constants, set per pipeline by VulkanPipeline)
+layout(constant_id = 0) const int LIGHTING_MODEL = 0;	// 0: Phong, 1: Blinn-Phong, 2: unlit
+layout(constant_id = 1) const bool ALPHA_TEST = false;	// (discard texels under half opacity)
+
+// Every loaded texture, bound once per frame; only the slots in use are written (partially bound).
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec3 fragNormal;
+layout(location = 2) in vec3 fragPos;
+layout(location = 3) in vec2 fragTexCoord;
+layout(location = 4) in vec3 lightPos;
+layout(location = 5) in vec3 lightColor;
+layout(location = 6) in vec3 viewPos;
+layout(location = 7) flat in int fragTextureIndex;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+	// Normalize the fragment normal
+	vec3 norm = normalize(fragNormal);
+
+	// Sample texture, if this object has one (the index is uniform across a draw)
+	vec4 texColor = vec4(1.0);
+	if (fragTextureIndex >= 0) {
+		texColor = texture(textures[fragTextureIndex], fragTexCoord);
+	}
+	if (ALPHA_TEST && texColor.a < 0.5) {
+		discard;
+	}
+	vec3 baseColor = texColor.rgb * fragColor;
+
+	// Unlit: the base color as it is
+	if (LIGHTING_MODEL == 2) {
+		outColor = vec4(baseColor, texColor.a);
+		return;
+	}
+
+	// Ambient lighting
+	float ambientStrength = 0.1;
+	vec3 ambient = ambientStrength * lightColor;
+
+	// Diffuse lighting
+	vec3 lightDir = normalize(lightPos - fragPos);
+	float diff = max(dot(norm, lightDir), 0.0);
+	vec3 diffuse = diff * lightColor;
+
+	// Specular lighting (Phong, or Blinn-Phong's halfway vector)
+	float specularStrength = 0.5;
+	vec3 viewDir = normalize(viewPos - fragPos);
+	float spec;
+	if (LIGHTING_MODEL == 1) {
+		vec3 halfwayDir = normalize(lightDir + viewDir);
+		spec = pow(max(dot(norm, halfwayDir), 0.0), 64);	// (about Phong's highlight, at twice the exponent)
+	} else {
+		vec3 reflectDir = reflect(-lightDir, norm);
+		spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+	}
+	vec3 specular = specularStrength * spec * lightColor;
+
+	// Combine all lighting components
+	vec3 lighting = ambient + diffuse + specular;
+	vec3 result = lighting * baseColor;
+
+	outColor = vec4(result, texColor.a);
+}
\ No newline at end of file
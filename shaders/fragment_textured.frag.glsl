@@ -1,6 +1,10 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// Pipeline variants (specialization constants, set per pipeline by VulkanPipeline)
+layout(constant_id = 0) const int LIGHTING_MODEL = 0;	// 0: Phong, 1: Blinn-Phong, 2: unlit
+layout(constant_id = 1) const bool ALPHA_TEST = false;	// (discard texels under half opacity)
+
 layout(set = 1, binding = 0) uniform sampler2D texSampler;
 
 layout(location = 0) in vec3 fragColor;
@@ -19,8 +23,17 @@ void main() {
 
 	// Sample texture
 	vec4 texColor = texture(texSampler, fragTexCoord);
+	if (ALPHA_TEST && texColor.a < 0.5) {
+		discard;
+	}
 	vec3 baseColor = texColor.rgb * fragColor;
 
+	// Unlit: the base color as it is
+	if (LIGHTING_MODEL == 2) {
+		outColor = vec4(baseColor, texColor.a);
+		return;
+	}
+
 	// Ambient lighting
 	float ambientStrength = 0.1;
 	vec3 ambient = ambientStrength * lightColor;
@@ -30,11 +43,17 @@ void main() {
 	float diff = max(dot(norm, lightDir), 0.0);
 	vec3 diffuse = diff * lightColor;
 
-	// Specular lighting (Phong)
+	// Specular lighting (Phong, or Blinn-Phong's halfway vector)
 	float specularStrength = 0.5;
 	vec3 viewDir = normalize(viewPos - fragPos);
-	vec3 reflectDir = reflect(-lightDir, norm);
-	float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+	float spec;
+	if (LIGHTING_MODEL == 1) {
+		vec3 halfwayDir = normalize(lightDir + viewDir);
+		spec = pow(max(dot(norm, halfwayDir), 0.0), 64);	// (about Phong's highlight, at twice the exponent)
+	} else {
+		vec3 reflectDir = reflect(-lightDir, norm);
+		spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+	}
 	vec3 specular = specularStrength * spec * lightColor;
 
 	// Combine all lighting components
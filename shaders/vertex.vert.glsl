@@ -10,11 +10,16 @@ layout(binding = 0) uniform GlobalUniforms {
 	vec4 viewPos;
 } global;
 
-// Per-object uniforms (binding 1) - different for each object via dynamic offsets
-layout(binding = 1) uniform PerObjectUniforms {
+// Per-object data (binding 1) - every object's record, indexed by the draw's firstInstance
+struct PerObjectData {
 	mat4 model;
 	mat4 normalMatrix;
-} object;
+	int textureIndex;	// (bindless pipeline only)
+};
+
+layout(std430, binding = 1) readonly buffer PerObjectBuffer {
+	PerObjectData objects[];
+};
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
@@ -30,6 +35,8 @@ layout(location = 5) out vec3 lightColor;
 layout(location = 6) out vec3 viewPos;
 
 void main() {
+	PerObjectData object = objects[gl_InstanceIndex];
+
 	// Transform position to world space
 	vec4 worldPos = object.model * vec4(inPosition, 1.0);
 	fragPos = worldPos.xyz;
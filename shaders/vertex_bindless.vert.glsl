@@ -0,0 +1,64 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Pipeline variant (a specialization constant, set per pipeline by VulkanPipeline)
+layout(constant_id = 2) const bool VERTEX_COLORS = true;	// (false: as if every vertex were white)
+
+// Global uniforms (binding 0) - same for all objects
+layout(binding = 0) uniform GlobalUniforms {
+	mat4 view;
+	mat4 proj;
+	vec4 lightPos;
+	vec4 lightColor;
+	vec4 viewPos;
+} global;
+
+// Per-object data (binding 1) - every object's record, indexed by the draw's firstInstance
+struct PerObjectData {
+	mat4 model;
+	mat4 normalMatrix;
+	int textureIndex;	// Slot in the bindless texture array (set 1), or -1 if untextured
+};
+
+layout(std430, binding = 1) readonly buffer PerObjectBuffer {
+	PerObjectData objects[];
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec3 inColor;
+layout(location = 3) in vec2 inTexCoord;
+
+// (invariant, so the depth pre-pass - vertex_depth - computes exactly the same depth)
+invariant gl_Position;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec3 fragPos;
+layout(location = 3) out vec2 fragTexCoord;
+layout(location = 4) out vec3 lightPos;
+layout(location = 5) out vec3 lightColor;
+layout(location = 6) out vec3 viewPos;
+layout(location = 7) flat out int fragTextureIndex;
+
+void main() {
+	PerObjectData object = objects[gl_InstanceIndex];
+
+	// Transform position to world space
+	vec4 worldPos = object.model * vec4(inPosition, 1.0);
+	fragPos = worldPos.xyz;
+
+	// Transform position to clip space
+	gl_Position = global.proj * global.view * worldPos;
+
+	// Transform normal to world space (using precomputed normal matrix)
+	fragNormal = mat3(object.normalMatrix) * inNormal;
+
+	// Pass through vertex color, texture coordinates/index, and lighting parameters
+	fragColor = VERTEX_COLORS ? inColor : vec3(1.0);
+	fragTexCoord = inTexCoord;
+	fragTextureIndex = object.textureIndex;
+	lightPos = global.lightPos.xyz;
+	lightColor = global.lightColor.xyz;
+	viewPos = global.viewPos.xyz;
+}
\ No newline at end of file
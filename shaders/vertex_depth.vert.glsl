@@ -0,0 +1,37 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Depth pre-pass: position only, no fragment shader. Transforms exactly as the main pass's vertex
+//	shaders do (all of them declaring gl_Position invariant), so the main pass - testing LESS_OR_EQUAL
+//	against this depth - shades only the nearest surface at each pixel.
+
+// Global uniforms (binding 0) - same for all objects
+layout(binding = 0) uniform GlobalUniforms {
+	mat4 view;
+	mat4 proj;
+	vec4 lightPos;
+	vec4 lightColor;
+	vec4 viewPos;
+} global;
+
+// Per-object data (binding 1) - every object's record, indexed by the draw's firstInstance
+struct PerObjectData {
+	mat4 model;
+	mat4 normalMatrix;
+	int textureIndex;	// (bindless pipeline only)
+};
+
+layout(std430, binding = 1) readonly buffer PerObjectBuffer {
+	PerObjectData objects[];
+};
+
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main() {
+	PerObjectData object = objects[gl_InstanceIndex];
+
+	vec4 worldPos = object.model * vec4(inPosition, 1.0);
+	gl_Position = global.proj * global.view * worldPos;
+}
@@ -1,6 +1,9 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// Pipeline variant (a specialization constant, set per pipeline by VulkanPipeline)
+layout(constant_id = 2) const bool VERTEX_COLORS = true;	// (false: as if every vertex were white)
+
 // Global uniforms (binding 0) - same for all objects
 layout(binding = 0) uniform GlobalUniforms {
 	mat4 view;
@@ -10,17 +13,25 @@ layout(binding = 0) uniform GlobalUniforms {
 	vec4 viewPos;
 } global;
 
-// Per-object uniforms (binding 1) - different for each object via dynamic offsets
-layout(binding = 1) uniform PerObjectUniforms {
+// Per-object data (binding 1) - every object's record, indexed by the draw's firstInstance
+struct PerObjectData {
 	mat4 model;
 	mat4 normalMatrix;
-} object;
+	int textureIndex;	// (bindless pipeline only)
+};
+
+layout(std430, binding = 1) readonly buffer PerObjectBuffer {
+	PerObjectData objects[];
+};
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec3 inColor;
 // Note: No texture coordinate input for untextured models
 
+// (invariant, so the depth pre-pass - vertex_depth - computes exactly the same depth)
+invariant gl_Position;
+
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragNormal;
 layout(location = 2) out vec3 fragPos;
@@ -29,6 +40,8 @@ layout(location = 4) out vec3 lightColor;
 layout(location = 5) out vec3 viewPos;
 
 void main() {
+	PerObjectData object = objects[gl_InstanceIndex];
+
 	// Transform position to world space
 	vec4 worldPos = object.model * vec4(inPosition, 1.0);
 	fragPos = worldPos.xyz;
@@ -40,7 +53,7 @@ void main() {
 	fragNormal = mat3(object.normalMatrix) * inNormal;
 
 	// Pass through vertex color and lighting parameters
-	fragColor = inColor;
+	fragColor = VERTEX_COLORS ? inColor : vec3(1.0);
 	lightPos = global.lightPos.xyz;
 	lightColor = global.lightColor.xyz;
 	viewPos = global.viewPos.xyz;
@@ -1,34 +1,103 @@
 #include "Application.h"
 #include "vulkan/VulkanEngine.h"
+#include "vulkan/VulkanDevice.h"
+#include "vulkan/GpuProfiler.h"
+#include "vulkan/FrameContext.h"
+#include "vulkan/PipelineCache.h"
+#include "vulkan/VulkanSwapchain.h"
 #include "rendering/Renderer.h"
 #include "rendering/Camera.h"
+#include "rendering/CameraPath.h"
 #include "rendering/Texture.h"
+#include "rendering/TextureManager.h"
+#include "rendering/TextureStreamer.h"
+#include "rendering/DynamicResolution.h"
 #include "geometry/Model.h"
 #include "scene/SceneManager.h"
 #include "scene/GeneratedModel.h"
 #include "scene/LoadedModel.h"
 #include "math/Vector3.h"
 #include "utils/logger/Logging.h"
+#include "utils/Trace.h"
+#include "utils/FrameStats.h"
+#include "utils/StartupTimeline.h"
+#include <SDL2/SDL_image.h>
 #include <stdexcept>
+#include <algorithm>
+#include <unordered_map>
 #include <chrono>
 #include <fstream>
 #include <cstdlib>
+#include <cstdio>
+#include <thread>
 
 using Shape = GeneratedModel::Shape;
 
 
-Application::Application()
+Application::Application(const std::vector<std::string>& arguments)
 	: window(nullptr)
+	, sceneLoaded(false)
+	, startupLogged(false)
+	, scenePath("assets/scenes/default_scene.json")
+	, depthPrepass(false)
+	, dynamicResolutionMs(0.0)
+	, headless(false)
+	, headlessFrames(300)
+	, warmupFrames(10)
+	, recordingTime(0.0f)
+	, replayTime(0.0f)
 	, running(false)
 	, windowWidth(1200)
 	, windowHeight(800)
+	, animationPaused(false)
+	, animationTime(0.0f)
 {
 	memset(keys, 0, sizeof(keys));
-
-	initializeSDL();
-	createWindow();
+	Tracer::setThreadName("main");
+	StartupTimeline::start();
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::string> pacingArguments = parseArguments(arguments);	// (first: headless, or not?)
+
+	// The scene file is parsed while SDL starts up (it has to be in before Vulkan, since it may say how
+	//	to pace frames); then its models are read and their textures decoded (via SDL_image, initialized
+	//	here first) on worker threads while Vulkan is set up. They're joined before uploading.
+	std::thread sceneLoader([this] {
+		Tracer::setThreadName("scene loader");
+		STARTUP_PHASE("parse scene file");
+		loadScene();
+	});
+	if (!headless) {
+		STARTUP_PHASE("SDL");
+		try {
+			initializeSDL();
+		} catch (...) {
+			sceneLoader.join();		// (a joinable thread can't be destroyed)
+			throw;
+		}
+	}
+	sceneLoader.join();
+	initializeImageLoaders();
+	sceneManager->startPreload(std::thread::hardware_concurrency());
+
+	configurePacing(pacingArguments);
+	if (!headless) {
+		STARTUP_PHASE("window");
+		createWindow();
+	}
 	initializeVulkan();
-	setUpScene();
+	{
+		STARTUP_PHASE("wait for preload");
+		sceneManager->finishPreload();
+	}
+	{
+		STARTUP_PHASE("set up scene");
+		setUpScene();
+	}
+	Texture::clearPrefetched();		// (any not claimed by a texture)
+	Log(NOTE, "Startup took %.0f ms (%s pipeline cache)",
+		std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count(),
+		vulkanEngine->getPipelineCache().isWarm() ? "warm" : "cold");
 
 	// Run matrix tests to verify everything is working:
 	#if DEBUG_LOW
@@ -47,6 +116,15 @@ void Application::initializeSDL() {
 	}
 }
 
+// SDL_image sets up each format's loader on first use unless initialized beforehand - which the
+//	preload threads decoding at once mustn't race to do. (Headless too: it needs no SDL_Init.)
+void Application::initializeImageLoaders() {
+	int wanted = IMG_INIT_PNG | IMG_INIT_JPG;
+	if ((IMG_Init(wanted) & wanted) != wanted) {
+		Log(WARN, "Failed to initialize SDL_image loaders: %s", IMG_GetError());
+	}
+}
+
 void Application::createWindow() {
 	uint32_t flags = SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE;
 
@@ -121,20 +199,121 @@ void Application::initializeVulkan() {
 	Log(NOTE, "=================================");
 #endif
 
-	vulkanEngine = std::make_unique<VulkanEngine>(window, windowWidth, windowHeight);
+	VulkanSwapchain::setRenderScalingEnabled(dynamicResolutionMs > 0.0);		// (rendering to an intermediate to upscale)
+	vulkanEngine = std::make_unique<VulkanEngine>(window, windowWidth, windowHeight, pacing);
+	if (!gpuCsvFile.empty()) {
+		vulkanEngine->getGpuProfiler().openCsv(gpuCsvFile);
+	}
+	if (!gpuTraceFile.empty()) {
+		vulkanEngine->getGpuProfiler().openChromeTrace(gpuTraceFile);
+	}
+	STARTUP_PHASE("renderer and pipelines");
 	renderer = std::make_unique<Renderer>(*vulkanEngine);
+	renderer->setDepthPrepass(depthPrepass);
+	if (dynamicResolutionMs > 0.0) {
+		renderer->setDynamicResolution(dynamicResolutionMs);
+	}
+	textureManager = std::make_unique<TextureManager>(*vulkanEngine);
 }
 
 
-void Application::setUpScene() {
-	Log(NOTE, "\n≡≡≡ Setting Up Scene ≡≡≡");
-
+void Application::loadScene() {
 	// Initialize scene manager:
 	sceneManager = std::make_unique<SceneManager>();
 
 	// Load scene from JSON file:
 	Log(NOTE, "\n=== Loading Scene from JSON ===");
-	if (sceneManager->loadFromFile("assets/scenes/default_scene.json")) {
+	sceneLoaded = sceneManager->loadFromFile(scenePath);
+}
+
+// (returns the arguments left for frame pacing, which need the scene loaded first)
+std::vector<std::string> Application::parseArguments(const std::vector<std::string>& arguments) {
+	std::vector<std::string> pacingArguments;
+	bool sceneGiven = false;
+	for (size_t i = 0; i < arguments.size(); ++i) {
+		unsigned int width, height;
+		if (arguments[i] == "--headless") {
+			headless = true;
+		} else if (arguments[i] == "--frames" && i + 1 < arguments.size()) {
+			headlessFrames = static_cast<uint32_t>(std::max(1, atoi(arguments[++i].c_str())));
+		} else if (arguments[i] == "--warmup" && i + 1 < arguments.size()) {
+			warmupFrames = static_cast<uint32_t>(std::max(0, atoi(arguments[++i].c_str())));
+		} else if (arguments[i] == "--scene" && i + 1 < arguments.size()) {
+			scenePath = arguments[++i];
+			sceneGiven = true;
+		} else if (arguments[i] == "--resolution" && i + 1 < arguments.size()) {
+			if (sscanf(arguments[++i].c_str(), "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+				throw std::runtime_error("Failed to parse --resolution " + arguments[i] + " (expected e.g. 1920x1080)");
+			}
+			windowWidth = width;
+			windowHeight = height;
+		} else if (arguments[i] == "--stats" && i + 1 < arguments.size()) {
+			statsFile = arguments[++i];
+		} else if (arguments[i] == "--output-image" && i + 1 < arguments.size()) {
+			outputImageFile = arguments[++i];
+		} else if (arguments[i] == "--frame-csv" && i + 1 < arguments.size()) {
+			frameCsvFile = arguments[++i];
+		} else if (arguments[i] == "--record-path" && i + 1 < arguments.size()) {
+			recordPathFile = arguments[++i];
+		} else if (arguments[i] == "--replay-path" && i + 1 < arguments.size()) {
+			replayPathFile = arguments[++i];
+		} else if (arguments[i] == "--gpu-csv" && i + 1 < arguments.size()) {
+			gpuCsvFile = arguments[++i];
+		} else if (arguments[i] == "--gpu-trace" && i + 1 < arguments.size()) {
+			gpuTraceFile = arguments[++i];
+		} else if (arguments[i] == "--trace" && i + 1 < arguments.size()) {
+			traceFile = arguments[++i];
+		} else if (arguments[i] == "--depth-prepass") {
+			depthPrepass = true;
+		} else if (arguments[i] == "--dynamic-resolution" && i + 1 < arguments.size()) {
+			dynamicResolutionMs = std::max(0.0, atof(arguments[++i].c_str()));
+		} else {
+			pacingArguments.push_back(arguments[i]);
+		}
+	}
+
+	// A camera path replays in the scene it was recorded in, unless told otherwise
+	if (!replayPathFile.empty()) {
+		cameraReplay = std::make_unique<CameraPath>();
+		if (!cameraReplay->loadFromFile(replayPathFile) || cameraReplay->isEmpty()) {
+			throw std::runtime_error("Failed to load camera path to replay: " + replayPathFile);
+		}
+		if (!sceneGiven && !cameraReplay->getScenePath().empty()) {
+			scenePath = cameraReplay->getScenePath();
+		} else if (cameraReplay->getScenePath() != scenePath) {
+			Log(WARN, "Camera path was recorded in %s, but replaying in %s", cameraReplay->getScenePath().c_str(),
+				scenePath.c_str());
+		}
+	}
+	if (!recordPathFile.empty()) {
+		if (cameraReplay) {
+			throw std::runtime_error("Can't both record (--record-path) and replay (--replay-path) a camera path");
+		}
+		cameraRecording = std::make_unique<CameraPath>();
+		cameraRecording->setScenePath(scenePath);
+	}
+	return pacingArguments;
+}
+
+void Application::configurePacing(const std::vector<std::string>& pacingArguments) {
+	pacing.apply(sceneManager->getPacing());
+	if (!pacing.apply(pacingArguments)) {
+		throw std::runtime_error("Failed to parse command-line arguments (--frames-in-flight N, --present-mode MODE, "
+								 "--fps-cap FPS, --gpu-csv FILE, --gpu-trace FILE, --trace FILE, --scene PATH, "
+								 "--resolution WxH, --headless, --frames N, --warmup N, --stats FILE, --output-image FILE, "
+								 "--frame-csv FILE, --record-path FILE, --replay-path FILE, --depth-prepass, "
+								 "--dynamic-resolution MS)");
+	}
+	if (headless && pacing.fpsCap > 0) {
+		Log(NOTE, "Headless: ignoring the FPS cap, to run as fast as possible");
+		pacing.fpsCap = 0;
+	}
+}
+
+void Application::setUpScene() {
+	Log(NOTE, "\n≡≡≡ Setting Up Scene ≡≡≡");
+
+	if (sceneLoaded) {
 		Log(NOTE, "Scene loaded successfully!");
 		Log(NOTE, "Total models loaded: %zu", sceneManager->getObjectCount());
 	} else {
@@ -148,9 +327,10 @@ void Application::setUpScene() {
 		SceneObject* obj = sceneManager->getObject(i);
 		if (obj && obj->getType() == SceneObject::ObjectType::LOADED_MODEL) {
 			LoadedModel* loadedModel = static_cast<LoadedModel*>(obj);
-			loadedModel->initializeTexture(*vulkanEngine->getDevice(), *vulkanEngine);
+			loadedModel->initializeTexture(*textureManager);
 		}
 	}
+	textureManager->logReport();
 
 	// Create models for rendering:
 	models = sceneManager->createAllModels();
@@ -194,6 +374,12 @@ void Application::setUpScene() {
 			  "  P: Toggle perspective/orthographic\n"
 			  "  R: Reset camera\n"
 			  "  Space: Stop/start animation\n"
+			  "  T: Write trace (trace.json, or --trace FILE)\n"
+			  "  L: Cycle lighting model (Phong, Blinn-Phong, unlit)\n"
+			  "  F: Toggle wireframe\n"
+			  "  K: Toggle alpha test\n"
+			  "  C: Toggle vertex colors\n"
+			  "  Z: Toggle depth pre-pass\n"
 			  "=================================");
 }
 
@@ -201,11 +387,20 @@ void Application::run() {
 	running = true;
 	animationPaused = false;
 
+	if (headless || cameraReplay) {
+		runBenchmark();
+		return;
+	}
+
 	auto lastTime = std::chrono::high_resolution_clock::now();
 	int frameCount = 0;
 	auto fpsTime = lastTime;
 
+	FramePacer& pacer = vulkanEngine->getFramePacer();
+
 	while (running) {
+		pacer.waitForNextFrame();		// (returns right away if uncapped)
+
 		auto currentTime = std::chrono::high_resolution_clock::now();
 		float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
 		lastTime = currentTime;
@@ -214,18 +409,208 @@ void Application::run() {
 		float fpsDelta = std::chrono::duration<float>(currentTime - fpsTime).count();
 		if (fpsDelta >= 1.0f) {
 			float fps = frameCount / fpsDelta;
-			SDL_SetWindowTitle(window, ("3D Object Viewer - Vulkan [FPS: " + std::to_string(static_cast<int>(fps)) + "]").c_str());
+			char gpuTime[32];
+			snprintf(gpuTime, sizeof(gpuTime), "%.2f", vulkanEngine->getGpuProfiler().getAverageFrameMs());
+			std::string scale = renderer->getDynamicResolution()
+							  ? ", scale: " + std::to_string(static_cast<int>(renderer->getRenderScale() * 100.0f + 0.5f)) + "%" : "";
+			SDL_SetWindowTitle(window, ("3D Object Viewer - Vulkan [FPS: " + std::to_string(static_cast<int>(fps))
+									  + ", latency: " + std::to_string(static_cast<int>(pacer.getAverageLatencyMs() + 0.5)) + " ms"
+									  + ", GPU: " + gpuTime + " ms" + scale + "]").c_str());
 			frameCount = 0;
 			fpsTime = currentTime;
 		}
 
 		handleEvents();
+		pacer.markInputSampled();
 		update(deltaTime);
 		render();
 	}
 }
 
+// Render a fixed number of frames - or a recorded camera path's worth - as fast as pacing allows, timing
+//	each. The simulation steps a fixed 1/60 s per frame rather than by elapsed time, so the same run always
+//	renders the same frames (and yields the same final image), to compare builds and scenes by.
+void Application::runBenchmark() {
+	const float deltaTime = 1.0f / 60.0f;
+	const uint64_t NOT_RENDERED = ~0ull;
+	uint32_t measuredFrames = cameraReplay ? cameraReplay->getFrameCount(deltaTime) : headlessFrames;
+
+	// Each frame's times: the interval since the last (everything, waits included), the CPU's work on it,
+	//	and the GPU's - which arrives a few frames later, so is matched up by frame number at the end
+	struct FrameTimes {
+		double frameMs;
+		double cpuMs;
+		uint64_t frameNumber;
+		float renderScale;
+	};
+	std::vector<FrameTimes> frameTimes;
+	frameTimes.reserve(measuredFrames);
+	std::unordered_map<uint64_t, double> gpuMsByFrame;
+	GpuProfiler& profiler = vulkanEngine->getGpuProfiler();
+	profiler.setFrameCallback([&gpuMsByFrame](const GpuFrameTimings& timings) {
+		if (!timings.scopes.empty()) {
+			gpuMsByFrame[timings.frameNumber] = timings.scopes[0].durationMs;
+		}
+	});
+
+	Log(NOTE, "Benchmark: rendering %u frames%s (after %u warm-up) at %u × %u%s on %s", measuredFrames,
+		cameraReplay ? " of a camera path" : "", warmupFrames, windowWidth, windowHeight,
+		headless ? " offscreen" : "", vulkanEngine->getDevice()->getDeviceName());
+
+	FramePacer& pacer = vulkanEngine->getFramePacer();
+	auto lastTime = std::chrono::steady_clock::now();
+	for (uint32_t frame = 0; frame < warmupFrames + measuredFrames && running; ++frame) {
+		pacer.waitForNextFrame();		// (returns right away if uncapped, as it always is headless)
+
+		auto startTime = std::chrono::steady_clock::now();
+		if (!headless) {
+			handleEvents();				// (to be closed or resized; camera keys are ignored while replaying)
+		}
+		replayTime = frame < warmupFrames ? 0.0f : (frame - warmupFrames) * deltaTime;	// (holds still to warm up)
+		uint64_t frameNumber = vulkanEngine->getFrameRing().getFrameNumber();
+		update(deltaTime);
+		render();
+		bool rendered = vulkanEngine->getFrameRing().getFrameNumber() != frameNumber;	// (not, while resizing)
+
+		auto endTime = std::chrono::steady_clock::now();
+		if (frame >= warmupFrames) {
+			frameTimes.push_back({ std::chrono::duration<double, std::milli>(endTime - lastTime).count(),
+								   std::chrono::duration<double, std::milli>(endTime - startTime).count(),
+								   rendered ? frameNumber : NOT_RENDERED, renderer->getRenderScale() });
+		}
+		lastTime = endTime;
+	}
+	vulkanEngine->waitIdle();
+	profiler.resolvePending();		// (the last few frames)
+	profiler.setFrameCallback(nullptr);
+
+	FrameStats frameStats, cpuStats, gpuStats;
+	for (const FrameTimes& times : frameTimes) {
+		frameStats.add(times.frameMs);
+		cpuStats.add(times.cpuMs);
+		auto gpu = gpuMsByFrame.find(times.frameNumber);
+		if (gpu != gpuMsByFrame.end()) {
+			gpuStats.add(gpu->second);
+		}
+	}
+	frameStats.logSummary("Benchmark frame time");
+	cpuStats.logSummary("Benchmark CPU time");
+	if (gpuStats.getCount() > 0) {
+		gpuStats.logSummary("Benchmark GPU time");
+	}
+
+	if (!statsFile.empty()) {
+		writeStatistics(frameStats, cpuStats, gpuStats);
+	}
+	if (!frameCsvFile.empty()) {
+		std::ofstream csv(frameCsvFile);
+		if (!csv) {
+			Log(ERROR, "Benchmark: can't write per-frame times to %s", frameCsvFile.c_str());
+		} else {
+			csv << "frame,frameMs,cpuMs,gpuMs,renderScale\n";
+			for (size_t i = 0; i < frameTimes.size(); ++i) {
+				auto gpu = gpuMsByFrame.find(frameTimes[i].frameNumber);
+				csv << i << "," << frameTimes[i].frameMs << "," << frameTimes[i].cpuMs << ",";
+				if (gpu != gpuMsByFrame.end()) {
+					csv << gpu->second;
+				}
+				csv << "," << frameTimes[i].renderScale << "\n";
+			}
+			Log(NOTE, "Benchmark: per-frame times written to %s", frameCsvFile.c_str());
+		}
+	}
+	if (!outputImageFile.empty()) {
+		if (headless) {
+			writeImage();
+		} else {
+			Log(WARN, "Benchmark: --output-image needs --headless (a window's images can't be read back)");
+		}
+	}
+}
+
+void Application::writeStatistics(const FrameStats& frameTimes, const FrameStats& cpuTimes, const FrameStats& gpuTimes) {
+	json stats;
+	stats["frames"] = static_cast<double>(frameTimes.getCount());
+	stats["warmupFrames"] = static_cast<double>(warmupFrames);
+	stats["width"] = static_cast<double>(windowWidth);
+	stats["height"] = static_cast<double>(windowHeight);
+	stats["headless"] = headless;
+	stats["scene"] = scenePath;
+	stats["cameraPath"] = cameraReplay ? replayPathFile : std::string();
+	stats["device"] = std::string(vulkanEngine->getDevice()->getDeviceName());
+	stats["framesInFlight"] = static_cast<double>(pacing.framesInFlight);
+	stats["hitchMultiple"] = FrameStats::HITCH_MULTIPLE;
+	stats["frame"] = frameTimes.toJson();
+	stats["cpu"] = cpuTimes.toJson();
+	if (gpuTimes.getCount() > 0) {
+		stats["gpu"] = gpuTimes.toJson();
+	}
+	json variants = json::array();
+	for (const PipelineVariantStats& variant : renderer->getPipelineVariantStats()) {
+		variants.push_back(json::object({
+			{"name", variant.name},
+			{"requests", static_cast<double>(variant.requests)},
+			{"fallbacks", static_cast<double>(variant.fallbacks)},
+			{"compileMs", variant.compileMs},
+			{"ready", variant.ready}
+		}));
+	}
+	stats["pipelineVariants"] = variants;
+
+	// (GPU render pass time in each mode, as far as the run used each)
+	stats["depthPrepass"] = renderer->isDepthPrepass();
+	json renderPass;
+	const char* modeNames[] = { "withoutDepthPrepass", "withDepthPrepass" };
+	for (int withPrepass = 0; withPrepass < 2; ++withPrepass) {
+		const Renderer::PassTimings& timings = renderer->getRenderPassTimings(withPrepass != 0);
+		renderPass[modeNames[withPrepass]] = json::object({
+			{"frames", static_cast<double>(timings.frames)},
+			{"averageMs", timings.averageMs()}
+		});
+	}
+	stats["renderPass"] = renderPass;
+
+	if (const DynamicResolution* dynamicResolution = renderer->getDynamicResolution()) {
+		stats["dynamicResolution"] = json::object({
+			{"targetMs", dynamicResolution->getTargetMs()},
+			{"averageScale", static_cast<double>(dynamicResolution->getAverageScale())},
+			{"lowestScale", static_cast<double>(dynamicResolution->getLowestScale())},
+			{"changes", static_cast<double>(dynamicResolution->getChangeCount())}
+		});
+	}
+
+	std::ofstream file(statsFile);
+	if (!file) {
+		Log(ERROR, "Benchmark: can't write statistics to %s", statsFile.c_str());
+		return;
+	}
+	file << stats.dump(4) << std::endl;
+	Log(NOTE, "Benchmark: statistics written to %s", statsFile.c_str());
+}
+
+void Application::writeImage() {
+	std::vector<uint8_t> rgba;
+	uint32_t width, height;
+	if (!vulkanEngine->readLastImage(rgba, width, height)) {
+		Log(ERROR, "Headless: can't read back the final image");
+		return;
+	}
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(rgba.data(), width, height, 32, width * 4,
+															  SDL_PIXELFORMAT_RGBA32);
+	if (!surface) {
+		Log(ERROR, "Headless: can't wrap the final image: %s", SDL_GetError());
+		return;
+	}
+	if (IMG_SavePNG(surface, outputImageFile.c_str()) != 0) {
+		Log(ERROR, "Headless: can't write %s: %s", outputImageFile.c_str(), IMG_GetError());
+	} else {
+		Log(NOTE, "Headless: final image written to %s", outputImageFile.c_str());
+	}
+	SDL_FreeSurface(surface);
+}
+
 void Application::handleEvents() {
+	TRACE_SCOPE("Application::handleEvents");
 	SDL_Event event;
 
 	while (SDL_PollEvent(&event)) {
@@ -250,6 +635,38 @@ void Application::handleEvents() {
 						resetCamera();
 						break;
 
+					case SDL_SCANCODE_T:		// Write out a trace
+						if (!keys[SDL_SCANCODE_T]) {
+							Tracer::writeChromeTrace(traceFile.empty() ? "trace.json" : traceFile);
+						}
+						break;
+
+					case SDL_SCANCODE_L:		// Pipeline variants (compiled on demand, so may take a moment)
+					case SDL_SCANCODE_F:
+					case SDL_SCANCODE_K:
+					case SDL_SCANCODE_C:
+						if (!keys[event.key.keysym.scancode]) {
+							PipelineVariant variant = renderer->getPipelineVariant();
+							switch (event.key.keysym.scancode) {
+								case SDL_SCANCODE_L:
+									variant.lighting = static_cast<LightingModel>((static_cast<int>(variant.lighting) + 1) % 3);
+									break;
+								case SDL_SCANCODE_F:	variant.wireframe = !variant.wireframe;			break;
+								case SDL_SCANCODE_K:	variant.alphaTest = !variant.alphaTest;			break;
+								default:				variant.vertexColors = !variant.vertexColors;	break;
+							}
+							changePipelineVariant(variant);
+						}
+						break;
+
+					case SDL_SCANCODE_Z:		// Toggle the depth pre-pass
+						if (!keys[SDL_SCANCODE_Z]) {
+							renderer->setDepthPrepass(!renderer->isDepthPrepass());
+							Log(NOTE, "Depth pre-pass %s%s", renderer->isDepthPrepass() ? "on" : "off",
+								renderer->isDepthPrepassAvailable() ? "" : " (unavailable: drawing without it)");
+						}
+						break;
+
 					case SDL_SCANCODE_SPACE:	// Toggle animation
 						if (!keys[SDL_SCANCODE_SPACE]) {  // Prevent key repeat.
 							animationPaused = !animationPaused;
@@ -282,34 +699,46 @@ void Application::handleEvents() {
 }
 
 void Application::update(float deltaTime) {
-	const float moveSpeed = 5.0f;
-	const float rotateSpeed = 90.0f; // degrees per second
-
-	Vector3 movement(0.0f, 0.0f, 0.0f);
-	Vector3 rotation(0.0f, 0.0f, 0.0f);
-
-	// Camera movement
-	if (keys[SDL_SCANCODE_W]) movement.z -= moveSpeed * deltaTime;
-	if (keys[SDL_SCANCODE_S]) movement.z += moveSpeed * deltaTime;
-	if (keys[SDL_SCANCODE_A]) movement.x -= moveSpeed * deltaTime;
-	if (keys[SDL_SCANCODE_D]) movement.x += moveSpeed * deltaTime;
-	if (keys[SDL_SCANCODE_Q]) movement.y += moveSpeed * deltaTime;
-	if (keys[SDL_SCANCODE_E]) movement.y -= moveSpeed * deltaTime;
-
-	// Camera rotation
-	if (keys[SDL_SCANCODE_LEFT]) rotation.y += rotateSpeed * deltaTime;
-	if (keys[SDL_SCANCODE_RIGHT]) rotation.y -= rotateSpeed * deltaTime;
-	if (keys[SDL_SCANCODE_UP]) rotation.x += rotateSpeed * deltaTime;
-	if (keys[SDL_SCANCODE_DOWN]) rotation.x -= rotateSpeed * deltaTime;
-
-	camera->move(movement);
-	camera->rotate(rotation);
+	TRACE_SCOPE("Application::update");
+	bool animate = !animationPaused;
+
+	if (cameraReplay) {
+		// Replaying: the camera and the animation clock follow the path, not the keys
+		CameraPath::Keyframe pose = cameraReplay->sample(replayTime);
+		cameraReplay->apply(pose, *camera);
+		animationTime = pose.animationTime;
+		animate = true;
+	} else {
+		const float moveSpeed = 5.0f;
+		const float rotateSpeed = 90.0f; // degrees per second
+
+		Vector3 movement(0.0f, 0.0f, 0.0f);
+		Vector3 rotation(0.0f, 0.0f, 0.0f);
+
+		// Camera movement
+		if (keys[SDL_SCANCODE_W]) movement.z -= moveSpeed * deltaTime;
+		if (keys[SDL_SCANCODE_S]) movement.z += moveSpeed * deltaTime;
+		if (keys[SDL_SCANCODE_A]) movement.x -= moveSpeed * deltaTime;
+		if (keys[SDL_SCANCODE_D]) movement.x += moveSpeed * deltaTime;
+		if (keys[SDL_SCANCODE_Q]) movement.y += moveSpeed * deltaTime;
+		if (keys[SDL_SCANCODE_E]) movement.y -= moveSpeed * deltaTime;
+
+		// Camera rotation
+		if (keys[SDL_SCANCODE_LEFT]) rotation.y += rotateSpeed * deltaTime;
+		if (keys[SDL_SCANCODE_RIGHT]) rotation.y -= rotateSpeed * deltaTime;
+		if (keys[SDL_SCANCODE_UP]) rotation.x += rotateSpeed * deltaTime;
+		if (keys[SDL_SCANCODE_DOWN]) rotation.x -= rotateSpeed * deltaTime;
+
+		camera->move(movement);
+		camera->rotate(rotation);
+
+		if (animate) {
+			animationTime += deltaTime;
+		}
+	}
 
 	// Animate models (simple rotation)
-	if (!animationPaused) {
-		static float time = 0.0f;
-		time += deltaTime;
-
+	if (animate) {
 		// Different rotation speeds for different models.
 		for (size_t i = 0; i < models.size(); ++i) {
 			if (i == 4) continue;  // Don't rotate the ground plane
@@ -317,17 +746,35 @@ void Application::update(float deltaTime) {
 
 			float rotationSpeed = 30.0f * (1.0f + i * 0.5f);  // Vary speed by model
 			Vector3 rotation(
-				i == 3 ? time * 20.0f : 0.0f, // Cylinder rotates on X
-				time * rotationSpeed,		  // All rotate on Y
+				i == 3 ? animationTime * 20.0f : 0.0f, // Cylinder rotates on X
+				animationTime * rotationSpeed,		   // All rotate on Y
 				0.0f
 			);
 			models[i]->setRotation(rotation);
 		}
 	}
+
+	if (cameraRecording) {
+		cameraRecording->record(recordingTime, *camera, animationTime);
+		recordingTime += deltaTime;
+	}
+
+	// Carry changed transforms down the scene hierarchy to the models
+	sceneManager->updateWorldTransforms();
 }
 
 void Application::render() {
-	renderer->render();
+	TRACE_SCOPE("Application::render");
+	if (startupLogged) {
+		renderer->render();
+		return;
+	}
+	{
+		STARTUP_PHASE("first frame");
+		renderer->render();
+	}
+	StartupTimeline::logTimeline("Startup timeline");
+	startupLogged = true;
 }
 
 void Application::toggleProjectionMode() {
@@ -356,17 +803,37 @@ void Application::resetCamera() {
 	Log(NOTE, "Camera reset to default position");
 }
 
+void Application::changePipelineVariant(const PipelineVariant& variant) {
+	renderer->setPipelineVariant(variant);
+	Log(NOTE, "Pipeline variant: %s", variant.describe().c_str());
+}
+
 void Application::cleanup() {
 	if (vulkanEngine) {
 		vulkanEngine->waitIdle();
 	}
+	if (renderer) {
+		renderer->logReport();
+		renderer->getTextureStreamer()->logReport();
+		vulkanEngine->getGpuProfiler().logReport();
+	}
+	if (!traceFile.empty()) {
+		Tracer::writeChromeTrace(traceFile);
+	}
+	if (cameraRecording && !cameraRecording->isEmpty()) {
+		cameraRecording->saveToFile(recordPathFile);
+	}
 
 	// Clear models first while VulkanDevice is still valid.
 	// This ensures Mesh destructors can properly clean up Vulkan buffers.
+	if (sceneManager) {
+		sceneManager->unbindModels();
+	}
 	models.clear();
 
 	// Clear scene manager to release any cached meshes.
 	sceneManager.reset();
+	textureManager.reset();		// (after every texture handle above is released)
 
 	camera.reset();
 	renderer.reset();
@@ -377,6 +844,7 @@ void Application::cleanup() {
 		window = nullptr;
 	}
 
+	IMG_Quit();
 	SDL_Quit();
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include "vulkan/FramePacer.h"
 #include <memory>
+#include <string>
 #include <vector>
 
 class VulkanEngine;
@@ -9,24 +11,46 @@ class Renderer;
 class Camera;
 class Model;
 class SceneManager;
+class TextureManager;
+class FrameStats;
+class CameraPath;
+struct PipelineVariant;
 
 class Application {
 public:
-	Application();
+	// Arguments (e.g. --frames-in-flight 1 --present-mode fifo --fps-cap 60) override the scene file's
+	//	"pacing" settings, which override the defaults. --gpu-csv FILE and --gpu-trace FILE write GPU
+	//	timings as CSV and as a Chrome trace; --trace FILE names where CPU trace scopes (and GPU timings
+	//	on their own track) are written, on pressing T and at exit. --scene PATH loads a scene other than
+	//	the default, and --resolution WxH sizes the window.
+	// --headless renders offscreen, with no window, a fixed --frames N (after --warmup N more) then exits;
+	//	--stats FILE writes its frame-time statistics as JSON and --output-image FILE its final image as PNG.
+	// --record-path FILE records the camera's path (and the animation clock) through an interactive session,
+	//	saved at exit; --replay-path FILE replays one at a fixed timestep instead, headless or in the window,
+	//	timing every frame (--stats, and --frame-csv FILE for each frame's times) then exits.
+	Application(const std::vector<std::string>& arguments = {});
 	~Application();
 
 	void run();
 
 private:
 	void initializeSDL();
+	void initializeImageLoaders();
 	void createWindow();
+	void loadScene();
+	std::vector<std::string> parseArguments(const std::vector<std::string>& arguments);
+	void configurePacing(const std::vector<std::string>& pacingArguments);
 	void initializeVulkan();
 	void setUpScene();
 
 	void mainLoop();
+	void runBenchmark();
+	void writeStatistics(const FrameStats& frameTimes, const FrameStats& cpuTimes, const FrameStats& gpuTimes);
+	void writeImage();
 	void handleEvents();
 	void toggleProjectionMode();
 	void resetCamera();
+	void changePipelineVariant(const PipelineVariant& variant);
 	void update(float deltaTime);
 	void render();
 	void cleanup();
@@ -38,10 +62,37 @@ private:
 	std::unique_ptr<VulkanEngine> vulkanEngine;
 	std::unique_ptr<Renderer> renderer;
 	std::unique_ptr<Camera> camera;
+	std::unique_ptr<TextureManager> textureManager;
 
 	// Scene management
 	std::unique_ptr<SceneManager> sceneManager;
 	std::vector<std::unique_ptr<Model>> models;  // Cached models for rendering
+	bool sceneLoaded;
+	bool startupLogged;				// (the startup timeline, once the first frame is rendered)
+
+	PacingSettings pacing;
+	std::string gpuCsvFile;			// (empty for none)
+	std::string gpuTraceFile;
+	std::string traceFile;
+	std::string scenePath;
+	bool depthPrepass;				// (--depth-prepass: start with it on)
+	double dynamicResolutionMs;		// (--dynamic-resolution MS: the GPU frame time to hold to; 0 for off)
+
+	// Headless benchmarking
+	bool headless;
+	uint32_t headlessFrames;
+	uint32_t warmupFrames;
+	std::string statsFile;			// (empty for none)
+	std::string outputImageFile;
+	std::string frameCsvFile;
+
+	// Camera paths, recorded through an interactive session or replayed as a benchmark (else null)
+	std::unique_ptr<CameraPath> cameraRecording;
+	std::unique_ptr<CameraPath> cameraReplay;
+	std::string recordPathFile;
+	std::string replayPathFile;
+	float recordingTime;
+	float replayTime;
 
 	// Application state
 	bool running;
@@ -49,6 +100,7 @@ private:
 	uint32_t windowHeight;
 
 	bool animationPaused;  // Control animation state
+	float animationTime;   // (advances only while not paused)
 
 	// Input state
 	bool keys[SDL_NUM_SCANCODES];
@@ -7,35 +7,45 @@
 
 // Constructor should initialize transforms
 Model::Model()
-	: position(0.0f, 0.0f, 0.0f)
-	, rotation(0.0f, 0.0f, 0.0f)
-	, scale(1.0f, 1.0f, 1.0f)  // Default scale is 1,1,1 not 0,0,0!
+	: transform(TransformStore::shared().create())	// (at the origin, unrotated, scale 1,1,1 not 0,0,0!)
+	, ownsTransform(true)
+	, hasWorldMatrix(false)
 	, visible(true)
+	, transformVersion(0)
+{
+}
+
+Model::Model(TransformHandle sharedTransform)
+	: transform(sharedTransform)
+	, ownsTransform(false)
+	, hasWorldMatrix(false)
+	, visible(true)
+	, transformVersion(0)
 {
 }
 
 Model::~Model() {
+	if (ownsTransform) {
+		TransformStore::shared().destroy(transform);
+	}
 }
 
-// CRITICAL: This function builds the model transformation matrix
-Matrix4 Model::getModelMatrix() const {
-	// Build transformation matrix in the correct order:
+// CRITICAL: This function gets the model transformation matrix
+const Matrix4& Model::getModelMatrix() const {
+	// The transformation matrix is built in the correct order:
 	// Scale first, then rotate, then translate
 	// This is because we want to scale/rotate around the object's center,
 	// then move it to its world position
 
-	Matrix4 scaleMatrix = Matrix4::scale(scale);
-	Matrix4 rotationMatrix = Matrix4::rotation(rotation);  // Euler angles in degrees
-	Matrix4 translationMatrix = Matrix4::translation(position);
-
-	// Combine: T * R * S
-	// This means: scale first, then rotate, then translate
-	Matrix4 modelMatrix = translationMatrix * rotationMatrix * scaleMatrix;
+	// Combine: T * R * S, as the transform store composes it (all changed models at once, each frame),
+	// under its parents' transforms if it's in a scene hierarchy
+	const Matrix4& modelMatrix = hasWorldMatrix ? worldMatrix : TransformStore::shared().getWorldMatrix(transform);
 
 	// Debug: Print some info about this matrix
 	static int debugCounter = 3;
-	if (debugCounter > 0 && position.length() > 0.01f) {
+	if (debugCounter > 0 && getPosition().length() > 0.01f) {
 		debugCounter--;
+		Vector3 position = getPosition(), scale = getScale(), rotation = getRotation();
 		Log(LOW, "Model at position (%.2f, %.2f, %.2f)", position.x, position.y, position.z);
 		Log(LOW, "  Scale: (%.2f, %.2f, %.2f)", scale.x, scale.y, scale.z);
 		Log(LOW, "  Rotation: (%.2f, %.2f, %.2f)", rotation.x, rotation.y, rotation.z);
@@ -51,16 +61,51 @@ Matrix4 Model::getModelMatrix() const {
 	return modelMatrix;
 }
 
+const Matrix4& Model::getNormalMatrix() const {
+	return hasWorldMatrix ? worldNormalMatrix : TransformStore::shared().getNormalMatrix(transform);
+}
+
+void Model::setWorldMatrix(const Matrix4& world, const Matrix4& normal) {
+	worldMatrix = world;
+	worldNormalMatrix = normal;
+	hasWorldMatrix = true;
+	++transformVersion;
+}
+
 void Model::setPosition(const Vector3& pos) {
-	position = pos;
+	TransformStore::shared().setPosition(transform, pos);
+	++transformVersion;
 }
 
 void Model::setRotation(const Vector3& rot) {
-	rotation = rot;
+	TransformStore::shared().setRotation(transform, rot);
+	++transformVersion;
+}
+
+void Model::setRotation(const Quaternion& rot) {
+	TransformStore::shared().setRotation(transform, rot);
+	++transformVersion;
 }
 
 void Model::setScale(const Vector3& s) {
-	scale = s;
+	TransformStore::shared().setScale(transform, s);
+	++transformVersion;
+}
+
+Vector3 Model::getPosition() const {
+	return TransformStore::shared().getPosition(transform);
+}
+
+Vector3 Model::getRotation() const {
+	return TransformStore::shared().getRotation(transform);
+}
+
+Quaternion Model::getOrientation() const {
+	return TransformStore::shared().getOrientation(transform);
+}
+
+Vector3 Model::getScale() const {
+	return TransformStore::shared().getScale(transform);
 }
 
 void Model::setMesh(std::shared_ptr<Mesh> mesh) {
@@ -79,10 +124,10 @@ void Model::createBuffers(VulkanDevice& device) {
 	}
 }
 
-void Model::render(VkCommandBuffer commandBuffer) {
+void Model::render(VkCommandBuffer commandBuffer, uint32_t objectIndex) {
 	if (mesh && visible) {
-		auto vertices = mesh->getVertices();
-		auto indices = mesh->getIndices();
+		const auto& vertices = mesh->getVertices();
+		const auto& indices = mesh->getIndices();
 
 		static int debugCounter = 0;
 		if (debugCounter < 10) {  // Only print first few times to avoid spam
@@ -96,14 +141,6 @@ void Model::render(VkCommandBuffer commandBuffer) {
 		}
 
 		mesh->bind(commandBuffer);
-		mesh->draw(commandBuffer);
+		mesh->draw(commandBuffer, objectIndex);
 	}
 }
-
-void Model::updateModelMatrix() const {
-	Matrix4 translation = Matrix4::translation(position);
-	Matrix4 rotationMatrix = Matrix4::rotation(rotation);
-	Matrix4 scaleMatrix = Matrix4::scale(scale);
-
-	modelMatrix = translation * rotationMatrix * scaleMatrix;
-}
@@ -2,6 +2,7 @@
 
 #include "math/Vector3.h"
 #include "math/Matrix4.h"
+#include "math/TransformStore.h"
 #include <vulkan/vulkan.h>
 #include <memory>
 #include <string>
@@ -13,19 +14,35 @@ class Texture;
 class Model {
 public:
 	Model();
+	// (drives an existing transform store entry - its scene object's - instead of owning one)
+	explicit Model(TransformHandle sharedTransform);
 	~Model();
 
-	// Transform operations
+	Model(const Model&) = delete;				// (each owns its entry in the transform store)
+	Model& operator=(const Model&) = delete;
+
+	// Transform operations (kept in TransformStore::shared(), which composes them in batches)
 	void setPosition(const Vector3& position);
-	void setRotation(const Vector3& rotation);
+	void setRotation(const Vector3& rotation);		// (Euler angles in degrees)
+	void setRotation(const Quaternion& rotation);
 	void setScale(const Vector3& scale);
 
-	Vector3 getPosition() const { return position; }
-	Vector3 getRotation() const { return rotation; }
-	Vector3 getScale() const { return scale; }
+	Vector3 getPosition() const;
+	Vector3 getRotation() const;
+	Quaternion getOrientation() const;
+	Vector3 getScale() const;
+
+	// Model matrix, and its normal matrix (inverse transpose)
+	const Matrix4& getModelMatrix() const;
+	const Matrix4& getNormalMatrix() const;
+	TransformHandle getTransformHandle() const { return transform; }
+
+	// World matrices composed through a scene hierarchy (by SceneManager), which then replace
+	//	the model's own transform's matrices
+	void setWorldMatrix(const Matrix4& worldMatrix, const Matrix4& normalMatrix);
 
-	// Model matrix
-	Matrix4 getModelMatrix() const;
+	// Changes whenever position, rotation or scale is set (so renderers can skip unchanged transforms)
+	uint64_t getTransformVersion() const { return transformVersion; }
 
 	// Mesh operations
 	void setMesh(std::shared_ptr<Mesh> mesh);
@@ -38,23 +55,23 @@ public:
 
 	// Rendering
 	void createBuffers(VulkanDevice& device);
-	void render(VkCommandBuffer commandBuffer);
+	// (objectIndex selects the model's record in the per-object storage buffer, via the draw's firstInstance)
+	void render(VkCommandBuffer commandBuffer, uint32_t objectIndex = 0);
 
 	// Utility
 	bool isVisible() const { return visible; }
 	void setVisible(bool visible) { this->visible = visible; }
 
 private:
-	Vector3 position;
-	Vector3 rotation;
-	Vector3 scale;
+	TransformHandle transform;
+	bool ownsTransform;
+	bool hasWorldMatrix;
+	Matrix4 worldMatrix;
+	Matrix4 worldNormalMatrix;
 
 	std::shared_ptr<Mesh> mesh;
 	std::shared_ptr<Texture> texture;
 	bool visible;
 	bool buffersCreated;
-
-	mutable Matrix4 modelMatrix;
-
-	void updateModelMatrix() const;
+	uint64_t transformVersion;
 };
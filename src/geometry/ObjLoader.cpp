@@ -1,5 +1,6 @@
 #include "ObjLoader.h"
 #include "../utils/logger/Logging.h"
+#include "../utils/Trace.h"
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -13,20 +14,26 @@ ObjLoader::~ObjLoader() {
 }
 
 std::shared_ptr<Mesh> ObjLoader::load(const std::string& filename) {
+	TRACE_SCOPE("ObjLoader::load");
 	std::string content = loadFile(filename);
 	ObjData objData = parseObj(content);
-	return buildMeshFromObjData(objData);
+	std::shared_ptr<Mesh> mesh = buildMeshFromObjData(objData);
+	logMesh(*mesh);
+	return mesh;
 }
 
 ObjLoader::ObjResult ObjLoader::loadWithMaterial(const std::string& filename) {
+	TRACE_SCOPE("ObjLoader::loadWithMaterial");
 	std::string content = loadFile(filename);
 	ObjData objData = parseObj(content);
 
 	ObjResult result;
 	result.mesh = buildMeshFromObjData(objData);
+	logMesh(*result.mesh);
 
 	// Load material if specified:
 	if (!objData.materialLibrary.empty()) {
+		TRACE_SCOPE("ObjLoader::parseMtl");
 		try {
 			std::string objDir = getDirectoryPath(filename);
 			std::string mtlPath = objDir + "/" + objData.materialLibrary;
@@ -50,6 +57,7 @@ ObjLoader::ObjResult ObjLoader::loadWithMaterial(const std::string& filename) {
 }
 
 ObjLoader::ObjData ObjLoader::parseObj(const std::string& content) {
+	TRACE_SCOPE("ObjLoader::parseObj");
 	ObjData data;
 	std::istringstream stream(content);
 	std::string line;
@@ -91,6 +99,7 @@ ObjLoader::ObjData ObjLoader::parseObj(const std::string& content) {
 
 	// Generate normals if none were provided:
 	if (data.normals.empty() && !data.positions.empty()) {
+		TRACE_SCOPE("ObjLoader::generateNormals");
 		generateNormals(data);
 	}
 	return data;
@@ -292,6 +301,7 @@ std::string ObjLoader::getDirectoryPath(const std::string& filepath) {
 }
 
 std::string ObjLoader::loadFile(const std::string& filename) {
+	TRACE_SCOPE("ObjLoader::loadFile");
 	std::ifstream file(filename);
 	if (!file.is_open()) {
 		throw std::runtime_error("Could not open file: " + filename);
@@ -302,7 +312,16 @@ std::string ObjLoader::loadFile(const std::string& filename) {
 	return content.str();
 }
 
+// (not in buildMeshFromObjData, so that stays quiet for meshes built repeatedly, e.g. when benchmarking)
+void ObjLoader::logMesh(const Mesh& mesh) {
+	Log(SAME, "Loaded OBJ with %zu vertices and %zu triangles", mesh.getVertices().size(), mesh.getIndices().size() / 3);
+	if (mesh.hasTextureCoordinates())
+		Log(SAME, " (textured)");
+	Log(NOTE, ".");
+}
+
 std::shared_ptr<Mesh> ObjLoader::buildMeshFromObjData(const ObjData& objData) {
+	TRACE_SCOPE("ObjLoader::buildMesh");
 	auto mesh = std::make_shared<Mesh>();
 
 	std::vector<Vertex> vertices;
@@ -315,11 +334,6 @@ std::shared_ptr<Mesh> ObjLoader::buildMeshFromObjData(const ObjData& objData) {
 		processIndexedVertices(objData, vertices, indices, hasTextureCoords);
 	}
 
-	Log(SAME, "Loaded OBJ with %zu vertices and %zu triangles", vertices.size(), indices.size() / 3);
-	if (hasTextureCoords)
-		Log(SAME, " (textured)");
-	Log(NOTE, ".");
-
 	mesh->setVertices(vertices);
 	mesh->setIndices(indices);
 	mesh->setHasTexture(hasTextureCoords);
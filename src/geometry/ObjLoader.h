@@ -32,7 +32,7 @@ public:
 	std::shared_ptr<Mesh> load(const std::string& filename);
 	ObjResult loadWithMaterial(const std::string& filename);
 
-private:
+	// The two stages of load(), for OBJ text already in memory (and to time separately)
 	struct FaceVertex {
 		int positionIndex;
 		int texCoordIndex;
@@ -53,6 +53,9 @@ private:
 	};
 
 	ObjData parseObj(const std::string& content);
+	std::shared_ptr<Mesh> buildMeshFromObjData(const ObjData& objData);
+
+private:
 	std::unordered_map<std::string, Material> parseMtl(const std::string& filename);
 	Vector3 parseVector3(const std::string& line);
 	Vector2 parseVector2(const std::string& line);
@@ -60,9 +63,9 @@ private:
 	void generateNormals(ObjData& data);
 	std::string loadFile(const std::string& filename);
 	std::string getDirectoryPath(const std::string& filepath);
+	void logMesh(const Mesh& mesh);
 
 	// Consolidate common operations:
-	std::shared_ptr<Mesh> buildMeshFromObjData(const ObjData& objData);
 	Vertex createVertex(const ObjData& objData, const FaceVertex& faceVert, bool& hasTextureCoords);
 	Vertex createVertex(const ObjData& objData, size_t index, bool hasTextureCoords);
 	Vector3 determineVertexNormal(const ObjData& objData, int normalIndex, int positionIndex);
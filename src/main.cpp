@@ -1,10 +1,12 @@
 #include "Application.h"
 #include "utils/logger/Logging.h"
 #include <stdexcept>
+#include <string>
+#include <vector>
 
-int main() {
+int main(int argc, char* argv[]) {
 	try {
-		Application app;
+		Application app(std::vector<std::string>(argv + 1, argv + argc));
 		app.run();
 	}
 	catch (const std::exception& e) {
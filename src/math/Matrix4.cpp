@@ -1,4 +1,6 @@
 #include "Matrix4.h"
+#include "MatrixKernels.h"
+#include "Quaternion.h"
 #include <cmath>
 #include <cstring>
 
@@ -14,19 +16,7 @@ Matrix4::Matrix4(const std::array<std::array<float, 4>, 4>& matrix) : m(matrix)
 
 Matrix4 Matrix4::operator*(const Matrix4& other) const {
 	Matrix4 result;
-
-	// FIXED: Correct multiplication for column-major matrices
-	// m[col][row] layout, so m[i] is column i
-	for (int col = 0; col < 4; ++col) {
-		for (int row = 0; row < 4; ++row) {
-			result.m[col][row] = 0.0f;
-			for (int k = 0; k < 4; ++k) {
-				// result column = this * other column
-				result.m[col][row] += m[k][row] * other.m[col][k];
-			}
-		}
-	}
-
+	MatrixKernels::multiply(data(), other.data(), result.data());
 	return result;
 }
 
@@ -63,10 +53,13 @@ Matrix4 Matrix4::translation(const Vector3& translation) {
 }
 
 Matrix4 Matrix4::rotation(const Vector3& rotation) {
-	Matrix4 rotX = rotationX(rotation.x * PI / 180.0f);
-	Matrix4 rotY = rotationY(rotation.y * PI / 180.0f);
-	Matrix4 rotZ = rotationZ(rotation.z * PI / 180.0f);
-	return rotZ * rotY * rotX;
+	Matrix4 result;
+	MatrixKernels::composeTRS(Vector3::zero(), rotation, Vector3::one(), result.data());
+	return result;
+}
+
+Matrix4 Matrix4::rotation(const Quaternion& rotation) {
+	return trs(Vector3::zero(), rotation, Vector3::one());
 }
 
 Matrix4 Matrix4::scale(const Vector3& scale) {
@@ -77,6 +70,27 @@ Matrix4 Matrix4::scale(const Vector3& scale) {
 	return result;
 }
 
+Matrix4 Matrix4::trs(const Vector3& translation, const Vector3& rotation, const Vector3& scale) {
+	Matrix4 result;
+	MatrixKernels::composeTRS(translation, rotation, scale, result.data());
+	return result;
+}
+
+Matrix4 Matrix4::trs(const Vector3& translation, const Quaternion& rotation, const Vector3& scale) {
+	// Rotation columns straight from the (unit) quaternion, each scaled: no intermediate matrices
+	float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+	float xx = x * x, yy = y * y, zz = z * z;
+	float xy = x * y, xz = x * z, yz = y * z;
+	float wx = w * x, wy = w * y, wz = w * z;
+
+	Matrix4 result;
+	result.m[0] = { (1.0f - 2.0f * (yy + zz)) * scale.x, 2.0f * (xy + wz) * scale.x, 2.0f * (xz - wy) * scale.x, 0.0f };
+	result.m[1] = { 2.0f * (xy - wz) * scale.y, (1.0f - 2.0f * (xx + zz)) * scale.y, 2.0f * (yz + wx) * scale.y, 0.0f };
+	result.m[2] = { 2.0f * (xz + wy) * scale.z, 2.0f * (yz - wx) * scale.z, (1.0f - 2.0f * (xx + yy)) * scale.z, 0.0f };
+	result.m[3] = { translation.x, translation.y, translation.z, 1.0f };
+	return result;
+}
+
 Matrix4 Matrix4::perspective(float fovY, float aspect, float nearPlane, float farPlane) {
 	Matrix4 result;
 	memset(result.m.data(), 0, sizeof(result.m));
@@ -179,18 +193,22 @@ Matrix4 Matrix4::transposed() const {
 }
 
 Matrix4 Matrix4::inverted() const {
-	// Simplified inverse for now - you can implement full inverse if needed
-	// This assumes the matrix is orthogonal (rotation + translation only)
-	Matrix4 result = transposed();
-
-	// Fix the translation part
-	Vector3 translation = getTranslation();
-	result.setTranslation(Vector3(
-		-result.m[0][0] * translation.x - result.m[0][1] * translation.y - result.m[0][2] * translation.z,
-		-result.m[1][0] * translation.x - result.m[1][1] * translation.y - result.m[1][2] * translation.z,
-		-result.m[2][0] * translation.x - result.m[2][1] * translation.y - result.m[2][2] * translation.z
-	));
+	Matrix4 result;
+	if (!MatrixKernels::invert(data(), result.data())) {
+		return identity();
+	}
+	return result;
+}
 
+Vector3 Matrix4::transformPoint(const Vector3& point) const {
+	Vector3 result;
+	MatrixKernels::transformPoints(data(), &point, &result, 1);
+	return result;
+}
+
+Vector3 Matrix4::transformDirection(const Vector3& direction) const {
+	Vector3 result;
+	MatrixKernels::transformDirections(data(), &direction, &result, 1);
 	return result;
 }
 
@@ -239,12 +257,8 @@ void Matrix4::setTranslation(const Vector3& translation) {
 }
 
 void Matrix4::setRotation(const Vector3& rotation) {
-	Matrix4 rot = Matrix4::rotation(rotation);
-	Vector3 scale = getScale();
-	Vector3 translation = getTranslation();
-
 	// Preserve scale and translation, only change rotation
-	*this = Matrix4::translation(translation) * rot * Matrix4::scale(scale);
+	*this = Matrix4::trs(getTranslation(), rotation, getScale());
 }
 
 void Matrix4::setScale(const Vector3& scale) {
@@ -270,42 +284,3 @@ void Matrix4::setScale(const Vector3& scale) {
 		m[2][2] *= factor;
 	}
 }
-
-Matrix4 Matrix4::rotationX(float angle) {
-	Matrix4 result = identity();
-	float c = std::cos(angle);
-	float s = std::sin(angle);
-
-	result.m[1][1] = c;
-	result.m[2][1] = s;
-	result.m[1][2] = -s;
-	result.m[2][2] = c;
-
-	return result;
-}
-
-Matrix4 Matrix4::rotationY(float angle) {
-	Matrix4 result = identity();
-	float c = std::cos(angle);
-	float s = std::sin(angle);
-
-	result.m[0][0] = c;
-	result.m[2][0] = -s;
-	result.m[0][2] = s;
-	result.m[2][2] = c;
-
-	return result;
-}
-
-Matrix4 Matrix4::rotationZ(float angle) {
-	Matrix4 result = identity();
-	float c = std::cos(angle);
-	float s = std::sin(angle);
-
-	result.m[0][0] = c;
-	result.m[1][0] = s;
-	result.m[0][1] = -s;
-	result.m[1][1] = c;
-
-	return result;
-}
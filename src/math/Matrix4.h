@@ -3,10 +3,12 @@
 #include "Vector3.h"
 #include <array>
 
+class Quaternion;
+
 class Matrix4 {
 public:
-	// Column-major order (OpenGL/Vulkan style)
-	std::array<std::array<float, 4>, 4> m;
+	// Column-major order (OpenGL/Vulkan style), aligned for the SIMD kernels (see MatrixKernels.h)
+	alignas(16) std::array<std::array<float, 4>, 4> m;
 
 	Matrix4();
 	Matrix4(const std::array<std::array<float, 4>, 4>& matrix);
@@ -24,7 +26,10 @@ public:
 	static Matrix4 identity();
 	static Matrix4 translation(const Vector3& translation);
 	static Matrix4 rotation(const Vector3& rotation); // Euler angles in degrees
+	static Matrix4 rotation(const Quaternion& rotation);
 	static Matrix4 scale(const Vector3& scale);
+	static Matrix4 trs(const Vector3& translation, const Vector3& rotation, const Vector3& scale); // = T * R * S, in one step
+	static Matrix4 trs(const Vector3& translation, const Quaternion& rotation, const Vector3& scale); // (and without trig)
 	static Matrix4 perspective(float fovY, float aspect, float nearPlane, float farPlane);
 	static Matrix4 perspectiveVulkan(float fovY, float aspect, float nearPlane, float farPlane);
 	static Matrix4 orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane);
@@ -32,9 +37,13 @@ public:
 
 	// Utility functions
 	Matrix4 transposed() const;
-	Matrix4 inverted() const;
+	Matrix4 inverted() const;	// (identity if singular)
 	float determinant() const;
 
+	// Transform without perspective divide: a point (w = 1), or a direction (upper 3x3 only)
+	Vector3 transformPoint(const Vector3& point) const;
+	Vector3 transformDirection(const Vector3& direction) const;
+
 	// Get transformation components
 	Vector3 getTranslation() const;
 	Vector3 getScale() const;
@@ -47,9 +56,4 @@ public:
 	// Get raw data pointer (for sending to shaders)
 	const float* data() const { return &m[0][0]; }
 	float* data() { return &m[0][0]; }
-
-private:
-	static Matrix4 rotationX(float angle);
-	static Matrix4 rotationY(float angle);
-	static Matrix4 rotationZ(float angle);
 };
@@ -0,0 +1,625 @@
+#include "MatrixKernels.h"
+#include <cmath>
+#include <cstring>
+
+#if !defined(MATH_SCALAR_ONLY) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define MATH_KERNELS_SSE
+	#include <immintrin.h>
+#elif !defined(MATH_SCALAR_ONLY) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+	#define MATH_KERNELS_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace {
+	const float PI = 3.14159265359f;
+
+	const float IDENTITY[16] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+
+	// Element (row, col) of a column-major matrix
+	inline float& at(float* m, int row, int col) { return m[col * 4 + row]; }
+
+	// Upper 3x3 of Rz * Ry * Rx in closed form, as columns (w = 0) - matching the single-axis
+	//	rotations Reference::composeTRS multiplies together, but without any matrix products.
+	void rotationColumns(const Vector3& rotationDegrees, float columns[3][4]) {
+		float sx = std::sin(rotationDegrees.x * PI / 180.0f), cx = std::cos(rotationDegrees.x * PI / 180.0f);
+		float sy = std::sin(rotationDegrees.y * PI / 180.0f), cy = std::cos(rotationDegrees.y * PI / 180.0f);
+		float sz = std::sin(rotationDegrees.z * PI / 180.0f), cz = std::cos(rotationDegrees.z * PI / 180.0f);
+
+		columns[0][0] = cz * cy;				columns[0][1] = -sz * cy;				columns[0][2] = sy;			columns[0][3] = 0.0f;
+		columns[1][0] = cz * sy * sx + sz * cx;	columns[1][1] = cz * cx - sz * sy * sx;	columns[1][2] = -cy * sx;	columns[1][3] = 0.0f;
+		columns[2][0] = sz * sx - cz * sy * cx;	columns[2][1] = sz * sy * cx + cz * sx;	columns[2][2] = cy * cx;	columns[2][3] = 0.0f;
+	}
+
+	// World and normal matrix of one TransformArrays entry in closed form. For T * R * S, the inverse
+	//	transpose of the upper 3x3 is R * inverse(S), so the normal matrix needs no general inverse.
+	void composeTransform(const MatrixKernels::TransformArrays& transforms, uint32_t index, float* world, float* normal) {
+		float x = transforms.rotation[0][index], y = transforms.rotation[1][index];
+		float z = transforms.rotation[2][index], w = transforms.rotation[3][index];
+		const float rotation[3][3] = {		// (as columns)
+			{ 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w) },
+			{ 2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w) },
+			{ 2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y) }
+		};
+		const float scales[3] = { transforms.scale[0][index], transforms.scale[1][index], transforms.scale[2][index] };
+
+		float* out = world + index * 16;
+		for (int col = 0; col < 3; ++col) {
+			for (int row = 0; row < 3; ++row) {
+				out[col * 4 + row] = rotation[col][row] * scales[col];
+			}
+			out[col * 4 + 3] = 0.0f;
+		}
+		out[12] = transforms.translation[0][index];
+		out[13] = transforms.translation[1][index];
+		out[14] = transforms.translation[2][index];
+		out[15] = 1.0f;
+
+		float* outNormal = normal + index * 16;
+		if (std::fabs(scales[0] * scales[1] * scales[2]) < 1e-12f) {
+			memcpy(outNormal, out, 16 * sizeof(float));
+			return;
+		}
+		memcpy(outNormal, IDENTITY, 16 * sizeof(float));
+		for (int col = 0; col < 3; ++col) {
+			for (int row = 0; row < 3; ++row) {
+				outNormal[col * 4 + row] = rotation[col][row] / scales[col];
+			}
+		}
+	}
+}
+
+
+// Reference (scalar) implementations
+
+namespace MatrixKernels {
+namespace Reference {
+
+void multiply(const float* a, const float* b, float* out) {
+	// m[col][row] layout, so each result column = a * that column of b
+	for (int col = 0; col < 4; ++col) {
+		for (int row = 0; row < 4; ++row) {
+			out[col * 4 + row] = 0.0f;
+			for (int k = 0; k < 4; ++k) {
+				out[col * 4 + row] += a[k * 4 + row] * b[col * 4 + k];
+			}
+		}
+	}
+}
+
+// Cofactor expansion. (Being column-major doesn't matter: the inverse of the transpose is the transpose of the inverse.)
+bool invert(const float* m, float* out) {
+	float inv[16];
+
+	inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+	inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+	inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+	inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+	inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+	inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+	inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+	inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+	inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+	inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+	inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+	inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+	float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+	if (det == 0.0f) {
+		return false;
+	}
+
+	float invDet = 1.0f / det;
+	for (int i = 0; i < 16; ++i) {
+		out[i] = inv[i] * invDet;
+	}
+	return true;
+}
+
+// Builds translation, rotation (as Rz * Ry * Rx, each a single-axis matrix) and scale matrices and multiplies them.
+void composeTRS(const Vector3& translation, const Vector3& rotationDegrees, const Vector3& scale, float* out) {
+	float rotX[16], rotY[16], rotZ[16], scaleMatrix[16], translationMatrix[16];
+	memcpy(rotX, IDENTITY, sizeof(rotX));
+	memcpy(rotY, IDENTITY, sizeof(rotY));
+	memcpy(rotZ, IDENTITY, sizeof(rotZ));
+	memcpy(scaleMatrix, IDENTITY, sizeof(scaleMatrix));
+	memcpy(translationMatrix, IDENTITY, sizeof(translationMatrix));
+
+	float angle = rotationDegrees.x * PI / 180.0f;
+	at(rotX, 1, 1) = std::cos(angle);
+	at(rotX, 1, 2) = std::sin(angle);
+	at(rotX, 2, 1) = -std::sin(angle);
+	at(rotX, 2, 2) = std::cos(angle);
+
+	angle = rotationDegrees.y * PI / 180.0f;
+	at(rotY, 0, 0) = std::cos(angle);
+	at(rotY, 0, 2) = -std::sin(angle);
+	at(rotY, 2, 0) = std::sin(angle);
+	at(rotY, 2, 2) = std::cos(angle);
+
+	angle = rotationDegrees.z * PI / 180.0f;
+	at(rotZ, 0, 0) = std::cos(angle);
+	at(rotZ, 0, 1) = std::sin(angle);
+	at(rotZ, 1, 0) = -std::sin(angle);
+	at(rotZ, 1, 1) = std::cos(angle);
+
+	at(scaleMatrix, 0, 0) = scale.x;
+	at(scaleMatrix, 1, 1) = scale.y;
+	at(scaleMatrix, 2, 2) = scale.z;
+
+	at(translationMatrix, 0, 3) = translation.x;
+	at(translationMatrix, 1, 3) = translation.y;
+	at(translationMatrix, 2, 3) = translation.z;
+
+	float rotZY[16], rotation[16], translated[16];
+	multiply(rotZ, rotY, rotZY);
+	multiply(rotZY, rotX, rotation);
+	multiply(translationMatrix, rotation, translated);
+	multiply(translated, scaleMatrix, out);
+}
+
+void transformPoints(const float* m, const Vector3* in, Vector3* out, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		Vector3 p = in[i];
+		out[i] = Vector3(m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+						 m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+						 m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+	}
+}
+
+void transformDirections(const float* m, const Vector3* in, Vector3* out, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		Vector3 d = in[i];
+		out[i] = Vector3(m[0] * d.x + m[4] * d.y + m[8] * d.z,
+						 m[1] * d.x + m[5] * d.y + m[9] * d.z,
+						 m[2] * d.x + m[6] * d.y + m[10] * d.z);
+	}
+}
+
+// Each entry's rotation matrix from its quaternion, multiplied out with its translation and scale matrices,
+//	and the normal matrix by general inverse.
+void composeTransforms(const TransformArrays& transforms, const uint32_t* indices, size_t count,
+					   float* world, float* normal) {
+	for (size_t i = 0; i < count; ++i) {
+		uint32_t index = indices[i];
+		float x = transforms.rotation[0][index], y = transforms.rotation[1][index];
+		float z = transforms.rotation[2][index], w = transforms.rotation[3][index];
+
+		float rotation[16], scaleMatrix[16], translationMatrix[16];
+		memcpy(rotation, IDENTITY, sizeof(rotation));
+		memcpy(scaleMatrix, IDENTITY, sizeof(scaleMatrix));
+		memcpy(translationMatrix, IDENTITY, sizeof(translationMatrix));
+
+		at(rotation, 0, 0) = 1.0f - 2.0f * (y * y + z * z);
+		at(rotation, 0, 1) = 2.0f * (x * y - z * w);
+		at(rotation, 0, 2) = 2.0f * (x * z + y * w);
+		at(rotation, 1, 0) = 2.0f * (x * y + z * w);
+		at(rotation, 1, 1) = 1.0f - 2.0f * (x * x + z * z);
+		at(rotation, 1, 2) = 2.0f * (y * z - x * w);
+		at(rotation, 2, 0) = 2.0f * (x * z - y * w);
+		at(rotation, 2, 1) = 2.0f * (y * z + x * w);
+		at(rotation, 2, 2) = 1.0f - 2.0f * (x * x + y * y);
+
+		for (int axis = 0; axis < 3; ++axis) {
+			at(scaleMatrix, axis, axis) = transforms.scale[axis][index];
+			at(translationMatrix, axis, 3) = transforms.translation[axis][index];
+		}
+
+		float translated[16], inverse[16];
+		float* outWorld = world + index * 16;
+		float* outNormal = normal + index * 16;
+		multiply(translationMatrix, rotation, translated);
+		multiply(translated, scaleMatrix, outWorld);
+
+		if (!invert(outWorld, inverse)) {
+			memcpy(outNormal, outWorld, sizeof(inverse));
+			continue;
+		}
+		memcpy(outNormal, IDENTITY, sizeof(inverse));
+		for (int row = 0; row < 3; ++row) {
+			for (int col = 0; col < 3; ++col) {
+				at(outNormal, row, col) = at(inverse, col, row);
+			}
+		}
+	}
+}
+
+} // namespace Reference
+
+
+#if defined(MATH_KERNELS_SSE)
+
+// x86: SSE2 throughout; AVX for multiply (two result columns per instruction); FMA where the compiler targets it
+
+namespace {
+	inline __m128 madd(__m128 a, __m128 b, __m128 c) {
+	#if defined(__FMA__)
+		return _mm_fmadd_ps(a, b, c);
+	#else
+		return _mm_add_ps(_mm_mul_ps(a, b), c);
+	#endif
+	}
+
+	#define SHUFFLE(a, b, x, y, z, w)	_mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+	#define SWIZZLE(a, x, y, z, w)		SHUFFLE(a, a, x, y, z, w)
+
+	// 2x2 matrices packed in one register (as in the block inverse below, treating columns as rows):
+	//	A * B, adj(A) * B, and A * adj(B)
+	inline __m128 mat2Mul(__m128 a, __m128 b) {
+		return _mm_add_ps(_mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+	}
+	inline __m128 mat2AdjMul(__m128 a, __m128 b) {
+		return _mm_sub_ps(_mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+	}
+	inline __m128 mat2MulAdj(__m128 a, __m128 b) {
+		return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+	}
+
+	inline void storeVector3(Vector3& out, __m128 v) {
+		_mm_storel_pi(reinterpret_cast<__m64*>(&out.x), v);
+		_mm_store_ss(&out.z, _mm_movehl_ps(v, v));
+	}
+}
+
+const char* backendName() {
+#if defined(__AVX__) && defined(__FMA__)
+	return "AVX+FMA";
+#elif defined(__AVX__)
+	return "AVX";
+#else
+	return "SSE2";
+#endif
+}
+
+void multiply(const float* a, const float* b, float* out) {
+#if defined(__AVX__)
+	__m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+	__m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+	__m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+	__m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+	__m256 b01 = _mm256_loadu_ps(b);
+	__m256 b23 = _mm256_loadu_ps(b + 8);
+
+	__m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+	__m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+	#if defined(__FMA__)
+	r01 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, 0x55), r01);
+	r23 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, 0x55), r23);
+	r01 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b01, 0xAA), r01);
+	r23 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, 0xAA), r23);
+	r01 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b01, 0xFF), r01);
+	r23 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b23, 0xFF), r23);
+	#else
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a1, _mm256_permute_ps(b01, 0x55)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a1, _mm256_permute_ps(b23, 0x55)));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xAA)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a2, _mm256_permute_ps(b23, 0xAA)));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(a3, _mm256_permute_ps(b01, 0xFF)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xFF)));
+	#endif
+	_mm256_storeu_ps(out, r01);
+	_mm256_storeu_ps(out + 8, r23);
+#else
+	__m128 a0 = _mm_loadu_ps(a);
+	__m128 a1 = _mm_loadu_ps(a + 4);
+	__m128 a2 = _mm_loadu_ps(a + 8);
+	__m128 a3 = _mm_loadu_ps(a + 12);
+	__m128 columns[4];
+	for (int col = 0; col < 4; ++col) {
+		__m128 bc = _mm_loadu_ps(b + col * 4);
+		__m128 r = _mm_mul_ps(a0, SWIZZLE(bc, 0, 0, 0, 0));
+		r = madd(a1, SWIZZLE(bc, 1, 1, 1, 1), r);
+		r = madd(a2, SWIZZLE(bc, 2, 2, 2, 2), r);
+		columns[col] = madd(a3, SWIZZLE(bc, 3, 3, 3, 3), r);
+	}
+	for (int col = 0; col < 4; ++col) {
+		_mm_storeu_ps(out + col * 4, columns[col]);		// (after all of b is read, so out may alias it)
+	}
+#endif
+}
+
+// Block-wise inverse via 2x2 sub-matrices and their adjugates. It's written for row vectors in
+//	registers; given columns, it inverts the transpose, whose rows are the inverse's columns.
+bool invert(const float* m, float* out) {
+	__m128 c0 = _mm_loadu_ps(m);
+	__m128 c1 = _mm_loadu_ps(m + 4);
+	__m128 c2 = _mm_loadu_ps(m + 8);
+	__m128 c3 = _mm_loadu_ps(m + 12);
+
+	// Sub-matrices, and their determinants as (|A| |B| |C| |D|)
+	__m128 A = _mm_movelh_ps(c0, c1);
+	__m128 B = _mm_movehl_ps(c1, c0);
+	__m128 C = _mm_movelh_ps(c2, c3);
+	__m128 D = _mm_movehl_ps(c3, c2);
+
+	__m128 detSub = _mm_sub_ps(
+		_mm_mul_ps(SHUFFLE(c0, c2, 0, 2, 0, 2), SHUFFLE(c1, c3, 1, 3, 1, 3)),
+		_mm_mul_ps(SHUFFLE(c0, c2, 1, 3, 1, 3), SHUFFLE(c1, c3, 0, 2, 0, 2)));
+	__m128 detA = SWIZZLE(detSub, 0, 0, 0, 0);
+	__m128 detB = SWIZZLE(detSub, 1, 1, 1, 1);
+	__m128 detC = SWIZZLE(detSub, 2, 2, 2, 2);
+	__m128 detD = SWIZZLE(detSub, 3, 3, 3, 3);
+
+	// Inverse = 1/|M| * adj of [X Y; Z W], where
+	//	X# = |D|A - B(D#C), W# = |A|D - C(A#B), Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+	__m128 D_C = mat2AdjMul(D, C);
+	__m128 A_B = mat2AdjMul(A, B);
+	__m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, D_C));
+	__m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, A_B));
+	__m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, A_B));
+	__m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, D_C));
+
+	// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 trace = _mm_mul_ps(A_B, SWIZZLE(D_C, 0, 2, 1, 3));
+	trace = _mm_add_ps(trace, SWIZZLE(trace, 2, 3, 0, 1));
+	trace = _mm_add_ps(trace, SWIZZLE(trace, 1, 0, 3, 2));
+	__m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+	if (_mm_cvtss_f32(detM) == 0.0f) {
+		return false;
+	}
+
+	__m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+	X_ = _mm_mul_ps(X_, rDetM);
+	Y_ = _mm_mul_ps(Y_, rDetM);
+	Z_ = _mm_mul_ps(Z_, rDetM);
+	W_ = _mm_mul_ps(W_, rDetM);
+
+	// Adjugate shuffles, combined with the stores
+	_mm_storeu_ps(out, SHUFFLE(X_, Y_, 3, 1, 3, 1));
+	_mm_storeu_ps(out + 4, SHUFFLE(X_, Y_, 2, 0, 2, 0));
+	_mm_storeu_ps(out + 8, SHUFFLE(Z_, W_, 3, 1, 3, 1));
+	_mm_storeu_ps(out + 12, SHUFFLE(Z_, W_, 2, 0, 2, 0));
+	return true;
+}
+
+void composeTRS(const Vector3& translation, const Vector3& rotationDegrees, const Vector3& scale, float* out) {
+	alignas(16) float columns[3][4];
+	rotationColumns(rotationDegrees, columns);
+
+	_mm_storeu_ps(out, _mm_mul_ps(_mm_load_ps(columns[0]), _mm_set1_ps(scale.x)));
+	_mm_storeu_ps(out + 4, _mm_mul_ps(_mm_load_ps(columns[1]), _mm_set1_ps(scale.y)));
+	_mm_storeu_ps(out + 8, _mm_mul_ps(_mm_load_ps(columns[2]), _mm_set1_ps(scale.z)));
+	_mm_storeu_ps(out + 12, _mm_setr_ps(translation.x, translation.y, translation.z, 1.0f));
+}
+
+void transformPoints(const float* m, const Vector3* in, Vector3* out, size_t count) {
+	__m128 c0 = _mm_loadu_ps(m);
+	__m128 c1 = _mm_loadu_ps(m + 4);
+	__m128 c2 = _mm_loadu_ps(m + 8);
+	__m128 c3 = _mm_loadu_ps(m + 12);
+	for (size_t i = 0; i < count; ++i) {
+		__m128 r = madd(c0, _mm_set1_ps(in[i].x), c3);
+		r = madd(c1, _mm_set1_ps(in[i].y), r);
+		r = madd(c2, _mm_set1_ps(in[i].z), r);
+		storeVector3(out[i], r);
+	}
+}
+
+void transformDirections(const float* m, const Vector3* in, Vector3* out, size_t count) {
+	__m128 c0 = _mm_loadu_ps(m);
+	__m128 c1 = _mm_loadu_ps(m + 4);
+	__m128 c2 = _mm_loadu_ps(m + 8);
+	for (size_t i = 0; i < count; ++i) {
+		__m128 r = _mm_mul_ps(c0, _mm_set1_ps(in[i].x));
+		r = madd(c1, _mm_set1_ps(in[i].y), r);
+		r = madd(c2, _mm_set1_ps(in[i].z), r);
+		storeVector3(out[i], r);
+	}
+}
+
+void composeTransforms(const TransformArrays& transforms, const uint32_t* indices, size_t count,
+					   float* world, float* normal) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 epsilon = _mm_set1_ps(1e-12f);
+
+	// Four entries at a time, one per lane, as in composeTransform (see above)
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint32_t* lane = indices + i;
+		bool consecutive = lane[1] == lane[0] + 1 && lane[2] == lane[0] + 2 && lane[3] == lane[0] + 3;
+		auto load = [lane, consecutive](const float* array) {
+			return consecutive ? _mm_loadu_ps(array + lane[0])
+							   : _mm_setr_ps(array[lane[0]], array[lane[1]], array[lane[2]], array[lane[3]]);
+		};
+
+		__m128 x = load(transforms.rotation[0]), y = load(transforms.rotation[1]);
+		__m128 z = load(transforms.rotation[2]), w = load(transforms.rotation[3]);
+		__m128 x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z);
+		__m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+		__m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+		__m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+		const __m128 rotation[3][3] = {		// (as columns)
+			{ _mm_sub_ps(one, _mm_add_ps(yy, zz)), _mm_add_ps(xy, wz), _mm_sub_ps(xz, wy) },
+			{ _mm_sub_ps(xy, wz), _mm_sub_ps(one, _mm_add_ps(xx, zz)), _mm_add_ps(yz, wx) },
+			{ _mm_add_ps(xz, wy), _mm_sub_ps(yz, wx), _mm_sub_ps(one, _mm_add_ps(xx, yy)) }
+		};
+		const __m128 scales[3] = { load(transforms.scale[0]), load(transforms.scale[1]), load(transforms.scale[2]) };
+		__m128 singular = _mm_cmplt_ps(_mm_and_ps(_mm_mul_ps(_mm_mul_ps(scales[0], scales[1]), scales[2]), absMask), epsilon);
+
+		// Element [col][row] of each lane's matrices, so every column transposes into four entries' columns
+		__m128 worldColumns[4][4], normalColumns[4][4];
+		for (int col = 0; col < 3; ++col) {
+			__m128 inverseScale = _mm_div_ps(one, scales[col]);
+			for (int row = 0; row < 3; ++row) {
+				worldColumns[col][row] = _mm_mul_ps(rotation[col][row], scales[col]);
+				normalColumns[col][row] = _mm_mul_ps(rotation[col][row], inverseScale);
+			}
+			worldColumns[col][3] = zero;
+			normalColumns[col][3] = zero;
+		}
+		worldColumns[3][0] = load(transforms.translation[0]);
+		worldColumns[3][1] = load(transforms.translation[1]);
+		worldColumns[3][2] = load(transforms.translation[2]);
+		worldColumns[3][3] = one;
+		normalColumns[3][0] = normalColumns[3][1] = normalColumns[3][2] = zero;
+		normalColumns[3][3] = one;
+
+		for (int col = 0; col < 4; ++col) {
+			for (int row = 0; row < 4; ++row) {
+				normalColumns[col][row] = _mm_or_ps(_mm_and_ps(singular, worldColumns[col][row]),
+													_mm_andnot_ps(singular, normalColumns[col][row]));
+			}
+			_MM_TRANSPOSE4_PS(worldColumns[col][0], worldColumns[col][1], worldColumns[col][2], worldColumns[col][3]);
+			_MM_TRANSPOSE4_PS(normalColumns[col][0], normalColumns[col][1], normalColumns[col][2], normalColumns[col][3]);
+			for (int entry = 0; entry < 4; ++entry) {
+				_mm_storeu_ps(world + lane[entry] * 16 + col * 4, worldColumns[col][entry]);
+				_mm_storeu_ps(normal + lane[entry] * 16 + col * 4, normalColumns[col][entry]);
+			}
+		}
+	}
+	for (; i < count; ++i) {
+		composeTransform(transforms, indices[i], world, normal);
+	}
+}
+
+#undef SHUFFLE
+#undef SWIZZLE
+
+#elif defined(MATH_KERNELS_NEON)
+
+// ARM: NEON for multiply, TRS and transforms; the inverse and batched transforms stay scalar
+
+const char* backendName() {
+	return "NEON";
+}
+
+void multiply(const float* a, const float* b, float* out) {
+	float32x4_t a0 = vld1q_f32(a);
+	float32x4_t a1 = vld1q_f32(a + 4);
+	float32x4_t a2 = vld1q_f32(a + 8);
+	float32x4_t a3 = vld1q_f32(a + 12);
+	float32x4_t columns[4];
+	for (int col = 0; col < 4; ++col) {
+		float32x4_t bc = vld1q_f32(b + col * 4);
+		float32x4_t r = vmulq_n_f32(a0, vgetq_lane_f32(bc, 0));
+		r = vmlaq_n_f32(r, a1, vgetq_lane_f32(bc, 1));
+		r = vmlaq_n_f32(r, a2, vgetq_lane_f32(bc, 2));
+		columns[col] = vmlaq_n_f32(r, a3, vgetq_lane_f32(bc, 3));
+	}
+	for (int col = 0; col < 4; ++col) {
+		vst1q_f32(out + col * 4, columns[col]);
+	}
+}
+
+bool invert(const float* m, float* out) {
+	float result[16];		// (so out may alias m)
+	if (!Reference::invert(m, result)) {
+		return false;
+	}
+	memcpy(out, result, sizeof(result));
+	return true;
+}
+
+void composeTRS(const Vector3& translation, const Vector3& rotationDegrees, const Vector3& scale, float* out) {
+	float columns[3][4];
+	rotationColumns(rotationDegrees, columns);
+
+	vst1q_f32(out, vmulq_n_f32(vld1q_f32(columns[0]), scale.x));
+	vst1q_f32(out + 4, vmulq_n_f32(vld1q_f32(columns[1]), scale.y));
+	vst1q_f32(out + 8, vmulq_n_f32(vld1q_f32(columns[2]), scale.z));
+	out[12] = translation.x;
+	out[13] = translation.y;
+	out[14] = translation.z;
+	out[15] = 1.0f;
+}
+
+void transformPoints(const float* m, const Vector3* in, Vector3* out, size_t count) {
+	float32x4_t c0 = vld1q_f32(m);
+	float32x4_t c1 = vld1q_f32(m + 4);
+	float32x4_t c2 = vld1q_f32(m + 8);
+	float32x4_t c3 = vld1q_f32(m + 12);
+	for (size_t i = 0; i < count; ++i) {
+		float32x4_t r = vmlaq_n_f32(c3, c0, in[i].x);
+		r = vmlaq_n_f32(r, c1, in[i].y);
+		r = vmlaq_n_f32(r, c2, in[i].z);
+		out[i] = Vector3(vgetq_lane_f32(r, 0), vgetq_lane_f32(r, 1), vgetq_lane_f32(r, 2));
+	}
+}
+
+void transformDirections(const float* m, const Vector3* in, Vector3* out, size_t count) {
+	float32x4_t c0 = vld1q_f32(m);
+	float32x4_t c1 = vld1q_f32(m + 4);
+	float32x4_t c2 = vld1q_f32(m + 8);
+	for (size_t i = 0; i < count; ++i) {
+		float32x4_t r = vmulq_n_f32(c0, in[i].x);
+		r = vmlaq_n_f32(r, c1, in[i].y);
+		r = vmlaq_n_f32(r, c2, in[i].z);
+		out[i] = Vector3(vgetq_lane_f32(r, 0), vgetq_lane_f32(r, 1), vgetq_lane_f32(r, 2));
+	}
+}
+
+void composeTransforms(const TransformArrays& transforms, const uint32_t* indices, size_t count,
+					   float* world, float* normal) {
+	for (size_t i = 0; i < count; ++i) {
+		composeTransform(transforms, indices[i], world, normal);
+	}
+}
+
+#else
+
+// Portable fallback: the reference code, except for closed-form TRS and batched transforms (and copies where out may alias)
+
+const char* backendName() {
+	return "scalar";
+}
+
+void multiply(const float* a, const float* b, float* out) {
+	float result[16];
+	Reference::multiply(a, b, result);
+	memcpy(out, result, sizeof(result));
+}
+
+bool invert(const float* m, float* out) {
+	float result[16];
+	if (!Reference::invert(m, result)) {
+		return false;
+	}
+	memcpy(out, result, sizeof(result));
+	return true;
+}
+
+void composeTRS(const Vector3& translation, const Vector3& rotationDegrees, const Vector3& scale, float* out) {
+	float columns[3][4];
+	rotationColumns(rotationDegrees, columns);
+
+	const float scales[3] = { scale.x, scale.y, scale.z };
+	for (int col = 0; col < 3; ++col) {
+		for (int row = 0; row < 4; ++row) {
+			out[col * 4 + row] = columns[col][row] * scales[col];
+		}
+	}
+	out[12] = translation.x;
+	out[13] = translation.y;
+	out[14] = translation.z;
+	out[15] = 1.0f;
+}
+
+void transformPoints(const float* m, const Vector3* in, Vector3* out, size_t count) {
+	Reference::transformPoints(m, in, out, count);
+}
+
+void transformDirections(const float* m, const Vector3* in, Vector3* out, size_t count) {
+	Reference::transformDirections(m, in, out, count);
+}
+
+void composeTransforms(const TransformArrays& transforms, const uint32_t* indices, size_t count,
+					   float* world, float* normal) {
+	for (size_t i = 0; i < count; ++i) {
+		composeTransform(transforms, indices[i], world, normal);
+	}
+}
+
+#endif
+
+} // namespace MatrixKernels
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Vector3.h"
+#include <cstddef>
+#include <cstdint>
+
+// Low-level kernels on column-major 4x4 float matrices (float[16], laid out as Matrix4 stores them).
+// Each has a SIMD implementation chosen at compile time - AVX (with FMA if enabled) or SSE2 on x86,
+//	NEON on ARM - falling back to portable scalar code elsewhere, or if MATH_SCALAR_ONLY is defined.
+// The Reference versions are the original scalar code, kept to verify the others against (see bench/).
+namespace MatrixKernels {
+	const char* backendName();
+
+	// out = a * b (out may alias a or b)
+	void multiply(const float* a, const float* b, float* out);
+
+	// General inverse. Returns false, leaving out untouched, if m is singular.
+	bool invert(const float* m, float* out);
+
+	// out = translation * rotation * scale, rotation being Euler angles in degrees (applied X, then Y, then Z)
+	void composeTRS(const Vector3& translation, const Vector3& rotationDegrees, const Vector3& scale, float* out);
+
+	// Affine point transforms (w = 1, no perspective divide), and directions (upper 3x3 only).
+	//	in and out may be the same array.
+	void transformPoints(const float* m, const Vector3* in, Vector3* out, size_t count);
+	void transformDirections(const float* m, const Vector3* in, Vector3* out, size_t count);
+
+	// Translations, rotations (unit quaternions, x y z w) and scales of many transforms, each component
+	//	in its own array (as TransformStore keeps them)
+	struct TransformArrays {
+		const float* translation[3];
+		const float* rotation[4];
+		const float* scale[3];
+	};
+
+	// For each of count entries listed in indices: world = translation * rotation * scale into
+	//	world[index * 16], and its normal matrix (inverse transpose of the upper 3x3, as ObjectBuffer
+	//	derives it - the world matrix itself if the scale is singular) into normal[index * 16].
+	//	Batches four entries at a time, loading directly where their indices are consecutive.
+	void composeTransforms(const TransformArrays& transforms, const uint32_t* indices, size_t count,
+						   float* world, float* normal);
+
+	namespace Reference {
+		void multiply(const float* a, const float* b, float* out);	// (out may not alias a or b)
+		bool invert(const float* m, float* out);
+		void composeTRS(const Vector3& translation, const Vector3& rotationDegrees, const Vector3& scale, float* out);
+		void transformPoints(const float* m, const Vector3* in, Vector3* out, size_t count);
+		void transformDirections(const float* m, const Vector3* in, Vector3* out, size_t count);
+		void composeTransforms(const TransformArrays& transforms, const uint32_t* indices, size_t count,
+							   float* world, float* normal);
+	}
+}
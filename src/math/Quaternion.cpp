@@ -0,0 +1,167 @@
+#include "Quaternion.h"
+
+#if !defined(MATH_SCALAR_ONLY) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define QUATERNION_SSE
+	#include <immintrin.h>
+#elif !defined(MATH_SCALAR_ONLY) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+	#define QUATERNION_NEON
+	#include <arm_neon.h>
+#endif
+
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion must load as one 4-float vector");
+
+namespace {
+	const float PI = 3.14159265359f;
+
+	// a * weightA + b * weightB, normalized (unless it comes out zero)
+	Quaternion blend(const Quaternion& a, const Quaternion& b, float weightA, float weightB) {
+		Quaternion result;
+	#if defined(QUATERNION_SSE)
+		__m128 sum = _mm_add_ps(_mm_mul_ps(_mm_load_ps(&a.x), _mm_set1_ps(weightA)),
+								_mm_mul_ps(_mm_load_ps(&b.x), _mm_set1_ps(weightB)));
+		__m128 squares = _mm_mul_ps(sum, sum);
+		squares = _mm_add_ps(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(2, 3, 0, 1)));
+		squares = _mm_add_ps(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(1, 0, 3, 2)));
+		float lengthSquared = _mm_cvtss_f32(squares);
+		if (lengthSquared > 0.0f) {
+			sum = _mm_div_ps(sum, _mm_sqrt_ps(squares));
+		}
+		_mm_store_ps(&result.x, sum);
+	#elif defined(QUATERNION_NEON)
+		float32x4_t sum = vmlaq_n_f32(vmulq_n_f32(vld1q_f32(&a.x), weightA), vld1q_f32(&b.x), weightB);
+		float32x4_t squares = vmulq_f32(sum, sum);
+		float32x2_t pairs = vadd_f32(vget_low_f32(squares), vget_high_f32(squares));
+		float lengthSquared = vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+		if (lengthSquared > 0.0f) {
+			sum = vmulq_n_f32(sum, 1.0f / std::sqrt(lengthSquared));
+		}
+		vst1q_f32(&result.x, sum);
+	#else
+		result = Quaternion(a.x * weightA + b.x * weightB, a.y * weightA + b.y * weightB,
+							a.z * weightA + b.z * weightB, a.w * weightA + b.w * weightB);
+		float lengthSquared = result.dot(result);
+		if (lengthSquared > 0.0f) {
+			float inverseLength = 1.0f / std::sqrt(lengthSquared);
+			result = Quaternion(result.x * inverseLength, result.y * inverseLength,
+								result.z * inverseLength, result.w * inverseLength);
+		}
+	#endif
+		return result;
+	}
+}
+
+Quaternion Quaternion::fromEuler(const Vector3& degrees) {
+	// Rz * Ry * Rx as Matrix4::rotation multiplies them, each axis turning the opposite way to
+	//	a right-handed rotation by its angle (hence the negated half angles)
+	float halfX = -degrees.x * PI / 360.0f, halfY = -degrees.y * PI / 360.0f, halfZ = -degrees.z * PI / 360.0f;
+	float sx = std::sin(halfX), cx = std::cos(halfX);
+	float sy = std::sin(halfY), cy = std::cos(halfY);
+	float sz = std::sin(halfZ), cz = std::cos(halfZ);
+
+	return Quaternion(cz * cy * sx - sz * sy * cx,
+					  cz * sy * cx + sz * cy * sx,
+					  sz * cy * cx - cz * sy * sx,
+					  cz * cy * cx + sz * sy * sx);
+}
+
+Quaternion Quaternion::fromAxisAngle(const Vector3& axis, float degrees) {
+	// (turning the same way an Euler angle does about that axis)
+	float length = axis.length();
+	if (length <= 0.0f) {
+		return identity();
+	}
+	float half = -degrees * PI / 360.0f;
+	float s = std::sin(half) / length;
+	return Quaternion(axis.x * s, axis.y * s, axis.z * s, std::cos(half));
+}
+
+Vector3 Quaternion::toEuler() const {
+	// Elements of the rotation matrix, which for Rz * Ry * Rx has
+	//	m20 = sin y,  m21 = -cos y sin x,  m22 = cos y cos x
+	float m20 = 2.0f * (x * z - y * w);
+	float m21 = 2.0f * (y * z + x * w);
+	float m22 = 1.0f - 2.0f * (x * x + y * y);
+	float m01 = 2.0f * (x * y - z * w), m11 = 1.0f - 2.0f * (x * x + z * z);
+	float m02 = 2.0f * (x * z + y * w), m12 = 2.0f * (y * z - x * w);
+
+	// (y by atan2, not asin, which loses precision near +/-90 degrees)
+	float angleX = std::atan2(-m21, m22);
+	float angleY = std::atan2(m20, std::sqrt(m21 * m21 + m22 * m22));
+
+	// z from elements that stay well-conditioned given x: cos x m01 + sin x m02 = sin z, and
+	//	cos x m11 + sin x m12 = cos z. So approaching gimbal lock, where x becomes uncertain, z makes up
+	//	for it (and at lock, where only x + z or x - z matters, x comes out 0).
+	float sinX = std::sin(angleX), cosX = std::cos(angleX);
+	float angleZ = std::atan2(cosX * m01 + sinX * m02, cosX * m11 + sinX * m12);
+
+	return Vector3(angleX * 180.0f / PI, angleY * 180.0f / PI, angleZ * 180.0f / PI);
+}
+
+Quaternion Quaternion::operator*(const Quaternion& other) const {
+	// Hamilton product: w * b + x * (bw, -bz, by, -bx) + y * (bz, bw, -bx, -by) + z * (-by, bx, bw, -bz)
+	Quaternion result;
+#if defined(QUATERNION_SSE)
+	__m128 b = _mm_load_ps(&other.x);
+	const __m128 signsX = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+	const __m128 signsY = _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f);
+	const __m128 signsZ = _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f);
+
+	__m128 sum = _mm_mul_ps(_mm_set1_ps(w), b);
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(x), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)), signsX)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(y), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)), signsY)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(z), _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), signsZ)));
+	_mm_store_ps(&result.x, sum);
+#elif defined(QUATERNION_NEON)
+	static const float signsX[4] = { 1.0f, -1.0f, 1.0f, -1.0f };
+	static const float signsY[4] = { 1.0f, 1.0f, -1.0f, -1.0f };
+	static const float signsZ[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+	float32x4_t b = vld1q_f32(&other.x);
+	float32x4_t zwxy = vextq_f32(b, b, 2);
+	float32x4_t wzyx = vrev64q_f32(zwxy);
+	float32x4_t yxwz = vrev64q_f32(b);
+
+	float32x4_t sum = vmulq_n_f32(b, w);
+	sum = vmlaq_n_f32(sum, vmulq_f32(wzyx, vld1q_f32(signsX)), x);
+	sum = vmlaq_n_f32(sum, vmulq_f32(zwxy, vld1q_f32(signsY)), y);
+	sum = vmlaq_n_f32(sum, vmulq_f32(yxwz, vld1q_f32(signsZ)), z);
+	vst1q_f32(&result.x, sum);
+#else
+	result.x = w * other.x + x * other.w + y * other.z - z * other.y;
+	result.y = w * other.y - x * other.z + y * other.w + z * other.x;
+	result.z = w * other.z + x * other.y - y * other.x + z * other.w;
+	result.w = w * other.w - x * other.x - y * other.y - z * other.z;
+#endif
+	return result;
+}
+
+Quaternion Quaternion::normalized() const {
+	return blend(*this, *this, 1.0f, 0.0f);
+}
+
+Vector3 Quaternion::rotate(const Vector3& vector) const {
+	// v + w t + q x t, where t = 2 (q x v)
+	Vector3 axis(x, y, z);
+	Vector3 t = axis.cross(vector) * 2.0f;
+	return vector + t * w + axis.cross(t);
+}
+
+Quaternion Quaternion::nlerp(const Quaternion& a, const Quaternion& b, float t) {
+	// (q and -q are the same rotation: blend toward whichever is nearer)
+	float sign = a.dot(b) < 0.0f ? -1.0f : 1.0f;
+	return blend(a, b, 1.0f - t, t * sign);
+}
+
+Quaternion Quaternion::slerp(const Quaternion& a, const Quaternion& b, float t) {
+	float cosTheta = a.dot(b);
+	float sign = 1.0f;
+	if (cosTheta < 0.0f) {
+		cosTheta = -cosTheta;
+		sign = -1.0f;
+	}
+	if (cosTheta > 0.9995f) {
+		return blend(a, b, 1.0f - t, t * sign);		// (nearly parallel: sin(theta) too small to divide by)
+	}
+	float theta = std::acos(cosTheta);
+	float inverseSinTheta = 1.0f / std::sin(theta);
+	return blend(a, b, std::sin((1.0f - t) * theta) * inverseSinTheta, std::sin(t * theta) * inverseSinTheta * sign);
+}
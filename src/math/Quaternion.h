@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Vector3.h"
+#include <cmath>
+
+// Rotation as a unit quaternion. Laid out x, y, z, w in one aligned 16 bytes, so composing and
+//	interpolating work on all four components at once (SSE or NEON, as chosen for MatrixKernels).
+// Euler angles (in degrees) convert both ways with the convention Matrix4::rotation uses, as scene
+//	files and the UI still deal in them.
+class alignas(16) Quaternion {
+public:
+	float x, y, z, w;
+
+	Quaternion() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+	Quaternion(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+	static Quaternion identity() { return Quaternion(); }
+	static Quaternion fromEuler(const Vector3& degrees);
+	static Quaternion fromAxisAngle(const Vector3& axis, float degrees);
+
+	// Euler angles giving the same rotation (not necessarily the ones it was made from: any that match)
+	Vector3 toEuler() const;
+
+	// Composition: (a * b) rotates by b, then by a
+	Quaternion operator*(const Quaternion& other) const;
+	Quaternion& operator*=(const Quaternion& other) { *this = *this * other; return *this; }
+
+	Quaternion conjugate() const { return Quaternion(-x, -y, -z, w); }	// (the inverse, if unit length)
+	float dot(const Quaternion& other) const { return x * other.x + y * other.y + z * other.z + w * other.w; }
+	float length() const { return std::sqrt(dot(*this)); }
+	Quaternion normalized() const;
+	void normalize() { *this = normalized(); }
+
+	Vector3 rotate(const Vector3& vector) const;
+
+	// Interpolation, along the shorter arc: nlerp is cheaper (a normalized straight-line blend), and
+	//	close to slerp for small angles; slerp keeps constant angular speed.
+	static Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t);
+	static Quaternion slerp(const Quaternion& a, const Quaternion& b, float t);
+};
@@ -23,14 +23,24 @@ void Transform::translate(const Vector3& translation) {
 
 void Transform::setRotation(const Vector3& rotation) {
 	this->rotation = rotation;
+	orientation = Quaternion::fromEuler(rotation);
 	matrixDirty = true;
 }
 
 void Transform::rotate(const Vector3& rotation) {
-	this->rotation += rotation;
+	setRotation(this->rotation + rotation);
+}
+
+void Transform::setRotation(const Quaternion& orientation) {
+	this->orientation = orientation.normalized();
+	rotation = this->orientation.toEuler();
 	matrixDirty = true;
 }
 
+void Transform::rotate(const Quaternion& rotation) {
+	setRotation(rotation * orientation);
+}
+
 void Transform::setScale(const Vector3& scale) {
 	this->scale = scale;
 	matrixDirty = true;
@@ -55,27 +65,22 @@ Vector3 Transform::transformPoint(const Vector3& point) const {
 
 Vector3 Transform::transformDirection(const Vector3& direction) const {
 	// For directions, we don't want translation
-	Matrix4 rotScale = Matrix4::rotation(rotation) * Matrix4::scale(scale);
-	return rotScale * direction;
+	return getMatrix().transformDirection(direction);
 }
 
 Vector3 Transform::transformNormal(const Vector3& normal) const {
 	// For normals, we need the inverse transpose, but simplified here
-	Matrix4 rot = Matrix4::rotation(rotation);
-	return rot * normal;
+	return orientation.rotate(normal);
 }
 
 void Transform::reset() {
 	position = Vector3::zero();
 	rotation = Vector3::zero();
+	orientation = Quaternion::identity();
 	scale = Vector3::one();
 	matrixDirty = true;
 }
 
 void Transform::updateMatrix() const {
-	Matrix4 translation = Matrix4::translation(position);
-	Matrix4 rotationMatrix = Matrix4::rotation(rotation);
-	Matrix4 scaleMatrix = Matrix4::scale(scale);
-
-	matrix = translation * rotationMatrix * scaleMatrix;
+	matrix = Matrix4::trs(position, orientation, scale);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Vector3.h"
 #include "Matrix4.h"
+#include "Quaternion.h"
 
 class Transform {
 public:
@@ -13,11 +14,15 @@ public:
 	Vector3 getPosition() const { return position; }
 	void translate(const Vector3& translation);
 
-	// Rotation (Euler angles in degrees)
+	// Rotation (Euler angles in degrees, kept alongside the quaternion the matrix is built from)
 	void setRotation(const Vector3& rotation);
 	Vector3 getRotation() const { return rotation; }
 	void rotate(const Vector3& rotation);
 
+	void setRotation(const Quaternion& orientation);
+	Quaternion getOrientation() const { return orientation; }
+	void rotate(const Quaternion& rotation);	// (applied after the current rotation)
+
 	// Scale
 	void setScale(const Vector3& scale);
 	void setScale(float uniformScale);
@@ -37,6 +42,7 @@ public:
 private:
 	Vector3 position;
 	Vector3 rotation;
+	Quaternion orientation;
 	Vector3 scale;
 
 	mutable Matrix4 matrix;
@@ -0,0 +1,244 @@
+#include "TransformStore.h"
+#include "MatrixKernels.h"
+#include "Quaternion.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+const uint32_t TransformHandle::INVALID;
+const size_t TransformStore::MIN_ENTRIES_PER_WORKER;
+
+static_assert(sizeof(Matrix4) == 16 * sizeof(float), "Matrix4 arrays must be contiguous floats for the kernels");
+
+TransformStore::TransformStore()
+	: workerCount(std::max(1u, std::thread::hardware_concurrency())) {
+}
+
+TransformStore& TransformStore::shared() {
+	static TransformStore store;
+	return store;
+}
+
+TransformHandle TransformStore::create(const Vector3& position, const Vector3& rotation, const Vector3& scale) {
+	uint32_t slot;
+	if (!freeSlots.empty()) {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	} else {
+		slot = static_cast<uint32_t>(slots.size());
+		slots.push_back(Slot{ 0, 0 });
+	}
+
+	uint32_t entry = static_cast<uint32_t>(owners.size());
+	slots[slot].entry = entry;
+	owners.push_back(slot);
+
+	translationX.push_back(position.x);
+	translationY.push_back(position.y);
+	translationZ.push_back(position.z);
+	rotationX.push_back(0.0f);
+	rotationY.push_back(0.0f);
+	rotationZ.push_back(0.0f);
+	rotationW.push_back(1.0f);
+	scaleX.push_back(scale.x);
+	scaleY.push_back(scale.y);
+	scaleZ.push_back(scale.z);
+	eulerRotations.push_back(Vector3(0.0f, 0.0f, 0.0f));
+	worldMatrices.push_back(Matrix4());
+	normalMatrices.push_back(Matrix4());
+	dirty.push_back(0);
+
+	TransformHandle handle{ slot, slots[slot].generation };
+	setRotation(handle, rotation);		// (which marks the new entry dirty)
+	return handle;
+}
+
+void TransformStore::destroy(TransformHandle handle) {
+	if (!isAlive(handle)) {
+		return;
+	}
+	uint32_t entry = slots[handle.slot].entry;
+	uint32_t last = static_cast<uint32_t>(owners.size() - 1);
+
+	// Move the last entry into the hole, keeping the arrays dense
+	if (entry != last) {
+		translationX[entry] = translationX[last];
+		translationY[entry] = translationY[last];
+		translationZ[entry] = translationZ[last];
+		rotationX[entry] = rotationX[last];
+		rotationY[entry] = rotationY[last];
+		rotationZ[entry] = rotationZ[last];
+		rotationW[entry] = rotationW[last];
+		scaleX[entry] = scaleX[last];
+		scaleY[entry] = scaleY[last];
+		scaleZ[entry] = scaleZ[last];
+		eulerRotations[entry] = eulerRotations[last];
+		worldMatrices[entry] = worldMatrices[last];
+		normalMatrices[entry] = normalMatrices[last];
+		dirty[entry] = dirty[last];
+		owners[entry] = owners[last];
+		slots[owners[entry]].entry = entry;
+		if (dirty[entry]) {
+			dirtyList.push_back(entry);		// (update() skips the listing of its old place, and any duplicate)
+		}
+	}
+
+	translationX.pop_back();
+	translationY.pop_back();
+	translationZ.pop_back();
+	rotationX.pop_back();
+	rotationY.pop_back();
+	rotationZ.pop_back();
+	rotationW.pop_back();
+	scaleX.pop_back();
+	scaleY.pop_back();
+	scaleZ.pop_back();
+	eulerRotations.pop_back();
+	worldMatrices.pop_back();
+	normalMatrices.pop_back();
+	dirty.pop_back();
+	owners.pop_back();
+
+	++slots[handle.slot].generation;
+	freeSlots.push_back(handle.slot);
+}
+
+bool TransformStore::isAlive(TransformHandle handle) const {
+	return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation
+		&& slots[handle.slot].entry < owners.size() && owners[slots[handle.slot].entry] == handle.slot;
+}
+
+uint32_t TransformStore::entryOf(TransformHandle handle) const {
+	if (!isAlive(handle)) {
+		throw std::runtime_error("Stale or invalid transform handle");
+	}
+	return slots[handle.slot].entry;
+}
+
+void TransformStore::markDirty(uint32_t entry) {
+	if (!dirty[entry]) {
+		dirty[entry] = 1;
+		dirtyList.push_back(entry);
+	}
+}
+
+void TransformStore::setPosition(TransformHandle handle, const Vector3& position) {
+	uint32_t entry = entryOf(handle);
+	translationX[entry] = position.x;
+	translationY[entry] = position.y;
+	translationZ[entry] = position.z;
+	markDirty(entry);
+}
+
+void TransformStore::setRotation(TransformHandle handle, const Vector3& rotation) {
+	uint32_t entry = entryOf(handle);
+	Quaternion quaternion = Quaternion::fromEuler(rotation);
+	rotationX[entry] = quaternion.x;
+	rotationY[entry] = quaternion.y;
+	rotationZ[entry] = quaternion.z;
+	rotationW[entry] = quaternion.w;
+	eulerRotations[entry] = rotation;
+	markDirty(entry);
+}
+
+void TransformStore::setRotation(TransformHandle handle, const Quaternion& rotation) {
+	uint32_t entry = entryOf(handle);
+	Quaternion quaternion = rotation.normalized();
+	rotationX[entry] = quaternion.x;
+	rotationY[entry] = quaternion.y;
+	rotationZ[entry] = quaternion.z;
+	rotationW[entry] = quaternion.w;
+	eulerRotations[entry] = quaternion.toEuler();
+	markDirty(entry);
+}
+
+void TransformStore::setScale(TransformHandle handle, const Vector3& scale) {
+	uint32_t entry = entryOf(handle);
+	scaleX[entry] = scale.x;
+	scaleY[entry] = scale.y;
+	scaleZ[entry] = scale.z;
+	markDirty(entry);
+}
+
+Vector3 TransformStore::getPosition(TransformHandle handle) const {
+	uint32_t entry = entryOf(handle);
+	return Vector3(translationX[entry], translationY[entry], translationZ[entry]);
+}
+
+Vector3 TransformStore::getRotation(TransformHandle handle) const {
+	return eulerRotations[entryOf(handle)];
+}
+
+Quaternion TransformStore::getOrientation(TransformHandle handle) const {
+	uint32_t entry = entryOf(handle);
+	return Quaternion(rotationX[entry], rotationY[entry], rotationZ[entry], rotationW[entry]);
+}
+
+Vector3 TransformStore::getScale(TransformHandle handle) const {
+	uint32_t entry = entryOf(handle);
+	return Vector3(scaleX[entry], scaleY[entry], scaleZ[entry]);
+}
+
+size_t TransformStore::update() {
+	// Gather the entries still dirty (dropping ones since removed, and duplicates)
+	composeList.clear();
+	for (uint32_t entry : dirtyList) {
+		if (entry < dirty.size() && dirty[entry]) {
+			dirty[entry] = 0;
+			composeList.push_back(entry);
+		}
+	}
+	dirtyList.clear();
+
+	size_t count = composeList.size();
+	size_t workers = std::min<size_t>(workerCount, count / MIN_ENTRIES_PER_WORKER);
+	if (workers <= 1) {
+		composeEntries(composeList.data(), count);
+		return count;
+	}
+
+	// Equal chunks (in whole batches of four) to other threads, the remainder to this one
+	size_t chunk = (count / workers + 3) & ~static_cast<size_t>(3);
+	std::vector<std::thread> threads;
+	threads.reserve(workers - 1);
+	for (size_t worker = 0; worker + 1 < workers; ++worker) {
+		threads.emplace_back([this, worker, chunk]() {
+			composeEntries(composeList.data() + worker * chunk, chunk);
+		});
+	}
+	size_t first = (workers - 1) * chunk;
+	composeEntries(composeList.data() + first, count - first);
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	return count;
+}
+
+void TransformStore::composeEntries(const uint32_t* entries, size_t count) {
+	if (count == 0) {
+		return;
+	}
+	MatrixKernels::TransformArrays arrays = {
+		{ translationX.data(), translationY.data(), translationZ.data() },
+		{ rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data() },
+		{ scaleX.data(), scaleY.data(), scaleZ.data() }
+	};
+	MatrixKernels::composeTransforms(arrays, entries, count, worldMatrices.data()->data(), normalMatrices.data()->data());
+}
+
+const Matrix4& TransformStore::getWorldMatrix(TransformHandle handle) {
+	uint32_t entry = entryOf(handle);
+	if (dirty[entry]) {
+		composeEntries(&entry, 1);
+	}
+	return worldMatrices[entry];
+}
+
+const Matrix4& TransformStore::getNormalMatrix(TransformHandle handle) {
+	uint32_t entry = entryOf(handle);
+	if (dirty[entry]) {
+		composeEntries(&entry, 1);
+	}
+	return normalMatrices[entry];
+}
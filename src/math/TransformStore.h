@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Vector3.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Stable reference to a TransformStore entry. Stays valid as other entries come and go;
+//	once its own entry is destroyed, the slot's generation moves on and the handle goes stale.
+struct TransformHandle {
+	uint32_t slot = INVALID;
+	uint32_t generation = 0;
+
+	bool isValid() const { return slot != INVALID; }
+
+	static const uint32_t INVALID = 0xFFFFFFFF;
+};
+
+// TransformStore keeps the transforms of every object together, data-oriented: translation, rotation
+//	(a unit quaternion) and scale each in contiguous per-component arrays, packed densely (removing an
+//	entry moves the last one into its place), with the composed world and normal matrices alongside.
+// Setting a transform only marks its entry dirty; update() then composes all dirty entries in one
+//	batch, four at a time with the SIMD kernel (see MatrixKernels::composeTransforms), splitting large
+//	batches into chunks across threads. Objects (Model, SceneObject) hold a handle and read and write
+//	through it, rather than each keeping a transform and composing its own matrix.
+class TransformStore {
+public:
+	TransformStore();
+
+	// The store that Models and SceneObjects live in
+	static TransformStore& shared();
+
+	TransformHandle create(const Vector3& position = Vector3(0.0f, 0.0f, 0.0f),
+						   const Vector3& rotation = Vector3(0.0f, 0.0f, 0.0f),
+						   const Vector3& scale = Vector3(1.0f, 1.0f, 1.0f));
+	void destroy(TransformHandle handle);
+	bool isAlive(TransformHandle handle) const;
+
+	void setPosition(TransformHandle handle, const Vector3& position);
+	void setRotation(TransformHandle handle, const Vector3& rotation);		// Euler angles in degrees
+	void setRotation(TransformHandle handle, const Quaternion& rotation);	// (normalized on the way in)
+	void setScale(TransformHandle handle, const Vector3& scale);
+
+	Vector3 getPosition(TransformHandle handle) const;
+	Vector3 getRotation(TransformHandle handle) const;		// (Euler angles as last set, or equivalent to the quaternion)
+	Quaternion getOrientation(TransformHandle handle) const;
+	Vector3 getScale(TransformHandle handle) const;
+
+	// Compose the world and normal matrices of every dirty entry. Returns how many there were.
+	size_t update();
+
+	// Entries the last update() composed - those changed since the one before (valid until one is destroyed)
+	const std::vector<uint32_t>& getUpdatedEntries() const { return composeList; }
+	TransformHandle handleOf(uint32_t entry) const { return TransformHandle{ owners[entry], slots[owners[entry]].generation }; }
+
+	// An entry's matrices, composing just that one first if it's dirty (update() does many at once far faster,
+	//	and still counts the entry as updated)
+	const Matrix4& getWorldMatrix(TransformHandle handle);
+	const Matrix4& getNormalMatrix(TransformHandle handle);
+
+	size_t size() const { return owners.size(); }
+	// (at most: entries removed stay listed until the next update)
+	size_t getDirtyCount() const { return dirtyList.size(); }
+
+	// Threads update() may split a batch across (1: compose on the calling thread only)
+	void setWorkerCount(unsigned count) { workerCount = count > 0 ? count : 1; }
+	unsigned getWorkerCount() const { return workerCount; }
+
+	// Batches smaller than this per thread aren't worth starting threads for
+	static const size_t MIN_ENTRIES_PER_WORKER = 16384;
+
+private:
+	struct Slot {
+		uint32_t entry;			// (index into the dense arrays, while alive)
+		uint32_t generation;
+	};
+
+	uint32_t entryOf(TransformHandle handle) const;
+	void markDirty(uint32_t entry);
+	void composeEntries(const uint32_t* entries, size_t count);
+
+	// Translation, rotation quaternion and scale, component by component
+	std::vector<float> translationX, translationY, translationZ;
+	std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+	std::vector<float> scaleX, scaleY, scaleZ;
+	std::vector<Vector3> eulerRotations;		// (as set, for editing and serializing)
+
+	std::vector<Matrix4> worldMatrices;
+	std::vector<Matrix4> normalMatrices;
+
+	std::vector<uint8_t> dirty;				// (a flag per entry, so each is listed once)
+	std::vector<uint32_t> dirtyList;
+	std::vector<uint32_t> composeList;		// (reused by each update)
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> owners;			// (slot of each entry)
+	std::vector<uint32_t> freeSlots;
+
+	unsigned workerCount;
+};
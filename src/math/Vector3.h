@@ -9,25 +9,36 @@ public:
 	Vector3() : x(0.0f), y(0.0f), z(0.0f) {}
 	Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
 
-	// Basic operations
-	Vector3 operator+(const Vector3& other) const;
-	Vector3 operator-(const Vector3& other) const;
-	Vector3 operator*(float scalar) const;
-	Vector3 operator/(float scalar) const;
-
-	Vector3& operator+=(const Vector3& other);
-	Vector3& operator-=(const Vector3& other);
-	Vector3& operator*=(float scalar);
-	Vector3& operator/=(float scalar);
-
-	bool operator==(const Vector3& other) const;
-	bool operator!=(const Vector3& other) const;
+	// Basic operations (inline, as they're in every hot loop)
+	Vector3 operator+(const Vector3& other) const { return Vector3(x + other.x, y + other.y, z + other.z); }
+	Vector3 operator-(const Vector3& other) const { return Vector3(x - other.x, y - other.y, z - other.z); }
+	Vector3 operator*(float scalar) const { return Vector3(x * scalar, y * scalar, z * scalar); }
+	Vector3 operator/(float scalar) const { return Vector3(x / scalar, y / scalar, z / scalar); }
+
+	Vector3& operator+=(const Vector3& other) { x += other.x; y += other.y; z += other.z; return *this; }
+	Vector3& operator-=(const Vector3& other) { x -= other.x; y -= other.y; z -= other.z; return *this; }
+	Vector3& operator*=(float scalar) { x *= scalar; y *= scalar; z *= scalar; return *this; }
+	Vector3& operator/=(float scalar) { x /= scalar; y /= scalar; z /= scalar; return *this; }
+
+	bool operator==(const Vector3& other) const {
+		const float epsilon = 1e-6f;
+		return std::abs(x - other.x) < epsilon &&
+			   std::abs(y - other.y) < epsilon &&
+			   std::abs(z - other.z) < epsilon;
+	}
+	bool operator!=(const Vector3& other) const { return !(*this == other); }
 
 	// Vector operations
-	float dot(const Vector3& other) const;
-	Vector3 cross(const Vector3& other) const;
-	float length() const;
-	float lengthSquared() const;
+	float dot(const Vector3& other) const { return x * other.x + y * other.y + z * other.z; }
+	Vector3 cross(const Vector3& other) const {
+		return Vector3(
+			y * other.z - z * other.y,
+			z * other.x - x * other.z,
+			x * other.y - y * other.x
+		);
+	}
+	float length() const { return std::sqrt(x * x + y * y + z * z); }
+	float lengthSquared() const { return x * x + y * y + z * z; }
 	Vector3 normalized() const;
 	void normalize();
 
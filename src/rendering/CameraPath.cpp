@@ -0,0 +1,129 @@
+#include "CameraPath.h"
+#include "Camera.h"
+#include "../utils/logger/Logging.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+namespace {
+	json vectorToJson(const Vector3& vector) {
+		return json::object({ {"x", vector.x}, {"y", vector.y}, {"z", vector.z} });
+	}
+
+	Vector3 vectorFromJson(const json& jsonData) {
+		return Vector3(jsonData["x"].get<float>(), jsonData["y"].get<float>(), jsonData["z"].get<float>());
+	}
+}
+
+void CameraPath::record(float time, const Camera& camera, float animationTime) {
+	if (!keyframes.empty() && time <= keyframes.back().time) {
+		return;		// (time must increase, for sample() to search it)
+	}
+	keyframes.push_back({ time, camera.getPosition(), camera.getTarget(), animationTime });
+}
+
+uint32_t CameraPath::getFrameCount(float timestep) const {
+	if (keyframes.empty() || timestep <= 0.0f) {
+		return 0;
+	}
+	return static_cast<uint32_t>(std::floor(getDuration() / timestep)) + 1;
+}
+
+CameraPath::Keyframe CameraPath::sample(float time) const {
+	if (keyframes.empty()) {
+		return { time, Vector3(), Vector3(0.0f, 0.0f, -1.0f), 0.0f };
+	}
+	auto after = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+		[](float t, const Keyframe& keyframe) { return t < keyframe.time; });
+	if (after == keyframes.begin()) {
+		return keyframes.front();
+	}
+	if (after == keyframes.end()) {
+		return keyframes.back();
+	}
+	const Keyframe& before = *(after - 1);
+	float t = (time - before.time) / (after->time - before.time);
+	return { time,
+			 Vector3::lerp(before.position, after->position, t),
+			 Vector3::lerp(before.target, after->target, t),
+			 before.animationTime + (after->animationTime - before.animationTime) * t };
+}
+
+void CameraPath::apply(const Keyframe& pose, Camera& camera) const {
+	camera.setPosition(pose.position);
+	camera.setTarget(pose.target);
+}
+
+json CameraPath::serialize() const {
+	json jsonData;
+	jsonData["scene"] = scenePath;
+
+	json keyframeArray = json::array();
+	for (const Keyframe& keyframe : keyframes) {
+		keyframeArray.push_back(json::object({
+			{"time", keyframe.time},
+			{"position", vectorToJson(keyframe.position)},
+			{"target", vectorToJson(keyframe.target)},
+			{"animationTime", keyframe.animationTime}
+		}));
+	}
+	jsonData["keyframes"] = keyframeArray;
+	return jsonData;
+}
+
+bool CameraPath::deserialize(const json& jsonData) {
+	if (!jsonData.contains("keyframes") || !jsonData["keyframes"].is_array()) {
+		Log(ERROR, "CameraPath: no keyframes array");
+		return false;
+	}
+	keyframes.clear();
+	scenePath = jsonData.contains("scene") ? jsonData["scene"].get<std::string>() : "";
+
+	const json& keyframeArray = jsonData["keyframes"];
+	for (size_t i = 0; i < keyframeArray.size(); ++i) {
+		const json& keyframe = keyframeArray[i];
+		if (!keyframe.contains("time") || !keyframe.contains("position") || !keyframe.contains("target")) {
+			Log(ERROR, "CameraPath: keyframe %zu is incomplete", i);
+			return false;
+		}
+		Keyframe loaded{ keyframe["time"].get<float>(), vectorFromJson(keyframe["position"]),
+						 vectorFromJson(keyframe["target"]),
+						 keyframe.contains("animationTime") ? keyframe["animationTime"].get<float>() : 0.0f };
+		if (!keyframes.empty() && loaded.time <= keyframes.back().time) {
+			continue;	// (as record() would have)
+		}
+		keyframes.push_back(loaded);
+	}
+	return true;
+}
+
+bool CameraPath::saveToFile(const std::string& filename) const {
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		Log(ERROR, "CameraPath: Failed to open file for writing: %s", filename.c_str());
+		return false;
+	}
+	file << serialize().dump(1);
+	Log(NOTE, "Camera path saved to: %s (%zu keyframes, %.1f s)", filename.c_str(), keyframes.size(), getDuration());
+	return true;
+}
+
+bool CameraPath::loadFromFile(const std::string& filename) {
+	std::ifstream file(filename);
+	if (!file.is_open()) {
+		Log(ERROR, "CameraPath: Failed to open file for reading: %s", filename.c_str());
+		return false;
+	}
+	try {
+		std::string fileContent((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (!deserialize(json::parse(fileContent))) {
+			return false;
+		}
+	} catch (const std::exception& e) {
+		Log(ERROR, "CameraPath: Failed to load %s: %s", filename.c_str(), e.what());
+		return false;
+	}
+	Log(NOTE, "Camera path loaded from: %s (%zu keyframes, %.1f s)", filename.c_str(), keyframes.size(), getDuration());
+	return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "math/Vector3.h"
+#include "utils/JsonSupport.h"
+#include <string>
+#include <vector>
+
+class Camera;
+
+// CameraPath is a camera's pose over time, and the animation clock along with it, as recorded from an
+//	interactive session (at whatever frame rate it ran). Sampling interpolates between keyframes, so it
+//	replays the same at any timestep - a fixed one makes a replay deterministic, to compare runs by.
+class CameraPath {
+public:
+	struct Keyframe {
+		float time;				// (seconds since recording began)
+		Vector3 position;
+		Vector3 target;
+		float animationTime;	// (the animation clock, which stops while animation is paused)
+	};
+
+	void clear() { keyframes.clear(); }
+	void record(float time, const Camera& camera, float animationTime);
+
+	bool isEmpty() const { return keyframes.empty(); }
+	size_t getKeyframeCount() const { return keyframes.size(); }
+	float getDuration() const { return keyframes.empty() ? 0.0f : keyframes.back().time; }
+	uint32_t getFrameCount(float timestep) const;	// (to replay the whole path, both ends included)
+
+	// The pose at 'time' (clamped to the path), interpolated linearly from the keyframes either side
+	Keyframe sample(float time) const;
+	void apply(const Keyframe& pose, Camera& camera) const;
+
+	// { "scene": path, "keyframes": [ { "time", "position", "target", "animationTime" }, ... ] }
+	json serialize() const;
+	bool deserialize(const json& jsonData);
+	bool saveToFile(const std::string& filename) const;
+	bool loadFromFile(const std::string& filename);
+
+	// The scene it was recorded in (replaying in another still works, but compares nothing)
+	void setScenePath(const std::string& path) { scenePath = path; }
+	const std::string& getScenePath() const { return scenePath; }
+
+private:
+	std::vector<Keyframe> keyframes;
+	std::string scenePath;
+};
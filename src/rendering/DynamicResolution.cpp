@@ -0,0 +1,45 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution(double targetMs, float minScale, float maxScale)
+	: targetMs(targetMs)
+	, minScale(minScale)
+	, maxScale(maxScale)
+	, scale(maxScale)
+	, frames(0)
+	, scaleSum(0.0)
+	, lowestScale(maxScale)
+	, changes(0)
+{
+}
+
+void DynamicResolution::setScaleRange(float minScale, float maxScale) {
+	this->minScale = std::min(minScale, maxScale);
+	this->maxScale = std::max(minScale, maxScale);
+	scale = std::clamp(scale, this->minScale, this->maxScale);
+}
+
+float DynamicResolution::update(double gpuMs, float renderedScale) {
+	if (gpuMs <= 0.0 || targetMs <= 0.0) {
+		return scale;
+	}
+	float suggested = renderedScale * static_cast<float>(std::sqrt(targetMs / gpuMs));
+	suggested = std::clamp(suggested, minScale, maxScale);
+	// (over budget, always shrink; but only grow for a worthwhile gain, and settle on a limit rather than
+	//	creeping toward it)
+	float difference = suggested - scale;
+	if (difference == 0.0f || (difference > 0.0f && difference < DEAD_BAND && suggested != maxScale)) {
+		return scale;
+	}
+	scale = (std::fabs(difference) < DEAD_BAND && (suggested == minScale || suggested == maxScale))
+		  ? suggested : scale + DAMPING * difference;
+	++changes;
+	return scale;
+}
+
+void DynamicResolution::recordFrame(float renderedScale) {
+	++frames;
+	scaleSum += renderedScale;
+	lowestScale = std::min(lowestScale, renderedScale);
+}
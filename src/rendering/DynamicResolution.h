@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+// DynamicResolution chooses the scale to render at (of the output's width and height) from measured GPU
+//	frame time, to hold it at a target: losing sharpness when a scene is too heavy, rather than frames.
+//	GPU time is taken to follow the pixel count - the scale squared - so each measurement suggests the
+//	scale that would have just met the target; the scale moves only part of the way there each frame
+//	(damping, since measurements are noisy and a few frames old), growing only when the gain is beyond a
+//	small dead band, and always within its min and max.
+class DynamicResolution {
+public:
+	DynamicResolution(double targetMs = 16.0, float minScale = 0.5f, float maxScale = 1.0f);
+
+	void setTargetMs(double ms) { targetMs = ms; }
+	double getTargetMs() const { return targetMs; }
+	void setScaleRange(float minScale, float maxScale);
+
+	// One frame's GPU time, and the scale it was rendered at; returns the scale to render at next
+	float update(double gpuMs, float renderedScale);
+	float getScale() const { return scale; }
+
+	// What it has chosen so far (over every frame rendered, not only those measured)
+	void recordFrame(float renderedScale);
+	uint64_t getFrameCount() const { return frames; }
+	float getAverageScale() const { return frames > 0 ? static_cast<float>(scaleSum / frames) : scale; }
+	float getLowestScale() const { return lowestScale; }
+	uint32_t getChangeCount() const { return changes; }
+
+	static constexpr float DAMPING = 0.2f;			// (of the way to the suggested scale, per measurement)
+	static constexpr float DEAD_BAND = 0.02f;
+
+private:
+	double targetMs;
+	float minScale;
+	float maxScale;
+	float scale;
+
+	uint64_t frames;
+	double scaleSum;
+	float lowestScale;
+	uint32_t changes;
+};
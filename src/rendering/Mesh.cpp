@@ -2,6 +2,8 @@
 #include "../vulkan/VulkanDevice.h"
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
+#include <cmath>
 
 VkVertexInputBindingDescription Vertex::getBindingDescription() {
 	VkVertexInputBindingDescription bindingDescription{};
@@ -50,6 +52,9 @@ Mesh::Mesh()
 	, device(nullptr)
 	, buffersCreated(false)
 	, hasTexture(false)
+	, metricsValid(false)
+	, boundingRadius(0.0f)
+	, uvDensity(0.0f)
 {
 }
 
@@ -68,10 +73,46 @@ Mesh::~Mesh() {
 
 void Mesh::setVertices(const std::vector<Vertex>& vertices) {
 	this->vertices = vertices;
+	metricsValid = false;
 }
 
 void Mesh::setIndices(const std::vector<uint32_t>& indices) {
 	this->indices = indices;
+	metricsValid = false;
+}
+
+float Mesh::getBoundingRadius() const {
+	if (!metricsValid)
+		computeMetrics();
+	return boundingRadius;
+}
+
+float Mesh::getUVDensity() const {
+	if (!metricsValid)
+		computeMetrics();
+	return uvDensity;
+}
+
+void Mesh::computeMetrics() const {
+	float radiusSquared = 0.0f;
+	for (const Vertex& vertex : vertices) {
+		radiusSquared = std::max(radiusSquared, vertex.position.lengthSquared());
+	}
+	boundingRadius = std::sqrt(radiusSquared);
+
+	double surfaceArea = 0.0;
+	double uvArea = 0.0;
+	size_t count = hasIndices() ? indices.size() : vertices.size();
+	for (size_t i = 0; i + 2 < count; i += 3) {
+		const Vertex& a = vertices[hasIndices() ? indices[i] : i];
+		const Vertex& b = vertices[hasIndices() ? indices[i + 1] : i + 1];
+		const Vertex& c = vertices[hasIndices() ? indices[i + 2] : i + 2];
+		surfaceArea += 0.5 * (b.position - a.position).cross(c.position - a.position).length();
+		uvArea += 0.5 * std::fabs((b.texCoord.x - a.texCoord.x) * (c.texCoord.y - a.texCoord.y)
+								- (c.texCoord.x - a.texCoord.x) * (b.texCoord.y - a.texCoord.y));
+	}
+	uvDensity = surfaceArea > 0.0 ? static_cast<float>(std::sqrt(uvArea / surfaceArea)) : 0.0f;
+	metricsValid = true;
 }
 
 void Mesh::createBuffers(VulkanDevice& device) {
@@ -100,11 +141,11 @@ void Mesh::bind(VkCommandBuffer commandBuffer) {
 	}
 }
 
-void Mesh::draw(VkCommandBuffer commandBuffer) {
+void Mesh::draw(VkCommandBuffer commandBuffer, uint32_t firstInstance) {
 	if (hasIndices()) {
-		vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+		vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, firstInstance);
 	} else {
-		vkCmdDraw(commandBuffer, static_cast<uint32_t>(vertices.size()), 1, 0, 0);
+		vkCmdDraw(commandBuffer, static_cast<uint32_t>(vertices.size()), 1, 0, firstInstance);
 	}
 }
 
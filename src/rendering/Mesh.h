@@ -42,7 +42,7 @@ public:
 
 	void createBuffers(VulkanDevice& device);
 	void bind(VkCommandBuffer commandBuffer);
-	void draw(VkCommandBuffer commandBuffer);
+	void draw(VkCommandBuffer commandBuffer, uint32_t firstInstance = 0);
 
 	const std::vector<Vertex>& getVertices() const { return vertices; }
 	const std::vector<uint32_t>& getIndices() const { return indices; }
@@ -50,6 +50,11 @@ public:
 	bool hasIndices() const { return !indices.empty(); }
 	bool hasTextureCoordinates() const { return hasTexture; }
 
+	// For texture streaming: radius of a sphere around the local origin enclosing every vertex,
+	//	and UV units per local-space unit (square root of total UV area over total surface area).
+	float getBoundingRadius() const;
+	float getUVDensity() const;
+
 private:
 	std::vector<Vertex> vertices;
 	std::vector<uint32_t> indices;
@@ -63,6 +68,11 @@ private:
 	bool buffersCreated;
 	bool hasTexture;
 
+	mutable bool metricsValid;
+	mutable float boundingRadius;
+	mutable float uvDensity;
+
+	void computeMetrics() const;
 	void createVertexBuffer();
 	void createIndexBuffer();
 	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
@@ -0,0 +1,280 @@
+#include "ObjectBuffer.h"
+#include "../utils/logger/Logging.h"
+#include "vulkan/VulkanDevice.h"
+#include "math/Matrix4.h"
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+
+const uint32_t ObjectBuffer::INITIAL_CAPACITY;
+
+ObjectBuffer::ObjectBuffer(VulkanDevice* device, uint32_t framesInFlight, uint32_t initialCapacity)
+	: device(device)
+	, maxCapacity(0)
+	, growCount(0)
+	, coherent(true)
+	, nonCoherentAtomSize(1)
+	, lastBytesWritten(0)
+	, lastFlushRanges(0)
+	, totalBytesWritten(0)
+	, uploadCount(0) {
+
+	// A storage buffer descriptor can only span so much (at least 128 MB, by the spec)
+	VkPhysicalDeviceProperties deviceProps;
+	vkGetPhysicalDeviceProperties(device->getPhysicalDevice(), &deviceProps);
+	maxCapacity = deviceProps.limits.maxStorageBufferRange / sizeof(PerObjectData);
+	nonCoherentAtomSize = std::max<VkDeviceSize>(deviceProps.limits.nonCoherentAtomSize, 1);
+
+	initialCapacity = std::clamp(initialCapacity, 1u, maxCapacity);
+
+	Log(LOW, "ObjectBuffer: Creating buffers for %u objects", initialCapacity);
+	Log(LOW, "  Object size: %zu bytes", sizeof(PerObjectData));
+	Log(LOW, "  Max objects: %u", maxCapacity);
+
+	frames.resize(framesInFlight);
+	for (FrameBuffer& frame : frames) {
+		createBuffer(frame, initialCapacity);
+	}
+	Log(LOW, "  Memory: %s", coherent ? "host-coherent" : "non-coherent (flushed per dirty range)");
+}
+
+ObjectBuffer::~ObjectBuffer() {
+	for (FrameBuffer& frame : frames) {
+		destroyBuffer(frame);
+	}
+	frames.clear();
+}
+
+void ObjectBuffer::createBuffer(FrameBuffer& frame, uint32_t capacity) {
+	VkDeviceSize bufferSize = static_cast<VkDeviceSize>(capacity) * sizeof(PerObjectData);
+
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = bufferSize;
+	bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(device->getLogicalDevice(), &bufferInfo, nullptr, &frame.buffer) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create per-object storage buffer!");
+	}
+
+	VkMemoryRequirements memRequirements;
+	vkGetBufferMemoryRequirements(device->getLogicalDevice(), frame.buffer, &memRequirements);
+
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = memRequirements.size;
+	allocInfo.memoryTypeIndex = device->findMemoryType(
+		memRequirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT		// (coherent or not; upload() flushes if it isn't)
+	);
+
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(device->getPhysicalDevice(), &memProperties);
+	coherent = (memProperties.memoryTypes[allocInfo.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+	if (vkAllocateMemory(device->getLogicalDevice(), &allocInfo, nullptr, &frame.memory) != VK_SUCCESS) {
+		vkDestroyBuffer(device->getLogicalDevice(), frame.buffer, nullptr);
+		frame.buffer = VK_NULL_HANDLE;
+		throw std::runtime_error("Failed to allocate per-object storage buffer memory!");
+	}
+
+	vkBindBufferMemory(device->getLogicalDevice(), frame.buffer, frame.memory, 0);
+
+	// Map memory for persistent mapping (all of it, so flushed ranges may round up to the allocation's end)
+	vkMapMemory(device->getLogicalDevice(), frame.memory, 0, VK_WHOLE_SIZE, 0, &frame.mapped);
+
+	frame.allocationSize = memRequirements.size;
+	frame.capacity = capacity;
+
+	// Nothing's in the new buffer yet
+	frame.dirty.assign((records.size() + 63) / 64, 0);
+	markDirty(frame, 0, static_cast<uint32_t>(records.size()));
+}
+
+void ObjectBuffer::destroyBuffer(FrameBuffer& frame) {
+	if (frame.mapped) {
+		vkUnmapMemory(device->getLogicalDevice(), frame.memory);
+	}
+	if (frame.buffer) {
+		vkDestroyBuffer(device->getLogicalDevice(), frame.buffer, nullptr);
+	}
+	if (frame.memory) {
+		vkFreeMemory(device->getLogicalDevice(), frame.memory, nullptr);
+	}
+	frame.buffer = VK_NULL_HANDLE;
+	frame.memory = VK_NULL_HANDLE;
+	frame.mapped = nullptr;
+	frame.capacity = 0;
+}
+
+bool ObjectBuffer::reserve(uint32_t frameIndex, uint32_t objectCount) {
+	if (frameIndex >= frames.size()) {
+		throw std::runtime_error("Frame index out of bounds");
+	}
+	if (objectCount > records.size()) {
+		records.resize(objectCount, PerObjectData{});
+		for (FrameBuffer& each : frames) {
+			each.dirty.resize((records.size() + 63) / 64, 0);
+		}
+	}
+
+	FrameBuffer& frame = frames[frameIndex];
+	if (objectCount <= frame.capacity) {
+		return false;
+	}
+	if (objectCount > maxCapacity) {
+		throw std::runtime_error("Object count exceeds the largest per-object storage buffer");
+	}
+
+	uint32_t capacity = frame.capacity;
+	while (capacity < objectCount) {
+		capacity = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(capacity) * 2, maxCapacity));
+	}
+
+	// (this frame's buffer is idle - its last submission has completed - so it can go right away)
+	uint32_t oldCapacity = frame.capacity;
+	destroyBuffer(frame);
+	createBuffer(frame, capacity);
+	++growCount;
+
+	Log(NOTE, "ObjectBuffer: frame %u grew from %u to %u objects (%.1f KB)", frameIndex, oldCapacity, capacity,
+		capacity * sizeof(PerObjectData) / 1024.0f);
+	return true;
+}
+
+void ObjectBuffer::setObject(uint32_t objectIndex, const Matrix4& modelMatrix, int32_t textureIndex) {
+	if (objectIndex >= records.size()) {
+		throw std::runtime_error("Object index out of bounds");
+	}
+
+	PerObjectData& objectData = records[objectIndex];
+	memcpy(objectData.model, modelMatrix.data(), sizeof(objectData.model));
+	computeNormalMatrix(objectData.model, objectData.normalMatrix);
+	objectData.textureIndex = textureIndex;
+
+	for (FrameBuffer& frame : frames) {
+		markDirty(frame, objectIndex, 1);
+	}
+}
+
+void ObjectBuffer::setObject(uint32_t objectIndex, const Matrix4& modelMatrix, const Matrix4& normalMatrix,
+							 int32_t textureIndex) {
+	if (objectIndex >= records.size()) {
+		throw std::runtime_error("Object index out of bounds");
+	}
+
+	PerObjectData& objectData = records[objectIndex];
+	memcpy(objectData.model, modelMatrix.data(), sizeof(objectData.model));
+	memcpy(objectData.normalMatrix, normalMatrix.data(), sizeof(objectData.normalMatrix));
+	objectData.textureIndex = textureIndex;
+
+	for (FrameBuffer& frame : frames) {
+		markDirty(frame, objectIndex, 1);
+	}
+}
+
+void ObjectBuffer::upload(uint32_t frameIndex) {
+	if (frameIndex >= frames.size()) {
+		throw std::runtime_error("Frame index out of bounds");
+	}
+	FrameBuffer& frame = frames[frameIndex];
+	uint8_t* mapped = static_cast<uint8_t*>(frame.mapped);
+	uint32_t count = std::min(static_cast<uint32_t>(records.size()), frame.capacity);
+	const VkDeviceSize recordSize = sizeof(PerObjectData);
+
+	// Copy each run of dirty records in one go; when non-coherent, flush each run's range, rounded out
+	//	to whole atoms and merged with the previous one where they then meet.
+	flushRanges.clear();
+	VkDeviceSize bytesWritten = 0;
+	uint32_t index = 0;
+	while (index < count) {
+		if (frame.dirty[index / 64] == 0) {
+			index = (index / 64 + 1) * 64;		// (skip clean words whole)
+			continue;
+		}
+		if (!(frame.dirty[index / 64] & (1ull << (index % 64)))) {
+			++index;
+			continue;
+		}
+		uint32_t first = index;
+		while (index < count && (frame.dirty[index / 64] & (1ull << (index % 64)))) {
+			frame.dirty[index / 64] &= ~(1ull << (index % 64));
+			++index;
+		}
+
+		VkDeviceSize offset = first * recordSize;
+		VkDeviceSize size = (index - first) * recordSize;
+		memcpy(mapped + offset, &records[first], size);
+		bytesWritten += size;
+
+		if (!coherent) {
+			VkDeviceSize start = offset / nonCoherentAtomSize * nonCoherentAtomSize;
+			VkDeviceSize end = std::min((offset + size + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize,
+										frame.allocationSize);
+			if (!flushRanges.empty() && start <= flushRanges.back().offset + flushRanges.back().size) {
+				flushRanges.back().size = end - flushRanges.back().offset;
+			} else {
+				VkMappedMemoryRange range{};
+				range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+				range.memory = frame.memory;
+				range.offset = start;
+				range.size = end - start;
+				flushRanges.push_back(range);
+			}
+		}
+	}
+
+	if (!flushRanges.empty()) {
+		if (vkFlushMappedMemoryRanges(device->getLogicalDevice(), static_cast<uint32_t>(flushRanges.size()),
+									  flushRanges.data()) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to flush per-object storage buffer!");
+		}
+	}
+
+	lastBytesWritten = bytesWritten;
+	lastFlushRanges = static_cast<uint32_t>(flushRanges.size());
+	totalBytesWritten += bytesWritten;
+	++uploadCount;
+}
+
+void ObjectBuffer::markDirty(FrameBuffer& frame, uint32_t first, uint32_t count) {
+	for (uint32_t index = first; index < first + count; ++index) {
+		frame.dirty[index / 64] |= 1ull << (index % 64);
+	}
+}
+
+// Inverse transpose of the upper-left 3x3 (the cofactor matrix over the determinant), so normals stay
+//	perpendicular to surfaces under non-uniform scale. Falls back to the model matrix itself if singular.
+void ObjectBuffer::computeNormalMatrix(const float* model, float* normalMatrix) {
+	auto a = [model](int row, int col) { return model[col * 4 + row]; };
+
+	float cofactor[3][3];
+	for (int row = 0; row < 3; ++row) {
+		for (int col = 0; col < 3; ++col) {
+			int r1 = (row + 1) % 3, r2 = (row + 2) % 3;
+			int c1 = (col + 1) % 3, c2 = (col + 2) % 3;
+			cofactor[row][col] = a(r1, c1) * a(r2, c2) - a(r1, c2) * a(r2, c1);
+		}
+	}
+	float det = a(0, 0) * cofactor[0][0] + a(0, 1) * cofactor[0][1] + a(0, 2) * cofactor[0][2];
+	if (std::fabs(det) < 1e-12f) {
+		memcpy(normalMatrix, model, 16 * sizeof(float));
+		return;
+	}
+
+	for (int col = 0; col < 4; ++col) {
+		for (int row = 0; row < 4; ++row) {
+			normalMatrix[col * 4 + row] = (row < 3 && col < 3) ? cofactor[row][col] / det : (row == col ? 1.0f : 0.0f);
+		}
+	}
+}
+
+VkDescriptorBufferInfo ObjectBuffer::getDescriptorBufferInfo(uint32_t frameIndex) const {
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = frames[frameIndex].buffer;
+	bufferInfo.offset = 0;
+	bufferInfo.range = VK_WHOLE_SIZE;
+	return bufferInfo;
+}
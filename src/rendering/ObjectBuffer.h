@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstdint>
+
+class VulkanDevice;
+class Matrix4;
+
+// ObjectBuffer holds every drawn object's per-object record in one storage buffer per frame in flight,
+//	which the vertex shader indexes by gl_InstanceIndex (each draw passes its object index as firstInstance).
+// A frame's buffer grows geometrically when the scene outgrows it, and is otherwise never reallocated.
+// Records are kept in a CPU-side copy; each frame's buffer has a dirty bit per record, and only changed
+//	records are written to it - flushed in coalesced ranges when its memory isn't host-coherent.
+class ObjectBuffer {
+public:
+	// Structure matching the shader's std430 PerObjectData (array stride 144 bytes)
+	struct PerObjectData {
+		alignas(16) float model[16];		// Model matrix
+		alignas(16) float normalMatrix[16];	// Normal matrix (inverse transpose of model)
+		alignas(16) int32_t textureIndex;	// Slot in the bindless texture array, or -1 for none
+	};
+
+	ObjectBuffer(VulkanDevice* device, uint32_t framesInFlight, uint32_t initialCapacity = INITIAL_CAPACITY);
+	~ObjectBuffer();
+
+	// Make room for objectCount records in a frame's buffer, replacing it with one at least twice the size
+	//	if it's too small. Call only once that frame's previous submission has completed.
+	//	Returns true if the buffer was replaced, so descriptors referencing it need rewriting.
+	bool reserve(uint32_t frameIndex, uint32_t objectCount);
+
+	// Change an object's record (deriving its normal matrix), marking it dirty in every frame's buffer.
+	//	Call only for objects whose transform or texture changed; unchanged records cost nothing.
+	void setObject(uint32_t objectIndex, const Matrix4& modelMatrix, int32_t textureIndex = -1);
+	// (or with its normal matrix already composed, as TransformStore does)
+	void setObject(uint32_t objectIndex, const Matrix4& modelMatrix, const Matrix4& normalMatrix, int32_t textureIndex = -1);
+
+	// Write the records dirty in this frame's buffer, and flush them if its memory is non-coherent.
+	void upload(uint32_t frameIndex);
+
+	// Get descriptor buffer info for binding (the whole buffer, as a storage buffer)
+	VkDescriptorBufferInfo getDescriptorBufferInfo(uint32_t frameIndex) const;
+
+	// Records a frame's buffer holds, and how many times any frame's buffer has grown
+	uint32_t getCapacity(uint32_t frameIndex) const { return frames[frameIndex].capacity; }
+	uint32_t getGrowCount() const { return growCount; }
+
+	// Upload statistics: the most recent upload's, and totals over every upload
+	VkDeviceSize getBytesWritten() const { return lastBytesWritten; }
+	uint32_t getFlushRangeCount() const { return lastFlushRanges; }
+	VkDeviceSize getTotalBytesWritten() const { return totalBytesWritten; }
+	uint64_t getUploadCount() const { return uploadCount; }
+	bool isCoherent() const { return coherent; }
+
+	static const uint32_t INITIAL_CAPACITY = 256;
+
+private:
+	struct FrameBuffer {
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		VkDeviceSize allocationSize;
+		void* mapped;
+		uint32_t capacity;
+		std::vector<uint64_t> dirty;		// (a bit per record)
+	};
+
+	void createBuffer(FrameBuffer& frame, uint32_t capacity);
+	void destroyBuffer(FrameBuffer& frame);
+	static void markDirty(FrameBuffer& frame, uint32_t first, uint32_t count);
+	static void computeNormalMatrix(const float* model, float* normalMatrix);
+
+	VulkanDevice* device;
+	uint32_t maxCapacity;		// (as far as maxStorageBufferRange allows)
+	uint32_t growCount;
+	bool coherent;
+	VkDeviceSize nonCoherentAtomSize;
+
+	// Per-frame buffers for double/triple buffering
+	std::vector<FrameBuffer> frames;
+
+	// Every object's current record
+	std::vector<PerObjectData> records;
+
+	std::vector<VkMappedMemoryRange> flushRanges;		// (reused by each upload)
+
+	VkDeviceSize lastBytesWritten;
+	uint32_t lastFlushRanges;
+	VkDeviceSize totalBytesWritten;
+	uint64_t uploadCount;
+};
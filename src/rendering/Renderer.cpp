@@ -3,57 +3,102 @@
 #include "vulkan/VulkanPipeline.h"
 #include "vulkan/VulkanDevice.h"
 #include "vulkan/VulkanSwapchain.h"
+#include "vulkan/FrameContext.h"
+#include "vulkan/GpuProfiler.h"
 #include "Camera.h"
 #include "Light.h"
-#include "DynamicUBO.h"
+#include "ObjectBuffer.h"
 #include "geometry/Model.h"
 #include "Mesh.h"
 #include "Texture.h"
+#include "TextureStreamer.h"
+#include "DynamicResolution.h"
 #include "../utils/logger/Logging.h"
+#include "../utils/Trace.h"
 #include "math/Matrix4.h"
+#include "math/TransformStore.h"
 #include <stdexcept>
 #include <cstring>
 #include <array>
+#include <algorithm>
+#include <cmath>
 
 // Define static constants
-const int Renderer::MAX_FRAMES_IN_FLIGHT;
-const uint32_t Renderer::MAX_OBJECTS;
+const uint32_t Renderer::TEXTURE_SETS_PER_POOL;
+const uint32_t Renderer::MAX_BINDLESS_TEXTURES;
+
+bool Renderer::bindlessEnabled = true;
+
+namespace {
+	const char* pipelineName(PipelineType type) {
+		switch (type) {
+			case PipelineType::TEXTURED:	return "TEXTURED";
+			case PipelineType::BINDLESS:	return "BINDLESS";
+			default:						return "UNTEXTURED";
+		}
+	}
+
+	// (the render pass's GPU scope, named by whether the depth pre-pass ran, to time each mode apart)
+	const char* RENDER_PASS_SCOPE = "render pass";
+	const char* DEPTH_PREPASS_RENDER_PASS_SCOPE = "render pass (depth pre-pass)";
+}
 
 Renderer::Renderer(VulkanEngine& engine)
 	: engine(engine)
+	, depthPrepass(false)
+	, renderPassTimings{}
+	, lastTimedFrame(0)
+	, renderScales{}
 	, camera(nullptr)
 	, light(nullptr)
 	, descriptorSetLayout(VK_NULL_HANDLE)
 	, textureDescriptorSetLayout(VK_NULL_HANDLE)
 	, descriptorPool(VK_NULL_HANDLE)
-	, currentFrame(0)
+	, textureSetsInPool(TEXTURE_SETS_PER_POOL)
+	, bindless(bindlessEnabled && engine.getDevice()->supportsBindless())
+	, bindlessDescriptorSetLayout(VK_NULL_HANDLE)
+	, bindlessDescriptorPool(VK_NULL_HANDLE)
+	, bindlessDescriptorSet(VK_NULL_HANDLE)
+	, bindlessCapacity(0)
+	, nextBindlessSlot(0)
+	, globalUniformOffset(0)
+	, frameNumber(0)
 {
 	createDescriptorSetLayout();
 	createTextureDescriptorSetLayout();
+	if (bindless) {
+		createBindlessDescriptorSetLayout();
+	}
 	createGraphicsPipeline();
+	if (bindless && !pipeline->hasBindlessPipeline()) {
+		bindless = false;
+	}
+
+	// Create storage buffers for per-object transforms
+	objectBuffer = std::make_unique<ObjectBuffer>(engine.getDevice(), engine.getFramesInFlight());
 
-	// Create dynamic UBO for per-object transforms
-	dynamicUBO = std::make_unique<DynamicUBO>(engine.getDevice(), MAX_OBJECTS, MAX_FRAMES_IN_FLIGHT);
+	textureStreamer = std::make_unique<TextureStreamer>();
 
-	createGlobalUniformBuffers();
 	createDescriptorPool();
 	createDescriptorSets();
+	if (bindless) {
+		createBindlessDescriptorSet();
+	}
+	Log(NOTE, "Texture binding: %s", bindless ? "bindless (descriptor indexing)" : "descriptor set per texture");
 }
 
 Renderer::~Renderer() {
 	VulkanDevice* device = engine.getDevice();
 
-	// Clean up global uniform buffers
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		if (globalUniformBuffers[i] != VK_NULL_HANDLE) {
-			vkDestroyBuffer(device->getLogicalDevice(), globalUniformBuffers[i], nullptr);
-			vkFreeMemory(device->getLogicalDevice(), globalUniformBuffersMemory[i], nullptr);
-		}
-	}
-
 	if (descriptorPool != VK_NULL_HANDLE) {
 		vkDestroyDescriptorPool(device->getLogicalDevice(), descriptorPool, nullptr);
 	}
+	for (VkDescriptorPool texturePool : textureDescriptorPools) {
+		vkDestroyDescriptorPool(device->getLogicalDevice(), texturePool, nullptr);
+	}
+	if (bindlessDescriptorPool != VK_NULL_HANDLE) {
+		vkDestroyDescriptorPool(device->getLogicalDevice(), bindlessDescriptorPool, nullptr);
+	}
 
 	if (descriptorSetLayout != VK_NULL_HANDLE) {
 		vkDestroyDescriptorSetLayout(device->getLogicalDevice(), descriptorSetLayout, nullptr);
@@ -61,22 +106,40 @@ Renderer::~Renderer() {
 	if (textureDescriptorSetLayout != VK_NULL_HANDLE) {
 		vkDestroyDescriptorSetLayout(device->getLogicalDevice(), textureDescriptorSetLayout, nullptr);
 	}
+	if (bindlessDescriptorSetLayout != VK_NULL_HANDLE) {
+		vkDestroyDescriptorSetLayout(device->getLogicalDevice(), bindlessDescriptorSetLayout, nullptr);
+	}
 }
 
 void Renderer::render() {
+	// Swap in/out texture levels between frames (submitted ahead of this one's commands).
+	{
+		TRACE_SCOPE("TextureStreamer::update");
+		if (textureStreamer->update()) {
+			refreshTextureDescriptors(textureStreamer->getChangedTextures());
+		}
+	}
+
 	VkCommandBuffer commandBuffer = engine.beginFrame();
 	if (commandBuffer == nullptr) {
 		return; // Skip frame if swapchain recreation needed
 	}
+	sampleGpuTimings();
+
+	// Grow this frame's per-object buffer if the scene outgrew it (its last use has completed,
+	//	as has that of the descriptor set pointing at it)
+	uint32_t frameIndex = engine.getFrameIndex();
+	if (objectBuffer->reserve(frameIndex, static_cast<uint32_t>(models.size()))) {
+		writeObjectBufferDescriptor(frameIndex);
+	}
 
-	updateGlobalUniformBuffer(currentFrame);
-	updateDynamicUBO(currentFrame);
-	recordCommandBuffer(commandBuffer);
+	updateGlobalUniformBuffer(frameIndex);
+	updateObjectBuffer(frameIndex);
+	recordCommandBuffer(commandBuffer, frameIndex);
 
 	engine.endFrame(commandBuffer);
 
-	// Update frame counter
-	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	++frameNumber;
 }
 
 void Renderer::setCamera(Camera* camera) {
@@ -90,41 +153,23 @@ void Renderer::addModel(Model* model) {
 	if (model) {
 		model->createBuffers(*engine.getDevice());
 
-		// Create texture descriptor set if the model has a texture
-		if (model->hasTexture() && model->getTexture()) {
-			// Allocate descriptor set
-			VkDescriptorSetAllocateInfo allocInfo{};
-			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			allocInfo.descriptorPool = descriptorPool;
-			allocInfo.descriptorSetCount = 1;
-			allocInfo.pSetLayouts = &textureDescriptorSetLayout;
-
-			VkDescriptorSet textureDescriptorSet;
-			if (vkAllocateDescriptorSets(engine.getDevice()->getLogicalDevice(), &allocInfo, &textureDescriptorSet) != VK_SUCCESS) {
-				throw std::runtime_error("Failed to allocate texture descriptor set");
+		if (bindless) {
+			// Point the model at its texture's slot in the bindless array (writing the slot on first use)
+			BindlessModel entry{ nullptr, -1 };
+			if (model->hasTexture() && model->getMesh()->hasTextureCoordinates()) {
+				entry.texture = model->getTexture().get();
+				entry.textureIndex = acquireBindlessSlot(entry.texture);
+				if (entry.textureIndex < 0) {
+					entry.texture = nullptr;
+				}
 			}
-
-			// Update the descriptor set with the texture
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = model->getTexture()->getImageView();
-			imageInfo.sampler = model->getTexture()->getSampler();
-
-			VkWriteDescriptorSet descriptorWrite{};
-			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrite.dstSet = textureDescriptorSet;
-			descriptorWrite.dstBinding = 0; // Binding 0 in set 1
-			descriptorWrite.dstArrayElement = 0;
-			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorWrite.descriptorCount = 1;
-			descriptorWrite.pImageInfo = &imageInfo;
-
-			vkUpdateDescriptorSets(engine.getDevice()->getLogicalDevice(), 1, &descriptorWrite, 0, nullptr);
-
-			// Store the descriptor set
-			textureDescriptorSets[model] = textureDescriptorSet;
-
-			Log(LOW, "Created texture descriptor set for model at %p", model);
+			bindlessModels[model] = entry;
+		}
+		// Share the texture's descriptor set if the model has a texture
+		else if (model->hasTexture() && model->getTexture()) {
+			Texture* texture = model->getTexture().get();
+			acquireTextureSet(texture);
+			texturedModels[model] = texture;
 		}
 	}
 }
@@ -132,19 +177,43 @@ void Renderer::addModel(Model* model) {
 void Renderer::removeModel(Model* model) {
 	auto it = std::find(models.begin(), models.end(), model);
 	if (it != models.end()) {
+		// Models after it shift down an index, so their records need rewriting
+		size_t index = static_cast<size_t>(it - models.begin());
+		for (size_t i = index; i < objectStates.size(); ++i) {
+			objectStates[i].model = nullptr;
+		}
 		models.erase(it);
 	}
 
-	// Remove texture descriptor set if it exists
-	auto textureIt = textureDescriptorSets.find(model);
-	if (textureIt != textureDescriptorSets.end()) {
-		textureDescriptorSets.erase(textureIt);
+	// Release its texture's descriptor set if it has one
+	auto textureIt = texturedModels.find(model);
+	if (textureIt != texturedModels.end()) {
+		releaseTextureSet(textureIt->second);
+		texturedModels.erase(textureIt);
+	}
+
+	auto bindlessIt = bindlessModels.find(model);
+	if (bindlessIt != bindlessModels.end()) {
+		if (bindlessIt->second.texture) {
+			releaseBindlessSlot(bindlessIt->second.texture);
+		}
+		bindlessModels.erase(bindlessIt);
 	}
 }
 
 void Renderer::clearModels() {
 	models.clear();
-	textureDescriptorSets.clear();
+	objectStates.clear();
+	for (const auto& [texture, textureSet] : textureSets) {
+		retiredTextureSets.push_back({ textureSet.descriptorSet, frameNumber });
+	}
+	textureSets.clear();
+	texturedModels.clear();
+	bindlessModels.clear();
+	for (const auto& [texture, slot] : bindlessSlots) {
+		retiredBindlessSlots.push_back({ slot.index, frameNumber });
+	}
+	bindlessSlots.clear();
 }
 
 void Renderer::setLight(Light* light) {
@@ -154,15 +223,15 @@ void Renderer::setLight(Light* light) {
 void Renderer::createDescriptorSetLayout() {
 	std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
 
-	// Binding 0: Global uniforms (view, proj, lighting)
+	// Binding 0: Global uniforms (view, proj, lighting), at a per-frame offset into the upload arena
 	bindings[0].binding = 0;
-	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	bindings[0].descriptorCount = 1;
 	bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
-	// Binding 1: Dynamic UBO for per-object transforms
+	// Binding 1: Storage buffer of per-object transforms, indexed by instance
 	bindings[1].binding = 1;
-	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	bindings[1].descriptorCount = 1;
 	bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
@@ -194,66 +263,62 @@ void Renderer::createTextureDescriptorSetLayout() {
 	}
 }
 
-void Renderer::createGraphicsPipeline() {
-	pipeline = std::make_unique<VulkanPipeline>(*engine.getDevice(), *engine.getSwapchain(), descriptorSetLayout, textureDescriptorSetLayout);
-}
-
-void Renderer::createGlobalUniformBuffers() {
-	VkDeviceSize bufferSize = sizeof(GlobalUniformData);
+void Renderer::createBindlessDescriptorSetLayout() {
+	bindlessCapacity = std::min(MAX_BINDLESS_TEXTURES, engine.getDevice()->getMaxBindlessTextures());
+
+	VkDescriptorSetLayoutBinding texturesBinding{};
+	texturesBinding.binding = 0;  // Binding 0 in set 1, as an array of every texture
+	texturesBinding.descriptorCount = bindlessCapacity;
+	texturesBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	texturesBinding.pImmutableSamplers = nullptr;
+	texturesBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	// Unused slots may stay unwritten, and slots may be written while the set is bound
+	//	(even by frames still in flight, as long as those don't use the slot being written).
+	VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+										  | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+										  | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount = 1;
+	bindingFlagsInfo.pBindingFlags = &bindingFlags;
 
-	globalUniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	globalUniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-	globalUniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
-
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		VkBufferCreateInfo bufferInfo{};
-		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.size = bufferSize;
-		bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-		if (vkCreateBuffer(engine.getDevice()->getLogicalDevice(), &bufferInfo, nullptr, &globalUniformBuffers[i]) != VK_SUCCESS) {
-			throw std::runtime_error("Failed to create global uniform buffer");
-		}
-
-		VkMemoryRequirements memRequirements;
-		vkGetBufferMemoryRequirements(engine.getDevice()->getLogicalDevice(), globalUniformBuffers[i], &memRequirements);
-
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = engine.getDevice()->findMemoryType(memRequirements.memoryTypeBits,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-		if (vkAllocateMemory(engine.getDevice()->getLogicalDevice(), &allocInfo, nullptr, &globalUniformBuffersMemory[i]) != VK_SUCCESS) {
-			throw std::runtime_error("Failed to allocate global uniform buffer memory");
-		}
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.pNext = &bindingFlagsInfo;
+	layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutInfo.bindingCount = 1;
+	layoutInfo.pBindings = &texturesBinding;
 
-		vkBindBufferMemory(engine.getDevice()->getLogicalDevice(), globalUniformBuffers[i], globalUniformBuffersMemory[i], 0);
-		vkMapMemory(engine.getDevice()->getLogicalDevice(), globalUniformBuffersMemory[i], 0, bufferSize, 0, &globalUniformBuffersMapped[i]);
+	if (vkCreateDescriptorSetLayout(engine.getDevice()->getLogicalDevice(), &layoutInfo, nullptr, &bindlessDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create bindless texture descriptor set layout");
 	}
 }
 
+void Renderer::createGraphicsPipeline() {
+	pipeline = std::make_unique<VulkanPipeline>(*engine.getDevice(), *engine.getSwapchain(), engine.getPipelineCache(), descriptorSetLayout, textureDescriptorSetLayout,
+												bindlessDescriptorSetLayout);
+}
+
 void Renderer::createDescriptorPool() {
-	std::array<VkDescriptorPoolSize, 3> poolSizes{};
+	std::array<VkDescriptorPoolSize, 2> poolSizes{};
 
-	// Global uniform buffers
-	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+	uint32_t framesInFlight = engine.getFramesInFlight();
 
-	// Dynamic uniform buffers
-	poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-	poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+	// Global uniforms (in the upload arenas)
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	poolSizes[0].descriptorCount = framesInFlight;
 
-	// Texture samplers - allocate enough for all potential textured models
-	poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	poolSizes[2].descriptorCount = static_cast<uint32_t>(MAX_OBJECTS);
+	// Per-object storage buffers
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSizes[1].descriptorCount = framesInFlight;
 
+	// (texture descriptor sets come from their own pools, added as needed)
 	VkDescriptorPoolCreateInfo poolInfo{};
 	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
 	poolInfo.pPoolSizes = poolSizes.data();
-	poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT + MAX_OBJECTS);
+	poolInfo.maxSets = framesInFlight;
 
 	if (vkCreateDescriptorPool(engine.getDevice()->getLogicalDevice(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to create descriptor pool");
@@ -261,53 +326,284 @@ void Renderer::createDescriptorPool() {
 }
 
 void Renderer::createDescriptorSets() {
-	std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+	uint32_t framesInFlight = engine.getFramesInFlight();
+	std::vector<VkDescriptorSetLayout> layouts(framesInFlight, descriptorSetLayout);
 	VkDescriptorSetAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	allocInfo.descriptorPool = descriptorPool;
-	allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+	allocInfo.descriptorSetCount = framesInFlight;
 	allocInfo.pSetLayouts = layouts.data();
 
-	descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+	descriptorSets.resize(framesInFlight);
 	if (vkAllocateDescriptorSets(engine.getDevice()->getLogicalDevice(), &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to allocate descriptor sets");
 	}
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+	// (binding 0 gets written by each frame's first global uniform update, once it has an arena buffer to point at)
+	globalUniformBlocks.assign(framesInFlight, 0);
+	for (uint32_t i = 0; i < framesInFlight; i++) {
+		writeObjectBufferDescriptor(i);
+	}
+}
+
+// Binding 0 of set 0: the arena buffer holding the frame's global uniforms (rewritten whenever the arena
+//	changes block, i.e. grows; safe, as that's only on reset, once the frame's last use has completed).
+//	Blocks are told apart by generation, not handle: a new block's buffer may reuse a destroyed one's.
+void Renderer::writeGlobalUniformDescriptor(uint32_t frameIndex, const UploadArena::Allocation& allocation) {
+	VkDescriptorBufferInfo globalBufferInfo{};
+	globalBufferInfo.buffer = allocation.buffer;
+	globalBufferInfo.offset = 0;
+	globalBufferInfo.range = sizeof(GlobalUniformData);
+
+	VkWriteDescriptorSet descriptorWrite{};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = descriptorSets[frameIndex];
+	descriptorWrite.dstBinding = 0;
+	descriptorWrite.dstArrayElement = 0;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	descriptorWrite.descriptorCount = 1;
+	descriptorWrite.pBufferInfo = &globalBufferInfo;
+
+	vkUpdateDescriptorSets(engine.getDevice()->getLogicalDevice(), 1, &descriptorWrite, 0, nullptr);
+	globalUniformBlocks[frameIndex] = allocation.generation;
+}
+
+// Binding 1 of set 0: the frame's per-object storage buffer (rewritten whenever it grows).
+void Renderer::writeObjectBufferDescriptor(uint32_t frameIndex) {
+	VkDescriptorBufferInfo objectBufferInfo = objectBuffer->getDescriptorBufferInfo(frameIndex);
+
+	VkWriteDescriptorSet descriptorWrite{};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = descriptorSets[frameIndex];
+	descriptorWrite.dstBinding = 1;
+	descriptorWrite.dstArrayElement = 0;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descriptorWrite.descriptorCount = 1;
+	descriptorWrite.pBufferInfo = &objectBufferInfo;
+
+	vkUpdateDescriptorSets(engine.getDevice()->getLogicalDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void Renderer::createBindlessDescriptorSet() {
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSize.descriptorCount = bindlessCapacity;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = 1;
+
+	if (vkCreateDescriptorPool(engine.getDevice()->getLogicalDevice(), &poolInfo, nullptr, &bindlessDescriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create bindless descriptor pool");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = bindlessDescriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &bindlessDescriptorSetLayout;
+
+	if (vkAllocateDescriptorSets(engine.getDevice()->getLogicalDevice(), &allocInfo, &bindlessDescriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate bindless descriptor set");
+	}
+	Log(LOW, "Bindless texture array: %u slots", bindlessCapacity);
+}
+
+int32_t Renderer::acquireBindlessSlot(Texture* texture) {
+	auto it = bindlessSlots.find(texture);
+	if (it != bindlessSlots.end()) {
+		++it->second.users;
+		return static_cast<int32_t>(it->second.index);
+	}
+
+	uint32_t slot;
+	if (!allocateBindlessSlot(slot)) {
+		Log(WARN, "Bindless texture array full (%u); drawing model untextured", bindlessCapacity);
+		return -1;
+	}
+
+	writeTextureDescriptor(bindlessDescriptorSet, slot, texture);
+
+	bindlessSlots[texture] = { slot, 1 };
+	Log(LOW, "Bindless texture slot %u for texture at %p", slot, texture);
+	return static_cast<int32_t>(slot);
+}
+
+// (a released slot may still be read by frames in flight, so can't be rewritten until they're done)
+bool Renderer::allocateBindlessSlot(uint32_t& slot) {
+	if (!retiredBindlessSlots.empty() && frameNumber - retiredBindlessSlots.front().frameNumber >= engine.getFramesInFlight()) {
+		slot = retiredBindlessSlots.front().index;
+		retiredBindlessSlots.pop_front();
+		return true;
+	}
+	if (nextBindlessSlot < bindlessCapacity) {
+		slot = nextBindlessSlot++;
+		return true;
+	}
+	return false;
+}
+
+void Renderer::releaseBindlessSlot(Texture* texture) {
+	auto it = bindlessSlots.find(texture);
+	if (it == bindlessSlots.end()) {
+		return;
+	}
+	if (--it->second.users == 0) {
+		retiredBindlessSlots.push_back({ it->second.index, frameNumber });	// (left as-is; partially bound, so it's never read unless reused)
+		bindlessSlots.erase(it);
+	}
+}
+
+VkDescriptorSet Renderer::acquireTextureSet(Texture* texture) {
+	auto it = textureSets.find(texture);
+	if (it != textureSets.end()) {
+		++it->second.users;
+		return it->second.descriptorSet;
+	}
+
+	VkDescriptorSet textureDescriptorSet = allocateTextureSet();
+	writeTextureDescriptor(textureDescriptorSet, 0, texture);
+
+	textureSets[texture] = { textureDescriptorSet, 1 };
+	Log(LOW, "Created texture descriptor set for texture at %p", texture);
+	return textureDescriptorSet;
+}
+
+// A retired set no frame in flight can still use, else a new one
+VkDescriptorSet Renderer::allocateTextureSet() {
+	VkDescriptorSet textureDescriptorSet;
+	if (!retiredTextureSets.empty() && frameNumber - retiredTextureSets.front().frameNumber >= engine.getFramesInFlight()) {
+		textureDescriptorSet = retiredTextureSets.front().descriptorSet;
+		retiredTextureSets.pop_front();
+	} else {
+		if (textureSetsInPool == TEXTURE_SETS_PER_POOL) {
+			VkDescriptorPoolSize poolSize{};
+			poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			poolSize.descriptorCount = TEXTURE_SETS_PER_POOL;
+
+			VkDescriptorPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolInfo.poolSizeCount = 1;
+			poolInfo.pPoolSizes = &poolSize;
+			poolInfo.maxSets = TEXTURE_SETS_PER_POOL;
+
+			VkDescriptorPool texturePool;
+			if (vkCreateDescriptorPool(engine.getDevice()->getLogicalDevice(), &poolInfo, nullptr, &texturePool) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to create texture descriptor pool");
+			}
+			textureDescriptorPools.push_back(texturePool);
+			textureSetsInPool = 0;
+			Log(LOW, "Texture descriptor pool %zu (%u sets)", textureDescriptorPools.size(), TEXTURE_SETS_PER_POOL);
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = textureDescriptorPools.back();
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &textureDescriptorSetLayout;
+
+		if (vkAllocateDescriptorSets(engine.getDevice()->getLogicalDevice(), &allocInfo, &textureDescriptorSet) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate texture descriptor set");
+		}
+		++textureSetsInPool;
+	}
+	return textureDescriptorSet;
+}
+
+void Renderer::releaseTextureSet(Texture* texture) {
+	auto it = textureSets.find(texture);
+	if (it == textureSets.end()) {
+		return;
+	}
+	if (--it->second.users == 0) {
+		retiredTextureSets.push_back({ it->second.descriptorSet, frameNumber });
+		textureSets.erase(it);
+	}
+}
 
-		// Global uniform buffer
-		VkDescriptorBufferInfo globalBufferInfo{};
-		globalBufferInfo.buffer = globalUniformBuffers[i];
-		globalBufferInfo.offset = 0;
-		globalBufferInfo.range = sizeof(GlobalUniformData);
+// Binding 0 of set 1: the texture's own set, or one element of the bindless array.
+void Renderer::writeTextureDescriptor(VkDescriptorSet descriptorSet, uint32_t arrayElement, Texture* texture) {
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView = texture->getImageView();
+	imageInfo.sampler = texture->getSampler();
+
+	VkWriteDescriptorSet descriptorWrite{};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = descriptorSet;
+	descriptorWrite.dstBinding = 0;
+	descriptorWrite.dstArrayElement = arrayElement;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrite.descriptorCount = 1;
+	descriptorWrite.pImageInfo = &imageInfo;
+
+	vkUpdateDescriptorSets(engine.getDevice()->getLogicalDevice(), 1, &descriptorWrite, 0, nullptr);
+}
 
-		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[0].dstSet = descriptorSets[i];
-		descriptorWrites[0].dstBinding = 0;
-		descriptorWrites[0].dstArrayElement = 0;
-		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		descriptorWrites[0].descriptorCount = 1;
-		descriptorWrites[0].pBufferInfo = &globalBufferInfo;
+// After streaming replaced some textures' image views. Frames in flight may still read the descriptors
+//	holding the old views, so rather than rewriting those, each texture moves to a fresh set (or
+//	bindless slot), the old one retired like a released one.
+void Renderer::refreshTextureDescriptors(const std::vector<Texture*>& changedTextures) {
+	for (Texture* texture : changedTextures) {
+		auto setIt = textureSets.find(texture);
+		if (setIt != textureSets.end()) {
+			VkDescriptorSet textureDescriptorSet = allocateTextureSet();
+			writeTextureDescriptor(textureDescriptorSet, 0, texture);
+			retiredTextureSets.push_back({ setIt->second.descriptorSet, frameNumber });
+			setIt->second.descriptorSet = textureDescriptorSet;
+		}
 
-		// Dynamic UBO for per-object data
-		VkDescriptorBufferInfo dynamicBufferInfo = dynamicUBO->getDescriptorBufferInfo(i);
+		auto slotIt = bindlessSlots.find(texture);
+		if (slotIt == bindlessSlots.end()) {
+			continue;
+		}
+		uint32_t slot;
+		if (!allocateBindlessSlot(slot)) {		// (array full: rewrite in place, once nothing's in flight)
+			Log(LOW, "Bindless texture array full (%u); waiting to rewrite slot %u", bindlessCapacity, slotIt->second.index);
+			engine.waitIdle();
+			writeTextureDescriptor(bindlessDescriptorSet, slotIt->second.index, texture);
+			continue;
+		}
+		writeTextureDescriptor(bindlessDescriptorSet, slot, texture);
+		retiredBindlessSlots.push_back({ slotIt->second.index, frameNumber });
+		slotIt->second.index = slot;
+		for (auto& [model, entry] : bindlessModels) {	// (their per-object records pick it up next update)
+			if (entry.texture == texture) {
+				entry.textureIndex = static_cast<int32_t>(slot);
+			}
+		}
+	}
+}
 
-		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[1].dstSet = descriptorSets[i];
-		descriptorWrites[1].dstBinding = 1;
-		descriptorWrites[1].dstArrayElement = 0;
-		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-		descriptorWrites[1].descriptorCount = 1;
-		descriptorWrites[1].pBufferInfo = &dynamicBufferInfo;
+// Finest mip level a draw of the model samples: texels per pixel for a surface facing the camera at the
+//	model's nearest point, from the texture's size, the mesh's UV density and the projection's scale.
+uint32_t Renderer::estimateMipLevel(const Model& model, const Texture& texture) const {
+	const Mesh& mesh = *model.getMesh();
+	const Matrix4& world = model.getModelMatrix();		// (not getScale()/getPosition(), which are relative to any parent)
+	Vector3 scale = world.getScale();
+	float maxScale = std::max({ scale.x, scale.y, scale.z });
+
+	float pixelsPerUnit = std::fabs(camera->getProjectionMatrix().data()[5]) * maxScale
+						* engine.getSwapchain()->getRenderExtent().height * 0.5f;
+	if (camera->getIsPerspective()) {
+		float distance = Vector3::distance(world.getTranslation(), camera->getPosition())
+					   - mesh.getBoundingRadius() * maxScale;
+		pixelsPerUnit /= std::max(distance, camera->getNearPlane());
+	}
 
-		vkUpdateDescriptorSets(engine.getDevice()->getLogicalDevice(),
-							  static_cast<uint32_t>(descriptorWrites.size()),
-							  descriptorWrites.data(), 0, nullptr);
+	float texelsPerUnit = mesh.getUVDensity() * std::sqrt(static_cast<float>(texture.getWidth()) * texture.getHeight());
+	if (pixelsPerUnit <= 0.0f || texelsPerUnit <= 0.0f) {
+		return texture.getFullMipLevels() - 1;
 	}
+	float level = std::floor(std::log2(texelsPerUnit / pixelsPerUnit));
+	return static_cast<uint32_t>(std::clamp(level, 0.0f, static_cast<float>(texture.getFullMipLevels() - 1)));
 }
 
-void Renderer::updateGlobalUniformBuffer(uint32_t currentFrame) {
+void Renderer::updateGlobalUniformBuffer(uint32_t frameIndex) {
+	TRACE_SCOPE("Renderer::updateGlobalUniformBuffer");
 	GlobalUniformData globalData{};
 
 	// Initialize matrices to identity
@@ -371,28 +667,67 @@ void Renderer::updateGlobalUniformBuffer(uint32_t currentFrame) {
 		globalData.lightColor[3] = 1.0f;
 	}
 
-	memcpy(globalUniformBuffersMapped[currentFrame], &globalData, sizeof(globalData));
+	// Into this frame's upload arena (freed as a whole once the frame completes)
+	UploadArena::Allocation allocation = engine.getCurrentFrame().uploadArena->push(globalData);
+	if (allocation.generation != globalUniformBlocks[frameIndex]) {
+		writeGlobalUniformDescriptor(frameIndex, allocation);
+	}
+	globalUniformOffset = static_cast<uint32_t>(allocation.offset);
 }
 
-void Renderer::updateDynamicUBO(uint32_t currentFrame) {
-	// Update all model transforms in the dynamic UBO
+void Renderer::updateObjectBuffer(uint32_t frameIndex) {
+	TRACE_SCOPE("Renderer::updateObjectBuffer");
+	// Compose every transform changed since last frame in one batch
+	TransformStore::shared().update();
+
+	// Rebuild only the records of models whose transform or texture changed (or that moved index)
+	if (objectStates.size() < models.size()) {
+		objectStates.resize(models.size(), ObjectState{ nullptr, 0, -1 });
+	}
 	for (size_t i = 0; i < models.size(); ++i) {
-		if (models[i]) {
-			Matrix4 modelMatrix = models[i]->getModelMatrix();
-			dynamicUBO->updateObjectTransform(currentFrame, static_cast<uint32_t>(i), modelMatrix);
+		Model* model = models[i];
+		if (!model) {
+			continue;
+		}
+		int32_t textureIndex = -1;
+		if (bindless) {
+			auto it = bindlessModels.find(model);
+			if (it != bindlessModels.end()) {
+				textureIndex = it->second.textureIndex;
+			}
+		}
+
+		ObjectState& state = objectStates[i];
+		if (state.model == model && state.transformVersion == model->getTransformVersion()
+		 && state.textureIndex == textureIndex) {
+			continue;
 		}
+		objectBuffer->setObject(static_cast<uint32_t>(i), model->getModelMatrix(), model->getNormalMatrix(), textureIndex);
+		state = { model, model->getTransformVersion(), textureIndex };
 	}
+
+	// Then write this frame's dirty records (which include those changed while other frames were current)
+	objectBuffer->upload(frameIndex);
 }
 
-void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer) {
+void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+	TRACE_SCOPE("Renderer::recordCommandBuffer");
 	VulkanSwapchain* swapchain = engine.getSwapchain();
 
+	// (scaled or not, the render pass draws to this corner of the framebuffer)
+	VkExtent2D renderExtent = swapchain->getRenderExtent();
+	float renderScale = swapchain->getRenderScale();
+	renderScales[engine.getFrameRing().getFrameNumber() % SCALE_HISTORY] = renderScale;
+	if (dynamicResolution) {
+		dynamicResolution->recordFrame(renderScale);
+	}
+
 	VkRenderPassBeginInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	renderPassInfo.renderPass = swapchain->getRenderPass();
 	renderPassInfo.framebuffer = swapchain->getFramebuffer(engine.getCurrentImageIndex());
 	renderPassInfo.renderArea.offset = {0, 0};
-	renderPassInfo.renderArea.extent = swapchain->getExtent();
+	renderPassInfo.renderArea.extent = renderExtent;
 
 	std::array<VkClearValue, 2> clearValues{};
 	clearValues[0].color = {{0.1f, 0.1f, 0.3f, 1.0f}};  // Dark blue background
@@ -401,20 +736,26 @@ void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer) {
 	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 	renderPassInfo.pClearValues = clearValues.data();
 
+	PipelineVariant variant = pipelineVariant;
+	bool prepass = beginDepthPrepass(variant);
+
+	GpuProfiler& profiler = engine.getGpuProfiler();
+	uint32_t renderPassScope = profiler.beginScope(commandBuffer, prepass ? DEPTH_PREPASS_RENDER_PASS_SCOPE : RENDER_PASS_SCOPE);
+	profiler.beginStatistics(commandBuffer);
 	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
 	VkViewport viewport{};
 	viewport.x = 0.0f;
 	viewport.y = 0.0f;
-	viewport.width = static_cast<float>(swapchain->getExtent().width);
-	viewport.height = static_cast<float>(swapchain->getExtent().height);
+	viewport.width = static_cast<float>(renderExtent.width);
+	viewport.height = static_cast<float>(renderExtent.height);
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
 	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
 	VkRect2D scissor{};
 	scissor.offset = {0, 0};
-	scissor.extent = swapchain->getExtent();
+	scissor.extent = renderExtent;
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
 	// Debug output
@@ -422,7 +763,7 @@ void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer) {
 	bool debug = debugCount > 0;
 	if (debug) {
 		--debugCount;
-		Log(LOW, "\n=== Dynamic UBO Rendering Debug ===");
+		Log(LOW, "\n=== Rendering Debug ===");
 		Log(LOW, "Viewport: %.0fx%.0f", viewport.width, viewport.height);
 		Log(LOW, "Number of models: %zu", models.size());
 
@@ -435,9 +776,30 @@ void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer) {
 		}
 	}
 
+	// Depth pre-pass subpass (left empty when not drawing with it)
+	if (prepass) {
+		recordDepthPrepass(commandBuffer, frameIndex);
+	}
+	vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+
 	// Track current pipeline to avoid redundant binding
 	PipelineType currentPipeline = static_cast<PipelineType>(-1);
 
+	// Each run of draws with the same pipeline is a batch, timed as a scope named for the pipeline
+	uint32_t batchScope = GpuProfiler::NO_SCOPE;
+
+	// Bindless: one pipeline and one texture array for every draw
+	if (bindless) {
+		batchScope = profiler.beginScope(commandBuffer, pipelineName(PipelineType::BINDLESS));
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+						 pipeline->getPipeline(PipelineType::BINDLESS, variant));
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+							   pipeline->getPipelineLayout(PipelineType::BINDLESS), 1, 1,
+							   &bindlessDescriptorSet, 0, nullptr);
+		currentPipeline = PipelineType::BINDLESS;
+	}
+	bool objectSetBound = false;
+
 	// Render each model with dynamic offsets
 	for (size_t i = 0; i < models.size(); ++i) {
 		Model* model = models[i];
@@ -447,35 +809,35 @@ void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer) {
 		}
 
 		// Determine which pipeline to use based on texture coordinates
-		PipelineType pipelineType = model->getMesh()->hasTextureCoordinates() ?
-								   PipelineType::TEXTURED : PipelineType::UNTEXTURED;
+		PipelineType pipelineType = bindless ? PipelineType::BINDLESS
+								  : model->getMesh()->hasTextureCoordinates() ? PipelineType::TEXTURED : PipelineType::UNTEXTURED;
+
+		// Bind pipeline (and the frame's global/per-object set with its layout) if it changed
+		if (pipelineType != currentPipeline || !objectSetBound) {
+			if (pipelineType != currentPipeline) {
+				profiler.endScope(commandBuffer, batchScope);
+				batchScope = profiler.beginScope(commandBuffer, pipelineName(pipelineType));
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+								 pipeline->getPipeline(pipelineType, variant));
+				currentPipeline = pipelineType;
 
-		// Bind pipeline if it changed
-		if (pipelineType != currentPipeline) {
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-							 pipeline->getPipeline(pipelineType));
-			currentPipeline = pipelineType;
-
-			if (debug) {
-				Log(LOW, "  Switched to %s pipeline", (pipelineType == PipelineType::TEXTURED ? "TEXTURED" : "UNTEXTURED"));
+				if (debug) {
+					Log(LOW, "  Switched to %s pipeline", pipelineName(pipelineType));
+				}
 			}
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+								   pipeline->getPipelineLayout(pipelineType), 0, 1,
+								   &descriptorSets[frameIndex], 1, &globalUniformOffset);
+			objectSetBound = true;
 		}
 
-		// Get dynamic offset for this object
-		uint32_t dynamicOffset = dynamicUBO->getDynamicOffset(static_cast<uint32_t>(i));
-
-		// Bind descriptor sets with dynamic offset
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-							   pipeline->getPipelineLayout(pipelineType), 0, 1,
-							   &descriptorSets[currentFrame], 1, &dynamicOffset);
-
 		// Bind texture descriptor set if this model has a texture
 		if (pipelineType == PipelineType::TEXTURED && model->hasTexture()) {
-			auto textureIt = textureDescriptorSets.find(model);
-			if (textureIt != textureDescriptorSets.end()) {
+			auto textureIt = texturedModels.find(model);
+			if (textureIt != texturedModels.end()) {
 				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
 									   pipeline->getPipelineLayout(pipelineType), 1, 1,
-									   &textureIt->second, 0, nullptr);
+									   &textureSets[textureIt->second].descriptorSet, 0, nullptr);
 
 				if (debug) {
 					Log(LOW, "    Bound texture descriptor set for model");
@@ -483,16 +845,24 @@ void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer) {
 			}
 		}
 
-		// Render this model
-		model->render(commandBuffer);
+		// Report how finely it's drawn, so the streamer keeps that level resident
+		if (camera && model->hasTexture() && model->getMesh()->hasTextureCoordinates()) {
+			std::shared_ptr<Texture> texture = model->getTexture();
+			if (texture->isStreamable()) {
+				textureStreamer->requestLevel(texture, estimateMipLevel(*model, *texture));
+			}
+		}
+
+		// Render this model (its index selects its per-object record)
+		model->render(commandBuffer, static_cast<uint32_t>(i));
 
 		if (debug) {
 			Vector3 pos = model->getPosition();
 			Matrix4 modelMatrix = model->getModelMatrix();
 			Log(LOW, "  Model %zu at (%.2f, %.2f, %.2f)", i, pos.x, pos.y, pos.z);
-			Log(LOW, "    Pipeline: %s", (pipelineType == PipelineType::TEXTURED ? "TEXTURED" : "UNTEXTURED"));
+			Log(LOW, "    Pipeline: %s", pipelineName(pipelineType));
 			Log(LOW, "    Has texture coords: %s", (model->getMesh()->hasTextureCoordinates() ? "YES" : "NO"));
-			Log(LOW, "    Dynamic offset: %u", dynamicOffset);
+			Log(LOW, "    Object index: %zu", i);
 			Log(LOW, "    Model matrix [0]: %.2f, %.2f, %.2f, %.2f", modelMatrix.data()[0], modelMatrix.data()[1], modelMatrix.data()[2], modelMatrix.data()[3]);
 
 			// Show translation part of the matrix (should match model position)
@@ -501,5 +871,134 @@ void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer) {
 		}
 	}
 
+	profiler.endScope(commandBuffer, batchScope);
 	vkCmdEndRenderPass(commandBuffer);
+	profiler.endStatistics(commandBuffer);
+	profiler.endScope(commandBuffer, renderPassScope);
+
+	if (swapchain->isRenderScaled()) {
+		uint32_t upscaleScope = profiler.beginScope(commandBuffer, "upscale");
+		swapchain->recordUpscale(commandBuffer, engine.getCurrentImageIndex());
+		profiler.endScope(commandBuffer, upscaleScope);
+	}
+}
+
+// Whether this frame draws with the depth pre-pass, and if so, switches the variant to the main pass's
+//	to follow it. Only once those are compiled (asking for them if not): until then, the frame draws as
+//	usual, rather than following the pre-pass with pipelines that write depth and test LESS against it.
+bool Renderer::beginDepthPrepass(PipelineVariant& variant) {
+	// (wireframe lines and alpha-tested cut-outs wouldn't match the solid depth the pre-pass writes)
+	if (!depthPrepass || !pipeline->hasDepthPrepassPipeline() || variant.wireframe || variant.alphaTest) {
+		return false;
+	}
+	PipelineVariant prepassVariant = variant;
+	prepassVariant.depthPrepass = true;
+	bool ready;
+	if (bindless) {
+		ready = pipeline->requestPipeline(PipelineType::BINDLESS, prepassVariant);
+	} else {
+		bool untexturedReady = pipeline->requestPipeline(PipelineType::UNTEXTURED, prepassVariant);
+		bool texturedReady = pipeline->requestPipeline(PipelineType::TEXTURED, prepassVariant);
+		ready = untexturedReady && texturedReady;
+	}
+	if (ready) {
+		variant = prepassVariant;
+	}
+	return ready;
+}
+
+// Every visible model's depth, positions only (the untextured layout's set 0 is every pipeline's)
+void Renderer::recordDepthPrepass(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+	GpuProfiler& profiler = engine.getGpuProfiler();
+	uint32_t prepassScope = profiler.beginScope(commandBuffer, "depth pre-pass");
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getDepthPrepassPipeline());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+						   pipeline->getPipelineLayout(PipelineType::UNTEXTURED), 0, 1,
+						   &descriptorSets[frameIndex], 1, &globalUniformOffset);
+
+	for (size_t i = 0; i < models.size(); ++i) {
+		Model* model = models[i];
+		if (model && model->isVisible()) {
+			model->render(commandBuffer, static_cast<uint32_t>(i));
+		}
+	}
+	profiler.endScope(commandBuffer, prepassScope);
+}
+
+// From the frame GpuProfiler last read back (if new): adds its render pass time to its mode's total,
+//	and adjusts the render scale from its GPU time
+void Renderer::sampleGpuTimings() {
+	const GpuFrameTimings& latest = engine.getGpuProfiler().getLatestFrame();
+	if (latest.frameNumber == lastTimedFrame || latest.scopes.empty()) {
+		return;
+	}
+	lastTimedFrame = latest.frameNumber;
+	if (dynamicResolution) {
+		float scale = dynamicResolution->update(latest.scopes[0].durationMs, renderScales[latest.frameNumber % SCALE_HISTORY]);
+		engine.getSwapchain()->setRenderScale(scale);
+	}
+	for (const GpuTiming& scope : latest.scopes) {
+		bool withPrepass = strcmp(scope.name, DEPTH_PREPASS_RENDER_PASS_SCOPE) == 0;
+		if (withPrepass || strcmp(scope.name, RENDER_PASS_SCOPE) == 0) {
+			PassTimings& timings = renderPassTimings[withPrepass ? 1 : 0];
+			++timings.frames;
+			timings.totalMs += scope.durationMs;
+			break;
+		}
+	}
+}
+
+void Renderer::setDynamicResolution(double targetMs) {
+	VulkanSwapchain* swapchain = engine.getSwapchain();
+	if (targetMs <= 0.0) {
+		dynamicResolution.reset();
+		swapchain->setRenderScale(1.0f);
+		return;
+	}
+	if (!swapchain->isRenderScaled()) {
+		Log(WARN, "Dynamic resolution needs render scaling, which the swapchain doesn't have; rendering at full resolution");
+		return;
+	}
+	if (!dynamicResolution) {
+		dynamicResolution = std::make_unique<DynamicResolution>(targetMs);
+	}
+	dynamicResolution->setTargetMs(targetMs);
+	Log(NOTE, "Dynamic resolution: holding GPU frame time to %.2f ms", targetMs);
+}
+
+float Renderer::getRenderScale() const {
+	return engine.getSwapchain()->getRenderScale();
+}
+
+void Renderer::logReport() const {
+	Log(NOTE, "Renderer: %zu models; per-object buffer holds %u objects (grew %u times), %zu texture descriptor sets",
+		models.size(), objectBuffer->getCapacity(engine.getFrameIndex()), objectBuffer->getGrowCount(), textureSets.size());
+	uint64_t uploads = std::max<uint64_t>(objectBuffer->getUploadCount(), 1);
+	Log(NOTE, "  Per-object uploads (%s): %.1f KB/frame average over %llu frames, %.1f KB last frame",
+		objectBuffer->isCoherent() ? "coherent" : "flushed", objectBuffer->getTotalBytesWritten() / 1024.0f / uploads,
+		static_cast<unsigned long long>(objectBuffer->getUploadCount()), objectBuffer->getBytesWritten() / 1024.0f);
+
+	const FrameRing& frames = engine.getFrameRing();
+	const UploadArena& arena = *frames.getFrame(frames.getFrameIndex()).uploadArena;
+	Log(NOTE, "  Upload arenas (%u frames in flight): %.1f KB high-water mark, %.1f KB capacity each (%s)",
+		frames.getFramesInFlight(), frames.getUploadHighWaterMark() / 1024.0f, arena.getCapacity() / 1024.0f,
+		arena.isCoherent() ? "coherent" : "flushed");
+	pipeline->logVariantReport();
+
+	if (dynamicResolution) {
+		Log(NOTE, "  Dynamic resolution (%.2f ms target): scale %.2f average, %.2f lowest, over %llu frames (changed %u times)",
+			dynamicResolution->getTargetMs(), dynamicResolution->getAverageScale(), dynamicResolution->getLowestScale(),
+			static_cast<unsigned long long>(dynamicResolution->getFrameCount()), dynamicResolution->getChangeCount());
+	}
+
+	const PassTimings& without = renderPassTimings[0];
+	const PassTimings& with = renderPassTimings[1];
+	if (!pipeline->hasDepthPrepassPipeline()) {
+		Log(NOTE, "  Depth pre-pass: unavailable; render pass GPU time %.3f ms average (%llu frames)",
+			without.averageMs(), static_cast<unsigned long long>(without.frames));
+	} else {
+		Log(NOTE, "  Render pass GPU time: %.3f ms average without depth pre-pass (%llu frames), %.3f ms with (%llu frames)",
+			without.averageMs(), static_cast<unsigned long long>(without.frames),
+			with.averageMs(), static_cast<unsigned long long>(with.frames));
+	}
 }
@@ -1,16 +1,21 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include "vulkan/VulkanPipeline.h"
+#include "vulkan/UploadArena.h"
 #include <vector>
+#include <deque>
 #include <memory>
 #include <unordered_map>
 
 class VulkanEngine;
-class VulkanPipeline;
 class Camera;
 class Model;
 class Light;
-class DynamicUBO;
+class ObjectBuffer;
+class Texture;
+class TextureStreamer;
+class DynamicResolution;
 
 // Global uniform data that's the same for all objects
 struct GlobalUniformData {
@@ -36,20 +41,89 @@ public:
 
 	void setLight(Light* light);
 
+	// Bindless textures are used when the device supports descriptor indexing,
+	//	unless disabled before the Renderer is created.
+	static void setBindlessEnabled(bool enable) { bindlessEnabled = enable; }
+	bool isBindless() const { return bindless; }
+
+	// Streams texture mip levels in and out by on-screen size (e.g. to set its memory budget).
+	TextureStreamer* getTextureStreamer() const { return textureStreamer.get(); }
+
+	// Per-object records (e.g. for their capacity and how often it has grown).
+	const ObjectBuffer* getObjectBuffer() const { return objectBuffer.get(); }
+
+	// The pipeline variant every draw uses; one not compiled yet draws with the default meanwhile.
+	void setPipelineVariant(const PipelineVariant& variant) { pipelineVariant = variant; }
+	const PipelineVariant& getPipelineVariant() const { return pipelineVariant; }
+	std::vector<PipelineVariantStats> getPipelineVariantStats() const { return pipeline->getVariantStats(); }
+
+	// Depth pre-pass: lay down depth with a position-only pass first, so the main pass (testing
+	//	LESS_OR_EQUAL, writing no depth) shades each pixel once. Used only while its main-pass variants are
+	//	compiled - and not with wireframe or alpha test, which the depth-only pass can't match - else the
+	//	frame draws as usual. Each mode's render pass GPU time is kept, to compare them side by side.
+	void setDepthPrepass(bool enable) { depthPrepass = enable; }
+	bool isDepthPrepass() const { return depthPrepass; }
+	bool isDepthPrepassAvailable() const { return pipeline->hasDepthPrepassPipeline(); }
+
+	struct PassTimings {
+		uint64_t frames;
+		double totalMs;
+		double averageMs() const { return frames > 0 ? totalMs / frames : 0.0; }
+	};
+	const PassTimings& getRenderPassTimings(bool withDepthPrepass) const { return renderPassTimings[withDepthPrepass ? 1 : 0]; }
+
+	// Dynamic resolution: render at a scale adjusted each frame to hold GPU frame time at targetMs, then
+	//	upscale to the output. Needs the swapchain to render scaled (else stays at full resolution).
+	void setDynamicResolution(double targetMs);		// (0: off, back to full resolution)
+	const DynamicResolution* getDynamicResolution() const { return dynamicResolution.get(); }
+	float getRenderScale() const;					// (that the last frame recorded was rendered at)
+
+	void logReport() const;
+
 private:
 	void createDescriptorSetLayout();
 	void createTextureDescriptorSetLayout();
+	void createBindlessDescriptorSetLayout();
 	void createGraphicsPipeline();
-	void createGlobalUniformBuffers();
 	void createDescriptorPool();
 	void createDescriptorSets();
-
-	void updateGlobalUniformBuffer(uint32_t currentFrame);
-	void updateDynamicUBO(uint32_t currentFrame);
-	void recordCommandBuffer(VkCommandBuffer commandBuffer);
+	void writeObjectBufferDescriptor(uint32_t frameIndex);
+	void writeGlobalUniformDescriptor(uint32_t frameIndex, const UploadArena::Allocation& allocation);
+	void createBindlessDescriptorSet();
+
+	VkDescriptorSet acquireTextureSet(Texture* texture);
+	void releaseTextureSet(Texture* texture);
+	VkDescriptorSet allocateTextureSet();
+
+	int32_t acquireBindlessSlot(Texture* texture);
+	void releaseBindlessSlot(Texture* texture);
+	bool allocateBindlessSlot(uint32_t& slot);
+	void writeTextureDescriptor(VkDescriptorSet descriptorSet, uint32_t arrayElement, Texture* texture);
+	void refreshTextureDescriptors(const std::vector<Texture*>& changedTextures);
+	uint32_t estimateMipLevel(const Model& model, const Texture& texture) const;
+
+	void updateGlobalUniformBuffer(uint32_t frameIndex);
+	void updateObjectBuffer(uint32_t frameIndex);
+	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+	bool beginDepthPrepass(PipelineVariant& variant);
+	void recordDepthPrepass(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+	void sampleGpuTimings();
 
 	VulkanEngine& engine;
 	std::unique_ptr<VulkanPipeline> pipeline;
+	PipelineVariant pipelineVariant;
+
+	// Depth pre-pass, and the GPU time of each mode's render pass (indexed by whether it ran), taken
+	//	from the frames GpuProfiler reads back by their render pass scope's name
+	bool depthPrepass;
+	PassTimings renderPassTimings[2];
+	uint64_t lastTimedFrame;
+
+	// Dynamic resolution (null when off), and the scale each recent frame was rendered at (by frame
+	//	number), to know what scale a frame's GPU time - read back a few frames later - was measured at
+	std::unique_ptr<DynamicResolution> dynamicResolution;
+	static const uint32_t SCALE_HISTORY = 8;
+	float renderScales[SCALE_HISTORY];
 
 	Camera* camera;
 	std::vector<Model*> models;
@@ -60,18 +134,66 @@ private:
 	VkDescriptorPool descriptorPool;
 	std::vector<VkDescriptorSet> descriptorSets;
 
-	// Texture descriptor sets - one per model with texture
-	std::unordered_map<Model*, VkDescriptorSet> textureDescriptorSets;
-
-	// Global uniform buffers (view, proj, lighting)
-	std::vector<VkBuffer> globalUniformBuffers;
-	std::vector<VkDeviceMemory> globalUniformBuffersMemory;
-	std::vector<void*> globalUniformBuffersMapped;
-
-	// Dynamic UBO for per-object transforms
-	std::unique_ptr<DynamicUBO> dynamicUBO;
-
-	uint32_t currentFrame;
-	static const int MAX_FRAMES_IN_FLIGHT = 2;
-	static const uint32_t MAX_OBJECTS = 1000;
+	// Texture descriptor sets - one per texture, shared by the models using it. Allocated from as many
+	//	pools as it takes; released sets are reused once no frame in flight can still be reading them.
+	struct TextureSet {
+		VkDescriptorSet descriptorSet;
+		uint32_t users;
+	};
+	struct RetiredTextureSet {
+		VkDescriptorSet descriptorSet;
+		uint64_t frameNumber;		// (released before this frame was recorded)
+	};
+	std::unordered_map<Texture*, TextureSet> textureSets;
+	std::unordered_map<Model*, Texture*> texturedModels;
+	std::vector<VkDescriptorPool> textureDescriptorPools;
+	uint32_t textureSetsInPool;			// (allocated from the last pool)
+	std::deque<RetiredTextureSet> retiredTextureSets;
+
+	// Bindless mode - one update-after-bind array of all textures (set 1), bound once per frame,
+	//	indexed per draw by PerObjectData::textureIndex. Slots are shared by models using the same texture.
+	struct BindlessSlot {
+		uint32_t index;
+		uint32_t users;
+	};
+	struct BindlessModel {
+		Texture* texture;		// (nullptr if untextured)
+		int32_t textureIndex;
+	};
+	struct RetiredBindlessSlot {
+		uint32_t index;
+		uint64_t frameNumber;		// (released before this frame was recorded)
+	};
+	bool bindless;
+	VkDescriptorSetLayout bindlessDescriptorSetLayout;
+	VkDescriptorPool bindlessDescriptorPool;
+	VkDescriptorSet bindlessDescriptorSet;
+	uint32_t bindlessCapacity;
+	uint32_t nextBindlessSlot;
+	std::deque<RetiredBindlessSlot> retiredBindlessSlots;	// (rewritten only once no frame in flight can read them)
+	std::unordered_map<Texture*, BindlessSlot> bindlessSlots;
+	std::unordered_map<Model*, BindlessModel> bindlessModels;
+	static bool bindlessEnabled;
+
+	// Global uniforms (view, proj, lighting), written each frame to the frame's upload arena: binding 0 is
+	//	a dynamic uniform buffer, bound at this frame's offset into the arena buffer last written to its set
+	std::vector<uint64_t> globalUniformBlocks;		// (per frame index: generation of the arena block set 0 points at, 0 for none)
+	uint32_t globalUniformOffset;
+
+	// Storage buffer of per-object records (transforms, texture index), indexed by draw
+	std::unique_ptr<ObjectBuffer> objectBuffer;
+
+	// What each object index's record was last set from, to only rewrite it when that changes
+	struct ObjectState {
+		Model* model;			// (nullptr forces a rewrite)
+		uint64_t transformVersion;
+		int32_t textureIndex;
+	};
+	std::vector<ObjectState> objectStates;
+
+	std::unique_ptr<TextureStreamer> textureStreamer;
+
+	uint64_t frameNumber;		// (frames recorded so far)
+	static const uint32_t TEXTURE_SETS_PER_POOL = 256;
+	static const uint32_t MAX_BINDLESS_TEXTURES = 4096;
 };
@@ -1,14 +1,26 @@
 #include "Texture.h"
+#include "TextureCache.h"
+#include "TextureManager.h"
 #include "../utils/logger/Logging.h"
+#include "../utils/Trace.h"
 #include "../vulkan/VulkanDevice.h"
 #include "../vulkan/VulkanEngine.h"
 #include "../vulkan/VulkanBuffer.h"
+#include "../vulkan/FrameContext.h"
 #include <SDL2/SDL_image.h>
 #include <stdexcept>
 #include <cstring>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 
 Texture* Texture::defaultTexture = nullptr;
+float Texture::requestedAnisotropy = 16.0f;
+bool Texture::compressionEnabled = true;
+uint32_t Texture::streamingTailSize = 256;
+std::mutex Texture::prefetchMutex;
+std::unordered_map<std::string, std::shared_ptr<Texture::PrefetchedImage>> Texture::prefetched;
 
 Texture::Texture()
 	: textureImage(VK_NULL_HANDLE)
@@ -18,6 +30,21 @@ Texture::Texture()
 	, device(nullptr)
 	, engine(nullptr)
 	, loaded(false)
+	, mipLevels(1)
+	, textureFormat(VK_FORMAT_R8G8B8A8_SRGB)
+	, memorySize(0)
+	, manager(nullptr)
+	, streamable(false)
+	, flipped(false)
+	, blockFormat(BlockFormat::BC1)
+	, width(0)
+	, height(0)
+	, fullMipLevels(1)
+	, residentBaseLevel(0)
+	, tailLevel(0)
+	, batchCommands(VK_NULL_HANDLE)
+	, batchStagingBuffer(VK_NULL_HANDLE)
+	, batchStagingBufferMemory(VK_NULL_HANDLE)
 { }
 
 Texture::~Texture() {
@@ -26,6 +53,7 @@ Texture::~Texture() {
 
 bool Texture::loadFromFile(const std::string& filename, VulkanDevice& vulkanDevice,
 														VulkanEngine& vulkanEngine, bool flipVertically) {
+	TRACE_SCOPE("Texture::loadFromFile");
 	this->device = &vulkanDevice;
 	this->engine = &vulkanEngine;
 
@@ -37,6 +65,10 @@ bool Texture::loadFromFile(const std::string& filename, VulkanDevice& vulkanDevi
 		return createDefaultWhiteTexture();
 	}
 
+	// Prefer a cached (or freshly encoded) block-compressed chain, else fall back to RGBA8 below.
+	if (compressionEnabled && loadCompressed(filename, flipVertically))
+		return true;
+
 	// Try to load actual image file using SDL_image.
 	SDL_Surface* surface = IMG_Load(filename.c_str());
 	if (!surface) {
@@ -69,8 +101,9 @@ bool Texture::loadFromFile(const std::string& filename, VulkanDevice& vulkanDevi
 		int height = surface->h;
 		int bytesPerPixel = surface->format->BytesPerPixel;
 
+		std::vector<unsigned char> flippedPixels;	// (must outlive the upload below)
 		if (flipVertically) {
-			std::vector<unsigned char> flippedPixels = flipImageVertically(pixels, width, height, bytesPerPixel);
+			flippedPixels = flipImageVertically(pixels, width, height, bytesPerPixel);
 			pixels = flippedPixels.data();
 		}
 
@@ -90,30 +123,30 @@ bool Texture::loadFromFile(const std::string& filename, VulkanDevice& vulkanDevi
 }
 
 void Texture::cleanup() {
-	if (device && loaded) {
+	if (device) {
 		VkDevice logicalDevice = device->getLogicalDevice();
 
-		if (textureSampler != VK_NULL_HANDLE) {
-			vkDestroySampler(logicalDevice, textureSampler, nullptr);
-			textureSampler = VK_NULL_HANDLE;
+		if (!retiredImages.empty()) {		// (frames in flight may still use them)
+			vkQueueWaitIdle(device->getGraphicsQueue());
+			for (const RetiredImage& retired : retiredImages)
+				destroyRetired(retired);
+			retiredImages.clear();
 		}
 
-		if (textureImageView != VK_NULL_HANDLE) {
-			vkDestroyImageView(logicalDevice, textureImageView, nullptr);
-			textureImageView = VK_NULL_HANDLE;
-		}
-
-		if (textureImage != VK_NULL_HANDLE) {
-			vkDestroyImage(logicalDevice, textureImage, nullptr);
-			textureImage = VK_NULL_HANDLE;
+		if (textureSampler != VK_NULL_HANDLE) {
+			if (!manager)	// (otherwise it belongs to the manager's sampler cache)
+				vkDestroySampler(logicalDevice, textureSampler, nullptr);
+			textureSampler = VK_NULL_HANDLE;
 		}
 
-		if (textureImageMemory != VK_NULL_HANDLE) {
-			vkFreeMemory(logicalDevice, textureImageMemory, nullptr);
-			textureImageMemory = VK_NULL_HANDLE;
-		}
+		destroyImage(textureImage, textureImageMemory, textureImageView);
+		textureImage = VK_NULL_HANDLE;
+		textureImageMemory = VK_NULL_HANDLE;
+		textureImageView = VK_NULL_HANDLE;
+		memorySize = 0;
 
 		loaded = false;
+		streamable = false;
 	}
 }
 
@@ -157,31 +190,391 @@ bool Texture::createDefaultWhiteTexture() {
 }
 
 void Texture::createTextureImage(unsigned char* pixels, int width, int height) {
-	VkDeviceSize imageSize = width * height * 4; // 4 bytes per pixel (RGBA)
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	textureFormat = VK_FORMAT_R8G8B8A8_SRGB;
+	mipLevels = TextureCompressor::calculateMipLevels(width, height);
+
+	// Blit the chain on the GPU where the format allows linear-filtered blits,
+	//	otherwise downsample every level on the CPU and upload them all at once.
+	bool gpuBlit = mipLevels == 1 || supportsLinearBlit(textureFormat);
+
+	std::vector<MipLevel> levels;
+	std::vector<unsigned char> mipChain;
+	const unsigned char* uploadPixels = pixels;
+	VkDeviceSize baseSize = static_cast<VkDeviceSize>(width) * height * 4; // 4 bytes per pixel (RGBA)
+	VkDeviceSize uploadSize = baseSize;
+
+	if (gpuBlit) {
+		levels.push_back({ 0, static_cast<size_t>(baseSize), static_cast<uint32_t>(width), static_cast<uint32_t>(height) });
+	} else {
+		mipChain = TextureCompressor::buildMipChain(pixels, width, height, levels);
+		uploadPixels = mipChain.data();
+		uploadSize = mipChain.size();
+	}
+
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	createBuffer(uploadSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				 stagingBuffer, stagingBufferMemory);
+
+	void* data;
+	vkMapMemory(device->getLogicalDevice(), stagingBufferMemory, 0, uploadSize, 0, &data);
+	memcpy(data, uploadPixels, static_cast<size_t>(uploadSize));
+	vkUnmapMemory(device->getLogicalDevice(), stagingBufferMemory);
+
+	createImage(static_cast<uint32_t>(width), static_cast<uint32_t>(height), textureFormat,
+				VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+	// Transfer the texture data to GPU:
+	transitionImageLayout(textureImage, textureFormat,
+						  VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+	copyBufferToImage(stagingBuffer, textureImage, levels);
+	if (gpuBlit) {
+		generateMipmaps(textureImage, width, height, mipLevels);	// (leaves every level shader-readable)
+	} else {
+		transitionImageLayout(textureImage, textureFormat,
+							  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels);
+	}
+
+	vkDestroyBuffer(device->getLogicalDevice(), stagingBuffer, nullptr);
+	vkFreeMemory(device->getLogicalDevice(), stagingBufferMemory, nullptr);
+
+	if (mipLevels > 1) {
+		float elapsedMs = std::chrono::duration<float, std::milli>(
+							std::chrono::high_resolution_clock::now() - startTime).count();
+		// The chain costs about a third more memory, but a surface minified 4x samples level 2,
+		//	touching 1/16th of the texels (and cache lines) that the base level would.
+		VkDeviceSize chainSize = 0;
+		for (int w = width, h = height, i = 0; i < static_cast<int>(mipLevels); ++i) {
+			chainSize += static_cast<VkDeviceSize>(w) * h * 4;
+			w = std::max(1, w / 2);
+			h = std::max(1, h / 2);
+		}
+		VkDeviceSize extraSize = chainSize - baseSize;
+		Log(RAW, " - %d x %d, %u mips via %s in %.2f ms: +%.1f KB (+%.0f%%) memory, 4x-minified reads %.1f KB instead of %.1f KB",
+			width, height, mipLevels, gpuBlit ? "GPU blit" : "CPU box filter", elapsedMs,
+			extraSize / 1024.0f, 100.0f * extraSize / baseSize,
+			std::max(1, width / 4) * std::max(1, height / 4) * 4 / 1024.0f, baseSize / 1024.0f);
+	}
+}
+
+bool Texture::loadCompressed(const std::string& filename, bool flipVertically) {
+	TRACE_SCOPE("Texture::loadCompressed");
+	if (!supportsSampling(TextureCompressor::vulkanFormat(BlockFormat::BC1)))
+		return false;
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	CompressedImage image;
+	const char* source = "cached";
+	std::shared_ptr<PrefetchedImage> prefetchedImage = takePrefetched(filename, flipVertically);
+	bool decoded = prefetchedImage && !prefetchedImage->pixels.empty();
+	bool cacheHit = false;
+	if (prefetchedImage && !prefetchedImage->compressed.levels.empty()
+	 && supportsSampling(TextureCompressor::vulkanFormat(prefetchedImage->compressed.format))) {
+		image = std::move(prefetchedImage->compressed);
+		source = "prefetched";
+		cacheHit = true;
+	} else if (!decoded) {
+		cacheHit = TextureCache::load(filename, flipVertically, image)
+				&& supportsSampling(TextureCompressor::vulkanFormat(image.format));
+	}
+	if (!cacheHit) {
+		source = "encoded";
+		bool preferBC7 = supportsSampling(TextureCompressor::vulkanFormat(BlockFormat::BC7));
+		if (decoded) {
+			TextureCache::encodePixels(prefetchedImage->pixels, prefetchedImage->width, prefetchedImage->height,
+									   preferBC7, image);
+		} else {
+			std::error_code error;
+			if (!std::filesystem::exists(filename, error))
+				return false;
+			if (!TextureCache::encodeFile(filename, flipVertically, preferBC7, image))
+				return false;
+		}
+		TextureCache::store(filename, flipVertically, image);
+	}
+
+	// Start with just the coarse tail of the chain resident; the streamer brings in finer levels as needed.
+	uint32_t baseLevel = 0;
+	if (streamingTailSize > 0) {
+		while (baseLevel + 1 < image.levels.size()
+			&& std::max(image.levels[baseLevel].width, image.levels[baseLevel].height) > streamingTailSize)
+			++baseLevel;
+	}
+
+	sourcePath = filename;
+	flipped = flipVertically;
+	blockFormat = image.format;
+	width = image.width;
+	height = image.height;
+	fullMipLevels = static_cast<uint32_t>(image.levels.size());
+	tailLevel = baseLevel;
+
+	try {
+		createCompressedTextureImage(image, baseLevel);
+		createTextureImageView();
+		createTextureSampler();
+	} catch (const std::exception& e) {
+		Log(WARN, "Failed to create compressed texture (%s), retrying as RGBA8", e.what());
+		cleanup();
+		return false;
+	}
+	loaded = true;
+	streamable = true;
+
+	float elapsedMs = std::chrono::duration<float, std::milli>(
+						std::chrono::high_resolution_clock::now() - startTime).count();
+	size_t uncompressedSize = 0;
+	for (const MipLevel& level : image.levels)
+		uncompressedSize += static_cast<size_t>(level.width) * level.height * 4;
+	Log(RAW, " - %u x %u %s, %u mips, %.1f KB vs %.1f KB RGBA8 (%.1f:1), %s in %.2f ms",
+		image.width, image.height, TextureCompressor::formatName(image.format), fullMipLevels,
+		image.data.size() / 1024.0f, uncompressedSize / 1024.0f, static_cast<float>(uncompressedSize) / image.data.size(),
+		source, elapsedMs);
+	if (baseLevel > 0) {
+		Log(RAW, "   streaming: levels %u-%u resident (%.1f KB), %u finer on demand",
+			baseLevel, fullMipLevels - 1, memorySize / 1024.0f, baseLevel);
+	}
+	return true;
+}
+
+std::string Texture::prefetchKey(const std::string& filename, bool flipVertically) {
+	return flipVertically ? filename + "|flipped" : filename;
+}
+
+void Texture::prefetch(const std::string& filename, bool flipVertically) {
+	if (!compressionEnabled)
+		return;
+	std::string key = prefetchKey(filename, flipVertically);
+	{
+		std::lock_guard<std::mutex> lock(prefetchMutex);
+		if (!prefetched.emplace(key, nullptr).second)
+			return;		// (another thread has it)
+	}
+	TRACE_SCOPE("Texture::prefetch");
+
+	auto image = std::make_shared<PrefetchedImage>();
+	if (!TextureCache::load(filename, flipVertically, image->compressed)) {
+		image->compressed = CompressedImage();
+		std::error_code error;
+		if (!std::filesystem::exists(filename, error)
+		 || !TextureCache::decodeFile(filename, flipVertically, image->pixels, image->width, image->height)) {
+			image.reset();	// (loadFromFile() will fail or fall back on its own, and report it)
+		} else if (!TextureCompressor::hasAlpha(image->pixels.data(), image->width, image->height)) {
+			TextureCache::encodePixels(image->pixels, image->width, image->height, false, image->compressed);
+			TextureCache::store(filename, flipVertically, image->compressed);
+			image->pixels.clear();
+		}
+	}
+	std::lock_guard<std::mutex> lock(prefetchMutex);
+	prefetched[key] = image;
+}
+
+std::shared_ptr<Texture::PrefetchedImage> Texture::takePrefetched(const std::string& filename, bool flipVertically) {
+	std::lock_guard<std::mutex> lock(prefetchMutex);
+	auto it = prefetched.find(prefetchKey(filename, flipVertically));
+	if (it == prefetched.end() || !it->second)
+		return nullptr;
+	std::shared_ptr<PrefetchedImage> image = std::move(it->second);
+	prefetched.erase(it);
+	return image;
+}
+
+void Texture::clearPrefetched() {
+	std::lock_guard<std::mutex> lock(prefetchMutex);
+	prefetched.clear();
+}
+
+// Block-compressed formats can't be blitted, so every level comes precomputed from the cache.
+//	Levels above baseLevel are left out: the image's level 0 is the chain's baseLevel.
+void Texture::createCompressedTextureImage(const CompressedImage& image, uint32_t baseLevel) {
+	textureFormat = TextureCompressor::vulkanFormat(image.format);
+	mipLevels = static_cast<uint32_t>(image.levels.size()) - baseLevel;
+
+	// Levels are packed largest-first, so the resident ones are one contiguous run.
+	size_t baseOffset = image.levels[baseLevel].offset;
+	std::vector<MipLevel> levels(image.levels.begin() + baseLevel, image.levels.end());
+	for (MipLevel& level : levels)
+		level.offset -= baseOffset;
 
+	VkDeviceSize uploadSize = image.data.size() - baseOffset;
 	VkBuffer stagingBuffer;
 	VkDeviceMemory stagingBufferMemory;
-	createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+	createBuffer(uploadSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 				 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 				 stagingBuffer, stagingBufferMemory);
 
 	void* data;
-	vkMapMemory(device->getLogicalDevice(), stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
+	vkMapMemory(device->getLogicalDevice(), stagingBufferMemory, 0, uploadSize, 0, &data);
+	memcpy(data, image.data.data() + baseOffset, static_cast<size_t>(uploadSize));
 	vkUnmapMemory(device->getLogicalDevice(), stagingBufferMemory);
 
-	VkImageCreateInfo imageInfo{};		// Create image:
+	createImage(levels[0].width, levels[0].height, textureFormat,	// (transfer source too, for eviction copies)
+				VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+	transitionImageLayout(textureImage, textureFormat,
+						  VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+	copyBufferToImage(stagingBuffer, textureImage, levels);
+	transitionImageLayout(textureImage, textureFormat,
+						  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels);
+
+	if (batchCommands != VK_NULL_HANDLE) {		// (not copied yet: kept until the batch has run)
+		batchStagingBuffer = stagingBuffer;
+		batchStagingBufferMemory = stagingBufferMemory;
+	} else {
+		vkDestroyBuffer(device->getLogicalDevice(), stagingBuffer, nullptr);
+		vkFreeMemory(device->getLogicalDevice(), stagingBufferMemory, nullptr);
+	}
+	residentBaseLevel = baseLevel;
+}
+
+VkDeviceSize Texture::estimateResidentBytes(uint32_t baseLevel) const {
+	if (!streamable)
+		return memorySize;
+	VkDeviceSize size = 0;
+	for (uint32_t level = baseLevel; level < fullMipLevels; ++level) {
+		VkDeviceSize blocksWide = (std::max(1u, width >> level) + 3) / 4;
+		VkDeviceSize blocksHigh = (std::max(1u, height >> level) + 3) / 4;
+		size += blocksWide * blocksHigh * TextureCompressor::blockSize(blockFormat);
+	}
+	return size;
+}
+
+bool Texture::streamIn(const CompressedImage& image, uint32_t baseLevel) {
+	if (!streamable || baseLevel >= fullMipLevels || image.format != blockFormat
+	 || image.width != width || image.height != height || image.levels.size() != fullMipLevels) {
+		Log(WARN, "Texture: streamed chain doesn't match %s", sourcePath.c_str());
+		return false;
+	}
+	return replaceImage("stream in", [&]() {
+		createCompressedTextureImage(image, baseLevel);
+	});
+}
+
+bool Texture::evictTo(uint32_t baseLevel) {
+	if (!streamable || baseLevel <= residentBaseLevel || baseLevel > tailLevel)
+		return false;
+
+	VkImage sourceImage = textureImage;
+	uint32_t sourceLevel = baseLevel - residentBaseLevel;
+	return replaceImage("evict", [&]() {
+		mipLevels = fullMipLevels - baseLevel;
+		createImage(std::max(1u, width >> baseLevel), std::max(1u, height >> baseLevel), textureFormat,
+					VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+		copyLevelsFrom(sourceImage, sourceLevel);
+		residentBaseLevel = baseLevel;
+	});
+}
+
+// Builds a new image (and view) via createLevels, keeping the current one if that fails. Its commands
+//	are recorded into one command buffer, submitted without waiting; the old image is retired.
+bool Texture::replaceImage(const char* action, const std::function<void()>& createLevels) {
+	releaseRetired();
+
+	VkImage oldImage = textureImage;
+	VkDeviceMemory oldMemory = textureImageMemory;
+	VkImageView oldView = textureImageView;
+	uint32_t oldMipLevels = mipLevels;
+	uint32_t oldBaseLevel = residentBaseLevel;
+	VkDeviceSize oldSize = memorySize;
+
+	textureImage = VK_NULL_HANDLE;
+	textureImageMemory = VK_NULL_HANDLE;
+	textureImageView = VK_NULL_HANDLE;
+	batchCommands = allocateCommandBuffer();
+	RetiredImage retired{ oldImage, oldMemory, oldView, VK_NULL_HANDLE, VK_NULL_HANDLE, batchCommands,
+						  engine->getFrameRing().getFrameNumber() };
+	try {
+		createLevels();
+		createTextureImageView();
+
+		vkEndCommandBuffer(batchCommands);
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batchCommands;
+		if (vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to submit texture commands");
+		}
+	} catch (const std::exception& e) {
+		Log(WARN, "Texture: failed to %s %s: %s", action, sourcePath.c_str(), e.what());
+		destroyImage(textureImage, textureImageMemory, textureImageView);
+		destroyRetired({ VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, batchStagingBuffer, batchStagingBufferMemory,
+						 batchCommands, 0 });		// (never submitted)
+		batchCommands = VK_NULL_HANDLE;
+		batchStagingBuffer = VK_NULL_HANDLE;
+		batchStagingBufferMemory = VK_NULL_HANDLE;
+		textureImage = oldImage;
+		textureImageMemory = oldMemory;
+		textureImageView = oldView;
+		mipLevels = oldMipLevels;
+		residentBaseLevel = oldBaseLevel;
+		memorySize = oldSize;
+		return false;
+	}
+	retired.stagingBuffer = batchStagingBuffer;
+	retired.stagingBufferMemory = batchStagingBufferMemory;
+	retiredImages.push_back(retired);
+	batchCommands = VK_NULL_HANDLE;
+	batchStagingBuffer = VK_NULL_HANDLE;
+	batchStagingBufferMemory = VK_NULL_HANDLE;
+
+	Log(LOW, "Texture: %s %s -> levels %u-%u, %.1f KB (was %.1f KB)", action, sourcePath.c_str(),
+		residentBaseLevel, fullMipLevels - 1, memorySize / 1024.0f, oldSize / 1024.0f);
+	return true;
+}
+
+// A frame's submission completing implies that of everything submitted before it, so once the frame
+//	submitted after an image was retired has completed (its context waited on, which happens by the
+//	time framesInFlight more have begun), nothing can still use it.
+void Texture::releaseRetired() {
+	if (retiredImages.empty())
+		return;
+	const FrameRing& frames = engine->getFrameRing();
+	while (!retiredImages.empty() && frames.getFrameNumber() - retiredImages.front().frameNumber > frames.getFramesInFlight()) {
+		destroyRetired(retiredImages.front());
+		retiredImages.pop_front();
+	}
+}
+
+void Texture::destroyRetired(const RetiredImage& retired) {
+	VkDevice logicalDevice = device->getLogicalDevice();
+	destroyImage(retired.image, retired.memory, retired.view);
+	if (retired.stagingBuffer != VK_NULL_HANDLE)
+		vkDestroyBuffer(logicalDevice, retired.stagingBuffer, nullptr);
+	if (retired.stagingBufferMemory != VK_NULL_HANDLE)
+		vkFreeMemory(logicalDevice, retired.stagingBufferMemory, nullptr);
+	if (retired.commandBuffer != VK_NULL_HANDLE)
+		vkFreeCommandBuffers(logicalDevice, engine->getCommandPool(), 1, &retired.commandBuffer);
+}
+
+void Texture::destroyImage(VkImage image, VkDeviceMemory memory, VkImageView view) {
+	VkDevice logicalDevice = device->getLogicalDevice();
+	if (view != VK_NULL_HANDLE)
+		vkDestroyImageView(logicalDevice, view, nullptr);
+	if (image != VK_NULL_HANDLE)
+		vkDestroyImage(logicalDevice, image, nullptr);
+	if (memory != VK_NULL_HANDLE)
+		vkFreeMemory(logicalDevice, memory, nullptr);
+}
+
+// Creates textureImage (with mipLevels levels) and binds it to newly allocated device-local memory.
+void Texture::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage) {
+	VkImageCreateInfo imageInfo{};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
-	imageInfo.extent.width = static_cast<uint32_t>(width);
-	imageInfo.extent.height = static_cast<uint32_t>(height);
+	imageInfo.extent.width = width;
+	imageInfo.extent.height = height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = 1;
-	imageInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+	imageInfo.format = format;
 	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.usage = usage;
 	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
@@ -205,17 +598,7 @@ void Texture::createTextureImage(unsigned char* pixels, int width, int height) {
 	}
 
 	vkBindImageMemory(device->getLogicalDevice(), textureImage, textureImageMemory, 0);
-
-	// Transfer the texture data to GPU:
-	transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB,
-						  VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(width),
-												   static_cast<uint32_t>(height));
-	transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB,
-						  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-	vkDestroyBuffer(device->getLogicalDevice(), stagingBuffer, nullptr);
-	vkFreeMemory(device->getLogicalDevice(), stagingBufferMemory, nullptr);
+	memorySize = memRequirements.size;
 }
 
 void Texture::createTextureImageView() {
@@ -223,10 +606,10 @@ void Texture::createTextureImageView() {
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	viewInfo.image = textureImage;
 	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-	viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+	viewInfo.format = textureFormat;
 	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.levelCount = mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = 1;
 
@@ -244,8 +627,13 @@ void Texture::createTextureSampler() {
 	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-	samplerInfo.anisotropyEnable = VK_FALSE;
-	samplerInfo.maxAnisotropy = 1.0f;
+
+	// Anisotropy is optional, but never beyond what the device supports.
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device->getPhysicalDevice(), &properties);
+	float anisotropy = std::min(requestedAnisotropy, properties.limits.maxSamplerAnisotropy);
+	samplerInfo.anisotropyEnable = anisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+	samplerInfo.maxAnisotropy = std::max(1.0f, anisotropy);
 	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 	samplerInfo.unnormalizedCoordinates = VK_FALSE;
 	samplerInfo.compareEnable = VK_FALSE;
@@ -253,16 +641,18 @@ void Texture::createTextureSampler() {
 	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	samplerInfo.mipLodBias = 0.0f;
 	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;	// (the view limits it to mipLevels; keeps samplers shareable)
 
-	if (vkCreateSampler(device->getLogicalDevice(), &samplerInfo,
-						nullptr, &textureSampler) != VK_SUCCESS) {
+	if (manager) {
+		textureSampler = manager->getSampler(samplerInfo);
+	} else if (vkCreateSampler(device->getLogicalDevice(), &samplerInfo,
+							   nullptr, &textureSampler) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to create texture sampler");
 	}
 }
 
 void Texture::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout,
-						VkImageLayout newLayout) {	  (void)format;
+						VkImageLayout newLayout, uint32_t levelCount) {	  (void)format;
 	// Create a temporary command buffer:
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
@@ -275,7 +665,7 @@ void Texture::transitionImageLayout(VkImage image, VkFormat format, VkImageLayou
 	barrier.image = image;
 	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = levelCount;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 
@@ -311,33 +701,180 @@ void Texture::transitionImageLayout(VkImage image, VkFormat format, VkImageLayou
 	endSingleTimeCommands(commandBuffer);
 }
 
-void Texture::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
+// Copy sourceImage's levels from sourceLevel on into every level of textureImage (the same chain, minus its finest levels).
+void Texture::copyLevelsFrom(VkImage sourceImage, uint32_t sourceLevel) {
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
-	VkBufferImageCopy region{};
-	region.bufferOffset = 0;
-	region.bufferRowLength = 0;
-	region.bufferImageHeight = 0;
+	VkImageMemoryBarrier barriers[2]{};
+	for (VkImageMemoryBarrier& barrier : barriers) {
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.levelCount = mipLevels;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+	}
+	VkImageMemoryBarrier& source = barriers[0];
+	source.image = sourceImage;
+	source.subresourceRange.baseMipLevel = sourceLevel;
+	source.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	source.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	source.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	source.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	VkImageMemoryBarrier& destination = barriers[1];
+	destination.image = textureImage;
+	destination.subresourceRange.baseMipLevel = 0;
+	destination.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	destination.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	destination.srcAccessMask = 0;
+	destination.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+
+	uint32_t baseLevel = fullMipLevels - mipLevels;
+	std::vector<VkImageCopy> copies(mipLevels);
+	for (uint32_t level = 0; level < mipLevels; ++level) {
+		VkImageCopy& region = copies[level];
+		region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, sourceLevel + level, 0, 1 };
+		region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+		region.srcOffset = {0, 0, 0};
+		region.dstOffset = {0, 0, 0};
+		region.extent = { std::max(1u, width >> (baseLevel + level)), std::max(1u, height >> (baseLevel + level)), 1 };
+	}
+	vkCmdCopyImage(commandBuffer, sourceImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				   textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()), copies.data());
+
+	// Both end up shader-readable (the source too, in case the caller has to keep it after all).
+	source.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	source.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	source.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	source.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	destination.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	destination.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	destination.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	destination.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+						 0, nullptr, 0, nullptr, 2, barriers);
 
-	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
-	region.imageSubresource.baseArrayLayer = 0;
-	region.imageSubresource.layerCount = 1;
+	endSingleTimeCommands(commandBuffer);
+}
+
+void Texture::copyBufferToImage(VkBuffer buffer, VkImage image, const std::vector<MipLevel>& levels) {
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+	std::vector<VkBufferImageCopy> copies(levels.size());
+	for (size_t level = 0; level < levels.size(); ++level) {
+		VkBufferImageCopy& region = copies[level];
+		region.bufferOffset = levels[level].offset;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
 
-	region.imageOffset = {0, 0, 0};
-	region.imageExtent = {width, height, 1};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = static_cast<uint32_t>(level);
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+
+		region.imageOffset = {0, 0, 0};
+		region.imageExtent = {levels[level].width, levels[level].height, 1};
+	}
 
 	vkCmdCopyBufferToImage(
 		commandBuffer,
 		buffer,
 		image,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		1,
-		&region
+		static_cast<uint32_t>(copies.size()),
+		copies.data()
 	);
 	endSingleTimeCommands(commandBuffer);
 }
 
+// Successively blit each level down from the one above it, transitioning each to shader-read once it's been read.
+void Texture::generateMipmaps(VkImage image, int32_t width, int32_t height, uint32_t levelCount) {
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	int32_t mipWidth = width;
+	int32_t mipHeight = height;
+
+	for (uint32_t level = 1; level < levelCount; ++level) {
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+							 0, nullptr, 0, nullptr, 1, &barrier);
+
+		int32_t nextWidth = std::max(1, mipWidth / 2);
+		int32_t nextHeight = std::max(1, mipHeight / 2);
+
+		VkImageBlit blit{};
+		blit.srcOffsets[0] = {0, 0, 0};
+		blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[0] = {0, 0, 0};
+		blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+
+		vkCmdBlitImage(commandBuffer,
+					   image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					   image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					   1, &blit, VK_FILTER_LINEAR);
+
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+							 0, nullptr, 0, nullptr, 1, &barrier);
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+
+	// The last level was only ever written to:
+	barrier.subresourceRange.baseMipLevel = levelCount - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+						 0, nullptr, 0, nullptr, 1, &barrier);
+
+	endSingleTimeCommands(commandBuffer);
+}
+
+bool Texture::supportsLinearBlit(VkFormat format) {
+	VkFormatProperties props;
+	vkGetPhysicalDeviceFormatProperties(device->getPhysicalDevice(), format, &props);
+	const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+										| VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (props.optimalTilingFeatures & required) == required;
+}
+
+bool Texture::supportsSampling(VkFormat format) {
+	VkFormatProperties props;
+	vkGetPhysicalDeviceFormatProperties(device->getPhysicalDevice(), format, &props);
+	return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
 void Texture::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
 						   VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
 	// Create buffer using Vulkan directly:
@@ -369,7 +906,14 @@ uint32_t Texture::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags prop
 	return device->findMemoryType(typeFilter, properties);
 }
 
+// (within replaceImage(), commands go into its batch instead, submitted once it's all recorded)
 VkCommandBuffer Texture::beginSingleTimeCommands() {
+	if (batchCommands != VK_NULL_HANDLE)
+		return batchCommands;
+	return allocateCommandBuffer();
+}
+
+VkCommandBuffer Texture::allocateCommandBuffer() {
 	VkCommandBufferAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -389,6 +933,8 @@ VkCommandBuffer Texture::beginSingleTimeCommands() {
 }
 
 void Texture::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
+	if (commandBuffer == batchCommands)
+		return;
 	vkEndCommandBuffer(commandBuffer);
 
 	VkSubmitInfo submitInfo{};
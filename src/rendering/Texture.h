@@ -1,9 +1,17 @@
 #pragma once
 
+#include "TextureCompressor.h"
 #include <vulkan/vulkan.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class VulkanDevice;
+class TextureManager;
 
 class Texture {
 public:
@@ -18,6 +26,51 @@ public:
 	VkSampler getSampler() const { return textureSampler; }
 
 	bool isLoaded() const { return loaded; }
+	uint32_t getMipLevels() const { return mipLevels; }
+	VkDeviceSize getMemorySize() const { return memorySize; }
+
+	// Mip streaming - only block-compressed textures (whose chains are in the texture cache) are streamable.
+	//	Their image holds just the levels from the resident base level down, so sampling never goes finer.
+	bool isStreamable() const { return streamable; }
+	const std::string& getSourcePath() const { return sourcePath; }
+	bool isFlipped() const { return flipped; }
+	uint32_t getWidth() const { return width; }			// (of level 0, whether resident or not)
+	uint32_t getHeight() const { return height; }
+	uint32_t getFullMipLevels() const { return fullMipLevels; }
+	uint32_t getResidentBaseLevel() const { return residentBaseLevel; }
+	uint32_t getTailLevel() const { return tailLevel; }	// (coarsest base level; never evicted past)
+	VkDeviceSize getResidentBytes() const { return memorySize; }
+	VkDeviceSize estimateResidentBytes(uint32_t baseLevel) const;
+
+	// Replace the image with levels [baseLevel, end) of the full chain, uploaded from the given one
+	//	(streaming in) or copied from the current image (evicting). Neither waits: the commands go to
+	//	the graphics queue ahead of the next frame's, and the old image (which frames in flight may
+	//	still sample, and the copy reads) is retired, destroyed by releaseRetired() once they're done.
+	//	Descriptors holding the old view must be replaced, not rewritten, for the same reason.
+	bool streamIn(const CompressedImage& image, uint32_t baseLevel);
+	bool evictTo(uint32_t baseLevel);
+	void releaseRetired();		// (call once per frame; destroys those no frame in flight can use)
+
+	// Take the sampler from the manager's shared cache rather than creating (and owning) one.
+	void setManager(TextureManager* textureManager) { manager = textureManager; }
+
+	// Requested anisotropy (clamped to the device limit); 1 or less disables it.
+	static void setMaxAnisotropy(float anisotropy) { requestedAnisotropy = anisotropy; }
+
+	// Upload block-compressed mip chains (from the texture cache) where the device supports them.
+	static void setCompressionEnabled(bool enable) { compressionEnabled = enable; }
+
+	// Read (or encode) a file's compressed mip chain ahead of loading it, from any thread - no device
+	//	needed - so loadFromFile() just uploads it. On a cache miss, opaque images are encoded (as BC1,
+	//	whatever the device); images with alpha are only decoded, since whether they're BC7 or BC3
+	//	depends on the device, so loadFromFile() compresses them. Does nothing with compression
+	//	disabled. clearPrefetched() drops any left unused.
+	static void prefetch(const std::string& filename, bool flipVertically = false);
+	static void clearPrefetched();
+
+	// Streamable textures load with only the levels at most this many texels across resident,
+	//	leaving finer ones to be streamed in as needed. 0 loads every level.
+	static void setStreamingTailSize(uint32_t maxDimension) { streamingTailSize = maxDimension; }
 
 	// Static default texture for models without textures
 	static Texture* getDefaultTexture(VulkanDevice& device, class VulkanEngine& engine);
@@ -31,18 +84,77 @@ private:
 	VulkanDevice* device;
 	class VulkanEngine* engine;
 	bool loaded;
+	uint32_t mipLevels;
+	VkFormat textureFormat;
+	VkDeviceSize memorySize;
+	TextureManager* manager;
+
+	// Streaming state
+	bool streamable;
+	std::string sourcePath;
+	bool flipped;
+	BlockFormat blockFormat;
+	uint32_t width;
+	uint32_t height;
+	uint32_t fullMipLevels;
+	uint32_t residentBaseLevel;
+	uint32_t tailLevel;
+
+	// Images replaced by streaming, with what uploaded their successors, until no frame in flight can
+	//	use them. A replacement's commands are recorded into one command buffer (batchCommands) and
+	//	submitted without waiting.
+	struct RetiredImage {
+		VkImage image;
+		VkDeviceMemory memory;
+		VkImageView view;
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		VkCommandBuffer commandBuffer;
+		uint64_t frameNumber;		// (retired before this frame was submitted)
+	};
+	std::deque<RetiredImage> retiredImages;
+	VkCommandBuffer batchCommands;
+	VkBuffer batchStagingBuffer;
+	VkDeviceMemory batchStagingBufferMemory;
 
 	static Texture* defaultTexture;
+	static float requestedAnisotropy;
+	static bool compressionEnabled;
+	static uint32_t streamingTailSize;
+
+	// A prefetched image: compressed, or (with alpha, on a cache miss) just decoded
+	struct PrefetchedImage {
+		CompressedImage compressed;		// (no levels if not)
+		std::vector<uint8_t> pixels;	// (RGBA8, if not compressed)
+		int width = 0;
+		int height = 0;
+	};
+	static std::mutex prefetchMutex;
+	static std::unordered_map<std::string, std::shared_ptr<PrefetchedImage>> prefetched;	// (null while in progress)
+	static std::string prefetchKey(const std::string& filename, bool flipVertically);
+	static std::shared_ptr<PrefetchedImage> takePrefetched(const std::string& filename, bool flipVertically);
 
 	bool createDefaultWhiteTexture();
 	void createTextureImage(unsigned char* pixels, int width, int height);
+	bool loadCompressed(const std::string& filename, bool flipVertically);
+	void createCompressedTextureImage(const CompressedImage& image, uint32_t baseLevel = 0);
+	void copyLevelsFrom(VkImage sourceImage, uint32_t sourceLevel);
+	bool replaceImage(const char* action, const std::function<void()>& createLevels);
+	void destroyImage(VkImage image, VkDeviceMemory memory, VkImageView view);
+	void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage);
 	std::vector<unsigned char> flipImageVertically(unsigned char* pixels, int width, int height, int bytesPerPixel);
 	void createTextureImageView();
 	void createTextureSampler();
-	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
-	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
+							   uint32_t levelCount = 1);
+	void copyBufferToImage(VkBuffer buffer, VkImage image, const std::vector<MipLevel>& levels);
+	void generateMipmaps(VkImage image, int32_t width, int32_t height, uint32_t levelCount);
+	bool supportsLinearBlit(VkFormat format);
+	bool supportsSampling(VkFormat format);
 	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 	VkCommandBuffer beginSingleTimeCommands();
 	void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+	VkCommandBuffer allocateCommandBuffer();
+	void destroyRetired(const RetiredImage& retired);
 };
\ No newline at end of file
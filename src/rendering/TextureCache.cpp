@@ -0,0 +1,274 @@
+#include "TextureCache.h"
+#include "../utils/logger/Logging.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+std::string TextureCache::directory = "cache/textures";
+
+namespace {
+	const uint8_t ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+#pragma pack(push, 1)		// (the 64-bit fields sit at a 4-byte-aligned offset in the file)
+	struct Ktx2Header {
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+
+	struct Ktx2LevelIndex {
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+#pragma pack(pop)
+
+	bool blockFormatFromVulkan(uint32_t vkFormat, BlockFormat& format) {
+		for (BlockFormat candidate : { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC7 }) {
+			if (static_cast<uint32_t>(TextureCompressor::vulkanFormat(candidate)) == vkFormat) {
+				format = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// (levels down to 1x1; 0 for an empty image)
+	uint32_t fullMipLevels(uint32_t width, uint32_t height) {
+		uint32_t levels = 0;
+		for (uint32_t size = std::max(width, height); size > 0; size >>= 1)
+			++levels;
+		return levels;
+	}
+
+	// FNV-1a, 64-bit: unlike std::hash, the same for every standard library, so cache file names are too
+	uint64_t fnv1a(const std::string& text) {
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (unsigned char c : text) {
+			hash ^= c;
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+}
+
+bool TextureCache::encodeFile(const std::string& sourcePath, bool flipVertically, bool preferBC7,
+							  CompressedImage& image) {
+	std::vector<uint8_t> pixels;
+	int width, height;
+	if (!decodeFile(sourcePath, flipVertically, pixels, width, height))
+		return false;
+	encodePixels(pixels, width, height, preferBC7, image);
+	return true;
+}
+
+bool TextureCache::decodeFile(const std::string& sourcePath, bool flipVertically, std::vector<uint8_t>& pixels,
+							  int& width, int& height) {
+	SDL_Surface* surface = IMG_Load(sourcePath.c_str());
+	if (!surface) {
+		Log(WARN, "TextureCache: can't load %s: %s", sourcePath.c_str(), IMG_GetError());
+		return false;
+	}
+	if (surface->format->format != SDL_PIXELFORMAT_ABGR8888) {
+		SDL_Surface* rgbaSurface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ABGR8888, 0);
+		SDL_FreeSurface(surface);
+		if (!rgbaSurface) {
+			Log(WARN, "TextureCache: can't convert %s to ABGR: %s", sourcePath.c_str(), SDL_GetError());
+			return false;
+		}
+		surface = rgbaSurface;
+	}
+
+	width = surface->w;
+	height = surface->h;
+	pixels.resize(static_cast<size_t>(width) * height * 4);
+	const uint8_t* rows = static_cast<const uint8_t*>(surface->pixels);
+	for (int y = 0; y < height; ++y) {		// (also drops any row padding in the surface's pitch)
+		int srcY = flipVertically ? height - 1 - y : y;
+		memcpy(&pixels[static_cast<size_t>(y) * width * 4], rows + static_cast<size_t>(srcY) * surface->pitch,
+			   static_cast<size_t>(width) * 4);
+	}
+	SDL_FreeSurface(surface);
+	return true;
+}
+
+void TextureCache::encodePixels(const std::vector<uint8_t>& pixels, int width, int height, bool preferBC7,
+								CompressedImage& image) {
+	BlockFormat format = BlockFormat::BC1;
+	if (TextureCompressor::hasAlpha(pixels.data(), width, height))
+		format = preferBC7 ? BlockFormat::BC7 : BlockFormat::BC3;
+
+	std::vector<MipLevel> levels;
+	std::vector<uint8_t> chain = TextureCompressor::buildMipChain(pixels.data(), width, height, levels);
+	image = TextureCompressor::compress(chain, levels, format);
+}
+
+bool TextureCache::load(const std::string& sourcePath, bool flipVertically, CompressedImage& image) {
+	namespace fs = std::filesystem;
+	std::string cachePath = cachePathFor(sourcePath, flipVertically);
+	std::error_code error;
+	if (!fs::exists(cachePath, error))
+		return false;
+	if (fs::exists(sourcePath, error)
+	 && fs::last_write_time(sourcePath, error) > fs::last_write_time(cachePath, error)) {
+		Log(LOW, "TextureCache: %s is stale", cachePath.c_str());
+		return false;
+	}
+	return readKtx2(cachePath, image);
+}
+
+bool TextureCache::store(const std::string& sourcePath, bool flipVertically, const CompressedImage& image) {
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		Log(WARN, "TextureCache: can't create %s: %s", directory.c_str(), error.message().c_str());
+		return false;
+	}
+	return writeKtx2(cachePathFor(sourcePath, flipVertically), image);
+}
+
+bool TextureCache::readKtx2(const std::string& path, CompressedImage& image) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	uint8_t identifier[sizeof ktx2Identifier];
+	Ktx2Header header;
+	file.read(reinterpret_cast<char*>(identifier), sizeof identifier);
+	file.read(reinterpret_cast<char*>(&header), sizeof header);
+	if (!file || memcmp(identifier, ktx2Identifier, sizeof identifier) != 0 || header.levelCount == 0
+	 || header.levelCount > fullMipLevels(header.pixelWidth, header.pixelHeight)
+	 || header.supercompressionScheme != 0 || !blockFormatFromVulkan(header.vkFormat, image.format)) {
+		Log(WARN, "TextureCache: %s is not a usable KTX2 file", path.c_str());
+		return false;
+	}
+
+	std::vector<Ktx2LevelIndex> index(header.levelCount);
+	file.read(reinterpret_cast<char*>(index.data()), index.size() * sizeof(Ktx2LevelIndex));
+	if (!file) {
+		Log(WARN, "TextureCache: %s is truncated", path.c_str());
+		return false;
+	}
+
+	// Every level must hold exactly its blocks and lie within the file (so a corrupt index can't
+	//	cause a huge allocation, or levels too short for the upload to read).
+	std::error_code error;
+	uint64_t fileSize = std::filesystem::file_size(path, error);
+	if (error) {
+		return false;
+	}
+	size_t totalSize = 0;
+	for (uint32_t level = 0; level < header.levelCount; ++level) {
+		uint64_t width = std::max(1u, header.pixelWidth >> level);
+		uint64_t height = std::max(1u, header.pixelHeight >> level);
+		uint64_t expectedSize = ((width + 3) / 4) * ((height + 3) / 4) * TextureCompressor::blockSize(image.format);
+		if (index[level].byteLength != expectedSize || index[level].byteOffset > fileSize
+		 || index[level].byteLength > fileSize - index[level].byteOffset) {
+			Log(WARN, "TextureCache: %s has a corrupt level index", path.c_str());
+			return false;
+		}
+		totalSize += static_cast<size_t>(expectedSize);
+	}
+
+	image.width = header.pixelWidth;
+	image.height = header.pixelHeight;
+	image.levels.clear();
+
+	// Level 0 is stored last; repack largest-first so the chain matches what the encoder produces.
+	image.data.resize(totalSize);
+
+	size_t offset = 0;
+	for (uint32_t level = 0; level < header.levelCount; ++level) {
+		uint32_t width = std::max(1u, header.pixelWidth >> level);
+		uint32_t height = std::max(1u, header.pixelHeight >> level);
+		file.seekg(static_cast<std::streamoff>(index[level].byteOffset));
+		file.read(reinterpret_cast<char*>(&image.data[offset]), static_cast<std::streamsize>(index[level].byteLength));
+		image.levels.push_back({ offset, static_cast<size_t>(index[level].byteLength), width, height });
+		offset += index[level].byteLength;
+	}
+	if (!file) {
+		Log(WARN, "TextureCache: %s is truncated", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool TextureCache::writeKtx2(const std::string& path, const CompressedImage& image) {
+	// Write it whole alongside, then swap it in (rename replaces atomically, on the same filesystem),
+	//	so a crash or another process never leaves a torn file at path
+	std::string temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open() || !writeKtx2(file, image)) {
+			Log(WARN, "TextureCache: can't write %s", temporaryPath.c_str());
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		Log(WARN, "TextureCache: can't replace %s: %s", path.c_str(), error.message().c_str());
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
+
+bool TextureCache::writeKtx2(std::ostream& file, const CompressedImage& image) {
+	Ktx2Header header{};
+	header.vkFormat = static_cast<uint32_t>(TextureCompressor::vulkanFormat(image.format));
+	header.typeSize = 1;
+	header.pixelWidth = image.width;
+	header.pixelHeight = image.height;
+	header.faceCount = 1;
+	header.levelCount = static_cast<uint32_t>(image.levels.size());
+
+	// Level data goes smallest-first, each aligned to its block size.
+	const size_t alignment = TextureCompressor::blockSize(image.format);
+	size_t dataStart = sizeof ktx2Identifier + sizeof header + image.levels.size() * sizeof(Ktx2LevelIndex);
+	size_t offset = (dataStart + alignment - 1) / alignment * alignment;
+
+	std::vector<Ktx2LevelIndex> index(image.levels.size());
+	for (size_t level = image.levels.size(); level-- > 0; ) {
+		index[level] = { offset, image.levels[level].size, image.levels[level].size };
+		offset += image.levels[level].size;		// (block sizes keep every later level aligned)
+	}
+
+	file.write(reinterpret_cast<const char*>(ktx2Identifier), sizeof ktx2Identifier);
+	file.write(reinterpret_cast<const char*>(&header), sizeof header);
+	file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Ktx2LevelIndex));
+	std::vector<char> padding(static_cast<size_t>(index.back().byteOffset) - dataStart, 0);
+	file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+	for (size_t level = image.levels.size(); level-- > 0; ) {
+		file.write(reinterpret_cast<const char*>(&image.data[image.levels[level].offset]),
+				   static_cast<std::streamsize>(image.levels[level].size));
+	}
+	return static_cast<bool>(file);
+}
+
+std::string TextureCache::cachePathFor(const std::string& sourcePath, bool flipVertically) {
+	std::error_code error;
+	std::filesystem::path canonical = std::filesystem::weakly_canonical(sourcePath, error);
+	std::string key = (error ? sourcePath : canonical.string()) + (flipVertically ? "|flipped" : "");
+
+	std::ostringstream name;
+	name << std::filesystem::path(sourcePath).stem().string() << "-"
+		 << std::hex << std::setw(16) << std::setfill('0') << fnv1a(key) << ".ktx2";
+	return (std::filesystem::path(directory) / name.str()).string();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "TextureCompressor.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * On-disk cache of block-compressed mip chains, one file per source image.
+ * Files follow the KTX2 layout (identifier, header, level index, level data
+ *	smallest-first), without a data format descriptor or key/value data,
+ *	so they're only meant to be read back by this class.
+ * A cached file is considered stale once its source image is newer.
+ */
+class TextureCache {
+public:
+	// Decode an image file (via SDL_image) to RGBA8 and compress its full mip chain.
+	//	Picks BC1 for opaque images, otherwise BC7 (or BC3 if preferBC7 is false).
+	static bool encodeFile(const std::string& sourcePath, bool flipVertically, bool preferBC7,
+						   CompressedImage& image);
+
+	// The two halves of encodeFile(): decoding to tightly packed RGBA8, and compressing that
+	static bool decodeFile(const std::string& sourcePath, bool flipVertically, std::vector<uint8_t>& pixels,
+						   int& width, int& height);
+	static void encodePixels(const std::vector<uint8_t>& pixels, int width, int height, bool preferBC7,
+							 CompressedImage& image);
+
+	static bool load(const std::string& sourcePath, bool flipVertically, CompressedImage& image);
+	static bool store(const std::string& sourcePath, bool flipVertically, const CompressedImage& image);
+
+	static bool readKtx2(const std::string& path, CompressedImage& image);
+	static bool writeKtx2(const std::string& path, const CompressedImage& image);	// (via a temporary file, renamed over path)
+
+	static std::string cachePathFor(const std::string& sourcePath, bool flipVertically);
+
+	static void setDirectory(const std::string& path) { directory = path; }
+	static const std::string& getDirectory() { return directory; }
+
+private:
+	static bool writeKtx2(std::ostream& file, const CompressedImage& image);
+
+	static std::string directory;
+};
@@ -0,0 +1,347 @@
+#include "TextureCompressor.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+uint32_t TextureCompressor::calculateMipLevels(int width, int height) {
+	return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+// 2x2 box filter per level, averaging color in linear space (the image is sRGB-encoded,
+//	so averaging the raw bytes would darken each successive level).  Returns the packed chain.
+std::vector<uint8_t> TextureCompressor::buildMipChain(const uint8_t* pixels, int width, int height,
+													  std::vector<MipLevel>& levels) {
+	// (built once, thread-safely, on first call - preload threads encode concurrently)
+	static const std::array<float, 256> toLinear = [] {
+		std::array<float, 256> table;
+		for (int i = 0; i < 256; ++i) {
+			float c = i / 255.0f;
+			table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		return table;
+	}();
+	auto toSRGB = [](float linear) {
+		float c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+		return static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+	};
+
+	uint32_t levelCount = calculateMipLevels(width, height);
+	levels.clear();
+	size_t totalSize = 0;
+	for (int w = width, h = height, level = 0; level < static_cast<int>(levelCount); ++level) {
+		size_t size = static_cast<size_t>(w) * h * 4;
+		levels.push_back({ totalSize, size, static_cast<uint32_t>(w), static_cast<uint32_t>(h) });
+		totalSize += size;
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+	}
+
+	std::vector<uint8_t> chain(totalSize);
+	memcpy(chain.data(), pixels, levels[0].size);
+
+	for (uint32_t level = 1; level < levelCount; ++level) {
+		const MipLevel& src = levels[level - 1];
+		const MipLevel& dst = levels[level];
+		const uint8_t* srcPixels = &chain[src.offset];
+		uint8_t* dstPixels = &chain[dst.offset];
+
+		for (uint32_t y = 0; y < dst.height; ++y) {
+			uint32_t y0 = std::min(y * 2, src.height - 1);
+			uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+			for (uint32_t x = 0; x < dst.width; ++x) {
+				uint32_t x0 = std::min(x * 2, src.width - 1);
+				uint32_t x1 = std::min(x * 2 + 1, src.width - 1);
+				const uint8_t* texels[4] = { &srcPixels[(y0 * src.width + x0) * 4], &srcPixels[(y0 * src.width + x1) * 4],
+											 &srcPixels[(y1 * src.width + x0) * 4], &srcPixels[(y1 * src.width + x1) * 4] };
+				uint8_t* out = &dstPixels[(y * dst.width + x) * 4];
+				for (int c = 0; c < 3; ++c) {
+					float sum = toLinear[texels[0][c]] + toLinear[texels[1][c]] + toLinear[texels[2][c]] + toLinear[texels[3][c]];
+					out[c] = toSRGB(sum * 0.25f);
+				}
+				out[3] = static_cast<uint8_t>((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+			}
+		}
+	}
+	return chain;
+}
+
+bool TextureCompressor::hasAlpha(const uint8_t* pixels, int width, int height) {
+	size_t texelCount = static_cast<size_t>(width) * height;
+	for (size_t i = 0; i < texelCount; ++i) {
+		if (pixels[i * 4 + 3] != 255)
+			return true;
+	}
+	return false;
+}
+
+CompressedImage TextureCompressor::compress(const std::vector<uint8_t>& chain, const std::vector<MipLevel>& levels,
+											BlockFormat format) {
+	CompressedImage image;
+	image.format = format;
+	image.width = levels.empty() ? 0 : levels[0].width;
+	image.height = levels.empty() ? 0 : levels[0].height;
+
+	const size_t bytesPerBlock = blockSize(format);
+	size_t totalSize = 0;
+	for (const MipLevel& level : levels) {
+		size_t size = ((level.width + 3) / 4) * ((level.height + 3) / 4) * bytesPerBlock;
+		image.levels.push_back({ totalSize, size, level.width, level.height });
+		totalSize += size;
+	}
+	image.data.resize(totalSize);
+
+	uint8_t texels[16 * 4];
+	for (size_t i = 0; i < levels.size(); ++i) {
+		const MipLevel& level = levels[i];
+		const uint8_t* pixels = &chain[level.offset];
+		uint8_t* block = &image.data[image.levels[i].offset];
+
+		for (uint32_t by = 0; by < level.height; by += 4) {
+			for (uint32_t bx = 0; bx < level.width; bx += 4) {
+				// Gather the 4x4 block, replicating edge texels for levels smaller than a block.
+				for (uint32_t y = 0; y < 4; ++y) {
+					uint32_t sy = std::min(by + y, level.height - 1);
+					for (uint32_t x = 0; x < 4; ++x) {
+						uint32_t sx = std::min(bx + x, level.width - 1);
+						memcpy(&texels[(y * 4 + x) * 4], &pixels[(sy * level.width + sx) * 4], 4);
+					}
+				}
+				switch (format) {
+					case BlockFormat::BC1:	encodeBC1(texels, block);	break;
+					case BlockFormat::BC3:	encodeBC3(texels, block);	break;
+					case BlockFormat::BC7:	encodeBC7(texels, block);	break;
+				}
+				block += bytesPerBlock;
+			}
+		}
+	}
+	return image;
+}
+
+VkFormat TextureCompressor::vulkanFormat(BlockFormat format) {
+	switch (format) {
+		case BlockFormat::BC1:	return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+		case BlockFormat::BC3:	return VK_FORMAT_BC3_SRGB_BLOCK;
+		case BlockFormat::BC7:	return VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+	return VK_FORMAT_UNDEFINED;
+}
+
+const char* TextureCompressor::formatName(BlockFormat format) {
+	switch (format) {
+		case BlockFormat::BC1:	return "BC1";
+		case BlockFormat::BC3:	return "BC3";
+		case BlockFormat::BC7:	return "BC7";
+	}
+	return "?";
+}
+
+
+// BC1/BC3 color: bounding-box endpoints (inset slightly to reduce error), RGB565, 2-bit indices.
+
+static uint16_t packRGB565(int r, int g, int b) {
+	return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+}
+
+static void unpackRGB565(uint16_t color, int* rgb) {
+	int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+void TextureCompressor::encodeColorBlock(const uint8_t* rgba, uint8_t* block) {
+	int minColor[3] = { 255, 255, 255 };
+	int maxColor[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < 3; ++c) {
+			minColor[c] = std::min(minColor[c], static_cast<int>(rgba[i * 4 + c]));
+			maxColor[c] = std::max(maxColor[c], static_cast<int>(rgba[i * 4 + c]));
+		}
+	}
+	for (int c = 0; c < 3; ++c) {
+		int inset = (maxColor[c] - minColor[c]) / 16;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	uint16_t color0 = packRGB565(maxColor[0], maxColor[1], maxColor[2]);
+	uint16_t color1 = packRGB565(minColor[0], minColor[1], minColor[2]);
+	if (color0 < color1)		// (color0 > color1 selects four-color mode)
+		std::swap(color0, color1);
+
+	uint32_t indices = 0;
+	if (color0 != color1) {
+		int palette[4][3];
+		unpackRGB565(color0, palette[0]);
+		unpackRGB565(color1, palette[1]);
+		for (int c = 0; c < 3; ++c) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		for (int i = 0; i < 16; ++i) {
+			int bestIndex = 0, bestError = INT32_MAX;
+			for (int p = 0; p < 4; ++p) {
+				int error = 0;
+				for (int c = 0; c < 3; ++c) {
+					int delta = rgba[i * 4 + c] - palette[p][c];
+					error += delta * delta;
+				}
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= static_cast<uint32_t>(bestIndex) << (i * 2);
+		}
+	}
+
+	block[0] = color0 & 0xFF;	block[1] = color0 >> 8;
+	block[2] = color1 & 0xFF;	block[3] = color1 >> 8;
+	for (int b = 0; b < 4; ++b)
+		block[4 + b] = static_cast<uint8_t>(indices >> (b * 8));
+}
+
+// BC3 alpha: min/max endpoints in eight-value mode, 3-bit indices.
+void TextureCompressor::encodeAlphaBlock(const uint8_t* rgba, uint8_t* block) {
+	int minAlpha = 255, maxAlpha = 0;
+	for (int i = 0; i < 16; ++i) {
+		minAlpha = std::min(minAlpha, static_cast<int>(rgba[i * 4 + 3]));
+		maxAlpha = std::max(maxAlpha, static_cast<int>(rgba[i * 4 + 3]));
+	}
+
+	uint64_t indices = 0;
+	if (maxAlpha != minAlpha) {
+		int palette[8] = { maxAlpha, minAlpha };
+		for (int p = 2; p < 8; ++p)
+			palette[p] = ((8 - p) * maxAlpha + (p - 1) * minAlpha) / 7;
+
+		for (int i = 0; i < 16; ++i) {
+			int bestIndex = 0, bestError = INT32_MAX;
+			for (int p = 0; p < 8; ++p) {
+				int error = std::abs(rgba[i * 4 + 3] - palette[p]);
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+		}
+	}
+
+	block[0] = static_cast<uint8_t>(maxAlpha);
+	block[1] = static_cast<uint8_t>(minAlpha);
+	for (int b = 0; b < 6; ++b)
+		block[2 + b] = static_cast<uint8_t>(indices >> (b * 8));
+}
+
+void TextureCompressor::encodeBC1(const uint8_t* rgba, uint8_t* block) {
+	encodeColorBlock(rgba, block);
+}
+
+void TextureCompressor::encodeBC3(const uint8_t* rgba, uint8_t* block) {
+	encodeAlphaBlock(rgba, block);
+	encodeColorBlock(rgba, block + 8);
+}
+
+
+// BC7 mode 6: one subset, RGBA 7.7.7.7 endpoints each with a p-bit, 4-bit indices.
+
+namespace {
+	struct BitWriter {
+		uint8_t* out;
+		uint32_t position = 0;
+
+		void write(uint32_t value, uint32_t bitCount) {
+			for (uint32_t i = 0; i < bitCount; ++i, ++position) {
+				if ((value >> i) & 1)
+					out[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+			}
+		}
+	};
+
+	const int bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Quantize an RGBA endpoint to 7 bits per channel plus one shared p-bit, choosing the p-bit with less error.
+	void quantizeEndpoint(const int* color, int* quantized, int& pBit) {
+		int bestError = INT32_MAX;
+		for (int p = 0; p < 2; ++p) {
+			int q[4], error = 0;
+			for (int c = 0; c < 4; ++c) {
+				q[c] = std::clamp((color[c] - p + 1) >> 1, 0, 127);
+				int delta = color[c] - ((q[c] << 1) | p);
+				error += delta * delta;
+			}
+			if (error < bestError) {
+				bestError = error;
+				pBit = p;
+				std::copy(q, q + 4, quantized);
+			}
+		}
+	}
+}
+
+void TextureCompressor::encodeBC7(const uint8_t* rgba, uint8_t* block) {
+	int minColor[4] = { 255, 255, 255, 255 };
+	int maxColor[4] = { 0, 0, 0, 0 };
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < 4; ++c) {
+			minColor[c] = std::min(minColor[c], static_cast<int>(rgba[i * 4 + c]));
+			maxColor[c] = std::max(maxColor[c], static_cast<int>(rgba[i * 4 + c]));
+		}
+	}
+
+	int endpoint[2][4], pBit[2];
+	quantizeEndpoint(minColor, endpoint[0], pBit[0]);
+	quantizeEndpoint(maxColor, endpoint[1], pBit[1]);
+
+	int decoded[2][4];
+	for (int e = 0; e < 2; ++e)
+		for (int c = 0; c < 4; ++c)
+			decoded[e][c] = (endpoint[e][c] << 1) | pBit[e];
+
+	int palette[16][4];
+	for (int p = 0; p < 16; ++p)
+		for (int c = 0; c < 4; ++c)
+			palette[p][c] = ((64 - bc7Weights4[p]) * decoded[0][c] + bc7Weights4[p] * decoded[1][c] + 32) >> 6;
+
+	int indices[16];
+	for (int i = 0; i < 16; ++i) {
+		int bestIndex = 0, bestError = INT32_MAX;
+		for (int p = 0; p < 16; ++p) {
+			int error = 0;
+			for (int c = 0; c < 4; ++c) {
+				int delta = rgba[i * 4 + c] - palette[p][c];
+				error += delta * delta;
+			}
+			if (error < bestError) {
+				bestError = error;
+				bestIndex = p;
+			}
+		}
+		indices[i] = bestIndex;
+	}
+
+	// The anchor (first) index is stored without its high bit, so it must be < 8: swap endpoints if not.
+	if (indices[0] & 8) {
+		for (int c = 0; c < 4; ++c)
+			std::swap(endpoint[0][c], endpoint[1][c]);
+		std::swap(pBit[0], pBit[1]);
+		for (int i = 0; i < 16; ++i)
+			indices[i] = 15 - indices[i];
+	}
+
+	memset(block, 0, 16);
+	BitWriter bits{ block };
+	bits.write(1 << 6, 7);					// mode 6
+	for (int c = 0; c < 4; ++c) {
+		bits.write(endpoint[0][c], 7);
+		bits.write(endpoint[1][c], 7);
+	}
+	bits.write(pBit[0], 1);
+	bits.write(pBit[1], 1);
+	bits.write(indices[0], 3);
+	for (int i = 1; i < 16; ++i)
+		bits.write(indices[i], 4);
+}
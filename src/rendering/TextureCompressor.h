@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * CPU-side texture processing: mip chain generation and block compression.
+ * Pure CPU (no device access), so it is shared by Texture's upload path
+ *	and the offline texture encoder tool.
+ */
+
+// One level within a tightly packed mip chain.
+struct MipLevel {
+	size_t offset;
+	size_t size;
+	uint32_t width;
+	uint32_t height;
+};
+
+enum class BlockFormat {
+	BC1,	// RGB, 4 bpp - opaque textures
+	BC3,	// RGBA, 8 bpp - interpolated alpha block + BC1 color
+	BC7		// RGBA, 8 bpp - mode 6 only, higher quality than BC3
+};
+
+// A block-compressed mip chain, as stored in the texture cache.
+struct CompressedImage {
+	BlockFormat format = BlockFormat::BC1;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<MipLevel> levels;
+	std::vector<uint8_t> data;
+};
+
+class TextureCompressor {
+public:
+	static uint32_t calculateMipLevels(int width, int height);
+
+	// Box-filter an RGBA8 (sRGB-encoded) image down to 1x1, averaging in linear space.
+	static std::vector<uint8_t> buildMipChain(const uint8_t* pixels, int width, int height,
+											  std::vector<MipLevel>& levels);
+
+	static bool hasAlpha(const uint8_t* pixels, int width, int height);
+
+	// Compress every level of an RGBA8 chain (as produced by buildMipChain).
+	static CompressedImage compress(const std::vector<uint8_t>& chain, const std::vector<MipLevel>& levels,
+									BlockFormat format);
+
+	static size_t blockSize(BlockFormat format) { return format == BlockFormat::BC1 ? 8 : 16; }
+	static VkFormat vulkanFormat(BlockFormat format);
+	static const char* formatName(BlockFormat format);
+
+	// Single 4x4 block encoders (input is 16 RGBA texels, row-major).
+	static void encodeBC1(const uint8_t* rgba, uint8_t* block);
+	static void encodeBC3(const uint8_t* rgba, uint8_t* block);
+	static void encodeBC7(const uint8_t* rgba, uint8_t* block);
+
+private:
+	static void encodeColorBlock(const uint8_t* rgba, uint8_t* block);
+	static void encodeAlphaBlock(const uint8_t* rgba, uint8_t* block);
+};
@@ -0,0 +1,98 @@
+#include "TextureManager.h"
+#include "Texture.h"
+#include "../vulkan/VulkanEngine.h"
+#include "../vulkan/VulkanDevice.h"
+#include "../utils/logger/Logging.h"
+#include <filesystem>
+#include <stdexcept>
+
+TextureManager::TextureManager(VulkanEngine& engine)
+	: engine(engine)
+	, textureRequests(0)
+	, textureHits(0)
+	, bytesSaved(0)
+	, samplerRequests(0)
+{ }
+
+TextureManager::~TextureManager() {
+	VkDevice device = engine.getDevice()->getLogicalDevice();
+	for (SamplerEntry& entry : samplers) {
+		vkDestroySampler(device, entry.sampler, nullptr);
+	}
+	samplers.clear();
+}
+
+std::shared_ptr<Texture> TextureManager::acquire(const std::string& path, bool flipVertically) {
+	++textureRequests;
+	std::string key = makeKey(path, flipVertically);
+
+	auto it = textures.find(key);
+	if (it != textures.end()) {
+		if (std::shared_ptr<Texture> existing = it->second.lock()) {
+			++textureHits;
+			bytesSaved += existing->getMemorySize();
+			Log(LOW, "TextureManager: reusing %s", key.c_str());
+			return existing;
+		}
+	}
+
+	auto texture = std::make_shared<Texture>();
+	texture->setManager(this);
+	if (!texture->loadFromFile(path, *engine.getDevice(), engine, flipVertically)) {
+		return nullptr;
+	}
+	textures[key] = texture;
+	return texture;
+}
+
+VkSampler TextureManager::getSampler(const VkSamplerCreateInfo& samplerInfo) {
+	++samplerRequests;
+	for (const SamplerEntry& entry : samplers) {
+		if (sameSamplerState(entry.state, samplerInfo)) {
+			return entry.sampler;
+		}
+	}
+
+	SamplerEntry entry;
+	entry.state = samplerInfo;
+	entry.state.pNext = nullptr;
+	if (vkCreateSampler(engine.getDevice()->getLogicalDevice(), &samplerInfo,
+						nullptr, &entry.sampler) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create texture sampler");
+	}
+	samplers.push_back(entry);
+	return entry.sampler;
+}
+
+size_t TextureManager::getTextureCount() const {
+	size_t live = 0;
+	for (const auto& entry : textures) {
+		if (!entry.second.expired())
+			++live;
+	}
+	return live;
+}
+
+void TextureManager::logReport() const {
+	size_t imagesSaved = textureHits;		// (each also saves its VkImageView and device memory)
+	size_t samplersSaved = samplerRequests - samplers.size();
+	Log(NOTE, "TextureManager: %zu requests -> %zu textures, %zu samplers; saved %zu images + views, "
+			  "%zu samplers, %.1f KB device memory",
+		textureRequests, getTextureCount(), samplers.size(), imagesSaved, samplersSaved, bytesSaved / 1024.0f);
+}
+
+std::string TextureManager::makeKey(const std::string& path, bool flipVertically) {
+	std::error_code error;
+	std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+	return (error ? path : canonical.string()) + (flipVertically ? "|flipped" : "");
+}
+
+bool TextureManager::sameSamplerState(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b) {
+	return a.flags == b.flags
+		&& a.magFilter == b.magFilter && a.minFilter == b.minFilter && a.mipmapMode == b.mipmapMode
+		&& a.addressModeU == b.addressModeU && a.addressModeV == b.addressModeV && a.addressModeW == b.addressModeW
+		&& a.mipLodBias == b.mipLodBias && a.anisotropyEnable == b.anisotropyEnable && a.maxAnisotropy == b.maxAnisotropy
+		&& a.compareEnable == b.compareEnable && a.compareOp == b.compareOp
+		&& a.minLod == b.minLod && a.maxLod == b.maxLod
+		&& a.borderColor == b.borderColor && a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Texture;
+class VulkanEngine;
+
+/**
+ * Hands out shared Texture handles, deduplicated by canonical path and load options,
+ *	so models referencing the same image share one VkImage/VkImageView.
+ * Also owns a small cache of VkSamplers keyed by sampler state, which textures
+ *	created through it use instead of creating their own.
+ * Entries are held weakly: a texture is released once its last handle goes away.
+ */
+class TextureManager {
+public:
+	TextureManager(VulkanEngine& engine);
+	~TextureManager();
+
+	std::shared_ptr<Texture> acquire(const std::string& path, bool flipVertically = false);
+
+	// Returns an existing sampler with identical state, or creates one (owned by this cache).
+	VkSampler getSampler(const VkSamplerCreateInfo& samplerInfo);
+
+	size_t getTextureCount() const;
+	size_t getSamplerCount() const { return samplers.size(); }
+
+	void logReport() const;
+
+private:
+	struct SamplerEntry {
+		VkSamplerCreateInfo state;
+		VkSampler sampler;
+	};
+
+	static std::string makeKey(const std::string& path, bool flipVertically);
+	static bool sameSamplerState(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b);
+
+	VulkanEngine& engine;
+
+	std::unordered_map<std::string, std::weak_ptr<Texture>> textures;
+	std::vector<SamplerEntry> samplers;
+
+	// Statistics for logReport()
+	size_t textureRequests;
+	size_t textureHits;
+	VkDeviceSize bytesSaved;
+	size_t samplerRequests;
+};
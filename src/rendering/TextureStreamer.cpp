@@ -0,0 +1,230 @@
+#include "TextureStreamer.h"
+#include "Texture.h"
+#include "TextureCache.h"
+#include "../utils/logger/Logging.h"
+#include "../utils/Trace.h"
+#include <algorithm>
+#include <vector>
+
+const VkDeviceSize TextureStreamer::DEFAULT_BUDGET;
+const uint32_t TextureStreamer::NOT_WANTED;
+
+TextureStreamer::TextureStreamer(VkDeviceSize budgetBytes)
+	: budget(budgetBytes)
+	, maxUploadsPerFrame(2)
+	, frameNumber(0)
+	, stopping(false)
+	, uploads(0)
+	, evictions(0)
+	, bytesStreamedIn(0)
+	, bytesEvicted(0)
+{
+	worker = std::thread(&TextureStreamer::workerLoop, this);
+}
+
+TextureStreamer::~TextureStreamer() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	if (worker.joinable())
+		worker.join();
+}
+
+void TextureStreamer::requestLevel(const std::shared_ptr<Texture>& texture, uint32_t level) {
+	if (!texture || !texture->isStreamable())
+		return;
+
+	Entry fresh{ texture, NOT_WANTED, 0, false, false };
+	auto [it, inserted] = entries.try_emplace(texture.get(), fresh);
+	if (!inserted && it->second.texture.expired())
+		it->second = fresh;		// (a new texture at a released one's address)
+
+	Entry& entry = it->second;
+	entry.wantedLevel = std::min(entry.wantedLevel, std::min(level, texture->getFullMipLevels() - 1));
+	entry.lastUsedFrame = frameNumber;
+}
+
+bool TextureStreamer::update() {
+	++frameNumber;
+	changedTextures.clear();
+
+	for (auto it = entries.begin(); it != entries.end(); ) {
+		if (std::shared_ptr<Texture> texture = it->second.texture.lock()) {
+			texture->releaseRetired();		// (images replaced frames ago)
+			++it;
+		} else {
+			it = entries.erase(it);
+		}
+	}
+
+	// Upload chains the worker has loaded - only a few per frame, to bound each frame's transfer work.
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		while (!results.empty()) {
+			ready.push_back(std::move(results.front()));
+			results.pop_front();
+		}
+	}
+	for (uint32_t uploaded = 0; !ready.empty() && uploaded < maxUploadsPerFrame; ) {
+		LoadResult result = std::move(ready.front());
+		ready.pop_front();
+		if (applyLoad(result))
+			++uploaded;
+	}
+
+	// Load chains for textures drawn finer than what's resident.
+	for (auto& [key, entry] : entries) {
+		std::shared_ptr<Texture> texture = entry.texture.lock();
+		if (texture && entry.wantedLevel < texture->getResidentBaseLevel() && !entry.loading && !entry.failed) {
+			entry.loading = true;
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back({ key, texture->getSourcePath(), texture->isFlipped() });
+			jobAvailable.notify_one();
+		}
+	}
+
+	VkDeviceSize resident = getResidentBytes();
+	if (resident > budget)
+		evict(resident - budget, nullptr);
+
+	for (auto& [key, entry] : entries)
+		entry.wantedLevel = NOT_WANTED;		// (re-requested by whatever draws next frame)
+	return !changedTextures.empty();
+}
+
+// Streams in the level the texture was last drawn needing (which may have changed since its load
+//	was queued), making room under the budget - or settling for a coarser level if there isn't any.
+bool TextureStreamer::applyLoad(LoadResult& result) {
+	auto it = entries.find(result.key);
+	if (it == entries.end())
+		return false;
+	Entry& entry = it->second;
+	std::shared_ptr<Texture> texture = entry.texture.lock();
+	if (!texture || !entry.loading || result.path != texture->getSourcePath())
+		return false;
+	entry.loading = false;
+
+	if (!result.loaded) {
+		Log(WARN, "TextureStreamer: no cached chain for %s; leaving it at level %u",
+			texture->getSourcePath().c_str(), texture->getResidentBaseLevel());
+		entry.failed = true;
+		return false;
+	}
+
+	uint32_t baseLevel = texture->getResidentBaseLevel();
+	uint32_t level = entry.wantedLevel;
+	if (level >= baseLevel)
+		return false;		// (no longer drawn, or no longer needs it)
+
+	VkDeviceSize currentSize = texture->estimateResidentBytes(baseLevel);
+	VkDeviceSize resident = getResidentBytes();
+	VkDeviceSize growth = texture->estimateResidentBytes(level) - currentSize;
+	if (resident + growth > budget)
+		resident -= std::min(resident, evict(resident + growth - budget, texture.get()));
+	while (level < baseLevel && resident + texture->estimateResidentBytes(level) - currentSize > budget)
+		++level;
+	if (level >= baseLevel) {
+		Log(LOW, "TextureStreamer: over budget, %s stays at level %u", texture->getSourcePath().c_str(), baseLevel);
+		return false;
+	}
+
+	VkDeviceSize before = texture->getResidentBytes();
+	if (!texture->streamIn(result.image, level)) {
+		entry.failed = true;
+		return false;
+	}
+	++uploads;
+	bytesStreamedIn += texture->getResidentBytes() - std::min(before, texture->getResidentBytes());
+	changedTextures.push_back(texture.get());
+	return true;
+}
+
+// Frees at least bytesNeeded (if it can) by dropping fine levels: first from textures that weren't
+//	drawn last frame, least recently drawn first, down to their tail; then from those resident finer
+//	than they were drawn. Returns the bytes actually freed.
+VkDeviceSize TextureStreamer::evict(VkDeviceSize bytesNeeded, const Texture* keep) {
+	struct Candidate {
+		std::shared_ptr<Texture> texture;
+		uint32_t coarsestLevel;		// (how far it may go)
+		bool drawn;
+		uint64_t lastUsedFrame;
+	};
+	std::vector<Candidate> candidates;
+	for (auto& [key, entry] : entries) {
+		std::shared_ptr<Texture> texture = entry.texture.lock();
+		if (!texture || key == keep)
+			continue;
+		bool drawn = entry.wantedLevel != NOT_WANTED;
+		uint32_t coarsestLevel = drawn ? std::min(entry.wantedLevel, texture->getTailLevel()) : texture->getTailLevel();
+		if (texture->getResidentBaseLevel() < coarsestLevel)
+			candidates.push_back({ texture, coarsestLevel, drawn, entry.lastUsedFrame });
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		return a.drawn != b.drawn ? !a.drawn : a.lastUsedFrame < b.lastUsedFrame;
+	});
+
+	VkDeviceSize freed = 0;
+	for (Candidate& candidate : candidates) {
+		if (freed >= bytesNeeded)
+			break;
+
+		// Drop just enough of this texture's levels, or as many as it can spare.
+		Texture& texture = *candidate.texture;
+		VkDeviceSize currentSize = texture.estimateResidentBytes(texture.getResidentBaseLevel());
+		uint32_t level = texture.getResidentBaseLevel() + 1;
+		while (level < candidate.coarsestLevel && currentSize - texture.estimateResidentBytes(level) < bytesNeeded - freed)
+			++level;
+
+		VkDeviceSize before = texture.getResidentBytes();
+		if (texture.evictTo(level)) {
+			VkDeviceSize released = before - std::min(before, texture.getResidentBytes());
+			freed += released;
+			bytesEvicted += released;
+			++evictions;
+			changedTextures.push_back(&texture);
+		}
+	}
+	return freed;
+}
+
+VkDeviceSize TextureStreamer::getResidentBytes() const {
+	VkDeviceSize total = 0;
+	for (const auto& [key, entry] : entries) {
+		if (std::shared_ptr<Texture> texture = entry.texture.lock())
+			total += texture->getResidentBytes();
+	}
+	return total;
+}
+
+void TextureStreamer::logReport() const {
+	Log(NOTE, "TextureStreamer: %zu textures, %.1f of %.1f MB resident; %u uploads (%.1f MB), %u evictions (%.1f MB)",
+		entries.size(), getResidentBytes() / (1024.0f * 1024.0f), budget / (1024.0f * 1024.0f),
+		uploads, bytesStreamedIn / (1024.0f * 1024.0f), evictions, bytesEvicted / (1024.0f * 1024.0f));
+}
+
+// Reads whole cached chains off disk; the main thread picks out the levels it needs.
+void TextureStreamer::workerLoop() {
+	Tracer::setThreadName("texture streamer");
+	while (true) {
+		LoadJob job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			if (stopping)
+				return;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		TRACE_SCOPE("TextureStreamer::load");
+		LoadResult result;
+		result.key = job.key;
+		result.path = job.path;
+		result.loaded = TextureCache::load(job.path, job.flipped, result.image);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		results.push_back(std::move(result));
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "TextureCompressor.h"
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Texture;
+
+/**
+ * Keeps the mip levels of streamable textures resident according to how large they appear on screen.
+ * Each frame the Renderer reports the finest level each textured draw needs (requestLevel), then
+ *	update() uploads chains that finished loading, queues disk loads from the texture cache (on a
+ *	worker thread) for textures needing finer levels than they have, and evicts fine levels that
+ *	aren't needed - least recently drawn first - while resident texture memory is over budget.
+ * Until a finer level arrives, sampling stays clamped to the finest resident one.
+ */
+class TextureStreamer {
+public:
+	TextureStreamer(VkDeviceSize budgetBytes = DEFAULT_BUDGET);
+	~TextureStreamer();
+
+	void setBudget(VkDeviceSize bytes) { budget = bytes; }
+	VkDeviceSize getBudget() const { return budget; }
+	void setMaxUploadsPerFrame(uint32_t count) { maxUploadsPerFrame = count; }
+
+	// This frame draws the texture with 'level' as the finest mip it will sample.
+	void requestLevel(const std::shared_ptr<Texture>& texture, uint32_t level);
+
+	// Call once per frame, before beginning it (uploads and evictions are submitted ahead of its
+	//	commands, without waiting). Returns true if any texture's image view changed, listing them in
+	//	getChangedTextures(): descriptors referencing them need replacing, since frames in flight may
+	//	still read the old ones.
+	bool update();
+	const std::vector<Texture*>& getChangedTextures() const { return changedTextures; }
+
+	VkDeviceSize getResidentBytes() const;
+	void logReport() const;
+
+	static const VkDeviceSize DEFAULT_BUDGET = 256ull * 1024 * 1024;
+
+private:
+	struct Entry {
+		std::weak_ptr<Texture> texture;
+		uint32_t wantedLevel;		// finest level requested since the last update (NOT_WANTED if none)
+		uint64_t lastUsedFrame;
+		bool loading;
+		bool failed;				// (cached chain unreadable; stop retrying)
+	};
+	struct LoadJob {
+		Texture* key;
+		std::string path;
+		bool flipped;
+	};
+	struct LoadResult {
+		Texture* key;
+		std::string path;
+		bool loaded;
+		CompressedImage image;
+	};
+
+	void workerLoop();
+	bool applyLoad(LoadResult& result);
+	VkDeviceSize evict(VkDeviceSize bytesNeeded, const Texture* keep);
+
+	VkDeviceSize budget;
+	uint32_t maxUploadsPerFrame;
+	uint64_t frameNumber;
+
+	std::unordered_map<Texture*, Entry> entries;
+	std::deque<LoadResult> ready;			// (loaded, waiting for an upload slot)
+
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::deque<LoadJob> jobs;
+	std::deque<LoadResult> results;
+	bool stopping;
+
+	// Statistics for logReport()
+	uint32_t uploads;
+	uint32_t evictions;
+	VkDeviceSize bytesStreamedIn;
+	VkDeviceSize bytesEvicted;
+
+	std::vector<Texture*> changedTextures;		// (by the last update)
+
+	static const uint32_t NOT_WANTED = UINT32_MAX;
+};
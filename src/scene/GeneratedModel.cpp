@@ -48,7 +48,7 @@ void GeneratedModel::initializeDefaults() {
 }
 
 std::unique_ptr<Model> GeneratedModel::createModel() const {
-	auto model = std::make_unique<Model>();
+	auto model = std::make_unique<Model>(transform);		// (moving the model moves this object)
 
 	// Generate the appropriate mesh based on shape
 	std::shared_ptr<Mesh> mesh;
@@ -74,9 +74,6 @@ std::unique_ptr<Model> GeneratedModel::createModel() const {
 	}
 
 	model->setMesh(mesh);
-	model->setPosition(position);
-	model->setRotation(rotation);
-	model->setScale(scale);
 
 	if (texture) {
 		model->setTexture(texture);
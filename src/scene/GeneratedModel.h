@@ -38,7 +38,7 @@ public:
 
 
 	GeneratedModel(Shape shape, const std::string& name);
-	GeneratedModel(Shape shape) : GeneratedModel(shape, std::string(name())) { }
+	GeneratedModel(Shape shape) : GeneratedModel(shape, Name[(int) shape]) { }	// (not name(): 'shape' isn't set yet)
 	virtual ~GeneratedModel() = default;
 
 	// SceneObject interface
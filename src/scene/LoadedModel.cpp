@@ -2,8 +2,7 @@
 #include "../geometry/Model.h"
 #include "../geometry/ObjLoader.h"
 #include "../rendering/Texture.h"
-#include "../vulkan/VulkanEngine.h"
-#include "../vulkan/VulkanDevice.h"
+#include "../rendering/TextureManager.h"
 #include "../utils/JsonSupport.h"
 #include "../utils/logger/Logging.h"
 
@@ -15,7 +14,7 @@ LoadedModel::LoadedModel(const std::string& filepath, const std::string& name)
 { }
 
 std::unique_ptr<Model> LoadedModel::createModel() const {
-	auto model = std::make_unique<Model>();
+	auto model = std::make_unique<Model>(transform);		// (moving the model moves this object)
 
 	if (filePath.empty()) {
 		Log(ERROR, "LoadedModel: No file path specified for %s", name.c_str());
@@ -23,23 +22,11 @@ std::unique_ptr<Model> LoadedModel::createModel() const {
 	}
 
 	try {
-		std::shared_ptr<Mesh> mesh = cachedMesh;
-
-		if (!mesh) {	// Load mesh if not cached:
-			ObjLoader loader(flipTextureY);
-			auto result = loader.loadWithMaterial(filePath);
-			mesh = result.mesh;
-			cachedMesh = mesh; // Cache for future use.
-
-			if (result.material.hasTexture()) {	// Store the material texture path for later loading.
-				materialTexturePath = result.material.diffuseTexture;
-			}
+		if (!cachedMesh) {	// Load mesh if not cached (or preloaded):
+			loadMesh();
 		}
 
-		model->setMesh(mesh);
-		model->setPosition(position);
-		model->setRotation(rotation);
-		model->setScale(scale);
+		model->setMesh(cachedMesh);
 
 		if (texture) {	// Apply texture if available.
 			model->setTexture(texture);
@@ -51,15 +38,56 @@ std::unique_ptr<Model> LoadedModel::createModel() const {
 	return model;
 }
 
-void LoadedModel::initializeTexture(VulkanDevice& device, VulkanEngine& engine) {
-	// Force reload of material information if needed.
-	if (materialTexturePath.empty() && !filePath.empty()) {
+// Parses the model file, caching its mesh and noting its material's texture (so createModel()
+//	needn't parse it again)
+void LoadedModel::loadMesh() const {
+	ObjLoader loader(flipTextureY);
+	auto result = loader.loadWithMaterial(filePath);
+	cachedMesh = result.mesh;
+
+	if (result.material.hasTexture()) {	// Store the material texture path for later loading.
+		materialTexturePath = result.material.diffuseTexture;
+	}
+}
+
+void LoadedModel::preload() {
+	if (filePath.empty() || cachedMesh)
+		return;
+	try {
+		loadMesh();
+	} catch (const std::exception& e) {
+		Log(ERROR, "LoadedModel: Failed to preload %s: %s", filePath.c_str(), e.what());
+		return;		// (createModel() will try again, and report it)
+	}
+	std::string texturePathToLoad = resolveTexturePath();
+	if (!texturePathToLoad.empty()) {
+		Texture::prefetch(texturePathToLoad);
+	}
+}
+
+// Priority: explicit texturePath > material texture > none
+std::string LoadedModel::resolveTexturePath() const {
+	if (!texturePath.empty()) {
+		return texturePath;
+	}
+	if (materialTexturePath.empty()) {
+		return "";
+	}
+	// Handle material texture path - could be relative or absolute.
+	if (materialTexturePath.find("assets/") == 0) {
+		// Path already includes assets/, use as-is:
+		return materialTexturePath;
+	}
+	// Relative path, resolve relative to model directory:
+	std::string modelDir = filePath.substr(0, filePath.find_last_of("/\\"));
+	return modelDir + "/" + materialTexturePath;
+}
+
+void LoadedModel::initializeTexture(TextureManager& textureManager) {
+	// Load material information if needed (unless preloaded), caching the mesh for createModel().
+	if (!cachedMesh && !filePath.empty()) {
 		try {
-			ObjLoader loader(flipTextureY);
-			auto result = loader.loadWithMaterial(filePath);
-			if (result.material.hasTexture()) {
-				materialTexturePath = result.material.diffuseTexture;
-			}
+			loadMesh();
 		} catch (const std::exception& e) {
 			Log(ERROR, "LoadedModel: Failed to reload material for %s: %s", name.c_str(), e.what());
 		}
@@ -68,27 +96,12 @@ void LoadedModel::initializeTexture(VulkanDevice& device, VulkanEngine& engine)
 	if (texture)  // Don't reload if texture is already set.
 		return;
 
-	std::string texturePathToLoad;
-
-	// Priority: explicit texturePath > material texture > none
-	if (!texturePath.empty()) {
-		texturePathToLoad = texturePath;
-	} else if (!materialTexturePath.empty()) {
-		// Handle material texture path - could be relative or absolute.
-		if (materialTexturePath.find("assets/") == 0) {
-			// Path already includes assets/, use as-is:
-			texturePathToLoad = materialTexturePath;
-		} else {
-			// Relative path, resolve relative to model directory:
-			std::string modelDir = filePath.substr(0, filePath.find_last_of("/\\"));
-			texturePathToLoad = modelDir + "/" + materialTexturePath;
-		}
-	}
+	std::string texturePathToLoad = resolveTexturePath();
 
 	if (!texturePathToLoad.empty()) {
 		try {
-			auto loadedTexture = std::make_shared<Texture>();
-			if (loadedTexture->loadFromFile(texturePathToLoad, device, engine)) {
+			auto loadedTexture = textureManager.acquire(texturePathToLoad);
+			if (loadedTexture) {
 				texture = loadedTexture;
 				Log(NOTE, "Loaded texture for %s: %s", name.c_str(), texturePathToLoad.c_str());
 			} else {
@@ -18,6 +18,9 @@ public:
 	void deserialize(const json& jsonData) override;
 	std::unique_ptr<SceneObject> clone() const override;
 
+	// Parses the model file (caching its mesh) and prefetches its texture's compressed image
+	void preload() override;
+
 	// LoadedModel-specific methods
 	const std::string& getFilePath() const { return filePath; }
 	void setFilePath(const std::string& path) { filePath = path; }
@@ -32,13 +35,16 @@ public:
 	void setFlipTextureY(bool flip) { flipTextureY = flip; }
 
 	// Texture initialization - should be called after VulkanDevice/Engine are available.
-	void initializeTexture(class VulkanDevice& device, class VulkanEngine& engine);
+	void initializeTexture(class TextureManager& textureManager);
 
 	// Cache management
 	bool isCached() const { return cachedMesh != nullptr; }
 	void clearCache() { cachedMesh.reset(); }
 
 private:
+	std::string resolveTexturePath() const;
+	void loadMesh() const;
+
 	std::string filePath;		// Path to the model file
 	std::string materialPath;	// Path to material file (if separate)
 	std::string texturePath;	// Override texture path (if not from material)
@@ -2,10 +2,22 @@
 #include "GeneratedModel.h"
 #include "LoadedModel.h"
 #include "../geometry/Model.h"
+#include "../math/TransformStore.h"
 #include "../utils/JsonSupport.h"
 #include "../utils/logger/Logging.h"
+#include "../utils/StartupTimeline.h"
+#include "../utils/Trace.h"
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <unordered_set>
+
+const uint32_t SceneManager::NO_NODE;
+const uint32_t SceneManager::MAX_PRELOAD_THREADS;
+
+SceneManager::~SceneManager() {
+	finishPreload();
+}
 
 void SceneManager::addObject(std::unique_ptr<SceneObject> object) {
 	if (!object)
@@ -17,6 +29,7 @@ void SceneManager::addObject(std::unique_ptr<SceneObject> object) {
 	object->setName(uniqueName);
 
 	objects.push_back(std::move(object));
+	hierarchyChanged = true;
 }
 
 void SceneManager::removeObject(const std::string& name) {
@@ -28,12 +41,35 @@ void SceneManager::removeObject(const std::string& name) {
 
 void SceneManager::removeObject(size_t index) {
 	if (index < objects.size()) {
+		detach(objects[index].get());
 		objects.erase(objects.begin() + index);
+		hierarchyChanged = true;
 	}
 }
 
 void SceneManager::clear() {
 	objects.clear();
+	parents.clear();
+	boundModels.clear();
+	nodes.clear();
+	hierarchyChanged = true;
+}
+
+// Before removing an object: its children move up to its parent (keeping their local transforms)
+void SceneManager::detach(const SceneObject* object) {
+	SceneObject* parent = getParent(object);
+	for (auto it = parents.begin(); it != parents.end(); ) {
+		if (it->second != object) {
+			++it;
+		} else if (parent) {
+			it->second = parent;
+			++it;
+		} else {
+			it = parents.erase(it);
+		}
+	}
+	parents.erase(object);
+	boundModels.erase(object);
 }
 
 SceneObject* SceneManager::findObject(const std::string& name) const {
@@ -48,7 +84,7 @@ SceneObject* SceneManager::getObject(size_t index) const {
 	return (index < objects.size()) ? objects[index].get() : nullptr;
 }
 
-std::vector<std::unique_ptr<Model>> SceneManager::createAllModels() const {
+std::vector<std::unique_ptr<Model>> SceneManager::createAllModels() {
 	std::vector<std::unique_ptr<Model>> models;
 	models.reserve(objects.size());
 
@@ -56,13 +92,201 @@ std::vector<std::unique_ptr<Model>> SceneManager::createAllModels() const {
 		if (object && object->isVisible()) {
 			auto model = object->createModel();
 			if (model) {
+				boundModels[object.get()] = model.get();
 				models.push_back(std::move(model));
 			}
 		}
 	}
+	hierarchyChanged = true;	// (so the next update hands every model its world matrix)
 	return models;
 }
 
+void SceneManager::startPreload(uint32_t threadCount) {
+	finishPreload();
+	if (objects.empty())
+		return;
+	threadCount = std::max(1u, std::min({ threadCount, MAX_PRELOAD_THREADS, static_cast<uint32_t>(objects.size()) }));
+
+	// Each thread claims the next object not yet taken, so a slow one doesn't hold up the rest.
+	auto nextObject = std::make_shared<std::atomic<size_t>>(0);
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		preloaders.emplace_back([this, nextObject, i] {
+			Tracer::setThreadName("scene preload " + std::to_string(i));
+			STARTUP_PHASE("preload scene objects");
+			for (size_t index = (*nextObject)++; index < objects.size(); index = (*nextObject)++) {
+				TRACE_SCOPE("SceneObject::preload");
+				objects[index]->preload();
+			}
+		});
+	}
+}
+
+void SceneManager::finishPreload() {
+	for (std::thread& preloader : preloaders) {
+		preloader.join();
+	}
+	preloaders.clear();
+}
+
+void SceneManager::unbindModels() {
+	boundModels.clear();
+	for (Node& node : nodes) {
+		node.model = nullptr;
+	}
+}
+
+bool SceneManager::setParent(SceneObject* child, SceneObject* parent) {
+	if (!child) {
+		return false;
+	}
+	for (const SceneObject* ancestor = parent; ancestor; ancestor = getParent(ancestor)) {
+		if (ancestor == child) {
+			Log(WARN, "SceneManager: %s can't be parented to %s, which is within its own subtree",
+				child->getName().c_str(), parent->getName().c_str());
+			return false;
+		}
+	}
+
+	if (parent) {
+		parents[child] = parent;
+	} else {
+		parents.erase(child);
+	}
+	hierarchyChanged = true;
+	return true;
+}
+
+SceneObject* SceneManager::getParent(const SceneObject* object) const {
+	auto it = parents.find(object);
+	return it != parents.end() ? it->second : nullptr;
+}
+
+std::vector<SceneObject*> SceneManager::getChildren(const SceneObject* object) const {
+	std::vector<SceneObject*> children;
+	for (const auto& each : objects) {
+		if (getParent(each.get()) == object) {
+			children.push_back(each.get());
+		}
+	}
+	return children;
+}
+
+// Lay the nodes out depth-first (only when objects or their parents change, so it can afford to touch them all)
+void SceneManager::rebuildHierarchy() {
+	std::unordered_map<const SceneObject*, std::vector<SceneObject*>> children;
+	for (const auto& object : objects) {
+		if (SceneObject* parent = getParent(object.get())) {
+			children[parent].push_back(object.get());
+		}
+	}
+
+	nodes.clear();
+	nodes.reserve(objects.size());
+	std::vector<std::pair<SceneObject*, int32_t>> pending;		// (object, parent node: iterative, as nesting may be deep)
+	for (const auto& root : objects) {
+		if (getParent(root.get())) {
+			continue;
+		}
+		pending.push_back({ root.get(), -1 });
+		while (!pending.empty()) {
+			auto [object, parent] = pending.back();
+			pending.pop_back();
+
+			int32_t index = static_cast<int32_t>(nodes.size());
+			auto model = boundModels.find(object);
+			nodes.push_back(Node{ object, parent, 1, model != boundModels.end() ? model->second : nullptr });
+
+			auto it = children.find(object);
+			if (it != children.end()) {
+				for (auto child = it->second.rbegin(); child != it->second.rend(); ++child) {
+					pending.push_back({ *child, index });		// (reversed, so they come out in order)
+				}
+			}
+		}
+	}
+
+	// Subtree sizes, accumulated from each node to its parent (backwards, since children follow parents)
+	for (size_t i = nodes.size(); i-- > 0; ) {
+		if (nodes[i].parent >= 0) {
+			nodes[nodes[i].parent].subtreeSize += nodes[i].subtreeSize;
+		}
+	}
+
+	nodeOfSlot.clear();
+	for (uint32_t i = 0; i < nodes.size(); ++i) {
+		uint32_t slot = nodes[i].object->getTransformHandle().slot;
+		if (slot >= nodeOfSlot.size()) {
+			nodeOfSlot.resize(slot + 1, NO_NODE);
+		}
+		nodeOfSlot[slot] = i;
+	}
+
+	worldMatrices.resize(nodes.size());
+	normalMatrices.resize(nodes.size());
+	hierarchyChanged = false;
+}
+
+size_t SceneManager::updateWorldTransforms() {
+	TransformStore& store = TransformStore::shared();
+	store.update();
+
+	if (hierarchyChanged) {
+		rebuildHierarchy();
+		updateNodes(0, static_cast<uint32_t>(nodes.size()));
+		return nodes.size();
+	}
+
+	// Each object whose own transform changed roots a subtree to recompute; in node order, subtrees
+	//	within one already recomputed are skipped, so no node is visited twice.
+	changedNodes.clear();
+	for (uint32_t entry : store.getUpdatedEntries()) {
+		uint32_t slot = store.handleOf(entry).slot;
+		if (slot < nodeOfSlot.size() && nodeOfSlot[slot] != NO_NODE) {
+			changedNodes.push_back(nodeOfSlot[slot]);
+		}
+	}
+	std::sort(changedNodes.begin(), changedNodes.end());
+
+	size_t updated = 0;
+	uint32_t end = 0;
+	for (uint32_t node : changedNodes) {
+		if (node < end) {
+			continue;
+		}
+		end = node + nodes[node].subtreeSize;
+		updateNodes(node, end);
+		updated += end - node;
+	}
+	return updated;
+}
+
+// World matrix of each node in [first, end): its parent's (already updated, being earlier) times its own
+void SceneManager::updateNodes(uint32_t first, uint32_t end) {
+	TransformStore& store = TransformStore::shared();
+	for (uint32_t i = first; i < end; ++i) {
+		const Node& node = nodes[i];
+		TransformHandle transform = node.object->getTransformHandle();
+		if (node.parent < 0) {
+			worldMatrices[i] = store.getWorldMatrix(transform);
+			normalMatrices[i] = store.getNormalMatrix(transform);
+		} else {
+			worldMatrices[i] = worldMatrices[node.parent] * store.getWorldMatrix(transform);
+			normalMatrices[i] = normalMatrices[node.parent] * store.getNormalMatrix(transform);
+		}
+		if (node.model) {
+			node.model->setWorldMatrix(worldMatrices[i], normalMatrices[i]);
+		}
+	}
+}
+
+const Matrix4& SceneManager::getWorldMatrix(const SceneObject* object) const {
+	uint32_t slot = object->getTransformHandle().slot;
+	if (!hierarchyChanged && slot < nodeOfSlot.size() && nodeOfSlot[slot] != NO_NODE) {
+		return worldMatrices[nodeOfSlot[slot]];
+	}
+	return TransformStore::shared().getWorldMatrix(object->getTransformHandle());	// (not laid out yet: a root, as far as known)
+}
+
 std::unique_ptr<Model> SceneManager::createModelForObject(const std::string& name) const {
 	SceneObject* object = findObject(name);
 	return object ? object->createModel() : nullptr;
@@ -70,22 +294,37 @@ std::unique_ptr<Model> SceneManager::createModelForObject(const std::string& nam
 
 json SceneManager::serialize() const {
 	json jsonData;
-	jsonData["version"] = "1.0";
+	jsonData["version"] = "1.1";	// (1.1: objects may have a "parent", its index in the objects array)
 	jsonData["objectCount"] = static_cast<double>(objects.size());
 
-	json objectArray;
+	std::unordered_map<const SceneObject*, int> arrayIndices;
+	for (const auto& object : objects) {
+		if (object) {
+			arrayIndices[object.get()] = static_cast<int>(arrayIndices.size());
+		}
+	}
+
+	json objectArray = json::array();	// (an array even when empty, which JSON_LITE needs told)
 	for (const auto& object : objects) {
 		if (object) {
-			objectArray.push_back(object->serialize());
+			json objectData = object->serialize();
+			if (SceneObject* parent = getParent(object.get())) {
+				objectData["parent"] = arrayIndices[parent];
+			}
+			objectArray.push_back(objectData);
 		}
 	}
 	jsonData["objects"] = objectArray;
+	if (pacing.size() > 0) {
+		jsonData["pacing"] = pacing;
+	}
 
 	return jsonData;
 }
 
 void SceneManager::deserialize(const json& jsonData) {
 	clear();
+	pacing = jsonData.contains("pacing") ? jsonData["pacing"] : json();
 
 	if (!jsonData.contains("objects") || !jsonData["objects"].is_array()) {
 		return;
@@ -93,6 +332,22 @@ void SceneManager::deserialize(const json& jsonData) {
 
 	// Iterate through objects and recreate them based on type.
 	const json& objectsArray = jsonData["objects"];
+	std::vector<SceneObject*> loaded(objectsArray.size(), nullptr);
+	objects.reserve(objectsArray.size());
+
+	// As addObject() would, but with the names so far in a set: its uniqueness check scans every
+	//	object, which for a whole file of them is quadratic (and hours, for a million)
+	std::unordered_set<std::string> names;
+	auto adopt = [&](std::unique_ptr<SceneObject> object) {
+		std::string uniqueName = object->getName();
+		for (int counter = 1; names.count(uniqueName) > 0; ++counter) {
+			uniqueName = object->getName() + "_" + std::to_string(counter);
+		}
+		object->setName(uniqueName);
+		names.insert(uniqueName);
+		objects.push_back(std::move(object));
+		hierarchyChanged = true;
+	};
 	for (size_t i = 0; i < objectsArray.size(); ++i) {
 		const json& objData = objectsArray[i];
 
@@ -106,15 +361,32 @@ void SceneManager::deserialize(const json& jsonData) {
 		if (typeStr == "GeneratedModel") {
 			auto generatedModel = std::make_unique<GeneratedModel>(GeneratedModel::Shape::CUBE);
 			generatedModel->deserialize(objData);
-			addObject(std::move(generatedModel));
+			loaded[i] = generatedModel.get();
+			adopt(std::move(generatedModel));
 		} else if (typeStr == "LoadedModel") {
 			auto loadedModel = std::make_unique<LoadedModel>("", "");
 			loadedModel->deserialize(objData);
-			addObject(std::move(loadedModel));
+			loaded[i] = loadedModel.get();
+			adopt(std::move(loadedModel));
 		} else {
 			Log(ERROR, "SceneManager: Unknown object type: %s", typeStr.c_str());
 		}
 	}
+
+	// Then link each to its parent (which may come after it in the array)
+	for (size_t i = 0; i < objectsArray.size(); ++i) {
+		const json& objData = objectsArray[i];
+		if (!loaded[i] || !objData.contains("parent")) {
+			continue;
+		}
+		int parentIndex = objData["parent"].get<int>();
+		if (parentIndex < 0 || static_cast<size_t>(parentIndex) >= loaded.size() || !loaded[parentIndex]) {
+			Log(ERROR, "SceneManager: %s has an invalid parent index %d, leaving it a root",
+				loaded[i]->getName().c_str(), parentIndex);
+			continue;
+		}
+		setParent(loaded[i], loaded[parentIndex]);
+	}
 }
 
 bool SceneManager::saveToFile(const std::string& filename) const {
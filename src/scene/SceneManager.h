@@ -5,6 +5,7 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include "../utils/JsonSupport.h"
 
@@ -21,7 +22,7 @@ class VulkanEngine;
 class SceneManager {
 public:
 	SceneManager() = default;
-	~SceneManager() = default;
+	~SceneManager();
 
 	// Scene object management
 	void addObject(std::unique_ptr<SceneObject> object);
@@ -38,9 +39,33 @@ public:
 	std::vector<std::unique_ptr<SceneObject>>::const_iterator begin() const { return objects.begin(); }
 	std::vector<std::unique_ptr<SceneObject>>::const_iterator end() const { return objects.end(); }
 
-	// Model creation for rendering
-	std::vector<std::unique_ptr<Model>> createAllModels() const;
+	// Hierarchy: an object with a parent is positioned relative to it, so moving the parent moves its
+	//	whole subtree. setParent(child, nullptr) makes it a root again. Returns false (changing nothing)
+	//	if parent is the object itself or one of its descendants.
+	bool setParent(SceneObject* child, SceneObject* parent);
+	SceneObject* getParent(const SceneObject* object) const;
+	std::vector<SceneObject*> getChildren(const SceneObject* object) const;
+
+	// Bring world matrices up to date: composes changed transforms (TransformStore::update()), then
+	//	recomputes only the subtrees under changed objects - untouched subtrees are skipped entirely -
+	//	handing models created for them their new world matrices. Call once per frame, before rendering.
+	//	Returns how many objects' world matrices were recomputed.
+	size_t updateWorldTransforms();
+	const Matrix4& getWorldMatrix(const SceneObject* object) const;	// (as of the last update)
+
+	// Model creation for rendering (createAllModels binds each model to its object's world matrix,
+	//	until unbindModels(), which must precede destroying the models)
+	std::vector<std::unique_ptr<Model>> createAllModels();
 	std::unique_ptr<Model> createModelForObject(const std::string& name) const;
+	void unbindModels();
+
+	// Run every object's preload() across worker threads, returning at once (so other setup - the
+	//	renderer's - proceeds meanwhile). finishPreload() waits for them; until it returns, the scene
+	//	mustn't be changed or its models created.
+	void startPreload(uint32_t threadCount);		// (clamped to 1 - MAX_PRELOAD_THREADS)
+	void finishPreload();
+
+	static const uint32_t MAX_PRELOAD_THREADS = 4;
 
 	// Scene serialization for save/load
 	json serialize() const;
@@ -48,6 +73,9 @@ public:
 	bool saveToFile(const std::string& filename) const;
 	bool loadFromFile(const std::string& filename);
 
+	// The scene file's optional "pacing" object (see PacingSettings), kept as loaded and saved back
+	const json& getPacing() const { return pacing; }
+
 	// Utility methods
 	std::vector<std::string> getObjectNames() const;
 	size_t getObjectCountByType(SceneObject::ObjectType type) const;
@@ -60,6 +88,34 @@ public:
 private:
 	std::vector<std::unique_ptr<SceneObject>> objects;
 
+	// One per object, ordered depth-first: every parent precedes its children, and each subtree is
+	//	contiguous, so a subtree's world matrices update in one forward pass over a range.
+	struct Node {
+		SceneObject* object;
+		int32_t parent;			// (node index, or -1 for a root)
+		uint32_t subtreeSize;	// (the node and its descendants, which directly follow it)
+		Model* model;			// (bound by createAllModels, or null)
+	};
+
+	std::unordered_map<const SceneObject*, SceneObject*> parents;
+	std::unordered_map<const SceneObject*, Model*> boundModels;
+	std::vector<Node> nodes;
+	std::vector<Matrix4> worldMatrices;
+	std::vector<Matrix4> normalMatrices;
+	std::vector<uint32_t> nodeOfSlot;		// (node of each transform store slot, or NO_NODE)
+	std::vector<uint32_t> changedNodes;		// (reused by each update)
+	bool hierarchyChanged = true;
+
+	json pacing;
+
+	std::vector<std::thread> preloaders;
+
+	static const uint32_t NO_NODE = 0xFFFFFFFF;
+
+	void rebuildHierarchy();
+	void updateNodes(uint32_t first, uint32_t end);
+	void detach(const SceneObject* object);
+
 	// Helper methods
 	std::string makeUniqueName(const std::string& baseName) const;
 	size_t findObjectIndex(const std::string& name) const;
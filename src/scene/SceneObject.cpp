@@ -9,25 +9,24 @@
 
 SceneObject::SceneObject(const std::string& name)
 	: name(name)
-	, position(0.0f, 0.0f, 0.0f)
-	, rotation(0.0f, 0.0f, 0.0f)
-	, scale(1.0f, 1.0f, 1.0f)
+	, transform(TransformStore::shared().create())
 	, visible(true)
 	, texture(nullptr)
 { }
 
-Matrix4 SceneObject::getTransformMatrix() const {
-	// Build transformation matrix: scale * rotation * translation
-	Matrix4 scaleMatrix = Matrix4::scale(scale);
-	Matrix4 rotationMatrix = Matrix4::rotation(rotation);
-	Matrix4 translationMatrix = Matrix4::translation(position);
+SceneObject::~SceneObject() {
+	TransformStore::shared().destroy(transform);
+}
 
-	return translationMatrix * rotationMatrix * scaleMatrix;
+Matrix4 SceneObject::getTransformMatrix() const {
+	// Transformation matrix: translation * rotation * scale (composed by the transform store)
+	return TransformStore::shared().getWorldMatrix(transform);
 }
 
 json SceneObject::serialize() const {
 	json jsonData;
 	// Don't set name here - let derived classes set it first
+	Vector3 position = getPosition(), rotation = getRotation(), scale = getScale();
 
 	// Serialize position
 	jsonData["position"] = json::object({
@@ -58,6 +57,8 @@ void SceneObject::deserialize(const json& jsonData) {
 		name = jsonData["name"].get<std::string>();
 	}
 
+	Vector3 position = getPosition(), rotation = getRotation(), scale = getScale();
+
 	if (jsonData.contains("position")) {
 		const json& posJson = jsonData["position"];
 		if (posJson.contains("x")) position.x = posJson["x"].get<float>();
@@ -78,13 +79,17 @@ void SceneObject::deserialize(const json& jsonData) {
 		if (scaleJson.contains("y")) scale.y = scaleJson["y"].get<float>();
 		if (scaleJson.contains("z")) scale.z = scaleJson["z"].get<float>();
 	}
+
+	setPosition(position);
+	setRotation(rotation);
+	setScale(scale);
 }
 
 void SceneObject::copyBaseTo(SceneObject* other) const {
 	other->name = name;
-	other->position = position;
-	other->rotation = rotation;
-	other->scale = scale;
+	other->setPosition(getPosition());
+	other->setRotation(getRotation());
+	other->setScale(getScale());
 	other->visible = visible;
 	other->texture = texture; // Shallow copy - textures are shared.
 }
@@ -2,6 +2,7 @@
 
 #include "../math/Vector3.h"
 #include "../math/Matrix4.h"
+#include "../math/TransformStore.h"
 #include "../rendering/Mesh.h"
 #include "../rendering/Texture.h"
 #include <memory>
@@ -31,7 +32,10 @@ public:
 	};
 
 	SceneObject(const std::string& name = "Unnamed Object");
-	virtual ~SceneObject() = default;
+	virtual ~SceneObject();
+
+	SceneObject(const SceneObject&) = delete;			// (use clone(); each owns its transform store entry)
+	SceneObject& operator=(const SceneObject&) = delete;
 
 	// Core interface that all scene objects must implement
 	virtual ObjectType getType() const = 0;
@@ -39,18 +43,27 @@ public:
 	virtual json serialize() const;
 	virtual void deserialize(const json& jsonData);
 
+	// CPU-side loading ahead of createModel() (reading and decoding files), safe to run on a worker
+	//	thread while the renderer is set up - touches nothing but this object
+	virtual void preload() { }
+
 	// Common properties for all scene objects
 	const std::string& getName() const { return name; }
 	void setName(const std::string& n) { name = n; }
 
-	const Vector3& getPosition() const { return position; }
-	void setPosition(const Vector3& pos) { position = pos; }
+	// (transform kept in TransformStore::shared())
+	Vector3 getPosition() const { return TransformStore::shared().getPosition(transform); }
+	void setPosition(const Vector3& pos) { TransformStore::shared().setPosition(transform, pos); }
+
+	Vector3 getRotation() const { return TransformStore::shared().getRotation(transform); }
+	void setRotation(const Vector3& rot) { TransformStore::shared().setRotation(transform, rot); }
+	Quaternion getOrientation() const { return TransformStore::shared().getOrientation(transform); }
+	void setRotation(const Quaternion& rot) { TransformStore::shared().setRotation(transform, rot); }
 
-	const Vector3& getRotation() const { return rotation; }
-	void setRotation(const Vector3& rot) { rotation = rot; }
+	Vector3 getScale() const { return TransformStore::shared().getScale(transform); }
+	void setScale(const Vector3& s) { TransformStore::shared().setScale(transform, s); }
 
-	const Vector3& getScale() const { return scale; }
-	void setScale(const Vector3& s) { scale = s; }
+	TransformHandle getTransformHandle() const { return transform; }
 
 	bool isVisible() const { return visible; }
 	void setVisible(bool v) { visible = v; }
@@ -67,9 +80,7 @@ public:
 
 protected:
 	std::string name;
-	Vector3 position;
-	Vector3 rotation;  // Euler angles in degrees
-	Vector3 scale;
+	TransformHandle transform;  // Position, rotation (Euler angles in degrees) and scale
 	bool visible;
 	std::shared_ptr<Texture> texture;
 
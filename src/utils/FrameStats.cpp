@@ -0,0 +1,102 @@
+#include "FrameStats.h"
+#include "logger/Logging.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+const double FrameStats::HITCH_MULTIPLE = 2.0;
+
+void FrameStats::add(double milliseconds) {
+	samples.push_back(milliseconds);
+	sortedValid = false;
+}
+
+void FrameStats::clear() {
+	samples.clear();
+	sortedValid = false;
+}
+
+double FrameStats::mean() const {
+	return samples.empty() ? 0.0 : std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+double FrameStats::minimum() const {
+	return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+}
+
+double FrameStats::maximum() const {
+	return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+}
+
+double FrameStats::standardDeviation() const {
+	if (samples.size() < 2) {
+		return 0.0;
+	}
+	double average = mean();
+	double sumSquares = 0.0;
+	for (double sample : samples) {
+		sumSquares += (sample - average) * (sample - average);
+	}
+	return std::sqrt(sumSquares / (samples.size() - 1));
+}
+
+double FrameStats::percentile(double p) const {
+	if (samples.empty()) {
+		return 0.0;
+	}
+	if (!sortedValid) {
+		sorted = samples;
+		std::sort(sorted.begin(), sorted.end());
+		sortedValid = true;
+	}
+	double rank = std::clamp(p, 0.0, 100.0) / 100.0 * (sorted.size() - 1);
+	size_t below = static_cast<size_t>(rank);
+	size_t above = std::min(below + 1, sorted.size() - 1);
+	return sorted[below] + (sorted[above] - sorted[below]) * (rank - below);
+}
+
+double FrameStats::medianAbsoluteDeviation() const {
+	if (samples.empty()) {
+		return 0.0;
+	}
+	double median = percentile(50.0);
+	std::vector<double> deviations;
+	deviations.reserve(samples.size());
+	for (double sample : samples) {
+		deviations.push_back(std::fabs(sample - median));
+	}
+	size_t middle = deviations.size() / 2;
+	std::nth_element(deviations.begin(), deviations.begin() + middle, deviations.end());
+	if (deviations.size() % 2 == 1) {
+		return deviations[middle];
+	}
+	double above = deviations[middle];
+	return (*std::max_element(deviations.begin(), deviations.begin() + middle) + above) / 2.0;
+}
+
+size_t FrameStats::countHitches(double multipleOfMedian) const {
+	double threshold = percentile(50.0) * multipleOfMedian;
+	return std::count_if(samples.begin(), samples.end(), [threshold](double sample) { return sample > threshold; });
+}
+
+json FrameStats::toJson() const {
+	json result;
+	result["count"] = static_cast<double>(samples.size());
+	result["meanMs"] = mean();
+	result["minMs"] = minimum();
+	result["maxMs"] = maximum();
+	result["stdDevMs"] = standardDeviation();
+	result["madMs"] = medianAbsoluteDeviation();
+	result["p50Ms"] = percentile(50.0);
+	result["p95Ms"] = percentile(95.0);
+	result["p99Ms"] = percentile(99.0);
+	result["fps"] = mean() > 0.0 ? 1000.0 / mean() : 0.0;
+	result["hitches"] = static_cast<double>(countHitches());
+	return result;
+}
+
+void FrameStats::logSummary(const char* label) const {
+	Log(NOTE, "%s: %zu frames, %.3f ms mean (%.1f FPS), %.3f min, %.3f p50, %.3f p95, %.3f p99, %.3f max, %zu hitches",
+		label, samples.size(), mean(), mean() > 0.0 ? 1000.0 / mean() : 0.0, minimum(),
+		percentile(50.0), percentile(95.0), percentile(99.0), maximum(), countHitches());
+}
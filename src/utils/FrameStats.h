@@ -0,0 +1,38 @@
+#pragma once
+
+#include "JsonSupport.h"
+#include <vector>
+#include <cstddef>
+
+// FrameStats collects frame times (in milliseconds) and summarizes them: mean, extremes, percentiles.
+//	Percentiles interpolate between the nearest ranks, so p50 of an even count is the mean of the middle two.
+class FrameStats {
+public:
+	void reserve(size_t count) { samples.reserve(count); }
+	void add(double milliseconds);
+	void clear();
+
+	size_t getCount() const { return samples.size(); }
+	const std::vector<double>& getSamples() const { return samples; }
+
+	double mean() const;
+	double minimum() const;
+	double maximum() const;
+	double standardDeviation() const;
+	double percentile(double p) const;		// (p from 0 to 100)
+	double medianAbsoluteDeviation() const;	// (spread robust to outliers, unlike the standard deviation)
+
+	// Hitches: samples over some multiple of the median (a frame that took twice as long as usual is
+	//	visible as a stutter, however fast the rest)
+	size_t countHitches(double multipleOfMedian = HITCH_MULTIPLE) const;
+	static const double HITCH_MULTIPLE;
+
+	// { "count", "meanMs", "minMs", "maxMs", "stdDevMs", "madMs", "p50Ms", "p95Ms", "p99Ms", "fps", "hitches" }
+	json toJson() const;
+	void logSummary(const char* label) const;
+
+private:
+	std::vector<double> samples;
+	mutable std::vector<double> sorted;		// (samples, sorted when a percentile is first asked for)
+	mutable bool sortedValid = false;
+};
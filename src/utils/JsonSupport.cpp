@@ -1,6 +1,7 @@
 #include "JsonSupport.h"
 #include <sstream>
 #include <cctype>
+#include <cstdio>
 
 #ifdef JSON_LITE
 
@@ -29,7 +30,9 @@ std::string JsonValue::dump(int indent) const {
 	if (isString) {
 		return "\"" + stringValue + "\"";
 	} else if (isNumber) {
-		return std::to_string(numberValue);
+		char number[32];	// (to_string's fixed six decimals would lose small values, e.g. timings in ms)
+		snprintf(number, sizeof(number), "%.10g", numberValue);
+		return number;
 	} else if (isBool) {
 		return boolValue ? "true" : "false";
 	} else if (isArrayType) {
@@ -141,7 +144,8 @@ void JsonValue::parseValue(const std::string& str, size_t& pos) {
 			numStr += c;
 			++pos;
 		}
-		while (pos < str.length() && (std::isdigit(str[pos]) || str[pos] == '.')) {
+		while (pos < str.length() && (std::isdigit(str[pos]) || str[pos] == '.' || str[pos] == 'e' || str[pos] == 'E'
+									  || ((str[pos] == '-' || str[pos] == '+') && (str[pos - 1] == 'e' || str[pos - 1] == 'E')))) {
 			numStr += str[pos];
 			++pos;
 		}
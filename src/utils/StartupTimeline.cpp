@@ -0,0 +1,65 @@
+#include "StartupTimeline.h"
+#include "logger/Logging.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace {
+	std::mutex phasesMutex;
+	std::vector<StartupPhase> phases;
+	int64_t originNs = Tracer::nowNs();		// (until start() is called)
+}
+
+void StartupTimeline::start() {
+	std::lock_guard<std::mutex> lock(phasesMutex);
+	originNs = Tracer::nowNs();
+	phases.clear();
+}
+
+double StartupTimeline::elapsedMs() {
+	return (Tracer::nowNs() - originNs) / 1e6;
+}
+
+void StartupTimeline::record(const char* name, double startMs, double endMs) {
+	const TraceBuffer& buffer = Tracer::threadBuffer();
+	std::string thread = buffer.getName().empty() ? "thread " + std::to_string(buffer.getId()) : buffer.getName();
+	std::lock_guard<std::mutex> lock(phasesMutex);
+	phases.push_back({ name, thread, startMs, endMs });
+}
+
+std::vector<StartupPhase> StartupTimeline::getPhases() {
+	std::vector<StartupPhase> sorted;
+	{
+		std::lock_guard<std::mutex> lock(phasesMutex);
+		sorted = phases;
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const StartupPhase& a, const StartupPhase& b) {
+		return a.startMs < b.startMs;
+	});
+	return sorted;
+}
+
+void StartupTimeline::logTimeline(const char* title) {
+	std::vector<StartupPhase> sorted = getPhases();
+	if (sorted.empty()) {
+		return;
+	}
+	double endMs = 0.0;
+	size_t threadWidth = 0, nameWidth = 0;
+	for (const StartupPhase& phase : sorted) {
+		endMs = std::max(endMs, phase.endMs);
+		threadWidth = std::max(threadWidth, phase.thread.size());
+		nameWidth = std::max(nameWidth, strlen(phase.name));
+	}
+	double msPerColumn = std::max(endMs, 1.0) / BAR_WIDTH;
+
+	Log(NOTE, "%s: %.0f ms (%.1f ms per column)", title, endMs, msPerColumn);
+	for (const StartupPhase& phase : sorted) {
+		int first = std::min(BAR_WIDTH - 1, static_cast<int>(phase.startMs / msPerColumn));
+		int last = std::clamp(static_cast<int>(phase.endMs / msPerColumn), first, BAR_WIDTH - 1);
+		std::string bar(BAR_WIDTH, ' ');
+		std::fill(bar.begin() + first, bar.begin() + last + 1, '#');
+		Log(RAW, "  %-*s  %-*s |%s| %7.1f - %7.1f ms (%.1f ms)", static_cast<int>(threadWidth), phase.thread.c_str(),
+			static_cast<int>(nameWidth), phase.name, bar.c_str(), phase.startMs, phase.endMs, phase.endMs - phase.startMs);
+	}
+}
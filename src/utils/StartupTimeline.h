@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Trace.h"
+#include <string>
+#include <vector>
+
+// StartupTimeline records the phases of startup - each one's name, thread and span - to print as a
+//	timeline once the first frame is out, showing what ran alongside what and where the time went.
+//	Phases may be recorded from any thread. Names must outlive it (string literals, typically).
+struct StartupPhase {
+	const char* name;
+	std::string thread;
+	double startMs;			// (since StartupTimeline::start())
+	double endMs;
+};
+
+class StartupTimeline {
+public:
+	static void start();			// (the timeline's zero: call first thing)
+	static double elapsedMs();		// (since then)
+
+	static void record(const char* name, double startMs, double endMs);
+
+	// Times the rest of the enclosing block as a phase
+	class Phase {
+	public:
+		explicit Phase(const char* name) : name(name), startMs(elapsedMs()) { }
+		~Phase() { record(name, startMs, elapsedMs()); }
+
+		Phase(const Phase&) = delete;
+		Phase& operator=(const Phase&) = delete;
+
+	private:
+		const char* name;
+		double startMs;
+	};
+
+	static std::vector<StartupPhase> getPhases();		// (in order of starting)
+
+	// One line per phase: its thread, a bar placing it on the timeline, and its span
+	static void logTimeline(const char* title);
+
+	static const int BAR_WIDTH = 50;
+};
+
+#define STARTUP_PHASE(name) StartupTimeline::Phase TRACE_CONCATENATE(startupPhase, __LINE__)(name)
@@ -0,0 +1,118 @@
+#include "Trace.h"
+#include "logger/Logging.h"
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <cstdio>
+#include <algorithm>
+
+const uint32_t Tracer::EVENTS_PER_BUFFER;
+
+namespace {
+	// Every buffer ever registered (so a finished thread's events can still be written out)
+	std::mutex registryMutex;
+	std::vector<std::unique_ptr<TraceBuffer>>& registry() {
+		static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+		return buffers;
+	}
+
+	thread_local TraceBuffer* currentThreadBuffer = nullptr;
+
+	// (caller holds registryMutex)
+	TraceBuffer& addBuffer(const std::string& name) {
+		auto& buffers = registry();
+		uint32_t id = static_cast<uint32_t>(buffers.size()) + 1;
+		buffers.push_back(std::make_unique<TraceBuffer>(name.empty() ? "thread " + std::to_string(id) : name,
+														id, Tracer::EVENTS_PER_BUFFER));
+		return *buffers.back();
+	}
+}
+
+TraceBuffer::TraceBuffer(const std::string& name, uint32_t id, uint32_t capacity)
+	: name(name)
+	, id(id)
+	, events(capacity)
+	, mask(capacity - 1)
+	, head(0)
+{ }
+
+size_t TraceBuffer::copyEvents(std::vector<TraceEvent>& out) const {
+	uint64_t end = head.load(std::memory_order_acquire);
+	uint64_t begin = end > events.size() ? end - events.size() : 0;
+	size_t first = out.size();
+	for (uint64_t i = begin; i < end; ++i) {
+		out.push_back(events[i & mask]);
+	}
+
+	// Any the owner wrapped round onto while they were copied are garbled: drop them. (The fence keeps
+	//	the copies above from being read after this load. Its slot for event 'now' may be mid-write,
+	//	not yet published, so it counts as overwritten too.)
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t now = head.load(std::memory_order_relaxed);
+	uint64_t overwritten = now + 1 > events.size() ? now + 1 - events.size() : 0;
+	if (overwritten > begin) {
+		size_t lost = static_cast<size_t>(std::min(overwritten - begin, end - begin));
+		out.erase(out.begin() + first, out.begin() + first + lost);
+	}
+	return out.size() - first;
+}
+
+TraceBuffer& Tracer::threadBuffer() {
+	if (!currentThreadBuffer) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		currentThreadBuffer = &addBuffer("");
+	}
+	return *currentThreadBuffer;
+}
+
+void Tracer::setThreadName(const std::string& name) {
+	TraceBuffer& buffer = threadBuffer();
+	std::lock_guard<std::mutex> lock(registryMutex);
+	buffer.name = name;
+}
+
+TraceBuffer& Tracer::track(const std::string& name) {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (auto& buffer : registry()) {
+		if (buffer->getName() == name) {
+			return *buffer;
+		}
+	}
+	return addBuffer(name);
+}
+
+bool Tracer::writeChromeTrace(const std::string& filename) {
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		Log(ERROR, "Tracer: Failed to open file for writing: %s", filename.c_str());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::vector<TraceEvent> events;
+	events.reserve(EVENTS_PER_BUFFER);
+	size_t eventCount = 0;
+	char line[256];
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	const char* separator = "\n";
+	for (const auto& buffer : registry()) {
+		snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+				 separator, buffer->getId(), buffer->getName().c_str());
+		file << line;
+		separator = ",\n";
+
+		events.clear();
+		buffer->copyEvents(events);
+		for (const TraceEvent& event : events) {
+			snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+					 event.name, buffer->getId(), event.startNs / 1000.0, event.durationNs / 1000.0);
+			file << line;
+		}
+		eventCount += events.size();
+	}
+	file << "\n]}\n";
+
+	Log(NOTE, "Trace written to %s (%zu events from %zu threads and tracks)", filename.c_str(), eventCount, registry().size());
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CPU trace scopes: TRACE_SCOPE("name") times the rest of the enclosing block and records it to the
+//	calling thread's ring buffer, to be written out as a Chrome trace (chrome://tracing, Perfetto) with
+//	Tracer::writeChromeTrace(). Building with NO_TRACE_SCOPES defined (CMake: USE_TRACE_SCOPES=OFF)
+//	compiles every scope away. Names must outlive the tracer (string literals, typically).
+
+struct TraceEvent {
+	const char* name;
+	int64_t startNs;		// (Tracer::nowNs() clock)
+	int64_t durationNs;
+};
+
+// One thread's (or one named track's) events: a fixed-size ring, written only by its owner without
+//	locking, overwriting its oldest events once full. Readers copy what's there and discard any the
+//	owner overwrote meanwhile.
+class TraceBuffer {
+public:
+	TraceBuffer(const std::string& name, uint32_t id, uint32_t capacity);
+
+	void record(const char* name, int64_t startNs, int64_t durationNs) {
+		uint64_t index = head.load(std::memory_order_relaxed);
+		events[index & mask] = { name, startNs, durationNs };
+		head.store(index + 1, std::memory_order_release);
+	}
+
+	// Appends the events still held, oldest first, returning how many
+	size_t copyEvents(std::vector<TraceEvent>& out) const;
+
+	const std::string& getName() const { return name; }
+	uint32_t getId() const { return id; }
+	uint64_t getRecordedCount() const { return head.load(std::memory_order_acquire); }
+
+private:
+	friend class Tracer;
+	std::string name;
+	uint32_t id;
+	std::vector<TraceEvent> events;
+	uint64_t mask;
+	std::atomic<uint64_t> head;
+};
+
+class Tracer {
+public:
+	// The calling thread's buffer (registered on first use, and kept after the thread ends)
+	static TraceBuffer& threadBuffer();
+	static void setThreadName(const std::string& name);
+
+	// A named track not tied to a thread (e.g. GPU work, placed on the CPU clock), written by one thread
+	static TraceBuffer& track(const std::string& name);
+
+	// Every buffer's events as Chrome trace_event JSON ("X" events, in microseconds, one row per buffer)
+	static bool writeChromeTrace(const std::string& filename);
+
+	static int64_t nowNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static const uint32_t EVENTS_PER_BUFFER = 1 << 16;	// (a power of two)
+};
+
+class TraceScope {
+public:
+	explicit TraceScope(const char* name) : name(name), startNs(Tracer::nowNs()) { }
+	~TraceScope() { Tracer::threadBuffer().record(name, startNs, Tracer::nowNs() - startNs); }
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	const char* name;
+	int64_t startNs;
+};
+
+#define TRACE_CONCATENATE_(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_(a, b)
+
+#ifndef NO_TRACE_SCOPES
+	#define TRACE_SCOPE(name) TraceScope TRACE_CONCATENATE(traceScope, __LINE__)(name)
+#else
+	#define TRACE_SCOPE(name) ((void) 0)
+#endif
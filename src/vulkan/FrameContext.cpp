@@ -0,0 +1,82 @@
+#include "FrameContext.h"
+#include "VulkanDevice.h"
+#include <stdexcept>
+#include <algorithm>
+
+FrameRing::FrameRing(VulkanDevice& device, uint32_t framesInFlight)
+	: device(device)
+	, frameIndex(0)
+	, frameNumber(0)
+{
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	// (transient: its one command buffer is re-recorded each time round, by resetting the whole pool)
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = device.getGraphicsQueueFamily();
+
+	frames.resize(std::max(framesInFlight, 1u));
+	for (uint32_t i = 0; i < frames.size(); ++i) {
+		FrameContext& frame = frames[i];
+		frame.index = i;
+		if (vkCreateSemaphore(device.getLogicalDevice(), &semaphoreInfo, nullptr, &frame.imageAvailableSemaphore) != VK_SUCCESS ||
+			vkCreateSemaphore(device.getLogicalDevice(), &semaphoreInfo, nullptr, &frame.renderFinishedSemaphore) != VK_SUCCESS ||
+			vkCreateFence(device.getLogicalDevice(), &fenceInfo, nullptr, &frame.inFlightFence) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create synchronization objects for a frame");
+		}
+
+		if (vkCreateCommandPool(device.getLogicalDevice(), &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create a frame's command pool");
+		}
+
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = frame.commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = 1;
+
+		if (vkAllocateCommandBuffers(device.getLogicalDevice(), &allocInfo, &frame.commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate command buffers");
+		}
+
+		frame.uploadArena = std::make_unique<UploadArena>(device);
+	}
+}
+
+FrameRing::~FrameRing() {
+	for (FrameContext& frame : frames) {
+		frame.uploadArena.reset();
+		vkDestroyCommandPool(device.getLogicalDevice(), frame.commandPool, nullptr);
+		vkDestroySemaphore(device.getLogicalDevice(), frame.renderFinishedSemaphore, nullptr);
+		vkDestroySemaphore(device.getLogicalDevice(), frame.imageAvailableSemaphore, nullptr);
+		vkDestroyFence(device.getLogicalDevice(), frame.inFlightFence, nullptr);
+	}
+}
+
+FrameContext& FrameRing::begin() {
+	FrameContext& frame = frames[frameIndex];
+	vkWaitForFences(device.getLogicalDevice(), 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+
+	vkResetCommandPool(device.getLogicalDevice(), frame.commandPool, 0);
+	frame.uploadArena->reset();
+	return frame;
+}
+
+void FrameRing::advance() {
+	frameIndex = (frameIndex + 1) % static_cast<uint32_t>(frames.size());
+	++frameNumber;
+}
+
+VkDeviceSize FrameRing::getUploadHighWaterMark() const {
+	VkDeviceSize highWaterMark = 0;
+	for (const FrameContext& frame : frames) {
+		highWaterMark = std::max(highWaterMark, frame.uploadArena->getHighWaterMark());
+	}
+	return highWaterMark;
+}
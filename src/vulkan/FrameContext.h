@@ -0,0 +1,54 @@
+#pragma once
+
+#include "UploadArena.h"
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class VulkanDevice;
+
+// Everything one frame in flight owns: the fence its submission signals, the semaphores ordering
+//	acquire, render and present, the command pool its commands are recorded from, and an arena for
+//	its transient uploads. None of it may be touched again until that fence has signaled.
+struct FrameContext {
+	VkFence inFlightFence;
+	VkSemaphore imageAvailableSemaphore;
+	VkSemaphore renderFinishedSemaphore;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+	std::unique_ptr<UploadArena> uploadArena;
+	uint32_t index;				// (in the ring, e.g. to pick per-frame descriptor sets)
+};
+
+// FrameRing cycles through the FrameContexts of the frames that may be in flight at once.
+class FrameRing {
+public:
+	FrameRing(VulkanDevice& device, uint32_t framesInFlight);
+	~FrameRing();
+
+	FrameRing(const FrameRing&) = delete;
+	FrameRing& operator=(const FrameRing&) = delete;
+
+	// The current context, once its previous submission has completed (waiting for it if need be),
+	//	with its command pool and upload arena reset for reuse
+	FrameContext& begin();
+	// On to the next context (after submitting the current one's commands)
+	void advance();
+
+	FrameContext& current() { return frames[frameIndex]; }
+	const FrameContext& current() const { return frames[frameIndex]; }
+	uint32_t getFrameIndex() const { return frameIndex; }
+	uint32_t getFramesInFlight() const { return static_cast<uint32_t>(frames.size()); }
+	uint64_t getFrameNumber() const { return frameNumber; }		// (frames advanced past so far)
+
+	// Most any frame has taken from its upload arena
+	VkDeviceSize getUploadHighWaterMark() const;
+	const FrameContext& getFrame(uint32_t index) const { return frames[index]; }
+
+private:
+	VulkanDevice& device;
+	std::vector<FrameContext> frames;
+	uint32_t frameIndex;
+	uint64_t frameNumber;
+};
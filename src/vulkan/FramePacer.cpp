@@ -0,0 +1,139 @@
+#include "FramePacer.h"
+#include "../utils/logger/Logging.h"
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+const uint32_t PacingSettings::MAX_FRAMES_IN_FLIGHT;
+const std::chrono::microseconds FramePacer::SPIN_MARGIN(1500);
+
+namespace {
+	const struct {
+		const char* name;
+		VkPresentModeKHR mode;
+	} PRESENT_MODES[] = {
+		{ "immediate", VK_PRESENT_MODE_IMMEDIATE_KHR },
+		{ "mailbox", VK_PRESENT_MODE_MAILBOX_KHR },
+		{ "fifo", VK_PRESENT_MODE_FIFO_KHR },
+		{ "fifo-relaxed", VK_PRESENT_MODE_FIFO_RELAXED_KHR }
+	};
+
+	uint32_t clampFramesInFlight(int frames) {
+		return static_cast<uint32_t>(std::clamp(frames, 1, static_cast<int>(PacingSettings::MAX_FRAMES_IN_FLIGHT)));
+	}
+}
+
+bool PacingSettings::parsePresentMode(const std::string& name, VkPresentModeKHR& mode) {
+	for (const auto& presentMode : PRESENT_MODES) {
+		if (name == presentMode.name) {
+			mode = presentMode.mode;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* PacingSettings::presentModeName(VkPresentModeKHR mode) {
+	for (const auto& presentMode : PRESENT_MODES) {
+		if (mode == presentMode.mode) {
+			return presentMode.name;
+		}
+	}
+	return "unknown";
+}
+
+void PacingSettings::apply(const json& pacing) {
+	if (pacing.contains("framesInFlight")) {
+		framesInFlight = clampFramesInFlight(pacing["framesInFlight"].get<int>());
+	}
+	if (pacing.contains("presentMode")) {
+		std::string name = pacing["presentMode"].get<std::string>();
+		if (!parsePresentMode(name, presentMode)) {
+			Log(WARN, "Pacing: unknown present mode \"%s\" (immediate, mailbox, fifo or fifo-relaxed)", name.c_str());
+		}
+	}
+	if (pacing.contains("fpsCap")) {
+		fpsCap = std::max(0.0f, pacing["fpsCap"].get<float>());
+	}
+}
+
+bool PacingSettings::apply(const std::vector<std::string>& arguments) {
+	for (size_t i = 0; i < arguments.size(); ++i) {
+		const std::string& argument = arguments[i];
+		bool hasValue = i + 1 < arguments.size();
+		if (argument == "--frames-in-flight" && hasValue) {
+			framesInFlight = clampFramesInFlight(atoi(arguments[++i].c_str()));
+		} else if (argument == "--present-mode" && hasValue) {
+			if (!parsePresentMode(arguments[++i], presentMode)) {
+				Log(ERROR, "Unknown present mode \"%s\" (immediate, mailbox, fifo or fifo-relaxed)", arguments[i].c_str());
+				return false;
+			}
+		} else if (argument == "--fps-cap" && hasValue) {
+			fpsCap = std::max(0.0f, static_cast<float>(atof(arguments[++i].c_str())));
+		} else {
+			Log(ERROR, "Unrecognized argument: %s", argument.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+FramePacer::FramePacer(float fpsCap, uint32_t framesInFlight)
+	: fpsCap(0.0f)
+	, frameInterval(Clock::duration::zero())
+	, nextFrameTime(Clock::now())
+	, inputTime(Clock::now())
+	, submittedInputTimes(framesInFlight)
+	, pending(framesInFlight, false)
+	, lastLatencyMs(0.0)
+	, averageLatencyMs(0.0)
+{
+	setFpsCap(fpsCap);
+}
+
+void FramePacer::setFpsCap(float fps) {
+	fpsCap = std::max(0.0f, fps);
+	frameInterval = fpsCap > 0.0f
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fpsCap))
+		: Clock::duration::zero();
+	nextFrameTime = Clock::now();
+}
+
+void FramePacer::waitForNextFrame() {
+	if (fpsCap <= 0.0f) {
+		return;
+	}
+	Clock::time_point now = Clock::now();
+	if (nextFrameTime - now > SPIN_MARGIN) {
+		std::this_thread::sleep_for(nextFrameTime - now - SPIN_MARGIN);
+	}
+	while (Clock::now() < nextFrameTime) {
+		std::this_thread::yield();
+	}
+
+	// Schedule the next from when this one was due, so frames keep to the cap on average;
+	//	but having fallen a whole frame behind, don't rush to catch up.
+	nextFrameTime += frameInterval;
+	now = Clock::now();
+	if (nextFrameTime < now) {
+		nextFrameTime = now + frameInterval;
+	}
+}
+
+void FramePacer::markInputSampled() {
+	inputTime = Clock::now();
+}
+
+void FramePacer::frameSubmitted(uint32_t frameIndex) {
+	submittedInputTimes[frameIndex] = inputTime;
+	pending[frameIndex] = true;
+}
+
+void FramePacer::frameCompleted(uint32_t frameIndex) {
+	if (!pending[frameIndex]) {
+		return;
+	}
+	pending[frameIndex] = false;
+	lastLatencyMs = std::chrono::duration<double, std::milli>(Clock::now() - submittedInputTimes[frameIndex]).count();
+	averageLatencyMs = averageLatencyMs == 0.0 ? lastLatencyMs : averageLatencyMs * 0.9 + lastLatencyMs * 0.1;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../utils/JsonSupport.h"
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// How frames are paced: the trade between latency and throughput. Fewer frames in flight and FIFO
+//	(or a cap just under the refresh rate) keep input-to-present latency down; more frames in flight and
+//	MAILBOX or IMMEDIATE keep the GPU busiest. Defaults match what the viewer always did.
+struct PacingSettings {
+	uint32_t framesInFlight = 2;							// (1 to MAX_FRAMES_IN_FLIGHT)
+	VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;	// (falls back to FIFO if unsupported)
+	float fpsCap = 0.0f;									// (0: uncapped)
+
+	static const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+	// From a scene file's "pacing" object, e.g. { "framesInFlight": 1, "presentMode": "fifo", "fpsCap": 60 },
+	//	leaving out whatever it leaves out
+	void apply(const json& pacing);
+	// From command-line arguments: --frames-in-flight N, --present-mode MODE, --fps-cap FPS.
+	//	Returns false (with an error logged) on one it doesn't recognize or can't parse.
+	bool apply(const std::vector<std::string>& arguments);
+
+	// immediate, mailbox, fifo or fifo-relaxed
+	static bool parsePresentMode(const std::string& name, VkPresentModeKHR& mode);
+	static const char* presentModeName(VkPresentModeKHR mode);
+};
+
+// FramePacer holds frames to an FPS cap, and estimates input-to-present latency: from when a frame's
+//	input was sampled to when the GPU finished that frame (at which point it's queued for presenting).
+//	Completion is noticed by polling the frame's fence, so the estimate runs slightly long by at most
+//	the gap between polls.
+class FramePacer {
+public:
+	FramePacer(float fpsCap = 0.0f, uint32_t framesInFlight = 2);
+
+	void setFpsCap(float fps);
+	float getFpsCap() const { return fpsCap; }
+
+	// Sleep until the cap allows the next frame to start: most of the way with the OS's sleep, which can
+	//	overshoot by a millisecond or more, and spin through the rest so the frame starts on time.
+	void waitForNextFrame();
+
+	// Latency bookkeeping: input sampled (for the frame about to be recorded), that frame submitted from
+	//	frame index, and its completion (observed via its fence)
+	void markInputSampled();
+	void frameSubmitted(uint32_t frameIndex);
+	void frameCompleted(uint32_t frameIndex);
+	bool isFramePending(uint32_t frameIndex) const { return pending[frameIndex]; }
+
+	// Input-to-present latency in milliseconds: the last frame's, and smoothed over recent frames
+	double getLatencyMs() const { return lastLatencyMs; }
+	double getAverageLatencyMs() const { return averageLatencyMs; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	float fpsCap;
+	Clock::duration frameInterval;
+	Clock::time_point nextFrameTime;
+
+	Clock::time_point inputTime;
+	std::vector<Clock::time_point> submittedInputTimes;		// (per frame index)
+	std::vector<bool> pending;
+	double lastLatencyMs;
+	double averageLatencyMs;
+
+	static const std::chrono::microseconds SPIN_MARGIN;
+};
@@ -0,0 +1,395 @@
+#include "GpuProfiler.h"
+#include "VulkanDevice.h"
+#include "../utils/logger/Logging.h"
+#include "../utils/Trace.h"
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+const uint32_t GpuProfiler::MAX_SCOPES;
+const uint32_t GpuProfiler::NO_SCOPE;
+
+namespace {
+	const uint32_t STATISTICS_COUNT = 6;		// (the PipelineStatistics members, in flag bit order)
+	const VkQueryPipelineStatisticFlags STATISTICS_FLAGS =
+		  VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+	const uint32_t CALIBRATION_ATTEMPTS = 5;
+}
+
+GpuProfiler::GpuProfiler(VulkanDevice& device, uint32_t framesInFlight)
+	: device(device)
+	, enabled(device.supportsTimestamps())
+	, statisticsEnabled(enabled && device.supportsPipelineStatistics())
+	, nsPerTick(device.getTimestampPeriod())
+	, tickMask(device.getTimestampValidBits() >= 64 ? ~0ull : (1ull << device.getTimestampValidBits()) - 1)
+	, recording(nullptr)
+	, referenceTicks(0)
+	, referenceMs(0.0)
+	, latest{}
+	, averageFrameMs(0.0)
+	, framesResolved(0)
+{
+	frames.resize(framesInFlight);
+	if (!enabled) {
+		Log(NOTE, "GPU profiling unavailable: no timestamps on the graphics queue");
+		return;
+	}
+
+	VkQueryPoolCreateInfo timestampInfo{};
+	timestampInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	timestampInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	timestampInfo.queryCount = 2 * MAX_SCOPES;
+
+	VkQueryPoolCreateInfo statisticsInfo{};
+	statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	statisticsInfo.queryCount = 1;
+	statisticsInfo.pipelineStatistics = STATISTICS_FLAGS;
+
+	for (FrameQueries& frame : frames) {
+		frame.statistics = VK_NULL_HANDLE;
+		frame.frameNumber = 0;
+		frame.cpuBeginMs = frame.cpuEndMs = 0.0;
+		frame.recorded = frame.statisticsRecorded = false;
+		frame.scopes.reserve(MAX_SCOPES);
+
+		if (vkCreateQueryPool(device.getLogicalDevice(), &timestampInfo, nullptr, &frame.timestamps) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create timestamp query pool");
+		}
+		if (statisticsEnabled
+		 && vkCreateQueryPool(device.getLogicalDevice(), &statisticsInfo, nullptr, &frame.statistics) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create pipeline statistics query pool");
+		}
+	}
+	results.resize(std::max(2 * MAX_SCOPES, STATISTICS_COUNT));
+	latest.scopes.reserve(MAX_SCOPES);
+
+	calibrate();
+}
+
+GpuProfiler::~GpuProfiler() {
+	for (FrameQueries& frame : frames) {
+		if (!enabled) {
+			break;
+		}
+		vkDestroyQueryPool(device.getLogicalDevice(), frame.timestamps, nullptr);
+		if (frame.statistics != VK_NULL_HANDLE) {
+			vkDestroyQueryPool(device.getLogicalDevice(), frame.statistics, nullptr);
+		}
+	}
+	if (trace.is_open()) {
+		trace << "\n]}\n";
+	}
+}
+
+double GpuProfiler::cpuNowMs() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Write a timestamp in a lone submit, bracketed by CPU times on either side; it was taken somewhere in
+//	between, so the narrowest bracket of a few attempts, split down the middle, places it best.
+void GpuProfiler::calibrate() {
+	if (!enabled) {
+		return;
+	}
+	VkDevice logicalDevice = device.getLogicalDevice();
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = device.getGraphicsQueueFamily();
+	VkCommandPool commandPool;
+	if (vkCreateCommandPool(logicalDevice, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create command pool for GPU clock calibration");
+	}
+
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = commandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+	VkCommandBuffer commandBuffer;
+	vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commandBuffer);
+
+	VkQueryPoolCreateInfo queryPoolInfo{};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = 1;
+	VkQueryPool queryPool;
+	if (vkCreateQueryPool(logicalDevice, &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+		vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
+		throw std::runtime_error("Failed to create query pool for GPU clock calibration");
+	}
+
+	double bestWindowMs = 0.0;
+	for (uint32_t attempt = 0; attempt < CALIBRATION_ATTEMPTS; ++attempt) {
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		vkCmdResetQueryPool(commandBuffer, queryPool, 0, 1);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+		vkEndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		double beforeMs = cpuNowMs();
+		vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+		vkQueueWaitIdle(device.getGraphicsQueue());
+		double afterMs = cpuNowMs();
+
+		uint64_t ticks;
+		if (vkGetQueryPoolResults(logicalDevice, queryPool, 0, 1, sizeof(ticks), &ticks, sizeof(ticks),
+								  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS
+		 && (attempt == 0 || afterMs - beforeMs < bestWindowMs)) {
+			bestWindowMs = afterMs - beforeMs;
+			referenceTicks = ticks & tickMask;
+			referenceMs = (beforeMs + afterMs) * 0.5;
+		}
+		vkResetCommandPool(logicalDevice, commandPool, 0);
+	}
+	vkDestroyQueryPool(logicalDevice, queryPool, nullptr);
+	vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
+
+	Log(LOW, "GPU clock calibrated to within %.3f ms", bestWindowMs * 0.5);
+}
+
+// Ticks since (or before) the reference, modulo the counter's width, taken the short way round
+double GpuProfiler::ticksToCpuMs(uint64_t ticks) {
+	uint64_t ahead = (ticks - referenceTicks) & tickMask;
+	double deltaTicks = ahead <= (tickMask >> 1) ? static_cast<double>(ahead)
+											   : -static_cast<double>((referenceTicks - ticks) & tickMask);
+	return referenceMs + deltaTicks * nsPerTick * 1e-6;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint64_t frameNumber) {
+	if (!enabled) {
+		return;
+	}
+	FrameQueries& frame = frames[frameIndex];
+	if (frame.recorded) {
+		resolve(frame);
+	}
+
+	frame.scopes.clear();
+	frame.frameNumber = frameNumber;
+	frame.cpuBeginMs = cpuNowMs();
+	frame.recorded = true;
+	frame.statisticsRecorded = false;
+	recording = &frame;
+	openScopes.clear();
+
+	vkCmdResetQueryPool(commandBuffer, frame.timestamps, 0, 2 * MAX_SCOPES);
+	if (frame.statistics != VK_NULL_HANDLE) {
+		vkCmdResetQueryPool(commandBuffer, frame.statistics, 0, 1);
+	}
+	beginScope(commandBuffer, "frame");
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer commandBuffer) {
+	if (!recording) {
+		return;
+	}
+	while (!openScopes.empty()) {		// (closing any left open, the frame last)
+		endScope(commandBuffer, openScopes.back());
+	}
+	recording->cpuEndMs = cpuNowMs();
+	recording = nullptr;
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name) {
+	if (!recording || recording->scopes.size() >= MAX_SCOPES) {
+		return NO_SCOPE;
+	}
+	uint32_t scope = static_cast<uint32_t>(recording->scopes.size());
+	recording->scopes.push_back({ name, static_cast<uint32_t>(openScopes.size()) });
+	openScopes.push_back(scope);
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, recording->timestamps, 2 * scope);
+	return scope;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+	if (!recording || scope == NO_SCOPE) {
+		return;
+	}
+	auto open = std::find(openScopes.begin(), openScopes.end(), scope);
+	if (open == openScopes.end()) {
+		return;
+	}
+	openScopes.erase(open);
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, recording->timestamps, 2 * scope + 1);
+}
+
+void GpuProfiler::beginStatistics(VkCommandBuffer commandBuffer) {
+	if (recording && recording->statistics != VK_NULL_HANDLE && !recording->statisticsRecorded) {
+		vkCmdBeginQuery(commandBuffer, recording->statistics, 0, 0);
+	}
+}
+
+void GpuProfiler::endStatistics(VkCommandBuffer commandBuffer) {
+	if (recording && recording->statistics != VK_NULL_HANDLE && !recording->statisticsRecorded) {
+		vkCmdEndQuery(commandBuffer, recording->statistics, 0);
+		recording->statisticsRecorded = true;
+	}
+}
+
+// (only called once the frame's fence has signaled, so everything's available without waiting)
+void GpuProfiler::resolve(FrameQueries& frame) {
+	frame.recorded = false;
+	uint32_t queryCount = 2 * static_cast<uint32_t>(frame.scopes.size());
+	if (queryCount == 0 || vkGetQueryPoolResults(device.getLogicalDevice(), frame.timestamps, 0, queryCount,
+												 queryCount * sizeof(uint64_t), results.data(), sizeof(uint64_t),
+												 VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+		return;
+	}
+
+	latest.frameNumber = frame.frameNumber;
+	latest.cpuBeginMs = frame.cpuBeginMs;
+	latest.cpuEndMs = frame.cpuEndMs;
+	latest.scopes.clear();
+	for (size_t i = 0; i < frame.scopes.size(); ++i) {
+		uint64_t begin = results[2 * i] & tickMask;
+		uint64_t end = results[2 * i + 1] & tickMask;
+		double durationMs = static_cast<double>((end - begin) & tickMask) * nsPerTick * 1e-6;
+		latest.scopes.push_back({ frame.scopes[i].name, frame.scopes[i].depth, ticksToCpuMs(begin), durationMs });
+	}
+
+	// (carry the calibration forward to this frame, a wrap-around or two on from the last)
+	referenceMs = latest.scopes[0].startMs;
+	referenceTicks = results[0] & tickMask;
+
+	latest.hasStatistics = frame.statisticsRecorded
+		&& vkGetQueryPoolResults(device.getLogicalDevice(), frame.statistics, 0, 1,
+								 STATISTICS_COUNT * sizeof(uint64_t), results.data(), STATISTICS_COUNT * sizeof(uint64_t),
+								 VK_QUERY_RESULT_64_BIT) == VK_SUCCESS;
+	if (latest.hasStatistics) {
+		latest.statistics = { results[0], results[1], results[2], results[3], results[4], results[5] };
+	}
+
+	double frameMs = latest.scopes[0].durationMs;
+	averageFrameMs = framesResolved == 0 ? frameMs : averageFrameMs * 0.95 + frameMs * 0.05;
+	++framesResolved;
+
+#ifndef NO_TRACE_SCOPES
+	// (onto the CPU trace too, as its own track, so one trace shows both)
+	TraceBuffer& gpuTrack = Tracer::track("GPU");
+	for (const GpuTiming& timing : latest.scopes) {
+		gpuTrack.record(timing.name, static_cast<int64_t>(timing.startMs * 1e6), static_cast<int64_t>(timing.durationMs * 1e6));
+	}
+#endif
+
+	if (csv.is_open()) {
+		writeCsv(latest);
+	}
+	if (trace.is_open()) {
+		writeTrace(latest);
+	}
+	if (frameCallback) {
+		frameCallback(latest);
+	}
+}
+
+void GpuProfiler::resolvePending() {
+	std::vector<FrameQueries*> pending;
+	for (FrameQueries& frame : frames) {
+		if (frame.recorded && &frame != recording) {
+			pending.push_back(&frame);
+		}
+	}
+	std::sort(pending.begin(), pending.end(), [](const FrameQueries* a, const FrameQueries* b) {
+		return a->frameNumber < b->frameNumber;
+	});
+	for (FrameQueries* frame : pending) {
+		resolve(*frame);
+	}
+}
+
+bool GpuProfiler::openCsv(const std::string& filename) {
+	csv.open(filename);
+	if (!csv.is_open()) {
+		Log(ERROR, "GpuProfiler: Failed to open file for writing: %s", filename.c_str());
+		return false;
+	}
+	csv << "frame,scope,depth,start_ms,duration_ms,"
+		   "vertices,primitives,vertex_invocations,clipping_invocations,clipping_primitives,fragment_invocations\n";
+	return true;
+}
+
+bool GpuProfiler::openChromeTrace(const std::string& filename) {
+	trace.open(filename);
+	if (!trace.is_open()) {
+		Log(ERROR, "GpuProfiler: Failed to open file for writing: %s", filename.c_str());
+		return false;
+	}
+	trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+			 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n"
+			 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+	return true;
+}
+
+void GpuProfiler::writeCsv(const GpuFrameTimings& timings) {
+	char line[256];
+	for (const GpuTiming& timing : timings.scopes) {
+		snprintf(line, sizeof(line), "%" PRIu64 ",%s,%u,%.4f,%.4f", timings.frameNumber, timing.name,
+				 timing.depth, timing.startMs, timing.durationMs);
+		csv << line;
+		if (timing.depth == 0 && timings.hasStatistics) {
+			const PipelineStatistics& stats = timings.statistics;
+			snprintf(line, sizeof(line), ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+					 stats.inputVertices, stats.inputPrimitives, stats.vertexShaderInvocations,
+					 stats.clippingInvocations, stats.clippingPrimitives, stats.fragmentShaderInvocations);
+			csv << line;
+		} else {
+			csv << ",,,,,,\n";
+		}
+	}
+}
+
+// Complete ("X") events in microseconds: the CPU's recording of the frame on one track, its GPU scopes
+//	(nested by time) on another, and the statistics as counters
+void GpuProfiler::writeTrace(const GpuFrameTimings& timings) {
+	char event[256];
+	snprintf(event, sizeof(event), ",\n{\"name\":\"record frame %" PRIu64 "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+			 "\"ts\":%.3f,\"dur\":%.3f}", timings.frameNumber, timings.cpuBeginMs * 1000.0,
+			 (timings.cpuEndMs - timings.cpuBeginMs) * 1000.0);
+	trace << event;
+	for (const GpuTiming& timing : timings.scopes) {
+		snprintf(event, sizeof(event), ",\n{\"name\":\"%s\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2,"
+				 "\"ts\":%.3f,\"dur\":%.3f}", timing.name, timing.startMs * 1000.0, timing.durationMs * 1000.0);
+		trace << event;
+	}
+	if (timings.hasStatistics) {
+		snprintf(event, sizeof(event), ",\n{\"name\":\"pipeline statistics\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,"
+				 "\"args\":{\"primitives\":%" PRIu64 ",\"fragments\":%" PRIu64 "}}", timings.scopes[0].startMs * 1000.0,
+				 timings.statistics.clippingPrimitives, timings.statistics.fragmentShaderInvocations);
+		trace << event;
+	}
+}
+
+void GpuProfiler::logReport() const {
+	if (!enabled || framesResolved == 0) {
+		return;
+	}
+	Log(NOTE, "GPU: %.3f ms/frame average over %llu frames", averageFrameMs, static_cast<unsigned long long>(framesResolved));
+	for (const GpuTiming& timing : latest.scopes) {
+		Log(NOTE, "  %*s%s: %.3f ms (last frame)", static_cast<int>(2 * timing.depth), "", timing.name, timing.durationMs);
+	}
+	if (latest.hasStatistics) {
+		const PipelineStatistics& stats = latest.statistics;
+		Log(NOTE, "  %llu vertices, %llu primitives (%llu clipped to %llu), %llu fragment invocations",
+			static_cast<unsigned long long>(stats.inputVertices), static_cast<unsigned long long>(stats.inputPrimitives),
+			static_cast<unsigned long long>(stats.clippingInvocations), static_cast<unsigned long long>(stats.clippingPrimitives),
+			static_cast<unsigned long long>(stats.fragmentShaderInvocations));
+	}
+}
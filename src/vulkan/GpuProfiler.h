@@ -0,0 +1,142 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+
+class VulkanDevice;
+
+// A named span of one frame's GPU work, placed on the CPU's clock (steady_clock, in milliseconds) so it
+//	lines up with CPU-side timings
+struct GpuTiming {
+	const char* name;
+	uint32_t depth;				// (0 for the whole frame, 1 for scopes within it, and so on)
+	double startMs;
+	double durationMs;
+};
+
+// Counts from a pipeline-statistics query (over the main render pass)
+struct PipelineStatistics {
+	uint64_t inputVertices;
+	uint64_t inputPrimitives;
+	uint64_t vertexShaderInvocations;
+	uint64_t clippingInvocations;
+	uint64_t clippingPrimitives;
+	uint64_t fragmentShaderInvocations;
+};
+
+struct GpuFrameTimings {
+	uint64_t frameNumber;
+	double cpuBeginMs;			// (when recording began and ended, on the same clock)
+	double cpuEndMs;
+	std::vector<GpuTiming> scopes;
+	bool hasStatistics;
+	PipelineStatistics statistics;
+};
+
+// GpuProfiler times named scopes of each frame's command buffer with timestamp queries, one query pool
+//	per frame in flight. A frame's results are read back when its slot comes round again - after its
+//	fence has been waited for, i.e. from frame N - framesInFlight (N-2 by default) - so reading never
+//	stalls. GPU ticks are mapped onto the CPU's clock by a calibration submit at creation (and on
+//	request), then carried forward frame to frame so a narrow counter's wrap-around doesn't matter.
+//	Does nothing (cheaply) if the graphics queue has no timestamps.
+class GpuProfiler {
+public:
+	GpuProfiler(VulkanDevice& device, uint32_t framesInFlight);
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	bool isEnabled() const { return enabled; }
+	bool hasStatistics() const { return statisticsEnabled; }
+
+	// Re-measure how GPU timestamps map to CPU time (submits and waits for the queue to idle)
+	void calibrate();
+
+	// At the start and end of recording a frame's command buffer (outside any render pass): reads back
+	//	what this frame index last recorded, resets its queries, and opens/closes the "frame" scope.
+	void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint64_t frameNumber);
+	void endFrame(VkCommandBuffer commandBuffer);
+
+	// Scopes nest; endScope takes what beginScope returned (NO_SCOPE, past MAX_SCOPES, is ignored).
+	//	Names must outlive the profiler (string literals, typically).
+	uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name);
+	void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+	// Pipeline statistics, at most once per frame (not straddling a render pass boundary)
+	void beginStatistics(VkCommandBuffer commandBuffer);
+	void endStatistics(VkCommandBuffer commandBuffer);
+
+	// The most recent frame read back (frameNumber 0 with no scopes until the first), and a running
+	//	average of whole-frame GPU time
+	const GpuFrameTimings& getLatestFrame() const { return latest; }
+	double getAverageFrameMs() const { return averageFrameMs; }
+
+	// Called with every frame as it's read back (e.g. to collect each frame's time; empty to stop)
+	using FrameCallback = std::function<void(const GpuFrameTimings&)>;
+	void setFrameCallback(FrameCallback callback) { frameCallback = std::move(callback); }
+
+	// Read back every frame not yet read, oldest first - only once the device is idle (as at the end
+	//	of a benchmark run), since it doesn't wait for their fences
+	void resolvePending();
+
+	// Write each frame read back to a CSV file (frame, scope, depth, start, duration), and/or to a Chrome
+	//	trace (chrome://tracing, Perfetto) alongside each frame's CPU recording span.
+	bool openCsv(const std::string& filename);
+	bool openChromeTrace(const std::string& filename);
+
+	void logReport() const;
+
+	static double cpuNowMs();		// (the CPU clock everything is placed on)
+
+	static const uint32_t MAX_SCOPES = 64;		// (per frame, including the frame itself)
+	static const uint32_t NO_SCOPE = 0xFFFFFFFF;
+
+private:
+	struct Scope {
+		const char* name;
+		uint32_t depth;			// (timestamps 2 * index and 2 * index + 1 bracket it)
+	};
+	struct FrameQueries {
+		VkQueryPool timestamps;
+		VkQueryPool statistics;		// (VK_NULL_HANDLE if unsupported)
+		std::vector<Scope> scopes;
+		uint64_t frameNumber;
+		double cpuBeginMs;
+		double cpuEndMs;
+		bool recorded;			// (submitted and not yet read back)
+		bool statisticsRecorded;
+	};
+
+	void resolve(FrameQueries& frame);
+	double ticksToCpuMs(uint64_t ticks);
+	void writeCsv(const GpuFrameTimings& timings);
+	void writeTrace(const GpuFrameTimings& timings);
+
+	VulkanDevice& device;
+	bool enabled;
+	bool statisticsEnabled;
+	double nsPerTick;
+	uint64_t tickMask;
+
+	std::vector<FrameQueries> frames;
+	FrameQueries* recording;		// (between beginFrame and endFrame)
+	std::vector<uint32_t> openScopes;
+	std::vector<uint64_t> results;	// (reused by each read-back)
+
+	// Calibration: a GPU tick count and the CPU time it corresponds to, moved forward with each frame
+	uint64_t referenceTicks;
+	double referenceMs;
+
+	GpuFrameTimings latest;
+	double averageFrameMs;
+	uint64_t framesResolved;
+
+	std::ofstream csv;
+	std::ofstream trace;
+	FrameCallback frameCallback;
+};
@@ -0,0 +1,125 @@
+#include "PipelineCache.h"
+#include "VulkanDevice.h"
+#include "../utils/logger/Logging.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+std::string PipelineCache::directory = "cache/pipelines";
+
+PipelineCache::PipelineCache(VulkanDevice& device)
+	: device(device)
+	, cache(VK_NULL_HANDLE)
+	, loadedSize(0)
+{
+	vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &properties);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%04x-%04x.bin", properties.vendorID, properties.deviceID);
+	filePath = (std::filesystem::path(directory) / name).string();
+
+	std::vector<char> data;
+	if (readFile(data) && !isCompatible(data)) {
+		Log(NOTE, "PipelineCache: %s is from another device or driver, starting empty", filePath.c_str());
+		data.clear();
+	}
+
+	VkPipelineCacheCreateInfo cacheInfo{};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize = data.size();
+	cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+	if (vkCreatePipelineCache(device.getLogicalDevice(), &cacheInfo, nullptr, &cache) != VK_SUCCESS) {
+		if (data.empty()) {
+			throw std::runtime_error("Failed to create pipeline cache");
+		}
+		// (the driver may still reject data that looked right: start over without it)
+		Log(WARN, "PipelineCache: driver rejected %s, starting empty", filePath.c_str());
+		cacheInfo.initialDataSize = 0;
+		cacheInfo.pInitialData = nullptr;
+		data.clear();
+		if (vkCreatePipelineCache(device.getLogicalDevice(), &cacheInfo, nullptr, &cache) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create pipeline cache");
+		}
+	}
+	loadedSize = data.size();
+	Log(LOW, "PipelineCache: %s (%zu bytes)", isWarm() ? "warm" : "cold", loadedSize);
+}
+
+PipelineCache::~PipelineCache() {
+	save();
+	vkDestroyPipelineCache(device.getLogicalDevice(), cache, nullptr);
+}
+
+bool PipelineCache::save() {
+	size_t size = 0;
+	if (vkGetPipelineCacheData(device.getLogicalDevice(), cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+		return false;
+	}
+	std::vector<char> data(size);
+	if (vkGetPipelineCacheData(device.getLogicalDevice(), cache, &size, data.data()) != VK_SUCCESS) {
+		return false;
+	}
+	data.resize(size);
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		Log(WARN, "PipelineCache: can't create %s: %s", directory.c_str(), error.message().c_str());
+		return false;
+	}
+
+	// Write it whole alongside, then swap it in (rename replaces atomically, on the same filesystem)
+	std::string temporaryPath = filePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), data.size());
+		if (!file) {
+			Log(WARN, "PipelineCache: can't write %s", temporaryPath.c_str());
+			return false;
+		}
+	}
+	std::filesystem::rename(temporaryPath, filePath, error);
+	if (error) {
+		Log(WARN, "PipelineCache: can't replace %s: %s", filePath.c_str(), error.message().c_str());
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	Log(LOW, "PipelineCache: saved %zu bytes to %s", data.size(), filePath.c_str());
+	return true;
+}
+
+bool PipelineCache::readFile(std::vector<char>& data) {
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+	std::streamoff size = file.tellg();
+	if (size <= 0) {
+		return false;
+	}
+	data.resize(static_cast<size_t>(size));
+	file.seekg(0);
+	if (!file.read(data.data(), data.size())) {
+		Log(WARN, "PipelineCache: %s is truncated, starting empty", filePath.c_str());
+		data.clear();		// (never hand the driver a partly read cache)
+		return false;
+	}
+	return true;
+}
+
+// The header every VkPipelineCache's data starts with, matched against this device
+bool PipelineCache::isCompatible(const std::vector<char>& data) const {
+	VkPipelineCacheHeaderVersionOne header;
+	if (data.size() < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, data.data(), sizeof(header));
+	return header.headerSize >= sizeof(header) && header.headerSize <= data.size()
+		&& header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& header.vendorID == properties.vendorID
+		&& header.deviceID == properties.deviceID
+		&& memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+
+class VulkanDevice;
+
+// PipelineCache is a VkPipelineCache kept on disk between runs, one file per device, so pipelines
+//	already compiled by the driver last time aren't compiled from SPIR-V again. A file whose header
+//	doesn't match the device (vendor ID, device ID, cache UUID - which a driver update changes) is
+//	ignored, and the cache starts empty. Saving (on destruction, else by save()) writes a temporary
+//	file then renames it over the old one, so a crash mid-write never leaves a truncated cache.
+class PipelineCache {
+public:
+	PipelineCache(VulkanDevice& device);
+	~PipelineCache();
+
+	PipelineCache(const PipelineCache&) = delete;
+	PipelineCache& operator=(const PipelineCache&) = delete;
+
+	VkPipelineCache get() const { return cache; }
+	bool isWarm() const { return loadedSize > 0; }		// (started with data from an earlier run)
+	size_t getLoadedSize() const { return loadedSize; }
+
+	bool save();
+
+	const std::string& getFilePath() const { return filePath; }
+
+	static void setDirectory(const std::string& path) { directory = path; }
+	static const std::string& getDirectory() { return directory; }
+
+private:
+	bool readFile(std::vector<char>& data);
+	bool isCompatible(const std::vector<char>& data) const;
+
+	VulkanDevice& device;
+	VkPhysicalDeviceProperties properties;
+	VkPipelineCache cache;
+	std::string filePath;
+	size_t loadedSize;
+
+	static std::string directory;
+};
@@ -0,0 +1,148 @@
+#include "UploadArena.h"
+#include "VulkanDevice.h"
+#include "../utils/logger/Logging.h"
+#include <stdexcept>
+#include <algorithm>
+
+const VkDeviceSize UploadArena::DEFAULT_CAPACITY;
+
+uint64_t UploadArena::blocksCreated = 0;
+
+UploadArena::UploadArena(VulkanDevice& device, VkDeviceSize capacity)
+	: device(device)
+	, used(0)
+	, highWaterMark(0)
+	, defaultAlignment(16)
+	, coherent(true)
+	, nonCoherentAtomSize(1)
+{
+	VkPhysicalDeviceProperties deviceProps;
+	vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &deviceProps);
+	defaultAlignment = std::max({ defaultAlignment, deviceProps.limits.minUniformBufferOffsetAlignment,
+								  deviceProps.limits.minStorageBufferOffsetAlignment });
+	nonCoherentAtomSize = std::max<VkDeviceSize>(deviceProps.limits.nonCoherentAtomSize, 1);
+
+	createBlock(std::max<VkDeviceSize>(capacity, defaultAlignment));
+}
+
+UploadArena::~UploadArena() {
+	for (Block& block : blocks) {
+		destroyBlock(block);
+	}
+}
+
+void UploadArena::createBlock(VkDeviceSize size) {
+	Block block{ VK_NULL_HANDLE, VK_NULL_HANDLE, nullptr, size, 0, ++blocksCreated };
+
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+					 | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+					 | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(device.getLogicalDevice(), &bufferInfo, nullptr, &block.buffer) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create upload arena buffer");
+	}
+
+	VkMemoryRequirements memRequirements;
+	vkGetBufferMemoryRequirements(device.getLogicalDevice(), block.buffer, &memRequirements);
+
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = memRequirements.size;
+	allocInfo.memoryTypeIndex = device.findMemoryType(memRequirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);	// (coherent or not; flush() covers it if not)
+
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(device.getPhysicalDevice(), &memProperties);
+	coherent = (memProperties.memoryTypes[allocInfo.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+	if (vkAllocateMemory(device.getLogicalDevice(), &allocInfo, nullptr, &block.memory) != VK_SUCCESS) {
+		vkDestroyBuffer(device.getLogicalDevice(), block.buffer, nullptr);
+		throw std::runtime_error("Failed to allocate upload arena memory");
+	}
+
+	vkBindBufferMemory(device.getLogicalDevice(), block.buffer, block.memory, 0);
+	vkMapMemory(device.getLogicalDevice(), block.memory, 0, VK_WHOLE_SIZE, 0, &block.mapped);
+
+	blocks.push_back(block);
+}
+
+void UploadArena::destroyBlock(Block& block) {
+	if (block.mapped) {
+		vkUnmapMemory(device.getLogicalDevice(), block.memory);
+	}
+	vkDestroyBuffer(device.getLogicalDevice(), block.buffer, nullptr);
+	vkFreeMemory(device.getLogicalDevice(), block.memory, nullptr);
+	block = Block{ VK_NULL_HANDLE, VK_NULL_HANDLE, nullptr, 0, 0, 0 };
+}
+
+UploadArena::Allocation UploadArena::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+	if (alignment == 0) {
+		alignment = defaultAlignment;
+	}
+
+	Block* block = &blocks.back();
+	VkDeviceSize offset = (block->offset + alignment - 1) & ~(alignment - 1);
+	if (offset + size > block->size) {
+		// Chain on a bigger block; this frame's allocations so far stay where they are
+		createBlock(std::max(block->size * 2, size + alignment));
+		block = &blocks.back();
+		offset = 0;
+		Log(LOW, "Upload arena: chained a %llu KB block", static_cast<unsigned long long>(block->size / 1024));
+	}
+
+	used += (offset - block->offset) + size;
+	highWaterMark = std::max(highWaterMark, used);
+	block->offset = offset + size;
+	return Allocation{ block->buffer, offset, static_cast<char*>(block->mapped) + offset, size, block->generation };
+}
+
+void UploadArena::flush() {
+	if (coherent) {
+		return;
+	}
+	flushRanges.clear();
+	for (const Block& block : blocks) {
+		if (block.offset == 0) {
+			continue;
+		}
+		VkMappedMemoryRange range{};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory = block.memory;
+		range.offset = 0;
+		range.size = (block.offset + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize;
+		if (range.size >= block.size) {
+			range.size = VK_WHOLE_SIZE;		// (rounding up mustn't pass the end of the allocation)
+		}
+		flushRanges.push_back(range);
+	}
+	if (!flushRanges.empty()) {
+		vkFlushMappedMemoryRanges(device.getLogicalDevice(), static_cast<uint32_t>(flushRanges.size()), flushRanges.data());
+	}
+}
+
+void UploadArena::reset() {
+	// Outgrew the block? Replace the chain with one that holds it all.
+	if (blocks.size() > 1) {
+		VkDeviceSize capacity = getCapacity();
+		for (Block& block : blocks) {
+			destroyBlock(block);
+		}
+		blocks.clear();
+		createBlock(capacity);
+		Log(LOW, "Upload arena: grew to %llu KB", static_cast<unsigned long long>(capacity / 1024));
+	}
+	blocks.back().offset = 0;
+	used = 0;
+}
+
+VkDeviceSize UploadArena::getCapacity() const {
+	VkDeviceSize capacity = 0;
+	for (const Block& block : blocks) {
+		capacity += block.size;
+	}
+	return capacity;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstring>
+
+class VulkanDevice;
+
+// UploadArena hands out a frame's transient GPU-readable data (uniforms, instance data, indirect
+//	commands) by bumping an offset through one persistently mapped buffer, and frees it all at once
+//	with reset(). Each FrameContext owns one, reset once the frame's fence shows the GPU is done with it.
+// Running out mid-frame chains on another block (leaving the frame's earlier allocations in place);
+//	the next reset() replaces the chain with one block big enough to hold it all.
+class UploadArena {
+public:
+	struct Allocation {
+		VkBuffer buffer;
+		VkDeviceSize offset;	// (into buffer: the dynamic offset or binding offset to use)
+		void* data;				// (mapped: write the data here)
+		VkDeviceSize size;
+		uint64_t generation;	// (of the block: unique to it among every arena's blocks, unlike its buffer handle,
+								//	which a block created after another's destruction may reuse)
+	};
+
+	UploadArena(VulkanDevice& device, VkDeviceSize capacity = DEFAULT_CAPACITY);
+	~UploadArena();
+
+	UploadArena(const UploadArena&) = delete;
+	UploadArena& operator=(const UploadArena&) = delete;
+
+	// Room for size bytes, aligned to alignment (a power of two), or if 0, to whatever uniform and
+	//	storage buffer offsets need on this device. Valid until the next reset().
+	Allocation allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+
+	// (allocate and copy in one)
+	template<typename T>
+	Allocation push(const T& value, VkDeviceSize alignment = 0) {
+		Allocation allocation = allocate(sizeof(T), alignment);
+		memcpy(allocation.data, &value, sizeof(T));
+		return allocation;
+	}
+
+	// Make everything written since reset() visible to the device (a no-op for host-coherent memory).
+	//	Call before submitting the commands that read it.
+	void flush();
+
+	// Free every allocation. Call only once the device has finished reading them.
+	void reset();
+
+	// Bytes allocated since reset() (alignment padding included), the most ever allocated between
+	//	resets, and the size of the block(s) holding them
+	VkDeviceSize getUsed() const { return used; }
+	VkDeviceSize getHighWaterMark() const { return highWaterMark; }
+	VkDeviceSize getCapacity() const;
+	size_t getBlockCount() const { return blocks.size(); }
+	bool isCoherent() const { return coherent; }
+
+	static const VkDeviceSize DEFAULT_CAPACITY = 1024 * 1024;
+
+private:
+	struct Block {
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		void* mapped;
+		VkDeviceSize size;
+		VkDeviceSize offset;	// (next free byte)
+		uint64_t generation;
+	};
+
+	void createBlock(VkDeviceSize size);
+	void destroyBlock(Block& block);
+
+	VulkanDevice& device;
+	std::vector<Block> blocks;
+	std::vector<VkMappedMemoryRange> flushRanges;		// (reused by each flush)
+	VkDeviceSize used;
+	VkDeviceSize highWaterMark;
+	VkDeviceSize defaultAlignment;
+	bool coherent;
+	VkDeviceSize nonCoherentAtomSize;
+
+	static uint64_t blocksCreated;		// (the last block's generation)
+};
@@ -1,5 +1,8 @@
 #include "VulkanDevice.h"
+#include "../utils/logger/Logging.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cstring>
 #include <set>
 
 const std::vector<const char*> VulkanDevice::deviceExtensions = {
@@ -13,7 +16,13 @@ VulkanDevice::VulkanDevice(VkInstance instance, VkSurfaceKHR surface)
 	, logicalDevice(VK_NULL_HANDLE)
 	, graphicsQueue(VK_NULL_HANDLE)
 	, presentQueue(VK_NULL_HANDLE)
+	, bindlessSupported(false)
+	, maxBindlessTextures(0)
+	, timestampPeriod(1.0f)
+	, timestampValidBits(0)
+	, pipelineStatisticsSupported(false)
 {
+	deviceName[0] = '\0';
 	pickPhysicalDevice();
 	createLogicalDevice();
 }
@@ -46,6 +55,12 @@ void VulkanDevice::pickPhysicalDevice() {
 	if (physicalDevice == VK_NULL_HANDLE) {
 		throw std::runtime_error("Failed to find a suitable GPU");
 	}
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	strncpy(deviceName, deviceProperties.deviceName, sizeof(deviceName) - 1);
+	deviceName[sizeof(deviceName) - 1] = '\0';
+	Log(NOTE, "Using %s%s", deviceName, isHeadless() ? " (headless)" : "");
 }
 
 void VulkanDevice::createLogicalDevice() {
@@ -65,17 +80,42 @@ void VulkanDevice::createLogicalDevice() {
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
 	deviceFeatures.fillModeNonSolid = VK_TRUE;
+	deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;	// (optional, for cached textures)
+	deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;	// (optional, for profiling)
+	pipelineStatisticsSupported = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+	queryTimestampSupport();
+
+	// Optional: just the descriptor indexing features the bindless texture array relies on.
+	queryBindlessSupport();
+	std::vector<const char*> enabledExtensions;
+	if (!isHeadless()) {
+		enabledExtensions = deviceExtensions;
+	}
+	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+	indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	if (bindlessSupported) {
+		enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+		indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+		indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+	}
 
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = bindlessSupported ? &indexingFeatures : nullptr;
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+	createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 #ifdef _DEBUG
 	const std::vector<const char*> validationLayers = {
@@ -95,13 +135,91 @@ void VulkanDevice::createLogicalDevice() {
 	vkGetDeviceQueue(logicalDevice, queueFamilies.presentFamily.value(), 0, &presentQueue);
 }
 
+void VulkanDevice::queryBindlessSupport() {
+	bindlessSupported = false;
+	maxBindlessTextures = 0;
+
+	// vkGetPhysicalDeviceFeatures2 is core as of 1.1 (which the instance requests).
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	if (deviceProperties.apiVersion < VK_API_VERSION_1_1) {
+		Log(LOW, "Bindless textures unavailable: device is Vulkan 1.0");
+		return;
+	}
+
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+	bool hasExtension = false;
+	for (const auto& extension : availableExtensions) {
+		if (strcmp(extension.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0) {
+			hasExtension = true;
+			break;
+		}
+	}
+	if (!hasExtension) {
+		Log(LOW, "Bindless textures unavailable: no %s", VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+		return;
+	}
+
+	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+	indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	VkPhysicalDeviceFeatures2 features2{};
+	features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features2.pNext = &indexingFeatures;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+	// (the fragment shader indexes the texture array by a per-draw index, which needs the core feature too)
+	if (!features2.features.shaderSampledImageArrayDynamicIndexing) {
+		Log(LOW, "Bindless textures unavailable: no dynamic indexing of sampled image arrays");
+		return;
+	}
+	if (!indexingFeatures.runtimeDescriptorArray || !indexingFeatures.descriptorBindingPartiallyBound
+	 || !indexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+	 || !indexingFeatures.descriptorBindingUpdateUnusedWhilePending) {
+		Log(LOW, "Bindless textures unavailable: missing descriptor indexing features");
+		return;
+	}
+
+	VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+	indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+	VkPhysicalDeviceProperties2 properties2{};
+	properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties2.pNext = &indexingProperties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+	maxBindlessTextures = std::min(indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+								   indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages);
+	maxBindlessTextures = std::min(maxBindlessTextures, indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers);
+	bindlessSupported = maxBindlessTextures > 0;
+	Log(LOW, "Bindless textures supported (up to %u per set)", maxBindlessTextures);
+}
+
+void VulkanDevice::queryTimestampSupport() {
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	timestampPeriod = deviceProperties.limits.timestampPeriod;
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> families(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, families.data());
+	timestampValidBits = families[queueFamilies.graphicsFamily.value()].timestampValidBits;
+
+	if (timestampValidBits == 0) {
+		Log(LOW, "GPU timestamps unavailable on the graphics queue");
+	}
+}
+
 bool VulkanDevice::isDeviceSuitable(VkPhysicalDevice device) const {
 	QueueFamilyIndices indices = findQueueFamilies(device);
 
 	bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-	bool swapchainAdequate = false;
-	if (extensionsSupported) {
+	bool swapchainAdequate = isHeadless();
+	if (extensionsSupported && !isHeadless()) {
 		SwapchainSupportDetails swapchainSupport = querySwapchainSupport(device);
 		swapchainAdequate = !swapchainSupport.formats.empty() && !swapchainSupport.presentModes.empty();
 	}
@@ -120,6 +238,9 @@ bool VulkanDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) const {
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
 	std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+	if (isHeadless()) {
+		requiredExtensions.clear();
+	}
 
 	for (const auto& extension : availableExtensions) {
 		requiredExtensions.erase(extension.extensionName);
@@ -144,7 +265,11 @@ QueueFamilyIndices VulkanDevice::findQueueFamilies(VkPhysicalDevice device) cons
 		}
 
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+		if (isHeadless()) {
+			presentSupport = indices.graphicsFamily.has_value() && indices.graphicsFamily.value() == static_cast<uint32_t>(i);
+		} else {
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+		}
 
 		if (presentSupport) {
 			indices.presentFamily = i;
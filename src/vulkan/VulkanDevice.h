@@ -23,6 +23,7 @@ class VulkanEngine;
 
 class VulkanDevice {
 public:
+	// (surface VK_NULL_HANDLE for headless use: no presenting, so no swapchain extension either)
 	VulkanDevice(VkInstance instance, VkSurfaceKHR surface);
 	~VulkanDevice();
 
@@ -35,6 +36,8 @@ public:
 	uint32_t getPresentQueueFamily() const { return queueFamilies.presentFamily.value(); }
 
 	QueueFamilyIndices getQueueFamilies() const { return queueFamilies; }
+	bool isHeadless() const { return surface == VK_NULL_HANDLE; }
+	const char* getDeviceName() const { return deviceName; }
 	SwapchainSupportDetails getSwapchainSupport() const;
 
 	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
@@ -42,6 +45,17 @@ public:
 								VkImageTiling tiling,
 								VkFormatFeatureFlags features) const;
 
+	// Descriptor indexing, for a single bindless texture array (otherwise one descriptor set per texture).
+	bool supportsBindless() const { return bindlessSupported; }
+	uint32_t getMaxBindlessTextures() const { return maxBindlessTextures; }
+
+	// GPU timing: timestamps on the graphics queue (in ticks of getTimestampPeriod() nanoseconds, of which
+	//	the low getTimestampValidBits() count), and pipeline-statistics queries (an optional feature)
+	bool supportsTimestamps() const { return timestampValidBits > 0; }
+	float getTimestampPeriod() const { return timestampPeriod; }
+	uint32_t getTimestampValidBits() const { return timestampValidBits; }
+	bool supportsPipelineStatistics() const { return pipelineStatisticsSupported; }
+
 private:
 	void pickPhysicalDevice();
 	void createLogicalDevice();
@@ -50,6 +64,8 @@ private:
 	bool checkDeviceExtensionSupport(VkPhysicalDevice device) const;
 	QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device) const;
 	SwapchainSupportDetails querySwapchainSupport(VkPhysicalDevice device) const;
+	void queryBindlessSupport();
+	void queryTimestampSupport();
 
 	VkInstance instance;
 	VkSurfaceKHR surface;
@@ -61,6 +77,14 @@ private:
 	VkQueue presentQueue;
 
 	QueueFamilyIndices queueFamilies;
+	char deviceName[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE];
+
+	bool bindlessSupported;
+	uint32_t maxBindlessTextures;
+
+	float timestampPeriod;
+	uint32_t timestampValidBits;
+	bool pipelineStatisticsSupported;
 
 	static const std::vector<const char*> deviceExtensions;
 };
\ No newline at end of file
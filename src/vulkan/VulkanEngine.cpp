@@ -1,51 +1,68 @@
 #include "VulkanEngine.h"
 #include "VulkanDevice.h"
 #include "VulkanSwapchain.h"
+#include "VulkanBuffer.h"
 #include "VulkanUtils.h"
+#include "FrameContext.h"
+#include "GpuProfiler.h"
+#include "PipelineCache.h"
 #include "../utils/logger/Logging.h"
+#include "../utils/StartupTimeline.h"
+#include "../utils/Trace.h"
 #include <stdexcept>
 #include <set>
 #include <cstring>
+#include <utility>
 
-VulkanEngine::VulkanEngine(SDL_Window* window, uint32_t width, uint32_t height)
+VulkanEngine::VulkanEngine(SDL_Window* window, uint32_t width, uint32_t height, const PacingSettings& pacing)
 	: window(window)
+	, width(width)
+	, height(height)
 	, instance(VK_NULL_HANDLE)
 	, surface(VK_NULL_HANDLE)
 	, debugMessenger(VK_NULL_HANDLE)
 	, commandPool(VK_NULL_HANDLE)
-	, currentFrame(0)
+	, pacing(pacing)
+	, framePacer(pacing.fpsCap, pacing.framesInFlight)
 	, imageIndex(0)
 {
-	(void)width; (void)height; (void)debugMessenger; // (tell compiler these are unused, so no warning)
+	(void)debugMessenger; // (tell compiler it's unused, so no warning)
 
-	createInstance();
+	{
+		STARTUP_PHASE("Vulkan instance");
+		createInstance();
 #ifdef _DEBUG
-	setupDebugMessenger();
+		setupDebugMessenger();
 #endif
-	createSurface();
-	createDevice();
+		createSurface();
+	}
+	{
+		STARTUP_PHASE("Vulkan device");
+		createDevice();
+		createPipelineCache();
+	}
+	STARTUP_PHASE("swapchain and frames");
 	createSwapchain();
 	createCommandPool();
-	createCommandBuffers();
-	createSynchronizationObjects();
+	createFrameContexts();
 }
 
 VulkanEngine::~VulkanEngine() {
 	waitIdle();
 
-	// Clean up synchronization objects
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		vkDestroySemaphore(device->getLogicalDevice(), renderFinishedSemaphores[i], nullptr);
-		vkDestroySemaphore(device->getLogicalDevice(), imageAvailableSemaphores[i], nullptr);
-		vkDestroyFence(device->getLogicalDevice(), inFlightFences[i], nullptr);
-	}
+	// Clean up per-frame synchronization objects, command pools, arenas and queries
+	gpuProfiler.reset();
+	frames.reset();
 
 	vkDestroyCommandPool(device->getLogicalDevice(), commandPool, nullptr);
 
 	swapchain.reset();
+	pipelineCache.reset();
 	device.reset();
 
-	vkDestroySurfaceKHR(instance, surface, nullptr);
+	if (surface != VK_NULL_HANDLE) {
+		vkDestroySurfaceKHR(instance, surface, nullptr);
+	}
 
 	#ifdef _DEBUG
 	if (debugMessenger != VK_NULL_HANDLE) {
@@ -67,16 +84,16 @@ void VulkanEngine::createInstance() {
 	appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 	appInfo.pEngineName = "Custom Engine";
 	appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-	appInfo.apiVersion = VK_API_VERSION_1_0;
+	appInfo.apiVersion = VK_API_VERSION_1_1;		// (for vkGetPhysicalDeviceFeatures2, used to probe optional features)
 
-	// Get required extensions
-	unsigned int extensionCount;
-	if (!SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, nullptr)) {
+	// Get required extensions (none, headless: there's no surface to present to)
+	unsigned int extensionCount = 0;
+	if (window && !SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, nullptr)) {
 		throw std::runtime_error("Failed to get SDL Vulkan extension count: " + std::string(SDL_GetError()));
 	}
 
 	std::vector<const char*> extensions(extensionCount);
-	if (!SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, extensions.data())) {
+	if (window && !SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, extensions.data())) {
 		throw std::runtime_error("Failed to get SDL Vulkan extensions: " + std::string(SDL_GetError()));
 	}
 
@@ -206,6 +223,9 @@ void VulkanEngine::createInstance() {
 }
 
 void VulkanEngine::createSurface() {
+	if (isHeadless()) {
+		return;
+	}
 	if (!SDL_Vulkan_CreateSurface(window, instance, &surface)) {
 		throw std::runtime_error("Failed to create window surface");
 	}
@@ -215,10 +235,18 @@ void VulkanEngine::createDevice() {
 	device = std::make_unique<VulkanDevice>(instance, surface);
 }
 
+void VulkanEngine::createPipelineCache() {
+	pipelineCache = std::make_unique<PipelineCache>(*device);
+}
+
 void VulkanEngine::createSwapchain() {
-	int width, height;
-	SDL_GetWindowSize(window, &width, &height);
-	swapchain = std::make_unique<VulkanSwapchain>(*device, surface, width, height);
+	if (window) {
+		int windowWidth, windowHeight;
+		SDL_GetWindowSize(window, &windowWidth, &windowHeight);
+		width = windowWidth;
+		height = windowHeight;
+	}
+	swapchain = std::make_unique<VulkanSwapchain>(*device, surface, width, height, pacing.presentMode, pacing.framesInFlight);
 }
 
 void VulkanEngine::createCommandPool() {
@@ -232,52 +260,69 @@ void VulkanEngine::createCommandPool() {
 	}
 }
 
-void VulkanEngine::createCommandBuffers() {
-	commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+void VulkanEngine::createFrameContexts() {
+	frames = std::make_unique<FrameRing>(*device, pacing.framesInFlight);
+	gpuProfiler = std::make_unique<GpuProfiler>(*device, pacing.framesInFlight);
+	Log(NOTE, "Frame pacing: %u frame%s in flight, %s present mode, %s", pacing.framesInFlight,
+		pacing.framesInFlight == 1 ? "" : "s",
+		isHeadless() ? "offscreen (no)" : PacingSettings::presentModeName(swapchain->getPresentMode()),
+		pacing.fpsCap > 0.0f ? ("capped at " + std::to_string(static_cast<int>(pacing.fpsCap)) + " FPS").c_str() : "uncapped");
+}
 
-	VkCommandBufferAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.commandPool = commandPool;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+VkPresentModeKHR VulkanEngine::getPresentMode() const {
+	return swapchain->getPresentMode();
+}
 
-	if (vkAllocateCommandBuffers(device->getLogicalDevice(), &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
-		throw std::runtime_error("Failed to allocate command buffers");
+// Note which submitted frames the GPU has finished since last time (for the latency estimate)
+void VulkanEngine::pollFrameCompletions() {
+	for (uint32_t i = 0; i < frames->getFramesInFlight(); ++i) {
+		if (framePacer.isFramePending(i)
+		 && vkGetFenceStatus(device->getLogicalDevice(), frames->getFrame(i).inFlightFence) == VK_SUCCESS) {
+			framePacer.frameCompleted(i);
+		}
 	}
 }
 
-void VulkanEngine::createSynchronizationObjects() {
-	imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-
-	VkSemaphoreCreateInfo semaphoreInfo{};
-	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+FrameContext& VulkanEngine::getCurrentFrame() {
+	return frames->current();
+}
 
-	VkFenceCreateInfo fenceInfo{};
-	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+uint32_t VulkanEngine::getFrameIndex() const {
+	return frames->getFrameIndex();
+}
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		if (vkCreateSemaphore(device->getLogicalDevice(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-			vkCreateSemaphore(device->getLogicalDevice(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-			vkCreateFence(device->getLogicalDevice(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
-			throw std::runtime_error("Failed to create synchronization objects for a frame");
-		}
-	}
+uint32_t VulkanEngine::getFramesInFlight() const {
+	return frames->getFramesInFlight();
 }
 
 VkCommandBuffer VulkanEngine::beginFrame() {
-	vkWaitForFences(device->getLogicalDevice(), 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+	TRACE_SCOPE("VulkanEngine::beginFrame");
+
+	// (waits for this frame's last submission, then recycles its command pool and upload arena)
+	pollFrameCompletions();
+	FrameContext* frameContext;
+	{
+		TRACE_SCOPE("wait for frame fence");
+		frameContext = &frames->begin();
+	}
+	FrameContext& frame = *frameContext;
+	framePacer.frameCompleted(frame.index);
 
-	VkResult result = vkAcquireNextImageKHR(
-		device->getLogicalDevice(),
-		swapchain->getSwapchain(),
-		UINT64_MAX,
-		imageAvailableSemaphores[currentFrame],
-		VK_NULL_HANDLE,
-		&imageIndex
-	);
+	// Headless, each frame in flight has an offscreen image of its own, free now its fence has signaled
+	VkResult result = VK_SUCCESS;
+	if (isHeadless()) {
+		imageIndex = frame.index;
+	} else {
+		TRACE_SCOPE("acquire swapchain image");
+		result = vkAcquireNextImageKHR(
+			device->getLogicalDevice(),
+			swapchain->getSwapchain(),
+			UINT64_MAX,
+			frame.imageAvailableSemaphore,
+			VK_NULL_HANDLE,
+			&imageIndex
+		);
+	}
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
 		int width, height;
@@ -288,43 +333,62 @@ VkCommandBuffer VulkanEngine::beginFrame() {
 		throw std::runtime_error("Failed to acquire swap chain image");
 	}
 
-	vkResetFences(device->getLogicalDevice(), 1, &inFlightFences[currentFrame]);
-
-	vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+	vkResetFences(device->getLogicalDevice(), 1, &frame.inFlightFence);
 
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-	if (vkBeginCommandBuffer(commandBuffers[currentFrame], &beginInfo) != VK_SUCCESS) {
+	if (vkBeginCommandBuffer(frame.commandBuffer, &beginInfo) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to begin recording command buffer");
 	}
+	gpuProfiler->beginFrame(frame.commandBuffer, frame.index, frames->getFrameNumber());
 
-	return commandBuffers[currentFrame];
+	return frame.commandBuffer;
 }
 
 void VulkanEngine::endFrame(VkCommandBuffer commandBuffer) {
+	TRACE_SCOPE("VulkanEngine::endFrame");
+	gpuProfiler->endFrame(commandBuffer);
 	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to record command buffer");
 	}
 
+	// Whatever the frame wrote to its upload arena, the GPU must see
+	FrameContext& frame = frames->current();
+	frame.uploadArena->flush();
+
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
+	VkSemaphore waitSemaphores[] = {frame.imageAvailableSemaphore};
 	VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-	submitInfo.waitSemaphoreCount = 1;
+	if (swapchain->isRenderScaled()) {
+		waitStages[0] |= VK_PIPELINE_STAGE_TRANSFER_BIT;		// (the image is blitted to, not rendered to)
+	}
+	submitInfo.waitSemaphoreCount = isHeadless() ? 0 : 1;		// (headless: no acquire, nor present, to order)
 	submitInfo.pWaitSemaphores = waitSemaphores;
 	submitInfo.pWaitDstStageMask = waitStages;
 
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 
-	VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-	submitInfo.signalSemaphoreCount = 1;
+	VkSemaphore signalSemaphores[] = {frame.renderFinishedSemaphore};
+	submitInfo.signalSemaphoreCount = isHeadless() ? 0 : 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
-	if (vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-		throw std::runtime_error("Failed to submit draw command buffer");
+	{
+		TRACE_SCOPE("submit");
+		if (vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo, frame.inFlightFence) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to submit draw command buffer");
+		}
+	}
+	framePacer.frameSubmitted(frame.index);
+
+	if (isHeadless()) {
+		pollFrameCompletions();
+		frames->advance();
+		return;
 	}
 
 	VkPresentInfoKHR presentInfo{};
@@ -337,7 +401,11 @@ void VulkanEngine::endFrame(VkCommandBuffer commandBuffer) {
 	presentInfo.pSwapchains = swapChains;
 	presentInfo.pImageIndices = &imageIndex;
 
-	VkResult result = vkQueuePresentKHR(device->getPresentQueue(), &presentInfo);
+	VkResult result;
+	{
+		TRACE_SCOPE("present");
+		result = vkQueuePresentKHR(device->getPresentQueue(), &presentInfo);
+	}
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
 		int width, height;
@@ -347,7 +415,8 @@ void VulkanEngine::endFrame(VkCommandBuffer commandBuffer) {
 		throw std::runtime_error("Failed to present swap chain image");
 	}
 
-	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	pollFrameCompletions();
+	frames->advance();
 }
 
 void VulkanEngine::handleResize(uint32_t width, uint32_t height) {
@@ -359,6 +428,82 @@ void VulkanEngine::waitIdle() {
 	vkDeviceWaitIdle(device->getLogicalDevice());
 }
 
+bool VulkanEngine::readLastImage(std::vector<uint8_t>& rgba, uint32_t& imageWidth, uint32_t& imageHeight) {
+	if (!swapchain->isOffscreen()) {
+		return false;	// (a presented image belongs to the presentation engine; no TRANSFER_SRC usage either)
+	}
+	waitIdle();
+
+	VkExtent2D extent = swapchain->getExtent();
+	VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+	VulkanBuffer staging(*device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+						 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandPool = commandPool;
+	allocInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer;
+	if (vkAllocateCommandBuffers(device->getLogicalDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate readback command buffer");
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	// The render pass (or the upscale after it) left the image in TRANSFER_SRC_OPTIMAL; make its writes
+	//	visible to the copy
+	bool scaled = swapchain->isRenderScaled();
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = scaled ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = swapchain->getImage(imageIndex);
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(commandBuffer, scaled ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkBufferImageCopy region{};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = {extent.width, extent.height, 1};
+	vkCmdCopyImageToBuffer(commandBuffer, barrier.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						   staging.getBuffer(), 1, &region);
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	vkQueueSubmit(device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(device->getGraphicsQueue());
+	vkFreeCommandBuffers(device->getLogicalDevice(), commandPool, 1, &commandBuffer);
+
+	staging.map();
+	const uint8_t* pixels = static_cast<const uint8_t*>(staging.getMappedData());
+	rgba.assign(pixels, pixels + size);
+	staging.unmap();
+
+	if (swapchain->getImageFormat() == VK_FORMAT_B8G8R8A8_SRGB) {
+		for (size_t i = 0; i < rgba.size(); i += 4) {
+			std::swap(rgba[i], rgba[i + 2]);
+		}
+	}
+	imageWidth = extent.width;
+	imageHeight = extent.height;
+	return true;
+}
+
 #ifdef _DEBUG
 void VulkanEngine::setupDebugMessenger() {
 	VkDebugUtilsMessengerCreateInfoEXT createInfo{};
@@ -3,16 +3,23 @@
 #include <vulkan/vulkan.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_vulkan.h>
+#include "FramePacer.h"
 #include <vector>
 #include <memory>
 
 class VulkanDevice;
 class VulkanSwapchain;
 class VulkanBuffer;
+class FrameRing;
+struct FrameContext;
+class GpuProfiler;
+class PipelineCache;
 
 class VulkanEngine {
 public:
-	VulkanEngine(SDL_Window* window, uint32_t width, uint32_t height);
+	// With no window (nullptr), runs headless: no surface or swapchain, rendering offscreen at width × height
+	//	to images that can be read back (e.g. for benchmarking where there's no display, as on lavapipe).
+	VulkanEngine(SDL_Window* window, uint32_t width, uint32_t height, const PacingSettings& pacing = PacingSettings());
 	~VulkanEngine();
 
 	void handleResize(uint32_t width, uint32_t height);
@@ -23,10 +30,29 @@ public:
 	VkSurfaceKHR getSurface() const { return surface; }
 	VulkanDevice* getDevice() const { return device.get(); }
 	VulkanSwapchain* getSwapchain() const { return swapchain.get(); }
-	VkCommandPool getCommandPool() const { return commandPool; }
+	VkCommandPool getCommandPool() const { return commandPool; }		// (for one-off commands, outside frames)
+	PipelineCache& getPipelineCache() const { return *pipelineCache; }
 
 	uint32_t getCurrentImageIndex() const { return imageIndex; }
 
+	bool isHeadless() const { return window == nullptr; }
+	// Copy the image last rendered to (headless only) into tightly packed 8-bit RGBA, after waiting for it
+	bool readLastImage(std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height);
+
+	// Frames in flight: the one being recorded (between beginFrame and endFrame), and the ring of them
+	FrameContext& getCurrentFrame();
+	uint32_t getFrameIndex() const;
+	uint32_t getFramesInFlight() const;
+	const FrameRing& getFrameRing() const { return *frames; }
+
+	// Frame pacing: frames in flight and present mode are fixed at creation; the FPS cap may change
+	const PacingSettings& getPacingSettings() const { return pacing; }
+	FramePacer& getFramePacer() { return framePacer; }
+	VkPresentModeKHR getPresentMode() const;		// (as chosen: the one asked for, if supported)
+
+	// GPU timestamps of each frame (and scopes within it), read back a few frames later
+	GpuProfiler& getGpuProfiler() { return *gpuProfiler; }
+
 	VkCommandBuffer beginFrame();
 	void endFrame(VkCommandBuffer commandBuffer);
 
@@ -34,12 +60,14 @@ private:
 	void createInstance();
 	void createSurface();
 	void createDevice();
+	void createPipelineCache();
 	void createSwapchain();
 	void createCommandPool();
-	void createCommandBuffers();
-	void createSynchronizationObjects();
+	void createFrameContexts();
+	void pollFrameCompletions();
 
 	SDL_Window* window;
+	uint32_t width, height;		// (of the offscreen images, when headless; else the window decides)
 
 	VkInstance instance;
 	VkSurfaceKHR surface;
@@ -47,18 +75,18 @@ private:
 
 	std::unique_ptr<VulkanDevice> device;
 	std::unique_ptr<VulkanSwapchain> swapchain;
+	std::unique_ptr<PipelineCache> pipelineCache;	// (saved to disk when destroyed)
 
 	VkCommandPool commandPool;
-	std::vector<VkCommandBuffer> commandBuffers;
 
-	std::vector<VkSemaphore> imageAvailableSemaphores;
-	std::vector<VkSemaphore> renderFinishedSemaphores;
-	std::vector<VkFence> inFlightFences;
+	// Per-frame fences, semaphores, command pools and upload arenas
+	std::unique_ptr<FrameRing> frames;
 
-	uint32_t currentFrame;
-	uint32_t imageIndex;
+	PacingSettings pacing;
+	FramePacer framePacer;
+	std::unique_ptr<GpuProfiler> gpuProfiler;
 
-	static const int MAX_FRAMES_IN_FLIGHT = 2;
+	uint32_t imageIndex;
 
 #ifdef _DEBUG
 	void setupDebugMessenger();
@@ -1,69 +1,318 @@
 #include "VulkanPipeline.h"
 #include "VulkanDevice.h"
 #include "VulkanSwapchain.h"
+#include "PipelineCache.h"
 #include "../rendering/Mesh.h"
 #include "../utils/logger/Logging.h"
+#include "../utils/Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <fstream>
 #include <stdexcept>
 #include <cstring>
 
-VulkanPipeline::VulkanPipeline(VulkanDevice& device, VulkanSwapchain& swapchain, VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSetLayout textureDescriptorSetLayout)
+const uint32_t VulkanPipeline::MAX_COMPILE_THREADS;
+
+namespace {
+	const char* typeName(PipelineType type) {
+		return (type == PipelineType::TEXTURED) ? "textured"
+			 : (type == PipelineType::BINDLESS) ? "bindless" : "untextured";
+	}
+
+	// The shaders' specialization constants, by constant_id (each module ignores any it doesn't declare)
+	struct SpecializationData {
+		int32_t lightingModel;		// 0
+		VkBool32 alphaTest;			// 1
+		VkBool32 vertexColors;		// 2
+	};
+}
+
+uint32_t PipelineVariant::key() const {
+	return static_cast<uint32_t>(lighting) | (alphaTest ? 1u << 4 : 0) | (vertexColors ? 1u << 5 : 0)
+		 | (wireframe ? 1u << 6 : 0) | (depthPrepass ? 1u << 7 : 0);
+}
+
+std::string PipelineVariant::describe() const {
+	const char* lightingNames[] = { "Phong", "Blinn-Phong", "unlit" };
+	std::string description = lightingNames[static_cast<int>(lighting)];
+	if (alphaTest)		description += ", alpha test";
+	if (!vertexColors)	description += ", no vertex colors";
+	if (wireframe)		description += ", wireframe";
+	if (depthPrepass)	description += ", after depth pre-pass";
+	return description;
+}
+
+VulkanPipeline::VulkanPipeline(VulkanDevice& device, VulkanSwapchain& swapchain, PipelineCache& pipelineCache, VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSetLayout textureDescriptorSetLayout,
+							   VkDescriptorSetLayout bindlessDescriptorSetLayout)
 	: device(device)
 	, swapchain(swapchain)
+	, pipelineCache(pipelineCache)
 	, descriptorSetLayout(descriptorSetLayout)
 	, textureDescriptorSetLayout(textureDescriptorSetLayout)
+	, bindlessDescriptorSetLayout(bindlessDescriptorSetLayout)
 	, untexturedPipelineLayout(VK_NULL_HANDLE)
 	, untexturedPipeline(VK_NULL_HANDLE)
 	, texturedPipelineLayout(VK_NULL_HANDLE)
 	, texturedPipeline(VK_NULL_HANDLE)
+	, bindlessPipelineLayout(VK_NULL_HANDLE)
+	, bindlessPipeline(VK_NULL_HANDLE)
+	, depthPrepassPipeline(VK_NULL_HANDLE)
+	, usingCannedShaders(false)
+	, stopping(false)
 {
+	for (int i = 0; i < TYPE_COUNT; ++i) {
+		vertexModules[i] = fragmentModules[i] = VK_NULL_HANDLE;
+	}
 	createGraphicsPipelines();
+
+	uint32_t threadCount = std::min(MAX_COMPILE_THREADS, std::max(1u, std::thread::hardware_concurrency() / 2));
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		compilers.emplace_back(&VulkanPipeline::compileLoop, this);
+	}
 }
 
 VulkanPipeline::~VulkanPipeline() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		jobs.clear();
+	}
+	jobAvailable.notify_all();
+	for (std::thread& compiler : compilers) {
+		compiler.join();
+	}
+
+	VkDevice logicalDevice = device.getLogicalDevice();
+	for (auto& [key, variant] : variants) {
+		// (the defaults are listed too, but destroyed below)
+		if (variant.pipeline != VK_NULL_HANDLE && variant.pipeline != untexturedPipeline
+		 && variant.pipeline != texturedPipeline && variant.pipeline != bindlessPipeline) {
+			vkDestroyPipeline(logicalDevice, variant.pipeline, nullptr);
+		}
+	}
+	for (int i = 0; i < TYPE_COUNT; ++i) {
+		if (vertexModules[i] != VK_NULL_HANDLE) {
+			vkDestroyShaderModule(logicalDevice, vertexModules[i], nullptr);
+		}
+		if (fragmentModules[i] != VK_NULL_HANDLE) {
+			vkDestroyShaderModule(logicalDevice, fragmentModules[i], nullptr);
+		}
+	}
+
 	if (untexturedPipeline != VK_NULL_HANDLE) {
 		vkDestroyPipeline(device.getLogicalDevice(), untexturedPipeline, nullptr);
 	}
 	if (texturedPipeline != VK_NULL_HANDLE) {
 		vkDestroyPipeline(device.getLogicalDevice(), texturedPipeline, nullptr);
 	}
+	if (bindlessPipeline != VK_NULL_HANDLE) {
+		vkDestroyPipeline(device.getLogicalDevice(), bindlessPipeline, nullptr);
+	}
+	if (depthPrepassPipeline != VK_NULL_HANDLE) {
+		vkDestroyPipeline(device.getLogicalDevice(), depthPrepassPipeline, nullptr);
+	}
 	if (untexturedPipelineLayout != VK_NULL_HANDLE) {
 		vkDestroyPipelineLayout(device.getLogicalDevice(), untexturedPipelineLayout, nullptr);
 	}
 	if (texturedPipelineLayout != VK_NULL_HANDLE) {
 		vkDestroyPipelineLayout(device.getLogicalDevice(), texturedPipelineLayout, nullptr);
 	}
+	if (bindlessPipelineLayout != VK_NULL_HANDLE) {
+		vkDestroyPipelineLayout(device.getLogicalDevice(), bindlessPipelineLayout, nullptr);
+	}
 }
 
 void VulkanPipeline::createGraphicsPipelines() {
 	Log(LOW, "Creating graphics pipelines...");
+	auto startTime = std::chrono::high_resolution_clock::now();
 	createPipeline(PipelineType::UNTEXTURED, untexturedPipelineLayout, untexturedPipeline);
 	createPipeline(PipelineType::TEXTURED, texturedPipelineLayout, texturedPipeline);
+	if (bindlessDescriptorSetLayout != VK_NULL_HANDLE) {
+		try {
+			createPipeline(PipelineType::BINDLESS, bindlessPipelineLayout, bindlessPipeline);
+		} catch (const std::exception& e) {
+			Log(WARN, "Bindless pipeline unavailable, using per-texture descriptor sets: %s", e.what());
+		}
+	}
+	if (!usingCannedShaders) {
+		try {
+			createDepthPrepassPipeline();
+		} catch (const std::exception& e) {
+			Log(WARN, "Depth pre-pass unavailable: %s", e.what());
+		}
+	}
+	double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	Log(NOTE, "Graphics pipelines created in %.1f ms (%s pipeline cache)", elapsedMs,
+		pipelineCache.isWarm() ? "warm" : "cold");
 }
 
+// A type's layout, shader modules and default variant (the rest of its variants come later, on demand)
 void VulkanPipeline::createPipeline(PipelineType type, VkPipelineLayout& pipelineLayout, VkPipeline& pipeline) {
-	const char* pipelineTypeName = (type == PipelineType::TEXTURED) ? "textured" : "untextured";
+	const char* pipelineTypeName = typeName(type);
 	Log(LOW, "Creating %s graphics pipeline...", pipelineTypeName);
 
 	// Load shaders
 	auto [vertShaderCode, fragShaderCode] = loadShaders(type);
 
-	VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-	VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+	int index = static_cast<int>(type);
+	vertexModules[index] = createShaderModule(vertShaderCode);
+	fragmentModules[index] = createShaderModule(fragShaderCode);
 
 	Log(LOW, "Shader modules created successfully");
 
+	// Pipeline layout - textured/untextured use the same descriptor set layouts for compatibility;
+	//	bindless shares set 0 but takes the whole texture array as set 1.
+	std::vector<VkDescriptorSetLayout> setLayouts = {descriptorSetLayout,
+		type == PipelineType::BINDLESS ? bindlessDescriptorSetLayout : textureDescriptorSetLayout};
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+	pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+
+	if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create " + std::string(pipelineTypeName) + " pipeline layout");
+	}
+	Log(LOW, "Pipeline layout created successfully");
+
+	PipelineVariant defaultVariant;
+	auto startTime = std::chrono::high_resolution_clock::now();
+	pipeline = buildPipeline(type, defaultVariant);
+	if (pipeline == VK_NULL_HANDLE) {
+		throw std::runtime_error("Failed to create " + std::string(pipelineTypeName) + " graphics pipeline");
+	}
+	Log(LOW, "%s graphics pipeline created successfully", pipelineTypeName);
+
+	Variant& variant = variants[variantKey(type, defaultVariant)];
+	variant.pipeline = pipeline;
+	variant.stats = { variantName(type, defaultVariant), 0, 0,
+		std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count(), true, false };
+}
+
+// Depth only: the position attribute alone, transformed as the main pass's vertex shaders do (all declare
+//	gl_Position invariant, so the main pass's LESS_OR_EQUAL finds exactly the depth written here)
+void VulkanPipeline::createDepthPrepassPipeline() {
+	Log(LOW, "Creating depth pre-pass pipeline...");
+	VkShaderModule vertShaderModule = createShaderModule(readFile("shaders/vertex_depth.vert.glsl.spv"));
+
 	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
 	vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
 	vertShaderStageInfo.module = vertShaderModule;
 	vertShaderStageInfo.pName = "main";
 
+	// Vertex input (same stride as every pipeline's, reading position only)
+	auto bindingDescription = Vertex::getBindingDescription();
+	auto attributeDescriptions = Vertex::getAttributeDescriptions();
+
+	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputInfo.vertexBindingDescriptionCount = 1;
+	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+	vertexInputInfo.vertexAttributeDescriptionCount = 1;
+	vertexInputInfo.pVertexAttributeDescriptions = &attributeDescriptions[0];
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+	VkPipelineViewportStateCreateInfo viewportState = createViewportState();
+
+	VkPipelineRasterizationStateCreateInfo rasterizer{};
+	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizer.depthClampEnable = VK_FALSE;
+	rasterizer.rasterizerDiscardEnable = VK_FALSE;
+	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizer.lineWidth = 1.0f;
+	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizer.depthBiasEnable = VK_FALSE;
+
+	VkPipelineMultisampleStateCreateInfo multisampling{};
+	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisampling.sampleShadingEnable = VK_FALSE;
+	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil{};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = VK_TRUE;
+	depthStencil.depthWriteEnable = VK_TRUE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+	depthStencil.depthBoundsTestEnable = VK_FALSE;
+	depthStencil.stencilTestEnable = VK_FALSE;
+
+	// (no color attachments in this subpass, so nothing to blend)
+	VkPipelineColorBlendStateCreateInfo colorBlending{};
+	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlending.attachmentCount = 0;
+
+	std::vector<VkDynamicState> dynamicStates = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+	VkPipelineDynamicStateCreateInfo dynamicState{};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+	dynamicState.pDynamicStates = dynamicStates.data();
+
+	VkGraphicsPipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = 1;
+	pipelineInfo.pStages = &vertShaderStageInfo;
+	pipelineInfo.pVertexInputState = &vertexInputInfo;
+	pipelineInfo.pInputAssemblyState = &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterizer;
+	pipelineInfo.pMultisampleState = &multisampling;
+	pipelineInfo.pDepthStencilState = &depthStencil;
+	pipelineInfo.pColorBlendState = &colorBlending;
+	pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.layout = untexturedPipelineLayout;
+	pipelineInfo.renderPass = swapchain.getRenderPass();
+	pipelineInfo.subpass = VulkanSwapchain::DEPTH_PREPASS_SUBPASS;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+	VkResult result = vkCreateGraphicsPipelines(device.getLogicalDevice(), pipelineCache.get(), 1, &pipelineInfo, nullptr, &depthPrepassPipeline);
+	vkDestroyShaderModule(device.getLogicalDevice(), vertShaderModule, nullptr);
+	if (result != VK_SUCCESS) {
+		depthPrepassPipeline = VK_NULL_HANDLE;
+		throw std::runtime_error("Failed to create depth pre-pass pipeline");
+	}
+	Log(LOW, "Depth pre-pass pipeline created successfully");
+}
+
+// One variant of a type, from its shader modules (safe to call from any thread, once those exist)
+VkPipeline VulkanPipeline::buildPipeline(PipelineType type, const PipelineVariant& variant) {
+	int index = static_cast<int>(type);
+
+	SpecializationData specializationData{ static_cast<int32_t>(variant.lighting),
+										   variant.alphaTest ? VK_TRUE : VK_FALSE,
+										   variant.vertexColors ? VK_TRUE : VK_FALSE };
+	VkSpecializationMapEntry mapEntries[] = {
+		{ 0, offsetof(SpecializationData, lightingModel), sizeof(int32_t) },
+		{ 1, offsetof(SpecializationData, alphaTest), sizeof(VkBool32) },
+		{ 2, offsetof(SpecializationData, vertexColors), sizeof(VkBool32) }
+	};
+	VkSpecializationInfo specializationInfo{};
+	specializationInfo.mapEntryCount = static_cast<uint32_t>(sizeof(mapEntries) / sizeof(mapEntries[0]));
+	specializationInfo.pMapEntries = mapEntries;
+	specializationInfo.dataSize = sizeof(specializationData);
+	specializationInfo.pData = &specializationData;
+
+	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+	vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	vertShaderStageInfo.module = vertexModules[index];
+	vertShaderStageInfo.pName = "main";
+	vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
 	VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
 	fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageInfo.module = fragShaderModule;
+	fragShaderStageInfo.module = fragmentModules[index];
 	fragShaderStageInfo.pName = "main";
+	fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
 
 	VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
@@ -92,7 +341,7 @@ void VulkanPipeline::createPipeline(PipelineType type, VkPipelineLayout& pipelin
 	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
 	rasterizer.depthClampEnable = VK_FALSE;
 	rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizer.polygonMode = variant.wireframe ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL;	// (the device enables fillModeNonSolid)
 	rasterizer.lineWidth = 1.0f;
 	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
 	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;	// Matches OpenGL models.
@@ -108,8 +357,8 @@ void VulkanPipeline::createPipeline(PipelineType type, VkPipelineLayout& pipelin
 	VkPipelineDepthStencilStateCreateInfo depthStencil{};
 	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencil.depthTestEnable = VK_TRUE;
-	depthStencil.depthWriteEnable = VK_TRUE;
-	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+	depthStencil.depthWriteEnable = variant.depthPrepass ? VK_FALSE : VK_TRUE;
+	depthStencil.depthCompareOp = variant.depthPrepass ? VK_COMPARE_OP_LESS_OR_EQUAL : VK_COMPARE_OP_LESS;
 	depthStencil.depthBoundsTestEnable = VK_FALSE;
 	depthStencil.stencilTestEnable = VK_FALSE;
 
@@ -139,18 +388,6 @@ void VulkanPipeline::createPipeline(PipelineType type, VkPipelineLayout& pipelin
 	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
 	dynamicState.pDynamicStates = dynamicStates.data();
 
-	// Pipeline layout - both pipelines use the same descriptor set layouts for compatibility.
-	std::vector<VkDescriptorSetLayout> setLayouts = {descriptorSetLayout, textureDescriptorSetLayout};
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
-	pipelineLayoutInfo.pSetLayouts = setLayouts.data();
-
-	if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-		throw std::runtime_error("Failed to create " + std::string(pipelineTypeName) + " pipeline layout");
-	}
-	Log(LOW, "Pipeline layout created successfully");
-
 	// Graphics pipeline
 	VkGraphicsPipelineCreateInfo pipelineInfo{};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -164,18 +401,111 @@ void VulkanPipeline::createPipeline(PipelineType type, VkPipelineLayout& pipelin
 	pipelineInfo.pDepthStencilState = &depthStencil;
 	pipelineInfo.pColorBlendState = &colorBlending;
 	pipelineInfo.pDynamicState = &dynamicState;
-	pipelineInfo.layout = pipelineLayout;
+	pipelineInfo.layout = getPipelineLayout(type);
 	pipelineInfo.renderPass = swapchain.getRenderPass();
-	pipelineInfo.subpass = 0;
+	pipelineInfo.subpass = VulkanSwapchain::MAIN_SUBPASS;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-	if (vkCreateGraphicsPipelines(device.getLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
-		throw std::runtime_error("Failed to create " + std::string(pipelineTypeName) + " graphics pipeline");
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	if (vkCreateGraphicsPipelines(device.getLogicalDevice(), pipelineCache.get(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+		return VK_NULL_HANDLE;
 	}
-	Log(LOW, "%s graphics pipeline created successfully", pipelineTypeName);
+	return pipeline;
+}
 
-	vkDestroyShaderModule(device.getLogicalDevice(), fragShaderModule, nullptr);
-	vkDestroyShaderModule(device.getLogicalDevice(), vertShaderModule, nullptr);
+VkPipeline VulkanPipeline::getPipeline(PipelineType type, const PipelineVariant& variant) {
+	VkPipeline fallback = getPipeline(type);
+	std::lock_guard<std::mutex> lock(mutex);
+	Variant& entry = findVariant(type, variant);
+	++entry.stats.requests;
+	if (entry.pipeline == VK_NULL_HANDLE) {
+		++entry.stats.fallbacks;
+		return fallback;
+	}
+	return entry.pipeline;
+}
+
+bool VulkanPipeline::requestPipeline(PipelineType type, const PipelineVariant& variant) {
+	std::lock_guard<std::mutex> lock(mutex);
+	return findVariant(type, variant).pipeline != VK_NULL_HANDLE;
+}
+
+// (with the mutex held) A variant's entry, queueing it to compile if it's new
+VulkanPipeline::Variant& VulkanPipeline::findVariant(PipelineType type, const PipelineVariant& variant) {
+	auto [it, added] = variants.try_emplace(variantKey(type, variant));
+	Variant& entry = it->second;
+	if (added) {
+		entry.pipeline = VK_NULL_HANDLE;
+		entry.stats = { variantName(type, variant), 0, 0, 0.0, false, false };
+		jobs.push_back({ type, variant });
+		jobAvailable.notify_one();
+	}
+	return entry;
+}
+
+void VulkanPipeline::compileLoop() {
+	Tracer::setThreadName("pipeline compiler");
+	while (true) {
+		CompileJob job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			if (stopping)
+				return;
+			job = jobs.front();
+			jobs.pop_front();
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		if (vertexModules[static_cast<int>(job.type)] != VK_NULL_HANDLE) {		// (a type that failed has none)
+			TRACE_SCOPE("compile pipeline variant");
+			pipeline = buildPipeline(job.type, job.variant);
+		}
+		double compileMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		Variant& entry = variants[variantKey(job.type, job.variant)];
+		entry.pipeline = pipeline;
+		entry.stats.compileMs = compileMs;
+		entry.stats.ready = pipeline != VK_NULL_HANDLE;
+		entry.stats.failed = !entry.stats.ready;
+		if (entry.stats.failed) {
+			Log(WARN, "Pipeline variant %s failed to compile, drawing with the default", entry.stats.name.c_str());
+		} else {
+			Log(LOW, "Pipeline variant %s compiled in %.1f ms", entry.stats.name.c_str(), compileMs);
+		}
+	}
+}
+
+uint64_t VulkanPipeline::variantKey(PipelineType type, const PipelineVariant& variant) {
+	return (static_cast<uint64_t>(type) << 32) | variant.key();
+}
+
+std::string VulkanPipeline::variantName(PipelineType type, const PipelineVariant& variant) {
+	return std::string(typeName(type)) + " (" + variant.describe() + ")";
+}
+
+std::vector<PipelineVariantStats> VulkanPipeline::getVariantStats() const {
+	std::vector<PipelineVariantStats> stats;
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const auto& [key, variant] : variants) {
+		stats.push_back(variant.stats);
+	}
+	std::sort(stats.begin(), stats.end(), [](const PipelineVariantStats& a, const PipelineVariantStats& b) {
+		return a.name < b.name;
+	});
+	return stats;
+}
+
+void VulkanPipeline::logVariantReport() const {
+	std::vector<PipelineVariantStats> stats = getVariantStats();
+	Log(NOTE, "Pipeline variants: %zu", stats.size());
+	for (const PipelineVariantStats& variant : stats) {
+		Log(NOTE, "  %-52s %s %7.1f ms, %u requests (%u drawn with the default)", variant.name.c_str(),
+			variant.ready ? "compiled" : variant.failed ? "FAILED  " : "pending ", variant.compileMs,
+			variant.requests, variant.fallbacks);
+	}
 }
 
 std::pair<std::vector<uint32_t>, std::vector<uint32_t>> VulkanPipeline::loadShaders(PipelineType type) {
@@ -204,6 +534,7 @@ std::pair<std::vector<uint32_t>, std::vector<uint32_t>> VulkanPipeline::loadShad
 		} catch (const std::exception& e) {
 			Log(LOW, "Could not load compiled SPIR-V shaders: %s", e.what());
 			Log(LOW, "Falling back to embedded shaders...");
+			usingCannedShaders = true;
 
 			auto [cannedVert, cannedFrag] = cannedShaders();
 			vertShaderCode = cannedVert;
@@ -211,6 +542,25 @@ std::pair<std::vector<uint32_t>, std::vector<uint32_t>> VulkanPipeline::loadShad
 
 			Log(LOW, "Using embedded SPIR-V shaders");
 		}
+	} else if (type == PipelineType::BINDLESS) {
+		try {
+			Log(LOW, "Attempting to load bindless SPIR-V shaders...");
+			Log(LOW, "  Looking for: shaders/vertex_bindless.vert.glsl.spv");
+			Log(LOW, "  Looking for: shaders/fragment_bindless.frag.glsl.spv");
+
+			auto vertSpirv = readFile("shaders/vertex_bindless.vert.glsl.spv");
+			auto fragSpirv = readFile("shaders/fragment_bindless.frag.glsl.spv");
+
+			vertShaderCode.resize(vertSpirv.size() / sizeof(uint32_t));
+			fragShaderCode.resize(fragSpirv.size() / sizeof(uint32_t));
+
+			memcpy(vertShaderCode.data(), vertSpirv.data(), vertSpirv.size());
+			memcpy(fragShaderCode.data(), fragSpirv.data(), fragSpirv.size());
+
+			Log(LOW, "Successfully loaded compiled SPIR-V shaders!");
+		} catch (const std::exception& e) {
+			throw std::runtime_error(std::string("Bindless shaders not found: ") + e.what());
+		}
 	} else { // PipelineType::TEXTURED - Load texture-specific shaders:
 		try {
 			Log(LOW, "Attempting to load textured SPIR-V shaders...");
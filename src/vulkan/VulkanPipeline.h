@@ -1,32 +1,118 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
-#include <vector>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 class VulkanDevice;
 class VulkanSwapchain;
+class PipelineCache;
 
 enum class PipelineType {
 	UNTEXTURED,
-	TEXTURED
+	TEXTURED,
+	BINDLESS	// Textured and untextured in one, indexing a texture array (needs descriptor indexing)
+};
+
+enum class LightingModel {
+	PHONG,
+	BLINN_PHONG,
+	UNLIT
+};
+
+// How a pipeline varies within its type: by the shaders' specialization constants (lighting model,
+//	alpha test, vertex colors), and by fixed-function state (wireframe, depth pre-pass). Every variant
+//	of a type is built from that type's one pair of shader modules.
+struct PipelineVariant {
+	LightingModel lighting = LightingModel::PHONG;
+	bool alphaTest = false;			// (discard texels under half opacity - textured and bindless only)
+	bool vertexColors = true;		// (false draws as if every vertex were white)
+	bool wireframe = false;
+	bool depthPrepass = false;		// (follows the depth pre-pass: tests LESS_OR_EQUAL against its depth, writes none)
+
+	uint32_t key() const;
+	bool isDefault() const { return key() == PipelineVariant().key(); }
+	std::string describe() const;
+};
+
+struct PipelineVariantStats {
+	std::string name;
+	uint32_t requests;		// (times bound, or asked to be)
+	uint32_t fallbacks;		// (of those, drawn with the type's default pipeline instead, while this compiled)
+	double compileMs;
+	bool ready;
+	bool failed;
 };
 
 class VulkanPipeline {
 public:
-	VulkanPipeline(VulkanDevice& device, VulkanSwapchain& swapchain, VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSetLayout textureDescriptorSetLayout);
+	// The bindless pipeline is only created if a bindless texture set layout is given.
+	VulkanPipeline(VulkanDevice& device, VulkanSwapchain& swapchain, PipelineCache& pipelineCache, VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSetLayout textureDescriptorSetLayout,
+				   VkDescriptorSetLayout bindlessDescriptorSetLayout = VK_NULL_HANDLE);
 	~VulkanPipeline();
 
+	// Each type's default variant, created up front
 	VkPipeline getPipeline(PipelineType type) const {
-		return type == PipelineType::TEXTURED ? texturedPipeline : untexturedPipeline;
+		switch (type) {
+			case PipelineType::TEXTURED:	return texturedPipeline;
+			case PipelineType::BINDLESS:	return bindlessPipeline;
+			default:						return untexturedPipeline;
+		}
 	}
+	bool hasBindlessPipeline() const { return bindlessPipeline != VK_NULL_HANDLE; }
+
+	// Any other variant is compiled on a worker thread when first asked for; until it's ready (or if
+	//	it fails) this returns the type's default, to draw with meanwhile.
+	VkPipeline getPipeline(PipelineType type, const PipelineVariant& variant);
+
+	// Whether a variant is ready to draw with, asking for it to be compiled if it isn't yet (without
+	//	counting as a request - for deciding up front between ways to draw a frame)
+	bool requestPipeline(PipelineType type, const PipelineVariant& variant);
+
+	// The depth pre-pass pipeline: positions only, no fragment shader, writing depth in the render
+	//	pass's first subpass (laid out as the untextured pipeline is, so shares its set 0). Null if its
+	//	shader wasn't found.
+	VkPipeline getDepthPrepassPipeline() const { return depthPrepassPipeline; }
+	bool hasDepthPrepassPipeline() const { return depthPrepassPipeline != VK_NULL_HANDLE; }
+
 	VkPipelineLayout getPipelineLayout(PipelineType type) const {
-		return type == PipelineType::TEXTURED ? texturedPipelineLayout : untexturedPipelineLayout;
+		switch (type) {
+			case PipelineType::TEXTURED:	return texturedPipelineLayout;
+			case PipelineType::BINDLESS:	return bindlessPipelineLayout;
+			default:						return untexturedPipelineLayout;
+		}
 	}
 
+	// Every variant so far (the defaults included): how often each was asked for, and its compile time
+	std::vector<PipelineVariantStats> getVariantStats() const;
+	void logVariantReport() const;
+
+	static const uint32_t MAX_COMPILE_THREADS = 2;
+
 private:
+	struct CompileJob {
+		PipelineType type;
+		PipelineVariant variant;
+	};
+	struct Variant {
+		VkPipeline pipeline;
+		PipelineVariantStats stats;
+	};
+
 	void createGraphicsPipelines();
 	void createPipeline(PipelineType type, VkPipelineLayout& pipelineLayout, VkPipeline& pipeline);
+	void createDepthPrepassPipeline();
+	VkPipeline buildPipeline(PipelineType type, const PipelineVariant& variant);
+	Variant& findVariant(PipelineType type, const PipelineVariant& variant);
+	void compileLoop();
+	static uint64_t variantKey(PipelineType type, const PipelineVariant& variant);
+	static std::string variantName(PipelineType type, const PipelineVariant& variant);
+
 	std::pair<std::vector<uint32_t>, std::vector<uint32_t>> loadShaders(PipelineType type);
 	VkPipelineViewportStateCreateInfo createViewportState();
 	std::pair<std::vector<uint32_t>, std::vector<uint32_t>> cannedShaders();
@@ -36,8 +122,10 @@ private:
 
 	VulkanDevice& device;
 	VulkanSwapchain& swapchain;
+	PipelineCache& pipelineCache;
 	VkDescriptorSetLayout descriptorSetLayout;
 	VkDescriptorSetLayout textureDescriptorSetLayout;
+	VkDescriptorSetLayout bindlessDescriptorSetLayout;
 
 	// Untextured pipeline
 	VkPipelineLayout untexturedPipelineLayout;
@@ -46,4 +134,25 @@ private:
 	// Textured pipeline
 	VkPipelineLayout texturedPipelineLayout;
 	VkPipeline texturedPipeline;
+
+	// Bindless pipeline (optional)
+	VkPipelineLayout bindlessPipelineLayout;
+	VkPipeline bindlessPipeline;
+
+	// Depth pre-pass pipeline (optional)
+	VkPipeline depthPrepassPipeline;
+	bool usingCannedShaders;		// (the untextured fallback shaders, which transform differently, so no pre-pass)
+
+	// Each type's shader modules (indexed by PipelineType), kept for compiling its variants
+	static const int TYPE_COUNT = 3;
+	VkShaderModule vertexModules[TYPE_COUNT];
+	VkShaderModule fragmentModules[TYPE_COUNT];
+
+	// Variants (keyed by variantKey), and the worker threads compiling them
+	mutable std::mutex mutex;
+	std::unordered_map<uint64_t, Variant> variants;
+	std::vector<std::thread> compilers;
+	std::condition_variable jobAvailable;
+	std::deque<CompileJob> jobs;
+	bool stopping;
 };
@@ -1,22 +1,34 @@
 #include "VulkanSwapchain.h"
 #include "VulkanDevice.h"
+#include "FramePacer.h"
+#include "../utils/logger/Logging.h"
 #include <stdexcept>
+#include <array>
 #include <algorithm>
 #include <limits>
 
-VulkanSwapchain::VulkanSwapchain(VulkanDevice& device, VkSurfaceKHR surface, uint32_t width, uint32_t height)
+bool VulkanSwapchain::renderScalingEnabled = false;
+
+VulkanSwapchain::VulkanSwapchain(VulkanDevice& device, VkSurfaceKHR surface, uint32_t width, uint32_t height,
+								 VkPresentModeKHR presentMode, uint32_t framesInFlight)
 	: device(device)
 	, surface(surface)
 	, width(width)
 	, height(height)
+	, requestedPresentMode(presentMode)
+	, presentMode(presentMode)
+	, framesInFlight(framesInFlight)
 	, swapchain(VK_NULL_HANDLE)
 	, renderPass(VK_NULL_HANDLE)
 	, depthImage(VK_NULL_HANDLE)
 	, depthImageMemory(VK_NULL_HANDLE)
 	, depthImageView(VK_NULL_HANDLE)
+	, renderScaling(renderScalingEnabled)
+	, renderScale(1.0f)
 {
 	createSwapchain();
 	createImageViews();
+	createRenderTargets();
 	createRenderPass();
 	createDepthResources();
 	createFramebuffers();
@@ -24,18 +36,29 @@ VulkanSwapchain::VulkanSwapchain(VulkanDevice& device, VkSurfaceKHR surface, uin
 
 VulkanSwapchain::~VulkanSwapchain() {
 	cleanup();
+	// (the render pass outlives recreate(), as pipelines - and their compiles in flight - refer to it)
+	if (renderPass != VK_NULL_HANDLE) {
+		vkDestroyRenderPass(device.getLogicalDevice(), renderPass, nullptr);
+	}
 }
 
 void VulkanSwapchain::createSwapchain() {
+	if (isOffscreen()) {
+		createOffscreenImages();
+		return;
+	}
 	SwapchainSupportDetails swapchainSupport = device.getSwapchainSupport();
 
 	VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapchainSupport.formats);
-	VkPresentModeKHR presentMode = chooseSwapPresentMode(swapchainSupport.presentModes);
+	presentMode = chooseSwapPresentMode(swapchainSupport.presentModes);
 	VkExtent2D extent = chooseSwapExtent(swapchainSupport.capabilities);
 
-	uint32_t imageCount = swapchainSupport.capabilities.minImageCount + 1;
-	if (swapchainSupport.capabilities.maxImageCount > 0 && imageCount > swapchainSupport.capabilities.maxImageCount) {
-		imageCount = swapchainSupport.capabilities.maxImageCount;
+	uint32_t imageCount = chooseImageCount(swapchainSupport.capabilities);
+
+	if (renderScaling && (!(swapchainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+						  || !supportsRenderScaling(surfaceFormat.format))) {
+		Log(WARN, "Render scaling unsupported (can't blit to the swapchain's images), rendering at full resolution");
+		renderScaling = false;
 	}
 
 	VkSwapchainCreateInfoKHR createInfo{};
@@ -48,6 +71,9 @@ void VulkanSwapchain::createSwapchain() {
 	createInfo.imageExtent = extent;
 	createInfo.imageArrayLayers = 1;
 	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	if (renderScaling) {
+		createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;		// (blitted to, from the intermediate)
+	}
 
 	QueueFamilyIndices indices = device.getQueueFamilies();
 	uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
@@ -79,6 +105,55 @@ void VulkanSwapchain::createSwapchain() {
 	this->extent = extent;
 }
 
+void VulkanSwapchain::createOffscreenImages() {
+	imageFormat = device.findSupportedFormat({VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB},
+											 VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
+	extent = {width, height};
+	if (renderScaling && !supportsRenderScaling(imageFormat)) {
+		Log(WARN, "Render scaling unsupported (can't blit the offscreen images), rendering at full resolution");
+		renderScaling = false;
+	}
+
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent.width = extent.width;
+	imageInfo.extent.height = extent.height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = imageFormat;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	if (renderScaling) {
+		imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	}
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	images.resize(std::max(framesInFlight, 1u));
+	imageMemories.resize(images.size());
+	for (size_t i = 0; i < images.size(); i++) {
+		if (vkCreateImage(device.getLogicalDevice(), &imageInfo, nullptr, &images[i]) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create offscreen color image");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(device.getLogicalDevice(), images[i], &memRequirements);
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = memRequirements.size;
+		allocInfo.memoryTypeIndex = device.findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if (vkAllocateMemory(device.getLogicalDevice(), &allocInfo, nullptr, &imageMemories[i]) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate offscreen color image memory");
+		}
+		vkBindImageMemory(device.getLogicalDevice(), images[i], imageMemories[i], 0);
+	}
+}
+
 void VulkanSwapchain::createImageViews() {
 	imageViews.resize(images.size());
 
@@ -104,6 +179,127 @@ void VulkanSwapchain::createImageViews() {
 	}
 }
 
+// One intermediate color image (at full size, so any scale fits) per output image, for render scaling
+void VulkanSwapchain::createRenderTargets() {
+	if (!renderScaling) {
+		return;
+	}
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent.width = extent.width;
+	imageInfo.extent.height = extent.height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = imageFormat;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	renderImages.resize(images.size());
+	renderImageMemories.resize(images.size());
+	renderImageViews.resize(images.size());
+	for (size_t i = 0; i < images.size(); i++) {
+		if (vkCreateImage(device.getLogicalDevice(), &imageInfo, nullptr, &renderImages[i]) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create render target image");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(device.getLogicalDevice(), renderImages[i], &memRequirements);
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = memRequirements.size;
+		allocInfo.memoryTypeIndex = device.findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if (vkAllocateMemory(device.getLogicalDevice(), &allocInfo, nullptr, &renderImageMemories[i]) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate render target image memory");
+		}
+		vkBindImageMemory(device.getLogicalDevice(), renderImages[i], renderImageMemories[i], 0);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = renderImages[i];
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = imageFormat;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		if (vkCreateImageView(device.getLogicalDevice(), &viewInfo, nullptr, &renderImageViews[i]) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create render target image view");
+		}
+	}
+}
+
+// Blitting from the intermediate image to the output, filtered, and rendering to the intermediate
+bool VulkanSwapchain::supportsRenderScaling(VkFormat format) const {
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(device.getPhysicalDevice(), format, &properties);
+	VkFormatFeatureFlags required = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT
+								  | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (properties.optimalTilingFeatures & required) == required;
+}
+
+void VulkanSwapchain::setRenderScale(float scale) {
+	if (renderScaling) {
+		renderScale = std::clamp(scale, MIN_RENDER_SCALE, 1.0f);
+	}
+}
+
+VkExtent2D VulkanSwapchain::getRenderExtent() const {
+	if (!renderScaling) {
+		return extent;
+	}
+	return { std::max(1u, static_cast<uint32_t>(extent.width * renderScale + 0.5f)),
+			 std::max(1u, static_cast<uint32_t>(extent.height * renderScale + 0.5f)) };
+}
+
+void VulkanSwapchain::recordUpscale(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+	if (!renderScaling) {
+		return;
+	}
+	// (the intermediate image is already TRANSFER_SRC_OPTIMAL, its writes made visible, by the render pass)
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = images[imageIndex];
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkExtent2D renderExtent = getRenderExtent();
+	VkImageBlit blit{};
+	blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	blit.srcSubresource.layerCount = 1;
+	blit.srcOffsets[1] = { static_cast<int32_t>(renderExtent.width), static_cast<int32_t>(renderExtent.height), 1 };
+	blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	blit.dstSubresource.layerCount = 1;
+	blit.dstOffsets[1] = { static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1 };
+	vkCmdBlitImage(commandBuffer, renderImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				   images[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+	// (presenting waits on the frame's semaphore, and reading back offscreen on its fence)
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = isOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+						 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
 void VulkanSwapchain::createRenderPass() {
 	VkAttachmentDescription colorAttachment{};
 	colorAttachment.format = imageFormat;
@@ -113,7 +309,7 @@ void VulkanSwapchain::createRenderPass() {
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	colorAttachment.finalLayout = (isOffscreen() || renderScaling) ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 	VkAttachmentDescription depthAttachment{};
 	depthAttachment.format = findDepthFormat();
@@ -133,29 +329,66 @@ void VulkanSwapchain::createRenderPass() {
 	depthAttachmentRef.attachment = 1;
 	depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-	VkSubpassDescription subpass{};
+	// Two subpasses: an optional depth-only pre-pass, then the main pass, testing against the depth
+	//	the pre-pass laid down (when it ran - otherwise the pre-pass subpass is simply left empty).
+	std::array<VkSubpassDescription, 2> subpasses{};
+	VkSubpassDescription& prepass = subpasses[DEPTH_PREPASS_SUBPASS];
+	prepass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	prepass.colorAttachmentCount = 0;
+	prepass.pDepthStencilAttachment = &depthAttachmentRef;
+
+	VkSubpassDescription& subpass = subpasses[MAIN_SUBPASS];
 	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 	subpass.colorAttachmentCount = 1;
 	subpass.pColorAttachments = &colorAttachmentRef;
 	subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
-	VkSubpassDependency dependency{};
+	std::array<VkSubpassDependency, 4> dependencies{};
+	VkSubpassDependency& depthDependency = dependencies[0];
+	depthDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	depthDependency.dstSubpass = DEPTH_PREPASS_SUBPASS;
+	depthDependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	depthDependency.srcAccessMask = 0;
+	depthDependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	depthDependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	VkSubpassDependency& dependency = dependencies[1];
 	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-	dependency.dstSubpass = 0;
+	dependency.dstSubpass = MAIN_SUBPASS;
 	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 	dependency.srcAccessMask = 0;
 	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
+	// (the main pass reads - and without the pre-pass, writes - the depth the pre-pass wrote)
+	VkSubpassDependency& prepassDependency = dependencies[2];
+	prepassDependency.srcSubpass = DEPTH_PREPASS_SUBPASS;
+	prepassDependency.dstSubpass = MAIN_SUBPASS;
+	prepassDependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	prepassDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	prepassDependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	prepassDependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	prepassDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+	// (render scaling: the blit after the render pass reads what it drew)
+	VkSubpassDependency& upscaleDependency = dependencies[3];
+	upscaleDependency.srcSubpass = MAIN_SUBPASS;
+	upscaleDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+	upscaleDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	upscaleDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	upscaleDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	upscaleDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	uint32_t dependencyCount = renderScaling ? 4 : 3;
+
 	std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
 	VkRenderPassCreateInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
 	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
 	renderPassInfo.pAttachments = attachments.data();
-	renderPassInfo.subpassCount = 1;
-	renderPassInfo.pSubpasses = &subpass;
-	renderPassInfo.dependencyCount = 1;
-	renderPassInfo.pDependencies = &dependency;
+	renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+	renderPassInfo.pSubpasses = subpasses.data();
+	renderPassInfo.dependencyCount = dependencyCount;
+	renderPassInfo.pDependencies = dependencies.data();
 
 	if (vkCreateRenderPass(device.getLogicalDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to create render pass");
@@ -221,7 +454,7 @@ void VulkanSwapchain::createFramebuffers() {
 
 	for (size_t i = 0; i < imageViews.size(); i++) {
 		std::array<VkImageView, 2> attachments = {
-			imageViews[i],
+			renderScaling ? renderImageViews[i] : imageViews[i],
 			depthImageView
 		};
 
@@ -250,6 +483,7 @@ void VulkanSwapchain::recreate(uint32_t width, uint32_t height) {
 
 	createSwapchain();
 	createImageViews();
+	createRenderTargets();
 	createDepthResources();
 	createFramebuffers();
 }
@@ -278,15 +512,25 @@ void VulkanSwapchain::cleanup() {
 	}
 	imageViews.clear();
 
+	for (size_t i = 0; i < renderImages.size(); i++) {
+		vkDestroyImageView(device.getLogicalDevice(), renderImageViews[i], nullptr);
+		vkDestroyImage(device.getLogicalDevice(), renderImages[i], nullptr);
+		vkFreeMemory(device.getLogicalDevice(), renderImageMemories[i], nullptr);
+	}
+	renderImageViews.clear();
+	renderImageMemories.clear();
+	renderImages.clear();
+
 	if (swapchain != VK_NULL_HANDLE) {
 		vkDestroySwapchainKHR(device.getLogicalDevice(), swapchain, nullptr);
 		swapchain = VK_NULL_HANDLE;
 	}
-
-	if (renderPass != VK_NULL_HANDLE) {
-		vkDestroyRenderPass(device.getLogicalDevice(), renderPass, nullptr);
-		renderPass = VK_NULL_HANDLE;
+	for (size_t i = 0; i < imageMemories.size(); i++) {
+		vkDestroyImage(device.getLogicalDevice(), images[i], nullptr);
+		vkFreeMemory(device.getLogicalDevice(), imageMemories[i], nullptr);
 	}
+	imageMemories.clear();
+	images.clear();
 }
 
 VkSurfaceFormatKHR VulkanSwapchain::chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) {
@@ -301,14 +545,31 @@ VkSurfaceFormatKHR VulkanSwapchain::chooseSwapSurfaceFormat(const std::vector<Vk
 
 VkPresentModeKHR VulkanSwapchain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
 	for (const auto& availablePresentMode : availablePresentModes) {
-		if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+		if (availablePresentMode == requestedPresentMode) {
 			return availablePresentMode;
 		}
 	}
 
+	// (only the first time: once fallen back to FIFO, recreating it falls back again quietly)
+	if (presentMode == requestedPresentMode && requestedPresentMode != VK_PRESENT_MODE_FIFO_KHR) {
+		Log(WARN, "Present mode %s not supported, using fifo", PacingSettings::presentModeName(requestedPresentMode));
+	}
 	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+// Enough images for every frame in flight to have one while another is on screen; MAILBOX wants one
+//	more besides, to have a finished frame to swap in at each refresh without holding up rendering.
+uint32_t VulkanSwapchain::chooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities) const {
+	uint32_t imageCount = std::max(capabilities.minImageCount, framesInFlight + 1);
+	if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+		imageCount = std::max(imageCount, 3u);
+	}
+	if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount) {
+		imageCount = capabilities.maxImageCount;
+	}
+	return imageCount;
+}
+
 VkExtent2D VulkanSwapchain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) {
 	if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
 		return capabilities.currentExtent;
@@ -7,7 +7,11 @@ class VulkanDevice;
 
 class VulkanSwapchain {
 public:
-	VulkanSwapchain(VulkanDevice& device, VkSurfaceKHR surface, uint32_t width, uint32_t height);
+	// (presentMode is used if supported, else FIFO, which always is; the image count follows it and
+	//	the frames in flight, so there's always an image to render the next frame to.) With no surface,
+	//	renders offscreen instead: to one color image per frame in flight, left ready to copy from.
+	VulkanSwapchain(VulkanDevice& device, VkSurfaceKHR surface, uint32_t width, uint32_t height,
+					VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR, uint32_t framesInFlight = 2);
 	~VulkanSwapchain();
 
 	void recreate(uint32_t width, uint32_t height);
@@ -18,11 +22,39 @@ public:
 	VkRenderPass getRenderPass() const { return renderPass; }
 	VkFramebuffer getFramebuffer(uint32_t index) const { return framebuffers[index]; }
 	uint32_t getImageCount() const { return static_cast<uint32_t>(images.size()); }
+	VkPresentModeKHR getPresentMode() const { return presentMode; }
+
+	bool isOffscreen() const { return surface == VK_NULL_HANDLE; }
+	VkImage getImage(uint32_t index) const { return images[index]; }
+
+	// The render pass's subpasses: depth only (left empty unless the depth pre-pass is on), then color
+	static const uint32_t DEPTH_PREPASS_SUBPASS = 0;
+	static const uint32_t MAIN_SUBPASS = 1;
+
+	// Render scaling: the render pass draws into an intermediate color image per swapchain image instead,
+	//	to a corner of it getRenderScale() the output's width and height, which recordUpscale() blits
+	//	(filtered) to fill the output image. Only if enabled before the swapchain is created, and the
+	//	format can be blitted with linear filtering; else the render pass draws straight to the output.
+	static void setRenderScalingEnabled(bool enable) { renderScalingEnabled = enable; }
+	bool isRenderScaled() const { return renderScaling; }
+
+	void setRenderScale(float scale);		// (clamped to MIN_RENDER_SCALE..1; ignored unless render scaled)
+	float getRenderScale() const { return renderScale; }
+	VkExtent2D getRenderExtent() const;		// (the part of the framebuffer to draw to)
+
+	// After the render pass: blits what it drew to the output image, leaving that ready to present
+	//	(or, offscreen, to copy from). Does nothing unless render scaled.
+	void recordUpscale(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+	static constexpr float MIN_RENDER_SCALE = 0.25f;
 
 private:
 	void createSwapchain();
+	void createOffscreenImages();
 	void createImageViews();
 	void createRenderPass();
+	void createRenderTargets();
+	bool supportsRenderScaling(VkFormat format) const;
 	void createDepthResources();
 	void createFramebuffers();
 
@@ -31,14 +63,19 @@ private:
 	VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 	VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
 	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
+	uint32_t chooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities) const;
 	VkFormat findDepthFormat();
 
 	VulkanDevice& device;
 	VkSurfaceKHR surface;
 	uint32_t width, height;
+	VkPresentModeKHR requestedPresentMode;
+	VkPresentModeKHR presentMode;
+	uint32_t framesInFlight;
 
 	VkSwapchainKHR swapchain;
 	std::vector<VkImage> images;
+	std::vector<VkDeviceMemory> imageMemories;		// (offscreen only; a swapchain owns its images)
 	std::vector<VkImageView> imageViews;
 	VkFormat imageFormat;
 	VkExtent2D extent;
@@ -49,4 +86,12 @@ private:
 	VkImage depthImage;
 	VkDeviceMemory depthImageMemory;
 	VkImageView depthImageView;
+
+	// Render scaling (see above): an intermediate color image per output image, drawn to in its corner
+	bool renderScaling;
+	float renderScale;
+	std::vector<VkImage> renderImages;
+	std::vector<VkDeviceMemory> renderImageMemories;
+	std::vector<VkImageView> renderImageViews;
+	static bool renderScalingEnabled;
 };
\ No newline at end of file
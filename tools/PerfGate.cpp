@@ -0,0 +1,403 @@
+//
+// PerfGate.cpp
+//	Performance regression gate: compares benchmark results (coreBench --json, and the viewer's
+//	--stats from headless runs and camera-path replays) against a checked-in baseline of earlier runs,
+//	printing a table of every metric and exiting with failure if any got slower.
+//
+// Usage: perfGate --write-baseline BASELINE result.json...
+//			(collects repeat runs' results into BASELINE, keeping the tolerances it has)
+//		  perfGate [--tolerance PERCENT] [--alpha A] BASELINE result.json...
+//			(compares repeat runs' results with BASELINE; exits with failure on a regression)
+//
+// A metric regresses when its median across runs is slower than the baseline's by more than its
+//	tolerance, and - given repeat runs on both sides - a one-sided Mann-Whitney U test says it's
+//	slower with p < alpha (0.05). With too few runs for p ever to get that low (its least is
+//	1 / C(m + n, n): 1/6 for 2 and 2, 1/20 for 3 and 3), the test can't decide, so instead the
+//	bootstrap 95% confidence interval of the change must lie wholly beyond the tolerance. With a
+//	single run either side, the tolerance alone decides. The interval is shown alongside either way.
+//	Tolerances are a percentage: 5 unless --tolerance says otherwise, or the baseline's "tolerances"
+//	list has a longer "match" (substring of the metric name) for it.
+//
+// Lavapipe runs entirely on the CPU, so this works anywhere, e.g.:
+//	VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./3dObjViewer --headless
+//		--replay-path path.json --stats run1.json		(then run2.json, and so on)
+//
+#include "utils/JsonSupport.h"
+#include "utils/logger/Logging.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	const double DEFAULT_TOLERANCE_PERCENT = 5.0;
+	const double DEFAULT_ALPHA = 0.05;
+	const int BOOTSTRAP_RESAMPLES = 2000;
+	const size_t EXACT_TEST_LIMIT = 20;		// (runs per side, beyond which the test's normal approximation is used)
+
+	using Metrics = std::map<std::string, std::vector<double>>;		// (each metric's value in every run)
+
+	struct Tolerance {
+		std::string match;
+		double percent;
+	};
+
+	json loadJson(const std::string& filename) {
+		std::ifstream file(filename);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to open " + filename);
+		}
+		std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		return json::parse(content);
+	}
+
+	// Pull every gated metric (all times, in ms: lower is better) out of one run's results
+	void addRunMetrics(const json& run, Metrics& metrics) {
+		if (run.contains("benchmarks")) {		// (coreBench)
+			const json& benchmarks = run["benchmarks"];
+			for (size_t i = 0; i < benchmarks.size(); ++i) {
+				const json& benchmark = benchmarks[i];
+				std::string name = "bench/" + benchmark["name"].get<std::string>();
+				metrics[name + " p50"].push_back(benchmark["p50Ms"].get<double>());
+				metrics[name + " p95"].push_back(benchmark["p95Ms"].get<double>());
+			}
+		}
+		if (run.contains("frame")) {			// (the viewer's --stats)
+			bool replay = run.contains("cameraPath") && !run["cameraPath"].get<std::string>().empty();
+			std::string prefix = replay ? "replay/" : "frames/";
+			for (const char* section : { "frame", "cpu", "gpu" }) {
+				if (!run.contains(section)) {
+					continue;
+				}
+				const json& stats = run[section];
+				for (const char* percentile : { "p50", "p95", "p99" }) {
+					metrics[prefix + section + " " + percentile].push_back(stats[std::string(percentile) + "Ms"].get<double>());
+				}
+			}
+		}
+	}
+
+	double median(std::vector<double> values) {
+		if (values.empty()) {
+			return 0.0;
+		}
+		size_t middle = values.size() / 2;
+		std::nth_element(values.begin(), values.begin() + middle, values.end());
+		if (values.size() % 2 == 1) {
+			return values[middle];
+		}
+		return (*std::max_element(values.begin(), values.begin() + middle) + values[middle]) / 2.0;
+	}
+
+	// One-sided Mann-Whitney U test: the probability of 'current' being at least this much larger than
+	//	'baseline' by chance. Exact for small samples without ties, else the normal approximation
+	//	(with tie and continuity corrections).
+	double mannWhitneyGreater(const std::vector<double>& baseline, const std::vector<double>& current) {
+		size_t n = current.size(), m = baseline.size();
+		double u = 0.0;
+		bool ties = false;
+		for (double c : current) {
+			for (double b : baseline) {
+				u += c > b ? 1.0 : (c == b ? 0.5 : 0.0);
+				ties = ties || c == b;
+			}
+		}
+
+		if (!ties && n <= EXACT_TEST_LIMIT && m <= EXACT_TEST_LIMIT) {
+			// Ways to interleave i current values with j baseline ones so that current's win u pairs
+			std::vector<std::vector<std::vector<double>>> ways(n + 1,
+				std::vector<std::vector<double>>(m + 1, std::vector<double>(n * m + 1, 0.0)));
+			for (size_t i = 0; i <= n; ++i) {
+				for (size_t j = 0; j <= m; ++j) {
+					if (i == 0 || j == 0) {
+						ways[i][j][0] = 1.0;
+						continue;
+					}
+					for (size_t pairs = 0; pairs <= i * j; ++pairs) {		// (the largest is current's, or baseline's)
+						ways[i][j][pairs] = (pairs >= j ? ways[i - 1][j][pairs - j] : 0.0) + ways[i][j - 1][pairs];
+					}
+				}
+			}
+			double total = 0.0, atLeast = 0.0;
+			for (size_t pairs = 0; pairs <= n * m; ++pairs) {
+				total += ways[n][m][pairs];
+				atLeast += pairs >= static_cast<size_t>(u) ? ways[n][m][pairs] : 0.0;
+			}
+			return atLeast / total;
+		}
+
+		std::vector<std::pair<double, bool>> pooled;		// (value, and whether from current)
+		for (double c : current) pooled.push_back({ c, true });
+		for (double b : baseline) pooled.push_back({ b, false });
+		std::sort(pooled.begin(), pooled.end());
+		double tieTerm = 0.0;
+		for (size_t i = 0; i < pooled.size(); ) {
+			size_t j = i;
+			while (j < pooled.size() && pooled[j].first == pooled[i].first) ++j;
+			double t = static_cast<double>(j - i);
+			tieTerm += t * t * t - t;
+			i = j;
+		}
+		double total = static_cast<double>(n + m);
+		double mean = n * m / 2.0;
+		double variance = n * m / 12.0 * ((total + 1.0) - tieTerm / (total * (total - 1.0)));
+		if (variance <= 0.0) {
+			return 0.5;
+		}
+		double z = (u - mean - 0.5) / std::sqrt(variance);
+		return 0.5 * std::erfc(z / std::sqrt(2.0));
+	}
+
+	// The least p the exact test can give m baseline and n current runs: all current ones above every
+	//	baseline one, 1 of the C(m + n, n) equally likely orderings
+	double smallestMannWhitneyP(size_t m, size_t n) {
+		double orderings = 1.0;
+		for (size_t i = 1; i <= n; ++i) {
+			orderings = orderings * static_cast<double>(m + i) / static_cast<double>(i);
+		}
+		return 1.0 / orderings;
+	}
+
+	// Bootstrap 95% confidence interval of the relative change in median (resampling both sides)
+	std::pair<double, double> bootstrapChange(const std::vector<double>& baseline, const std::vector<double>& current) {
+		std::mt19937 random(12345);		// (fixed, so the same results always print the same interval)
+		std::uniform_int_distribution<size_t> pickBaseline(0, baseline.size() - 1), pickCurrent(0, current.size() - 1);
+		std::vector<double> changes, baselineSample(baseline.size()), currentSample(current.size());
+		changes.reserve(BOOTSTRAP_RESAMPLES);
+		for (int resample = 0; resample < BOOTSTRAP_RESAMPLES; ++resample) {
+			for (double& value : baselineSample) value = baseline[pickBaseline(random)];
+			for (double& value : currentSample) value = current[pickCurrent(random)];
+			double baselineMedian = median(baselineSample);
+			if (baselineMedian > 0.0) {
+				changes.push_back(median(currentSample) / baselineMedian - 1.0);
+			}
+		}
+		if (changes.empty()) {
+			return { 0.0, 0.0 };
+		}
+		std::sort(changes.begin(), changes.end());
+		return { changes[static_cast<size_t>(0.025 * (changes.size() - 1))],
+				 changes[static_cast<size_t>(0.975 * (changes.size() - 1))] };
+	}
+
+	double toleranceFor(const std::string& metric, const std::vector<Tolerance>& tolerances, double defaultPercent) {
+		const Tolerance* best = nullptr;
+		for (const Tolerance& tolerance : tolerances) {
+			if (metric.find(tolerance.match) != std::string::npos
+			 && (!best || tolerance.match.size() > best->match.size())) {
+				best = &tolerance;
+			}
+		}
+		return best ? best->percent : defaultPercent;
+	}
+
+	std::vector<Tolerance> readTolerances(const json& baseline) {
+		std::vector<Tolerance> tolerances;
+		if (baseline.contains("tolerances")) {
+			const json& list = baseline["tolerances"];
+			for (size_t i = 0; i < list.size(); ++i) {
+				tolerances.push_back({ list[i]["match"].get<std::string>(), list[i]["percent"].get<double>() });
+			}
+		}
+		return tolerances;
+	}
+
+	Metrics readBaselineMetrics(const json& baseline) {
+		Metrics metrics;
+		const json& list = baseline["metrics"];
+		for (size_t i = 0; i < list.size(); ++i) {
+			const json& values = list[i]["values"];
+			std::vector<double>& series = metrics[list[i]["name"].get<std::string>()];
+			for (size_t j = 0; j < values.size(); ++j) {
+				series.push_back(values[j].get<double>());
+			}
+		}
+		return metrics;
+	}
+
+	bool writeBaseline(const std::string& filename, const Metrics& metrics, const std::vector<Tolerance>& tolerances,
+					   size_t runs) {
+		json tolerancesJson = json::array();
+		for (const Tolerance& tolerance : tolerances) {
+			tolerancesJson.push_back(json::object({ {"match", tolerance.match}, {"percent", tolerance.percent} }));
+		}
+		json metricsJson = json::array();
+		for (const auto& metric : metrics) {
+			json values = json::array();
+			for (double value : metric.second) {
+				values.push_back(value);
+			}
+			metricsJson.push_back(json::object({ {"name", metric.first}, {"values", values} }));
+		}
+		json baseline;
+		baseline["runs"] = static_cast<double>(runs);
+		baseline["tolerances"] = tolerancesJson;
+		baseline["metrics"] = metricsJson;
+
+		std::ofstream file(filename);
+		if (!file) {
+			return false;
+		}
+		file << baseline.dump(4) << std::endl;
+		return true;
+	}
+
+	// (in whichever unit keeps it readable)
+	std::string formatMs(double milliseconds) {
+		char text[32];
+		if (milliseconds >= 1.0) {
+			snprintf(text, sizeof(text), "%.2f ms", milliseconds);
+		} else if (milliseconds >= 1e-3) {
+			snprintf(text, sizeof(text), "%.2f us", milliseconds * 1e3);
+		} else {
+			snprintf(text, sizeof(text), "%.1f ns", milliseconds * 1e6);
+		}
+		return text;
+	}
+
+	std::string formatPercent(double fraction) {
+		char text[32];
+		snprintf(text, sizeof(text), "%+.1f%%", fraction * 100.0);
+		return text;
+	}
+
+	int usage() {
+		Log(ERROR, "Usage: perfGate --write-baseline BASELINE result.json...\n"
+				   "       perfGate [--tolerance PERCENT] [--alpha A] BASELINE result.json...");
+		return 2;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	std::string writeBaselineFile;
+	double defaultTolerance = DEFAULT_TOLERANCE_PERCENT;
+	double alpha = DEFAULT_ALPHA;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc)
+			writeBaselineFile = argv[++i];
+		else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+			defaultTolerance = atof(argv[++i]);
+		else if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc)
+			alpha = atof(argv[++i]);
+		else
+			files.push_back(argv[i]);
+	}
+
+	try {
+		if (!writeBaselineFile.empty()) {
+			if (files.empty()) {
+				return usage();
+			}
+			std::vector<Tolerance> tolerances;
+			std::ifstream existing(writeBaselineFile);
+			if (existing.good()) {
+				tolerances = readTolerances(loadJson(writeBaselineFile));
+			}
+			Metrics metrics;
+			for (const std::string& file : files) {
+				addRunMetrics(loadJson(file), metrics);
+			}
+			if (!writeBaseline(writeBaselineFile, metrics, tolerances, files.size())) {
+				Log(ERROR, "Can't write %s", writeBaselineFile.c_str());
+				return 2;
+			}
+			Log(RAW, "Baseline of %zu metrics from %zu runs written to %s", metrics.size(), files.size(),
+				writeBaselineFile.c_str());
+			return EXIT_SUCCESS;
+		}
+
+		if (files.size() < 2) {
+			return usage();
+		}
+		const json baselineJson = loadJson(files[0]);
+		if (!baselineJson.contains("metrics")) {
+			Log(ERROR, "%s isn't a baseline (write one with --write-baseline)", files[0].c_str());
+			return 2;
+		}
+		Metrics baseline = readBaselineMetrics(baselineJson);
+		std::vector<Tolerance> tolerances = readTolerances(baselineJson);
+		Metrics current;
+		for (size_t i = 1; i < files.size(); ++i) {
+			addRunMetrics(loadJson(files[i]), current);
+		}
+
+		Log(RAW, "%-52s %10s %10s %8s %18s %7s %6s  %s", "metric", "baseline", "current", "change",
+			"95% CI", "p", "tol", "verdict");
+		int regressions = 0, improvements = 0, untestable = 0;
+		for (const auto& metric : current) {
+			const std::string& name = metric.first;
+			auto base = baseline.find(name);
+			if (base == baseline.end() || base->second.empty()) {
+				Log(RAW, "%-52s %10s %10s %8s %18s %7s %6s  %s", name.c_str(), "-", formatMs(median(metric.second)).c_str(),
+					"", "", "", "", "new");
+				continue;
+			}
+			const std::vector<double>& baseValues = base->second;
+			const std::vector<double>& currentValues = metric.second;
+			double baseMedian = median(baseValues), currentMedian = median(currentValues);
+			double change = baseMedian > 0.0 ? currentMedian / baseMedian - 1.0 : 0.0;
+			double tolerance = toleranceFor(name, tolerances, defaultTolerance) / 100.0;
+
+			bool repeated = baseValues.size() > 1 && currentValues.size() > 1;
+			double pSlower = repeated ? mannWhitneyGreater(baseValues, currentValues) : 0.0;
+			double pFaster = repeated ? mannWhitneyGreater(currentValues, baseValues) : 0.0;
+			std::pair<double, double> interval = bootstrapChange(baseValues, currentValues);
+
+			// (too few runs for the test: the interval decides)
+			bool testable = !repeated || smallestMannWhitneyP(baseValues.size(), currentValues.size()) < alpha;
+			bool slower = !repeated ? true : testable ? pSlower < alpha : interval.first > tolerance;
+			bool faster = !repeated ? true : testable ? pFaster < alpha : interval.second < -tolerance;
+			untestable += testable ? 0 : 1;
+
+			const char* verdict = "ok";
+			if (change > tolerance && slower) {
+				verdict = "REGRESSION";
+				++regressions;
+			} else if (change > tolerance) {
+				verdict = "slower? (noise)";
+			} else if (change < -tolerance && faster) {
+				verdict = "faster";
+				++improvements;
+			}
+
+			char p[16] = "-", ci[48], tol[16];
+			if (repeated) {
+				snprintf(p, sizeof(p), "%.3f", change >= 0.0 ? pSlower : pFaster);
+			}
+			snprintf(ci, sizeof(ci), "[%s, %s]", formatPercent(interval.first).c_str(), formatPercent(interval.second).c_str());
+			snprintf(tol, sizeof(tol), "%.0f%%", tolerance * 100.0);
+			Log(RAW, "%-52s %10s %10s %8s %18s %7s %6s  %s", name.c_str(), formatMs(baseMedian).c_str(),
+				formatMs(currentMedian).c_str(), formatPercent(change).c_str(), ci, p, tol, verdict);
+		}
+		for (const auto& metric : baseline) {
+			if (current.find(metric.first) == current.end()) {
+				Log(RAW, "%-52s %10s %10s %8s %18s %7s %6s  %s", metric.first.c_str(), formatMs(median(metric.second)).c_str(),
+					"-", "", "", "", "", "missing");
+			}
+		}
+
+		if (untestable > 0) {
+			Log(RAW, "\n%d metric%s had too few runs for p to reach %g, so were judged by the 95%% CI instead"
+				" (more runs a side make the test usable)", untestable, untestable == 1 ? "" : "s", alpha);
+		}
+		Log(RAW, "\n%d regression%s, %d improvement%s (%zu run%s against %zu baseline run%s)", regressions,
+			regressions == 1 ? "" : "s", improvements, improvements == 1 ? "" : "s", files.size() - 1,
+			files.size() == 2 ? "" : "s", static_cast<size_t>(baselineJson["runs"].get<double>()),
+			baselineJson["runs"].get<double>() == 1.0 ? "" : "s");
+		return regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	} catch (const std::exception& e) {
+		Log(ERROR, "%s", e.what());
+		return 2;
+	}
+}
@@ -0,0 +1,375 @@
+//
+// SceneGenerator.cpp
+//	Writes synthetic scenes of any size, to measure the viewer at scales its own scenes don't reach:
+//	a mix of GeneratedModel shapes and LoadedModel references, laid out in a grid, in clusters or at
+//	random, optionally as hierarchies, in the scene file format SceneManager::loadFromFile reads.
+//
+// Usage: sceneGenerator [--objects N] [--loaded-ratio F] [--distribution grid|clustered|random]
+//						 [--clusters N] [--spacing S] [--depth D] [--children N] [--segments N]
+//						 [--asset-dir DIR] [--mesh-share F] [--texture-share F] [--seed N] output.json
+//	(defaults: 1,000 objects, a quarter of them loaded, in a grid 3 units apart, all roots, seed 12345)
+//
+// --depth makes trees D levels deep below each root (each parent having --children children, 4),
+//	the distribution placing roots and each descendant sitting near its parent.
+// --asset-dir writes synthetic OBJ meshes and BMP textures there for LoadedModels to share: the share
+//	ratios run from 0 (each LoadedModel has its own) to 1 (all share one), so 0.9 means ten objects a
+//	mesh, on average. Without it, LoadedModels all reference the repo's own cube and crate texture.
+//	Asset paths are written as given, so run this from the directory the viewer runs in.
+// Loading takes around 8 KB an object (almost all of it the JSON parse tree), so a million is ~9 GB.
+//
+#include "utils/logger/Logging.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	const int MIN_OBJECTS = 10;
+	const int MAX_OBJECTS = 1000000;
+	const int MESH_SEGMENTS = 16;		// (of the synthetic OBJs, which are bumpy spheres)
+	const int TEXTURE_SIZE = 64;
+	const char* DEFAULT_MESH = "assets/models/cube.obj";
+	const char* DEFAULT_TEXTURE = "assets/textures/C4Crate.png";
+
+	enum class Distribution { GRID, CLUSTERED, RANDOM };
+
+	struct Settings {
+		int objects = 1000;
+		double loadedRatio = 0.25;
+		Distribution distribution = Distribution::GRID;
+		int clusters = 16;
+		float spacing = 3.0f;
+		int depth = 0;
+		int children = 4;
+		int segments = 24;
+		std::string assetDirectory;
+		double meshShare = 0.9;
+		double textureShare = 0.9;
+		unsigned seed = 12345;
+		std::string outputFile;
+	};
+
+	// GeneratedModel's shapes (by their GeneratedModel::Shape value), with its initializeDefaults()
+	struct ShapeInfo {
+		int shape;
+		const char* name;
+		float param1, param2;
+		bool tessellated;		// (takes --segments)
+	};
+	const ShapeInfo SHAPES[] = {
+		{ 0, "Cube",		 1.0f, 0.0f, false },
+		{ 1, "Sphere",		 1.0f, 0.0f, true },
+		{ 2, "Cylinder",	 0.5f, 1.0f, true },
+		{ 3, "Plane",		 1.0f, 1.0f, false },
+		{ 4, "Dodecahedron", 1.0f, 0.0f, false }
+	};
+
+	struct Point { float x, y, z; };
+
+	// Of 'count' users, how many distinct assets a share ratio leaves them
+	int distinctCount(int count, double share) {
+		return std::max(1, static_cast<int>(std::ceil(count * (1.0 - share))));
+	}
+
+	bool parseDistribution(const std::string& text, Distribution& distribution) {
+		if (text == "grid") {
+			distribution = Distribution::GRID;
+		} else if (text == "clustered") {
+			distribution = Distribution::CLUSTERED;
+		} else if (text == "random") {
+			distribution = Distribution::RANDOM;
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	bool parseArguments(int argc, char* argv[], Settings& settings) {
+		for (int i = 1; i < argc; ++i) {
+			std::string argument = argv[i];
+			if (argument.compare(0, 2, "--") != 0) {
+				if (!settings.outputFile.empty()) {
+					return false;
+				}
+				settings.outputFile = argument;
+				continue;
+			}
+			if (i + 1 >= argc) {
+				return false;
+			}
+			const char* value = argv[++i];
+			if (argument == "--objects") {
+				settings.objects = std::min(std::max(atoi(value), MIN_OBJECTS), MAX_OBJECTS);
+			} else if (argument == "--loaded-ratio") {
+				settings.loadedRatio = std::min(std::max(atof(value), 0.0), 1.0);
+			} else if (argument == "--distribution") {
+				if (!parseDistribution(value, settings.distribution)) {
+					return false;
+				}
+			} else if (argument == "--clusters") {
+				settings.clusters = std::max(1, atoi(value));
+			} else if (argument == "--spacing") {
+				settings.spacing = std::max(0.1f, static_cast<float>(atof(value)));
+			} else if (argument == "--depth") {
+				settings.depth = std::min(std::max(atoi(value), 0), 32);
+			} else if (argument == "--children") {
+				settings.children = std::max(1, atoi(value));
+			} else if (argument == "--segments") {
+				settings.segments = std::max(3, atoi(value));
+			} else if (argument == "--asset-dir") {
+				settings.assetDirectory = value;
+			} else if (argument == "--mesh-share") {
+				settings.meshShare = std::min(std::max(atof(value), 0.0), 1.0);
+			} else if (argument == "--texture-share") {
+				settings.textureShare = std::min(std::max(atof(value), 0.0), 1.0);
+			} else if (argument == "--seed") {
+				settings.seed = static_cast<unsigned>(strtoul(value, nullptr, 10));
+			} else {
+				return false;
+			}
+		}
+		return !settings.outputFile.empty();
+	}
+
+	// A UV sphere of radius about 1, its surface displaced by a few random bumps (so each mesh differs)
+	bool writeObj(const std::string& path, std::mt19937& random) {
+		std::ofstream file(path);
+		if (!file) {
+			return false;
+		}
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		float bumpX = unit(random) * 3.0f, bumpY = unit(random) * 3.0f, bumpDepth = unit(random) * 0.15f;
+		const float PI = 3.14159265f;
+		const int rings = MESH_SEGMENTS / 2, row = MESH_SEGMENTS + 1;
+
+		file << "# synthetic mesh (sceneGenerator)\n";
+		char line[96];
+		for (int ring = 0; ring <= rings; ++ring) {
+			float phi = PI * ring / rings;
+			for (int segment = 0; segment <= MESH_SEGMENTS; ++segment) {
+				float theta = 2.0f * PI * segment / MESH_SEGMENTS;
+				float nx = std::sin(phi) * std::cos(theta), ny = std::cos(phi), nz = std::sin(phi) * std::sin(theta);
+				float radius = 1.0f + bumpDepth * std::sin(bumpX * theta) * std::sin(bumpY * phi);
+				snprintf(line, sizeof(line), "v %.4f %.4f %.4f\n", nx * radius, ny * radius, nz * radius);
+				file << line;
+				snprintf(line, sizeof(line), "vt %.4f %.4f\n", static_cast<float>(segment) / MESH_SEGMENTS,
+						 1.0f - static_cast<float>(ring) / rings);
+				file << line;
+				snprintf(line, sizeof(line), "vn %.4f %.4f %.4f\n", nx, ny, nz);
+				file << line;
+			}
+		}
+		for (int ring = 0; ring < rings; ++ring) {
+			for (int segment = 0; segment < MESH_SEGMENTS; ++segment) {
+				int a = ring * row + segment + 1, b = a + 1, c = a + row + 1, d = a + row;
+				snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+						 a, a, a, d, d, d, c, c, c, b, b, b);
+				file << line;
+			}
+		}
+		return static_cast<bool>(file);
+	}
+
+	void writeLittleEndian(std::ofstream& file, uint32_t value, int bytes) {
+		for (int i = 0; i < bytes; ++i) {
+			file.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+		}
+	}
+
+	// A two-tone checkerboard, as an uncompressed 24-bit BMP (which SDL_image loads without any codec)
+	bool writeBmp(const std::string& path, std::mt19937& random) {
+		std::ofstream file(path, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		std::uniform_int_distribution<int> channel(40, 255);
+		uint8_t light[3] = { static_cast<uint8_t>(channel(random)), static_cast<uint8_t>(channel(random)),
+							 static_cast<uint8_t>(channel(random)) };
+		uint8_t dark[3] = { static_cast<uint8_t>(light[0] / 3), static_cast<uint8_t>(light[1] / 3),
+							static_cast<uint8_t>(light[2] / 3) };
+		const uint32_t rowBytes = TEXTURE_SIZE * 3;		// (already a multiple of 4, so unpadded)
+		const uint32_t imageBytes = rowBytes * TEXTURE_SIZE;
+
+		file.put('B');
+		file.put('M');
+		writeLittleEndian(file, 54 + imageBytes, 4);	// (file size)
+		writeLittleEndian(file, 0, 4);
+		writeLittleEndian(file, 54, 4);					// (offset of the pixels)
+		writeLittleEndian(file, 40, 4);					// (BITMAPINFOHEADER size)
+		writeLittleEndian(file, TEXTURE_SIZE, 4);
+		writeLittleEndian(file, TEXTURE_SIZE, 4);
+		writeLittleEndian(file, 1, 2);					// (planes)
+		writeLittleEndian(file, 24, 2);					// (bits per pixel)
+		writeLittleEndian(file, 0, 4);					// (uncompressed)
+		writeLittleEndian(file, imageBytes, 4);
+		writeLittleEndian(file, 2835, 4);				// (72 DPI, both ways)
+		writeLittleEndian(file, 2835, 4);
+		writeLittleEndian(file, 0, 4);
+		writeLittleEndian(file, 0, 4);
+		for (int y = 0; y < TEXTURE_SIZE; ++y) {
+			for (int x = 0; x < TEXTURE_SIZE; ++x) {
+				const uint8_t* color = ((x / 8 + y / 8) % 2) ? light : dark;
+				file.put(static_cast<char>(color[2]));	// (BGR)
+				file.put(static_cast<char>(color[1]));
+				file.put(static_cast<char>(color[0]));
+			}
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool writeAssets(const std::string& directory, const char* prefix, const char* extension, int count,
+					 bool (*write)(const std::string&, std::mt19937&), std::mt19937& random,
+					 std::vector<std::string>& paths) {
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		for (int i = 0; i < count; ++i) {
+			char filename[64];
+			snprintf(filename, sizeof(filename), "/%s_%06d.%s", prefix, i, extension);
+			paths.push_back(directory + filename);
+			if (!write(paths.back(), random)) {
+				Log(ERROR, "Can't write %s", paths.back().c_str());
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Where each root goes: the distribution covers a square about 'spacing' per root on a side
+	std::vector<Point> placeRoots(const Settings& settings, int rootCount, std::mt19937& random) {
+		std::vector<Point> positions;
+		positions.reserve(rootCount);
+		int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(rootCount))));
+		float extent = side * settings.spacing;
+		std::uniform_real_distribution<float> across(-extent / 2, extent / 2);
+		std::uniform_real_distribution<float> height(-settings.spacing, settings.spacing);
+
+		if (settings.distribution == Distribution::GRID) {
+			for (int i = 0; i < rootCount; ++i) {
+				positions.push_back({ (i % side - (side - 1) / 2.0f) * settings.spacing, 0.0f,
+									  (i / side - (side - 1) / 2.0f) * settings.spacing });
+			}
+		} else if (settings.distribution == Distribution::RANDOM) {
+			for (int i = 0; i < rootCount; ++i) {
+				positions.push_back({ across(random), height(random), across(random) });
+			}
+		} else {
+			// (clusters spread like the random distribution, their members normally about their centers)
+			std::vector<Point> centers;
+			for (int i = 0; i < settings.clusters; ++i) {
+				centers.push_back({ across(random), height(random), across(random) });
+			}
+			std::uniform_int_distribution<int> cluster(0, settings.clusters - 1);
+			std::normal_distribution<float> offset(0.0f, extent / (4.0f * std::sqrt(static_cast<float>(settings.clusters))));
+			for (int i = 0; i < rootCount; ++i) {
+				const Point& center = centers[cluster(random)];
+				positions.push_back({ center.x + offset(random), center.y + offset(random) * 0.25f,
+									  center.z + offset(random) });
+			}
+		}
+		return positions;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Settings settings;
+	if (!parseArguments(argc, argv, settings)) {
+		Log(ERROR, "Usage: sceneGenerator [--objects N] [--loaded-ratio F] [--distribution grid|clustered|random] "
+				   "[--clusters N] [--spacing S] [--depth D] [--children N] [--segments N] [--asset-dir DIR] "
+				   "[--mesh-share F] [--texture-share F] [--seed N] output.json");
+		return EXIT_FAILURE;
+	}
+	std::mt19937 random(settings.seed);
+
+	// Which objects are loaded (spread evenly through the scene, so every region has some)
+	int loadedCount = static_cast<int>(std::lround(settings.objects * settings.loadedRatio));
+	auto isLoaded = [&](int i) {
+		return static_cast<long long>(i + 1) * loadedCount / settings.objects
+			 > static_cast<long long>(i) * loadedCount / settings.objects;
+	};
+
+	std::vector<std::string> meshes, textures;
+	if (settings.assetDirectory.empty() || loadedCount == 0) {
+		meshes.push_back(DEFAULT_MESH);
+		textures.push_back(DEFAULT_TEXTURE);
+	} else if (!writeAssets(settings.assetDirectory, "mesh", "obj", distinctCount(loadedCount, settings.meshShare),
+							writeObj, random, meshes)
+			|| !writeAssets(settings.assetDirectory, "texture", "bmp", distinctCount(loadedCount, settings.textureShare),
+							writeBmp, random, textures)) {
+		return EXIT_FAILURE;
+	}
+
+	// Trees of depth D with N children a parent, heap-ordered: each node's parent is (node - 1) / N
+	long long treeSize = 1, levelSize = 1;
+	for (int level = 0; level < settings.depth && treeSize < settings.objects; ++level) {
+		levelSize *= settings.children;
+		treeSize += levelSize;
+	}
+	int rootCount = static_cast<int>((settings.objects + treeSize - 1) / treeSize);
+	std::vector<Point> roots = placeRoots(settings, rootCount, random);
+
+	FILE* file = fopen(settings.outputFile.c_str(), "w");
+	if (!file) {
+		Log(ERROR, "Can't write %s", settings.outputFile.c_str());
+		return EXIT_FAILURE;
+	}
+	fprintf(file, "{\n    \"version\": \"1.1\",\n    \"objectCount\": %d,\n    \"objects\": [", settings.objects);
+
+	std::uniform_int_distribution<int> shapeIndex(0, static_cast<int>(sizeof(SHAPES) / sizeof(SHAPES[0])) - 1);
+	std::uniform_int_distribution<int> meshIndex(0, static_cast<int>(meshes.size()) - 1);
+	std::uniform_int_distribution<int> textureIndex(0, static_cast<int>(textures.size()) - 1);
+	std::uniform_real_distribution<float> yaw(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> scale(0.75f, 1.25f);
+	std::uniform_real_distribution<float> nearby(-settings.spacing * 0.4f, settings.spacing * 0.4f);
+	int usedMeshes = 0, usedTextures = 0;
+
+	for (int i = 0; i < settings.objects; ++i) {
+		long long node = i % treeSize;
+		Point position = node == 0 ? roots[i / treeSize]
+								   : Point{ nearby(random), settings.spacing * 0.25f, nearby(random) };	// (parent-relative)
+		float size = scale(random);
+
+		fprintf(file, "%s\n        {\n", i > 0 ? "," : "");
+		if (isLoaded(i)) {
+			// (every asset gets used before any is reused, then the rest are picked at random)
+			const std::string& mesh = usedMeshes < static_cast<int>(meshes.size()) ? meshes[usedMeshes++] : meshes[meshIndex(random)];
+			const std::string& texture = usedTextures < static_cast<int>(textures.size()) ? textures[usedTextures++] : textures[textureIndex(random)];
+			fprintf(file, "            \"name\": \"Loaded %d\",\n            \"type\": \"LoadedModel\",\n"
+						  "            \"filePath\": \"%s\",\n            \"materialPath\": \"\",\n"
+						  "            \"texturePath\": \"%s\",\n            \"flipTextureY\": false,\n",
+					i, mesh.c_str(), texture.c_str());
+		} else {
+			const ShapeInfo& shape = SHAPES[shapeIndex(random)];
+			fprintf(file, "            \"name\": \"%s %d\",\n            \"type\": \"GeneratedModel\",\n"
+						  "            \"shape\": %d,\n            \"shapeName\": \"%s\",\n"
+						  "            \"param1\": %g,\n            \"param2\": %g,\n            \"segments\": %d,\n",
+					shape.name, i, shape.shape, shape.name, shape.param1, shape.param2,
+					shape.tessellated ? settings.segments : 1);
+		}
+		fprintf(file, "            \"position\": { \"x\": %.3f, \"y\": %.3f, \"z\": %.3f },\n"
+					  "            \"rotation\": { \"x\": 0.0, \"y\": %.1f, \"z\": 0.0 },\n"
+					  "            \"scale\": { \"x\": %.3f, \"y\": %.3f, \"z\": %.3f }",
+				position.x, position.y, position.z, yaw(random), size, size, size);
+		if (node > 0) {
+			fprintf(file, ",\n            \"parent\": %lld", i - node + (node - 1) / settings.children);
+		}
+		fprintf(file, "\n        }");
+	}
+	fprintf(file, "\n    ]\n}\n");
+	bool written = !ferror(file);
+	if (fclose(file) != 0 || !written) {
+		Log(ERROR, "Failed writing %s", settings.outputFile.c_str());
+		return EXIT_FAILURE;
+	}
+
+	const char* distributionNames[] = { "grid", "clustered", "random" };
+	Log(RAW, "%s: %d objects (%d loaded, sharing %zu meshes and %zu textures), %d roots in a %s, depth %d",
+		settings.outputFile.c_str(), settings.objects, loadedCount, meshes.size(), textures.size(), rootCount,
+		distributionNames[static_cast<int>(settings.distribution)], settings.depth);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+//
+// TextureEncoder.cpp
+//	Offline pre-population of the block-compressed texture cache,
+//	so the viewer's first run doesn't pay for encoding.
+//
+// Usage: textureEncoder [--bc3] [--flip] [--cache <dir>] image...
+//	(run from the directory the viewer runs in, so cache paths match)
+//
+#include "rendering/TextureCache.h"
+#include "utils/logger/Logging.h"
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+	bool preferBC7 = true;
+	bool flipVertically = false;
+	std::vector<std::string> sources;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--bc3") == 0)
+			preferBC7 = false;
+		else if (strcmp(argv[i], "--flip") == 0)
+			flipVertically = true;
+		else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+			TextureCache::setDirectory(argv[++i]);
+		else
+			sources.push_back(argv[i]);
+	}
+	if (sources.empty()) {
+		Log(RAW, "Usage: %s [--bc3] [--flip] [--cache <dir>] image...", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	int failures = 0;
+	for (const std::string& source : sources) {
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		CompressedImage image;
+		if (!TextureCache::encodeFile(source, flipVertically, preferBC7, image)
+		 || !TextureCache::store(source, flipVertically, image)) {
+			Log(ERROR, "Failed to encode %s", source.c_str());
+			++failures;
+			continue;
+		}
+
+		float elapsedMs = std::chrono::duration<float, std::milli>(
+							std::chrono::high_resolution_clock::now() - startTime).count();
+		size_t uncompressedSize = 0;
+		for (const MipLevel& level : image.levels)
+			uncompressedSize += static_cast<size_t>(level.width) * level.height * 4;
+		Log(RAW, "%s: %u x %u %s, %zu mips, %.1f KB (%.1f:1) in %.0f ms -> %s",
+			source.c_str(), image.width, image.height, TextureCompressor::formatName(image.format), image.levels.size(),
+			image.data.size() / 1024.0f, static_cast<float>(uncompressedSize) / image.data.size(), elapsedMs,
+			TextureCache::cachePathFor(source, flipVertically).c_str());
+	}
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}